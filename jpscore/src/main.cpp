@@ -33,7 +33,6 @@
 #include "general/Format.h"
 #include "general/Logger.h"
 #include "geometry/Building.h"
-#include "pedestrian/AgentsSourcesManager.h"
 
 #include <iomanip>
 #include <memory>
@@ -41,7 +40,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
-#include <thread>
 #include <time.h>
 
 int main(int argc, char ** argv)
@@ -75,6 +73,7 @@ int main(int argc, char ** argv)
 
         return EXIT_FAILURE;
     }
+    config.set_ff_cache_rebuild(a.RebuildFloorfieldCache());
 
 
     // create and initialize the simulation engine
@@ -85,26 +84,10 @@ int main(int argc, char ** argv)
     Simulation sim(&config);
 
     if(sim.InitArgs()) {
-        // evacuation time
-        double evacTime = 0;
         Logging::Info(
             fmt::format(check_fmt("Simulation started with {} pedestrians"), sim.GetPedsNumber()));
-        if(sim.GetAgentSrcManager().GetMaxAgentNumber()) {
-            // Start the thread for managing the sources of agents if any
-            // std::thread t1(sim.GetAgentSrcManager());
-            double simMaxTime = config.GetTmax();
-            std::thread t1(&AgentsSourcesManager::Run, &sim.GetAgentSrcManager());
-            while(!sim.GetAgentSrcManager().IsRunning()) {
-                // std::cout << "waiting...\n";
-            }
-            // main thread for the simulation
-            evacTime = sim.RunStandardSimulation(simMaxTime);
-            // Join the main thread
-            t1.join();
-        } else {
-            // main thread for the simulation
-            evacTime = sim.RunStandardSimulation(config.GetTmax());
-        }
+        // evacuation time, agent sources are processed by the simulation loop
+        const double evacTime = sim.RunStandardSimulation(config.GetTmax());
 
         Logging::Info(fmt::format(check_fmt("\n\nSimulation completed"), sim.GetPedsNumber()));
         time(&endtime);
@@ -40,6 +40,7 @@
 #include "methods/Method_J.h"
 #include "methods/PedData.h"
 #include "methods/VoronoiDiagram.h"
+#include "methods/VoronoiPipeline.h"
 
 #include <algorithm> // std::min_element, std::max_element
 #include <cfloat>
@@ -331,7 +332,6 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             Log->Write("ERROR: Method A selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
-#pragma omp parallel for
         for(int i = 0; i < int(_areaForMethod_A.size()); i++) {
             Method_A method_A;
             method_A.SetMeasurementArea(_areaForMethod_A[i]);
@@ -358,7 +358,6 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             exit(EXIT_FAILURE);
         }
 
-#pragma omp parallel for
         for(int i = 0; i < int(_areaForMethod_B.size()); i++) {
             Method_B method_B;
             method_B.SetMeasurementArea(_areaForMethod_B[i]);
@@ -383,7 +382,6 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             Log->Write("ERROR: Method C selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
-#pragma omp parallel for
         for(int i = 0; i < int(_areaForMethod_C.size()); i++) {
             Method_C method_C;
             method_C.SetMeasurementArea(_areaForMethod_C[i]);
@@ -402,6 +400,15 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
         }
     }
 
+    // the Voronoi methods share the Voronoi cells of each frame and analyse the frames in parallel
+    VoronoiPipeline voronoiPipeline;
+    voronoiPipeline.SetGeometryBoundaries(_lowVertexX, _lowVertexY, _highVertexX, _highVertexY);
+    if(_cutByCircle) {
+        voronoiPipeline.Setcutbycircle(_cutRadius, _circleEdges);
+    }
+
+    std::vector<Method_D> methods_D;
+    std::vector<bool> results_D;
     if(_DoesUseMethodD) //method_D
     {
         if(_areaForMethod_D.empty()) {
@@ -409,38 +416,32 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             exit(EXIT_FAILURE);
         }
 
-#pragma omp parallel for
+        methods_D.resize(_areaForMethod_D.size());
         for(int i = 0; i < int(_areaForMethod_D.size()); i++) {
-            Method_D method_D;
+            Method_D & method_D = methods_D[i];
             method_D.SetStartFrame(_StartFramesMethodD[i]);
             method_D.SetStopFrame(_StopFramesMethodD[i]);
             method_D.SetCalculateIndividualFD(_IndividualFDFlags[i]);
-            method_D.SetGeometryPolygon(_geoPolyMethodD[_areaForMethod_D[i]->_id]);
             method_D.SetGeometryFileName(_geometryFileName);
             method_D.SetGeometryBoundaries(_lowVertexX, _lowVertexY, _highVertexX, _highVertexY);
             method_D.SetGridSize(_grid_size_X, _grid_size_Y);
             method_D.SetDimensional(_isOneDimensional);
             method_D.SetCalculateProfiles(_getProfile);
             method_D.SetTrajectoriesLocation(path);
-            if(_cutByCircle) {
-                method_D.Setcutbycircle(_cutRadius, _circleEdges);
-            }
             method_D.SetMeasurementArea(_areaForMethod_D[i]);
-            bool result_D = method_D.Process(data, _scriptsLocation, _areaForMethod_D[i]->_zPos);
-            if(result_D) {
-                Log->Write(
-                    "INFO:\tSuccess with Method D using measurement area id %d!\n",
-                    _areaForMethod_D[i]->_id);
-                std::cout << "INFO:\tSuccess with Method D using measurement area id "
-                          << _areaForMethod_D[i]->_id << "\n";
-            } else {
-                Log->Write(
-                    "INFO:\tFailed with Method D using measurement area id %d!\n",
-                    _areaForMethod_D[i]->_id);
+            results_D.push_back(
+                method_D.Prepare(data, _scriptsLocation, _areaForMethod_D[i]->_zPos));
+            if(results_D[i]) {
+                voronoiPipeline.AddMethod(
+                    &method_D,
+                    _geoPolyMethodD[_areaForMethod_D[i]->_id],
+                    _areaForMethod_D[i]->_zPos);
             }
         }
     }
 
+    std::vector<Method_I> methods_I;
+    std::vector<bool> results_I;
     if(_DoesUseMethodI) //method_I
     {
         if(_areaForMethod_I.empty()) {
@@ -448,37 +449,31 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             exit(EXIT_FAILURE);
         }
 
-#pragma omp parallel for
+        methods_I.resize(_areaForMethod_I.size());
         for(int i = 0; i < int(_areaForMethod_I.size()); i++) {
-            Method_I method_I;
+            Method_I & method_I = methods_I[i];
             method_I.SetStartFrame(_StartFramesMethodI[i]);
             method_I.SetStopFrame(_StopFramesMethodI[i]);
             method_I.SetCalculateIndividualFD(_IndividualFDFlags[i]);
-            method_I.SetGeometryPolygon(_geoPolyMethodI[_areaForMethod_I[i]->_id]);
             method_I.SetGeometryFileName(_geometryFileName);
             method_I.SetGeometryBoundaries(_lowVertexX, _lowVertexY, _highVertexX, _highVertexY);
             method_I.SetGridSize(_grid_size_X, _grid_size_Y);
             method_I.SetDimensional(_isOneDimensional);
             method_I.SetTrajectoriesLocation(path);
-            if(_cutByCircle) {
-                method_I.Setcutbycircle(_cutRadius, _circleEdges);
-            }
             method_I.SetMeasurementArea(_areaForMethod_I[i]);
-            bool result_I = method_I.Process(data, _scriptsLocation, _areaForMethod_I[i]->_zPos);
-            if(result_I) {
-                Log->Write(
-                    "INFO:\tSuccess with Method I using measurement area id %d!\n",
-                    _areaForMethod_I[i]->_id);
-                std::cout << "INFO:\tSuccess with Method I using measurement area id "
-                          << _areaForMethod_I[i]->_id << "\n";
-            } else {
-                Log->Write(
-                    "INFO:\tFailed with Method I using measurement area id %d!\n",
-                    _areaForMethod_I[i]->_id);
+            results_I.push_back(
+                method_I.Prepare(data, _scriptsLocation, _areaForMethod_I[i]->_zPos));
+            if(results_I[i]) {
+                voronoiPipeline.AddMethod(
+                    &method_I,
+                    _geoPolyMethodI[_areaForMethod_I[i]->_id],
+                    _areaForMethod_I[i]->_zPos);
             }
         }
     }
 
+    std::vector<Method_J> methods_J;
+    std::vector<bool> results_J;
     if(_DoesUseMethodJ) //Method_J
     {
         if(_areaForMethod_J.empty()) {
@@ -486,39 +481,77 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             exit(EXIT_FAILURE);
         }
 
-#pragma omp parallel for
+        methods_J.resize(_areaForMethod_J.size());
         for(int i = 0; i < int(_areaForMethod_J.size()); i++) {
-            Method_J Method_J;
+            Method_J & Method_J = methods_J[i];
             Method_J.SetStartFrame(_StartFramesMethodJ[i]);
             Method_J.SetStopFrame(_StopFramesMethodJ[i]);
             Method_J.SetCalculateIndividualFD(_IndividualFDFlags[i]);
-            Method_J.SetGeometryPolygon(_geoPolyMethodJ[_areaForMethod_J[i]->_id]);
             Method_J.SetGeometryFileName(_geometryFileName);
             Method_J.SetGeometryBoundaries(_lowVertexX, _lowVertexY, _highVertexX, _highVertexY);
             Method_J.SetGridSize(_grid_size_X, _grid_size_Y);
             Method_J.SetDimensional(_isOneDimensional);
             Method_J.SetCalculateProfiles(_getProfile);
             Method_J.SetTrajectoriesLocation(path);
-            if(_cutByCircle) {
-                Method_J.Setcutbycircle(_cutRadius, _circleEdges);
-            }
             Method_J.SetMeasurementArea(_areaForMethod_J[i]);
-            bool result_Voronoi =
-                Method_J.Process(data, _scriptsLocation, _areaForMethod_J[i]->_zPos);
-            if(result_Voronoi) {
-                Log->Write(
-                    "INFO:\tSuccess with Method J using measurement area id %d!\n",
-                    _areaForMethod_J[i]->_id);
-                std::cout << "INFO:\tSuccess with Method J using measurement area id "
-                          << _areaForMethod_J[i]->_id << "\n";
-            } else {
-                Log->Write(
-                    "INFO:\tFailed with Method J using measurement area id %d!\n",
-                    _areaForMethod_J[i]->_id);
+            results_J.push_back(
+                Method_J.Prepare(data, _scriptsLocation, _areaForMethod_J[i]->_zPos));
+            if(results_J[i]) {
+                voronoiPipeline.AddMethod(
+                    &Method_J,
+                    _geoPolyMethodJ[_areaForMethod_J[i]->_id],
+                    _areaForMethod_J[i]->_zPos);
             }
         }
     }
 
+    voronoiPipeline.Run(data);
+
+    for(int i = 0; i < int(methods_D.size()); i++) {
+        if(results_D[i]) {
+            methods_D[i].Finish();
+            Log->Write(
+                "INFO:\tSuccess with Method D using measurement area id %d!\n",
+                _areaForMethod_D[i]->_id);
+            std::cout << "INFO:\tSuccess with Method D using measurement area id "
+                      << _areaForMethod_D[i]->_id << "\n";
+        } else {
+            Log->Write(
+                "INFO:\tFailed with Method D using measurement area id %d!\n",
+                _areaForMethod_D[i]->_id);
+        }
+    }
+
+    for(int i = 0; i < int(methods_I.size()); i++) {
+        if(results_I[i]) {
+            methods_I[i].Finish();
+            Log->Write(
+                "INFO:\tSuccess with Method I using measurement area id %d!\n",
+                _areaForMethod_I[i]->_id);
+            std::cout << "INFO:\tSuccess with Method I using measurement area id "
+                      << _areaForMethod_I[i]->_id << "\n";
+        } else {
+            Log->Write(
+                "INFO:\tFailed with Method I using measurement area id %d!\n",
+                _areaForMethod_I[i]->_id);
+        }
+    }
+
+    for(int i = 0; i < int(methods_J.size()); i++) {
+        if(results_J[i]) {
+            methods_J[i].Finish();
+            Log->Write(
+                "INFO:\tSuccess with Method J using measurement area id %d!\n",
+                _areaForMethod_J[i]->_id);
+            std::cout << "INFO:\tSuccess with Method J using measurement area id "
+                      << _areaForMethod_J[i]->_id << "\n";
+        } else {
+            Log->Write(
+                "INFO:\tFailed with Method J using measurement area id %d!\n",
+                _areaForMethod_J[i]->_id);
+        }
+    }
+
     return 0;
 }
 
@@ -57,6 +57,7 @@ int OutputHandler::GetErrors()
 
 void OutputHandler::Write(const string & str)
 {
+    std::lock_guard<std::mutex> lock(_writeMutex);
     cout << str << endl;
 }
 
@@ -97,6 +98,7 @@ void OutputHandler::Write(const char * message, ...)
 
     string str(msg);
 
+    std::lock_guard<std::mutex> lock(_writeMutex);
     if(str.find("ERROR") != string::npos) {
         cerr << msg << endl;
         cerr.flush();
@@ -121,6 +123,7 @@ void STDIOHandler::Write(const char * message, ...)
 
     string str(msg);
 
+    std::lock_guard<std::mutex> lock(_writeMutex);
     if(str.find("ERROR") != string::npos) {
         cerr << msg << endl;
         cerr.flush();
@@ -137,6 +140,7 @@ void STDIOHandler::Write(const char * message, ...)
 
 void STDIOHandler::Write(const string & str)
 {
+    std::lock_guard<std::mutex> lock(_writeMutex);
     if(str.find("ERROR") != string::npos) {
         cerr << str << endl;
         cerr.flush();
@@ -170,8 +174,11 @@ FileHandler::~FileHandler()
 
 void FileHandler::Write(const string & str)
 {
-    _pfp << str << endl;
-    _pfp.flush();
+    {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        _pfp << str << endl;
+        _pfp.flush();
+    }
 
     if(str.find("ERROR") != string::npos) {
         incrementErrors();
@@ -187,8 +194,11 @@ void FileHandler::Write(const char * str_msg, ...)
     va_start(ap, str_msg);
     vsprintf(msg, str_msg, ap);
     va_end(ap);
-    _pfp << msg << endl;
-    _pfp.flush();
+    {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        _pfp << msg << endl;
+        _pfp.flush();
+    }
 
     string str(msg);
     if(str.find("ERROR") != string::npos) {
@@ -225,6 +235,7 @@ void SocketHandler::Write(const string & stringRef)
             str.erase(str.begin() + tagstart, str.begin() + tagstart + (*str_it).size());
         }
     }
+    std::lock_guard<std::mutex> lock(_writeMutex);
     client->sendData(str.c_str());
 }
 
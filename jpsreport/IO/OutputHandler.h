@@ -31,8 +31,10 @@
 
 #include "../general/Macros.h"
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 #ifdef _SIMULATOR
@@ -40,11 +42,15 @@
 #endif
 
 
+/**
+ * Writing is thread safe, the Voronoi methods log while frames are analysed in parallel.
+ */
 class OutputHandler
 {
 protected:
-    int _nWarnings;
-    int _nErrors;
+    std::atomic<int> _nWarnings;
+    std::atomic<int> _nErrors;
+    std::mutex _writeMutex; // serialises the output of concurrent Write calls
 
 public:
     OutputHandler()
@@ -0,0 +1,142 @@
+/**
+ * \file        TrajectoriesBinaryReader.h
+ * \copyright   <2009-2022> Forschungszentrum Juelich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Reader of the binary trajectory format of jpscore, see TrajectoriesBinary in
+ * libcore/src/IO/Trajectories.h. It only uses the standard library, so the unit
+ * tests of jpscore check it against the writer.
+ *
+ **/
+
+#ifndef TRAJECTORIESBINARYREADER_H_
+#define TRAJECTORIESBINARYREADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * Content of a binary trajectory file, positions in metres. The columns of all
+ * frames are appended to the same vectors, the agents of frame i are stored at
+ * [frameStart[i], frameStart[i + 1]).
+ */
+struct BinaryTrajectories {
+    static constexpr char MAGIC[4]                 = {'J', 'P', 'S', 'B'};
+    static constexpr std::uint32_t VERSION         = 2;
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    std::int32_t count = 0;
+    std::int32_t seed  = 0;
+    double fps         = 0;
+    std::string geometry;
+    std::vector<int> frames;
+    std::vector<std::size_t> frameStart{0};
+    std::vector<std::int32_t> ids;
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    int truncatedFrame = -1; ///< incomplete frame at the end of the file, it is dropped
+};
+
+/**
+ * Read the header and all complete frames of a binary trajectory file.
+ * @return an empty string on success, the reason why the file cannot be read otherwise
+ */
+inline std::string ReadBinaryTrajectories(std::istream & in, BinaryTrajectories & trajectories)
+{
+    auto read = [&in](void * value, std::size_t size) {
+        return static_cast<bool>(in.read(static_cast<char *>(value), size));
+    };
+
+    // header
+    char magic[4];
+    if(!read(magic, sizeof(magic)) ||
+       std::memcmp(magic, BinaryTrajectories::MAGIC, sizeof(magic)) != 0) {
+        return "not a binary trajectory file";
+    }
+    std::uint32_t byteOrderMark = 0;
+    if(!read(&byteOrderMark, sizeof(byteOrderMark))) {
+        return "incomplete header";
+    }
+    if(byteOrderMark != BinaryTrajectories::BYTE_ORDER_MARK) {
+        // the mark with its bytes reversed
+        return byteOrderMark == 0x04030201 ?
+                   "binary trajectory file written on a machine of the other byte order" :
+                   "unknown byte order of the binary trajectory file";
+    }
+    std::uint32_t version = 0;
+    if(!read(&version, sizeof(version))) {
+        return "incomplete header";
+    }
+    if(version != BinaryTrajectories::VERSION) {
+        return "unsupported version " + std::to_string(version) + " of the binary trajectory file";
+    }
+    std::uint32_t length = 0;
+    if(!read(&trajectories.count, sizeof(trajectories.count)) ||
+       !read(&trajectories.seed, sizeof(trajectories.seed)) ||
+       !read(&trajectories.fps, sizeof(trajectories.fps)) || !read(&length, sizeof(length))) {
+        return "incomplete header";
+    }
+    trajectories.geometry.assign(length, '\0');
+    if(length > 0 && !read(&trajectories.geometry[0], length)) {
+        return "incomplete header";
+    }
+
+    // frames
+    std::vector<std::int32_t> & ids = trajectories.ids;
+    std::vector<float> & xs         = trajectories.xs;
+    std::vector<float> & ys         = trajectories.ys;
+    std::vector<float> & zs         = trajectories.zs;
+    std::vector<float> angles; // not used by the analysis
+    std::int32_t frameNr = 0;
+    std::uint32_t nPeds  = 0;
+    while(read(&frameNr, sizeof(frameNr))) {
+        const std::size_t start = ids.size();
+        bool complete           = read(&nPeds, sizeof(nPeds));
+        if(complete) {
+            ids.resize(start + nPeds);
+            xs.resize(start + nPeds);
+            ys.resize(start + nPeds);
+            zs.resize(start + nPeds);
+            angles.resize(nPeds);
+            complete = read(ids.data() + start, nPeds * sizeof(std::int32_t)) &&
+                       read(xs.data() + start, nPeds * sizeof(float)) &&
+                       read(ys.data() + start, nPeds * sizeof(float)) &&
+                       read(zs.data() + start, nPeds * sizeof(float)) &&
+                       read(angles.data(), nPeds * sizeof(float));
+        }
+        if(!complete) {
+            trajectories.truncatedFrame = frameNr;
+            ids.resize(start);
+            xs.resize(start);
+            ys.resize(start);
+            zs.resize(start);
+            break;
+        }
+        trajectories.frames.push_back(frameNr);
+        trajectories.frameStart.push_back(ids.size());
+    }
+    return "";
+}
+
+#endif /* TRAJECTORIESBINARYREADER_H_ */
@@ -278,9 +278,11 @@ bool ArgumentParser::ParseIniFile(const string & inifile)
             _fileFormat = FORMAT_XML_PLAIN;
         } else if(fmt == ".txt") {
             _fileFormat = FORMAT_PLAIN;
+        } else if(fmt == ".bin") {
+            _fileFormat = FORMAT_BINARY;
         } else {
-            Log->Write("Error: \tthe given trajectory format is not supported. Supply '.xml' or "
-                       "'.txt' format!");
+            Log->Write("Error: \tthe given trajectory format is not supported. Supply '.xml', "
+                       "'.txt' or '.bin' format!");
             return false;
         }
 
@@ -127,7 +127,8 @@ enum FileFormat {
     FORMAT_XML_BIN,
     FORMAT_PLAIN,
     FORMAT_VTK,
-    FORMAT_XML_PLAIN_WITH_MESH
+    FORMAT_XML_PLAIN_WITH_MESH,
+    FORMAT_BINARY
 };
 
 enum RoutingStrategy {
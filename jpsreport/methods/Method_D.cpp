@@ -28,9 +28,13 @@
 
 #include "Method_D.h"
 
+#include "VoronoiProfile.h"
+
 #include <cmath>
+#include <fmt/printf.h>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <tuple>
 #include <vector>
 //using std::string;
@@ -49,9 +53,6 @@ Method_D::Method_D()
     _geoMinY          = 0;
     _geoMaxX          = 0;
     _geoMaxY          = 0;
-    _cutByCircle      = false;
-    _cutRadius        = -1;
-    _circleEdges      = -1;
     _fIndividualFD    = nullptr;
     _calcIndividualFD = false;
     _fVoronoiRhoV     = nullptr;
@@ -59,11 +60,12 @@ Method_D::Method_D()
     _isOneDimensional = false;
     _startFrame       = -1;
     _stopFrame        = -1;
+    _minFrame         = 0;
 }
 
 Method_D::~Method_D() {}
 
-bool Method_D::Process(
+bool Method_D::Prepare(
     const PedData & peddata,
     const fs::path & scriptsLocation,
     const double & zPos_measureArea)
@@ -78,6 +80,7 @@ bool Method_D::Process(
     _fps              = peddata.GetFps();
     int mycounter     = 0;
     int minFrame      = peddata.GetMinFrame();
+    _minFrame         = minFrame;
     Log->Write(
         "INFO:\tMethod D: frame rate fps: <%.2f>, start: <%d>, stop: <%d> (minFrame = %d)",
         _fps,
@@ -111,105 +114,103 @@ bool Method_D::Process(
         }
     }
     Log->Write("------------------------Analyzing with Method D-----------------------------");
-    for(auto ite : _peds_t) {
-        int frameNr = ite.first;
-        int frid    = frameNr + minFrame;
-        //padd the frameid with 0
-        std::ostringstream ss;
-        ss << std::setw(5) << std::setfill('0') << std::internal << frid;
-        const std::string str_frid = ss.str();
-        if(!(frid % 50)) {
-            Log->Write("INFO:\tframe ID = %d", frid);
-        }
-        vector<int> ids         = _peds_t[frameNr];
-        vector<int> IdInFrame   = peddata.GetIdInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> XInFrame = peddata.GetXInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> YInFrame = peddata.GetYInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> ZInFrame = peddata.GetZInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> VInFrame = peddata.GetVInFrame(frameNr, ids, zPos_measureArea);
-        //vector int to_remove
-        //------------------------------Remove peds outside geometry------------------------------------------
-        for(int i = 0; i < (int) IdInFrame.size(); i++) {
-            if(false == within(point_2d(round(XInFrame[i]), round(YInFrame[i])), _geoPoly)) {
-                Log->Write(
-                    "Warning:\tPedestrian at <x=%.4f, y=%.4f> is not in geometry and not "
-                    "considered in analysis!",
-                    XInFrame[i] * CMtoM,
-                    YInFrame[i] * CMtoM);
-                IdInFrame.erase(IdInFrame.begin() + i);
-                XInFrame.erase(XInFrame.begin() + i);
-                YInFrame.erase(YInFrame.begin() + i);
-                ZInFrame.erase(ZInFrame.begin() + i);
-                VInFrame.erase(VInFrame.begin() + i);
-                i--;
-            }
-        }
-        int NumPeds = IdInFrame.size();
-        //---------------------------------------------------------------------------------------------------------------
-        if(NumPeds > 3) {
-            if(_isOneDimensional) {
-                CalcVoronoiResults1D(
-                    XInFrame, VInFrame, IdInFrame, _areaForMethod_D->_poly, str_frid);
-            } else {
-                if(IsPointsOnOneLine(XInFrame, YInFrame)) {
-                    if(fabs(XInFrame[1] - XInFrame[0]) < dmin) {
-                        XInFrame[1] += offset;
-                    } else {
-                        YInFrame[1] += offset;
-                    }
+    return return_value;
+}
+
+bool Method_D::IsFrameAnalysed(int frameNr) const
+{
+    return _peds_t.count(frameNr) > 0;
+}
+
+void Method_D::AnalyseFrame(VoronoiFrame & frame, VoronoiFrameResults & results)
+{
+    int frid = frame.frameNr + _minFrame;
+    //padd the frameid with 0
+    std::ostringstream ss;
+    ss << std::setw(5) << std::setfill('0') << std::internal << frid;
+    const std::string str_frid = ss.str();
+    if(!(frid % 50)) {
+        results.logMessages.push_back(fmt::sprintf("INFO:\tframe ID = %d", frid));
+    }
+    for(std::size_t i = 0; i < frame.XOutside.size(); i++) {
+        results.logMessages.push_back(fmt::sprintf(
+            "Warning:\tPedestrian at <x=%.4f, y=%.4f> is not in geometry and not "
+            "considered in analysis!",
+            frame.XOutside[i] * CMtoM,
+            frame.YOutside[i] * CMtoM));
+    }
+    int NumPeds = frame.numPeds;
+    //---------------------------------------------------------------------------------------------------------------
+    if(NumPeds > 3) {
+        if(_isOneDimensional) {
+            CalcVoronoiResults1D(
+                frame.XInFrame,
+                frame.VInFrame,
+                frame.IdInFrame,
+                _areaForMethod_D->_poly,
+                str_frid,
+                results);
+        } else {
+            const vector<polygon_2d> & polygons = frame.GetPolygons();
+
+            if(!polygons.empty()) {
+                OutputVoronoiResults(polygons, str_frid, frame.VInFrame, results);
+                if(_calcIndividualFD) {
+                    GetIndividualFD(
+                        polygons,
+                        frame.VInFrame,
+                        frame.IdInFrame,
+                        _areaForMethod_D->_poly,
+                        str_frid,
+                        frame.XInFrame,
+                        frame.YInFrame,
+                        frame.ZInFrame,
+                        results);
                 }
-                std::vector<std::pair<polygon_2d, int>> polygons_id =
-                    GetPolygons(XInFrame, YInFrame, VInFrame, IdInFrame);
-                // std::cout << ">> polygons_id " << polygons_id.size() << "\n";
-                vector<polygon_2d> polygons;
-                for(auto p : polygons_id)
-                    polygons.push_back(p.first);
-
-                if(!polygons.empty()) {
-                    OutputVoronoiResults(polygons, str_frid, VInFrame); // TODO polygons_id
-                    if(_calcIndividualFD) {
-                        if(!_isOneDimensional) {
-                            // GetIndividualFD(polygons,VInFrame, IdInFrame, _areaForMethod_D->_poly, str_frid); // TODO polygons_id
-                            GetIndividualFD(
-                                polygons,
-                                VInFrame,
-                                IdInFrame,
-                                _areaForMethod_D->_poly,
-                                str_frid,
-                                XInFrame,
-                                YInFrame,
-                                ZInFrame);
-                        }
-                    }
-                    if(_getProfile) {                              //	field analysis
-                        GetProfiles(str_frid, polygons, VInFrame); // TODO polygons_id
-                    }
-                } else {
-                    for(int i = 0; i < (int) IdInFrame.size(); i++) {
-                        std::cout << XInFrame[i] * CMtoM << "   " << YInFrame[i] * CMtoM << "   "
-                                  << IdInFrame[i] << "\n";
-                    }
-                    Log->Write(
-                        "WARNING: \tVoronoi Diagrams are not obtained!. Frame: %d (minFrame = "
-                        "%d)\n",
-                        frid,
-                        minFrame);
+                if(_getProfile) {                                    //	field analysis
+                    GetProfiles(str_frid, polygons, frame.VInFrame); // TODO polygons_id
+                }
+            } else {
+                for(int i = 0; i < (int) frame.IdInFrame.size(); i++) {
+                    results.logMessages.push_back(fmt::sprintf(
+                        "%g   %g   %d",
+                        frame.XInFrame[i] * CMtoM,
+                        frame.YInFrame[i] * CMtoM,
+                        frame.IdInFrame[i]));
                 }
+                results.logMessages.push_back(fmt::sprintf(
+                    "WARNING: \tVoronoi Diagrams are not obtained!. Frame: %d (minFrame = %d)\n",
+                    frid,
+                    _minFrame));
             }
-        } // if N >3
-        else {
-            Log->Write(
-                "INFO: \tThe number of the pedestrians is small (%d). Frame = %d (minFrame = %d)\n",
-                NumPeds,
-                frid,
-                minFrame);
         }
+    } // if N >3
+    else {
+        results.logMessages.push_back(fmt::sprintf(
+            "INFO: \tThe number of the pedestrians is small (%d). Frame = %d (minFrame = %d)\n",
+            NumPeds,
+            frid,
+            _minFrame));
     }
+}
+
+void Method_D::WriteFrameResults(const VoronoiFrameResults & results)
+{
+    for(const auto & message : results.logMessages) {
+        Log->Write(message);
+    }
+    fputs(results.voronoiResults.c_str(), _fVoronoiRhoV);
+    if(_calcIndividualFD) {
+        fputs(results.individualFD.c_str(), _fIndividualFD);
+    }
+}
+
+void Method_D::Finish()
+{
     fclose(_fVoronoiRhoV);
     if(_calcIndividualFD) {
         fclose(_fIndividualFD);
     }
-    return return_value;
 }
 
 bool Method_D::OpenFileMethodD()
@@ -269,59 +270,34 @@ bool Method_D::OpenFileIndividualFD()
     }
 }
 
-std::vector<std::pair<polygon_2d, int>> Method_D::GetPolygons(
-    vector<double> & XInFrame,
-    vector<double> & YInFrame,
-    vector<double> & VInFrame,
-    vector<int> & IdInFrame)
-{
-    VoronoiDiagram vd;
-    //int NrInFrm = ids.size();
-    double boundpoint =
-        10 * max(max(fabs(_geoMinX), fabs(_geoMinY)), max(fabs(_geoMaxX), fabs(_geoMaxY)));
-    std::vector<std::pair<polygon_2d, int>> polygons_id;
-    polygons_id = vd.getVoronoiPolygons(XInFrame, YInFrame, VInFrame, IdInFrame, boundpoint);
-    // std:: cout << " GetPolygons " << polygons_id.size() << "\n";
-
-    polygon_2d poly;
-    if(_cutByCircle) {
-        polygons_id =
-            vd.cutPolygonsWithCircle(polygons_id, XInFrame, YInFrame, _cutRadius, _circleEdges);
-    }
-
-    polygons_id = vd.cutPolygonsWithGeometry(polygons_id, _geoPoly, XInFrame, YInFrame);
-
-    for(auto && p : polygons_id) {
-        poly = p.first;
-        ReducePrecision(poly);
-        // TODO update polygon_id?
-    }
-    return polygons_id;
-}
 /**
  * Output the Voronoi density and velocity in the corresponding file
  */
 void Method_D::OutputVoronoiResults(
     const vector<polygon_2d> & polygons,
     const string & frid,
-    const vector<double> & VInFrame)
+    const vector<double> & VInFrame,
+    VoronoiFrameResults & results)
 {
     double VoronoiVelocity = 1;
     double VoronoiDensity  = -1;
-    std::tie(VoronoiDensity, VoronoiVelocity) =
-        GetVoronoiDensityVelocity(polygons, VInFrame, _areaForMethod_D->_poly);
-    fprintf(_fVoronoiRhoV, "%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
+    std::tie(VoronoiDensity, VoronoiVelocity) = GetVoronoiDensityVelocity(
+        polygons, VInFrame, _areaForMethod_D->_poly, results.logMessages);
+    results.voronoiResults +=
+        fmt::sprintf("%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
 }
 
 /**
  * calculate the voronoi density and velocity according to voronoi cell of each pedestrian and their instantaneous velocity "Velocity".
  * input: voronoi cell and velocity of each pedestrian and the measurement area
- * output: the voronoi density and velocity in the measurement area (tuple)
+ * output: the voronoi density and velocity in the measurement area (tuple), wrong intersections
+ * are reported in logMessages
  */
 std::tuple<double, double> Method_D::GetVoronoiDensityVelocity(
     const vector<polygon_2d> & polygon,
     const vector<double> & Velocity,
-    const polygon_2d & measureArea)
+    const polygon_2d & measureArea,
+    vector<string> & logMessages)
 {
     double meanV   = 0;
     double density = 0;
@@ -333,18 +309,17 @@ std::tuple<double, double> Method_D::GetVoronoiDensityVelocity(
             meanV += Velocity[temp] * area(v[0]);
             density += area(v[0]) / area(polygon_iterator);
             if((area(v[0]) - area(polygon_iterator)) > J_EPS) {
-                std::cout << "----------------------Now calculating "
-                             "density-velocity!!!-----------------\n ";
-                std::cout << "measure area: \t" << std::setprecision(16) << dsv(measureArea)
-                          << "\n";
-                std::cout << "Original polygon:\t" << std::setprecision(16) << dsv(polygon_iterator)
-                          << "\n";
-                std::cout << "intersected polygon: \t" << std::setprecision(16) << dsv(v[0])
-                          << "\n";
-                std::cout << "this is a wrong result in density calculation\t " << area(v[0])
-                          << '\t' << area(polygon_iterator)
-                          << "  (diff=" << (area(v[0]) - area(polygon_iterator)) << ")"
-                          << "\n";
+                std::ostringstream message;
+                message << "----------------------Now calculating "
+                           "density-velocity!!!-----------------\n ";
+                message << "measure area: \t" << std::setprecision(16) << dsv(measureArea) << "\n";
+                message << "Original polygon:\t" << std::setprecision(16) << dsv(polygon_iterator)
+                        << "\n";
+                message << "intersected polygon: \t" << std::setprecision(16) << dsv(v[0]) << "\n";
+                message << "this is a wrong result in density calculation\t " << area(v[0]) << '\t'
+                        << area(polygon_iterator)
+                        << "  (diff=" << (area(v[0]) - area(polygon_iterator)) << ")";
+                logMessages.push_back(message.str());
             }
         }
         temp++;
@@ -382,38 +357,14 @@ void Method_D::GetProfiles(
         exit(EXIT_FAILURE);
     }
 
-    int NRow = (int) ceil(
-        (_geoMaxY - _geoMinY) /
-        _grid_size_Y); // the number of rows that the geometry will be discretized for field analysis
-    int NColumn = (int) ceil(
-        (_geoMaxX - _geoMinX) /
-        _grid_size_X); //the number of columns that the geometry will be discretized for field analysis
-    for(int row_i = 0; row_i < NRow; row_i++) { //
-        for(int colum_j = 0; colum_j < NColumn; colum_j++) {
-            polygon_2d measurezoneXY;
-            {
-                const double coor[][2] = {
-                    {_geoMinX + colum_j * _grid_size_X, _geoMaxY - row_i * _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X + _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X + _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y - _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y - _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y} // closing point is opening point
-                };
-                assign_points(measurezoneXY, coor);
-            }
-            correct(
-                measurezoneXY); // Polygons should be closed, and directed clockwise. If you're not sure if that is the case, call this function
-
-            double densityXY;
-            double velocityXY;
-            std::tie(densityXY, velocityXY) =
-                GetVoronoiDensityVelocity(polygons, velocity, measurezoneXY);
-            fprintf(Prf_density, "%.3f\t", densityXY);
-            fprintf(Prf_velocity, "%.3f\t", velocityXY);
+    VoronoiProfile profile(_geoMinX, _geoMinY, _geoMaxX, _geoMaxY, _grid_size_X, _grid_size_Y);
+    for(std::size_t i = 0; i < polygons.size(); i++) {
+        profile.AddPolygon(polygons[i], velocity[i]);
+    }
+    for(int row_i = 0; row_i < profile.GetNumRows(); row_i++) {
+        for(int colum_j = 0; colum_j < profile.GetNumColumns(); colum_j++) {
+            fprintf(Prf_density, "%.3f\t", profile.GetDensity(row_i, colum_j));
+            fprintf(Prf_velocity, "%.3f\t", profile.GetAreaWeightedVelocity(row_i, colum_j));
         }
         fprintf(Prf_density, "\n");
         fprintf(Prf_velocity, "\n");
@@ -506,7 +457,8 @@ void Method_D::GetIndividualFD(
     const string & frid,
     vector<double> & XInFrame,
     vector<double> & YInFrame,
-    vector<double> & ZInFrame)
+    vector<double> & ZInFrame,
+    VoronoiFrameResults & results)
 {
     double uniquedensity  = 0;
     double uniquevelocity = 0;
@@ -526,8 +478,7 @@ void Method_D::GetIndividualFD(
             x              = XInFrame[temp] * CMtoM;
             y              = YInFrame[temp] * CMtoM;
             z              = ZInFrame[temp] * CMtoM;
-            fprintf(
-                _fIndividualFD,
+            results.individualFD += fmt::sprintf(
                 "%s\t %d\t %.4f\t %.4f\t %.4f\t %.4f\t %.4f\t%s\t%s\n",
                 frid.c_str(),
                 uniqueId,
@@ -558,18 +509,6 @@ void Method_D::SetStopFrame(int stopFrame)
     _stopFrame = stopFrame;
 }
 
-void Method_D::Setcutbycircle(double radius, int edges)
-{
-    _cutByCircle = true;
-    _cutRadius   = radius;
-    _circleEdges = edges;
-}
-
-void Method_D::SetGeometryPolygon(polygon_2d geometryPolygon)
-{
-    _geoPoly = geometryPolygon;
-}
-
 void Method_D::SetGeometryBoundaries(double minX, double minY, double maxX, double maxY)
 {
     _geoMinX = minX;
@@ -609,20 +548,13 @@ void Method_D::SetDimensional(bool dimension)
     _isOneDimensional = dimension;
 }
 
-void Method_D::ReducePrecision(polygon_2d & polygon)
-{
-    for(auto && point : polygon.outer()) {
-        point.x(round(point.x() * 100000000000.0) / 100000000000.0);
-        point.y(round(point.y() * 100000000000.0) / 100000000000.0);
-    }
-}
-
 void Method_D::CalcVoronoiResults1D(
     vector<double> & XInFrame,
     vector<double> & VInFrame,
     vector<int> & IdInFrame,
     const polygon_2d & measureArea,
-    const string & frid)
+    const string & frid,
+    VoronoiFrameResults & results)
 {
     vector<double> measurearea_x;
     for(unsigned int i = 0; i < measureArea.outer().size(); i++) {
@@ -674,8 +606,7 @@ void Method_D::CalcVoronoiResults1D(
         if(_calcIndividualFD) {
             double headway           = (XRightNeighbor[i] - XInFrame[i]) * CMtoM;
             double individualDensity = 2.0 / ((XRightNeighbor[i] - XLeftNeighbor[i]) * CMtoM);
-            fprintf(
-                _fIndividualFD,
+            results.individualFD += fmt::sprintf(
                 "%s\t%d\t%.3f\t%.3f\t%.3f\n",
                 frid.c_str(),
                 IdInFrame[i],
@@ -686,7 +617,8 @@ void Method_D::CalcVoronoiResults1D(
     }
     VoronoiDensity /= ((right_boundary - left_boundary) * CMtoM);
     VoronoiVelocity /= ((right_boundary - left_boundary) * CMtoM);
-    fprintf(_fVoronoiRhoV, "%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
+    results.voronoiResults +=
+        fmt::sprintf("%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
 }
 
 double Method_D::getOverlapRatio(
@@ -709,29 +641,3 @@ double Method_D::getOverlapRatio(
     }
     return OverlapRatio;
 }
-
-bool Method_D::IsPointsOnOneLine(vector<double> & XInFrame, vector<double> & YInFrame)
-{
-    double deltaX    = XInFrame[1] - XInFrame[0];
-    bool isOnOneLine = true;
-    if(fabs(deltaX) < dmin) {
-        for(unsigned int i = 2; i < XInFrame.size(); i++) {
-            if(fabs(XInFrame[i] - XInFrame[0]) > dmin) {
-                isOnOneLine = false;
-                break;
-            }
-        }
-    } else {
-        double slope     = (YInFrame[1] - YInFrame[0]) / deltaX;
-        double intercept = YInFrame[0] - slope * XInFrame[0];
-        for(unsigned int i = 2; i < XInFrame.size(); i++) {
-            double dist =
-                fabs(slope * XInFrame[i] - YInFrame[i] + intercept) / sqrt(slope * slope + 1);
-            if(dist > dmin) {
-                isOnOneLine = false;
-                break;
-            }
-        }
-    }
-    return isOnOneLine;
-}
@@ -29,6 +29,7 @@
 #include "Method_I.h"
 
 #include <cmath>
+#include <fmt/printf.h>
 #include <iostream>
 #include <map>
 #include <tuple>
@@ -50,20 +51,18 @@ Method_I::Method_I()
     _geoMinY               = 0;
     _geoMaxX               = 0;
     _geoMaxY               = 0;
-    _cutByCircle           = false;
-    _cutRadius             = -1;
-    _circleEdges           = -1;
     _fIndividualFD         = nullptr;
     _calcIndividualFD      = true;
     _areaForMethod_I       = nullptr;
     _isOneDimensional      = false;
     _startFrame            = -1;
     _stopFrame             = -1;
+    _minFrame              = 0;
 }
 
 Method_I::~Method_I() {}
 
-bool Method_I::Process(
+bool Method_I::Prepare(
     const PedData & peddata,
     const fs::path & scriptsLocation,
     const double & zPos_measureArea)
@@ -78,6 +77,7 @@ bool Method_I::Process(
     _fps              = peddata.GetFps();
     int mycounter     = 0;
     int minFrame      = peddata.GetMinFrame();
+    _minFrame         = minFrame;
     Log->Write(
         "INFO:\tMethod I: frame rate fps: <%.2f>, start: <%d>, stop: <%d> (minFrame = %d)",
         _fps,
@@ -108,95 +108,94 @@ bool Method_I::Process(
         }
     }
     Log->Write("------------------------ Analyzing with Method I -----------------------------");
+    return return_value;
+}
 
-    for(auto ite : _peds_t) {
-        int frameNr = ite.first;
-        int frid    = frameNr + minFrame;
-        //padd the frameid with 0
-        std::ostringstream ss;
-        ss << std::setw(5) << std::setfill('0') << std::internal << frid;
-        const std::string str_frid = ss.str();
-        if(!(frid % 50)) {
-            Log->Write("INFO:\tframe ID = %d", frid);
-        }
-        vector<int> ids         = _peds_t[frameNr];
-        vector<int> IdInFrame   = peddata.GetIdInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> XInFrame = peddata.GetXInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> YInFrame = peddata.GetYInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> ZInFrame = peddata.GetZInFrame(frameNr, ids, zPos_measureArea);
-        vector<double> VInFrame = peddata.GetVInFrame(frameNr, ids, zPos_measureArea);
-        if(XInFrame.size() == 0) {
-            Log->Write("Warning:\t no pedestrians in frame <%d>", frameNr);
-            continue;
-        }
-        //------------------------------Remove peds outside geometry------------------------------------------
-        for(int i = 0; i < (int) IdInFrame.size(); i++) {
-            if(false == within(point_2d(round(XInFrame[i]), round(YInFrame[i])), _geoPoly)) {
-                Log->Write(
-                    "Warning:\tPedestrian at <x=%.4f, y=%.4f, , z=%.4f> is not in geometry and not "
-                    "considered in analysis!",
-                    XInFrame[i] * CMtoM,
-                    YInFrame[i] * CMtoM,
-                    ZInFrame[i] * CMtoM);
-                IdInFrame.erase(IdInFrame.begin() + i);
-                XInFrame.erase(XInFrame.begin() + i);
-                YInFrame.erase(YInFrame.begin() + i);
-                ZInFrame.erase(ZInFrame.begin() + i);
-                VInFrame.erase(VInFrame.begin() + i);
-                Log->Write("Warning:\t Pedestrian removed");
-                i--;
-            }
-        }
+bool Method_I::IsFrameAnalysed(int frameNr) const
+{
+    return _peds_t.count(frameNr) > 0;
+}
 
-        //---------------------------------------------------------------------------------------------------------------
-        if(_isOneDimensional) {
-            CalcVoronoiResults1D(XInFrame, VInFrame, IdInFrame, _areaForMethod_I->_poly, str_frid);
-        } else {
-            if(IsPointsOnOneLine(XInFrame, YInFrame)) {
-                if(fabs(XInFrame[1] - XInFrame[0]) < dmin) {
-                    XInFrame[1] += offset;
-                } else {
-                    YInFrame[1] += offset;
-                }
-            }
-            std::vector<std::pair<polygon_2d, int>> polygons_id =
-                GetPolygons(XInFrame, YInFrame, VInFrame, IdInFrame);
-            // std::cout << ">> polygons_id " << polygons_id.size() << "\n";
-            vector<polygon_2d> polygons;
-            for(auto p : polygons_id) {
-                polygons.push_back(p.first);
-            }
+void Method_I::AnalyseFrame(VoronoiFrame & frame, VoronoiFrameResults & results)
+{
+    int frid = frame.frameNr + _minFrame;
+    //padd the frameid with 0
+    std::ostringstream ss;
+    ss << std::setw(5) << std::setfill('0') << std::internal << frid;
+    const std::string str_frid = ss.str();
+    if(!(frid % 50)) {
+        results.logMessages.push_back(fmt::sprintf("INFO:\tframe ID = %d", frid));
+    }
+    if(frame.numPeds == 0 && frame.XOutside.empty()) {
+        results.logMessages.push_back(
+            fmt::sprintf("Warning:\t no pedestrians in frame <%d>", frame.frameNr));
+        return;
+    }
+    for(std::size_t i = 0; i < frame.XOutside.size(); i++) {
+        results.logMessages.push_back(fmt::sprintf(
+            "Warning:\tPedestrian at <x=%.4f, y=%.4f, , z=%.4f> is not in geometry and not "
+            "considered in analysis!",
+            frame.XOutside[i] * CMtoM,
+            frame.YOutside[i] * CMtoM,
+            frame.ZOutside[i] * CMtoM));
+        results.logMessages.push_back("Warning:\t Pedestrian removed");
+    }
 
-            if(!polygons.empty()) {
-                if(_calcIndividualFD) {
-                    if(!_isOneDimensional) {
-                        // GetIndividualFD(polygons,VInFrame, IdInFrame,  str_frid); // TODO polygons_id
-                        GetIndividualFD(
-                            polygons,
-                            VInFrame,
-                            IdInFrame,
-                            str_frid,
-                            XInFrame,
-                            YInFrame,
-                            ZInFrame); //
-                    }
-                }
-            } else {
-                for(int i = 0; i < (int) IdInFrame.size(); i++) {
-                    std::cout << XInFrame[i] * CMtoM << "   " << YInFrame[i] * CMtoM << "   "
-                              << IdInFrame[i] << "\n";
-                }
-                Log->Write(
-                    "WARNING: \tVoronoi Diagrams are not obtained!. Frame: %d (minFrame = %d)\n",
-                    frid,
-                    minFrame);
+    //---------------------------------------------------------------------------------------------------------------
+    if(_isOneDimensional) {
+        CalcVoronoiResults1D(
+            frame.XInFrame,
+            frame.VInFrame,
+            frame.IdInFrame,
+            _areaForMethod_I->_poly,
+            str_frid,
+            results);
+    } else {
+        const vector<polygon_2d> & polygons = frame.GetPolygons();
+
+        if(!polygons.empty()) {
+            if(_calcIndividualFD) {
+                GetIndividualFD(
+                    polygons,
+                    frame.VInFrame,
+                    frame.IdInFrame,
+                    str_frid,
+                    frame.XInFrame,
+                    frame.YInFrame,
+                    frame.ZInFrame,
+                    results);
+            }
+        } else {
+            for(int i = 0; i < (int) frame.IdInFrame.size(); i++) {
+                results.logMessages.push_back(fmt::sprintf(
+                    "%g   %g   %d",
+                    frame.XInFrame[i] * CMtoM,
+                    frame.YInFrame[i] * CMtoM,
+                    frame.IdInFrame[i]));
             }
+            results.logMessages.push_back(fmt::sprintf(
+                "WARNING: \tVoronoi Diagrams are not obtained!. Frame: %d (minFrame = %d)\n",
+                frid,
+                _minFrame));
         }
-    } //peds
+    }
+}
+
+void Method_I::WriteFrameResults(const VoronoiFrameResults & results)
+{
+    for(const auto & message : results.logMessages) {
+        Log->Write(message);
+    }
+    if(_calcIndividualFD) {
+        fputs(results.individualFD.c_str(), _fIndividualFD);
+    }
+}
+
+void Method_I::Finish()
+{
     if(_calcIndividualFD) {
         fclose(_fIndividualFD);
     }
-    return return_value;
 }
 
 bool Method_I::OpenFileIndividualFD()
@@ -227,34 +226,6 @@ bool Method_I::OpenFileIndividualFD()
     }
 }
 
-std::vector<std::pair<polygon_2d, int>> Method_I::GetPolygons(
-    vector<double> & XInFrame,
-    vector<double> & YInFrame,
-    vector<double> & VInFrame,
-    vector<int> & IdInFrame)
-{
-    VoronoiDiagram vd;
-    //int NrInFrm = ids.size();
-    double boundpoint =
-        10 * max(max(fabs(_geoMinX), fabs(_geoMinY)), max(fabs(_geoMaxX), fabs(_geoMaxY)));
-    std::vector<std::pair<polygon_2d, int>> polygons_id;
-    polygons_id = vd.getVoronoiPolygons(XInFrame, YInFrame, VInFrame, IdInFrame, boundpoint);
-    polygon_2d poly;
-    if(_cutByCircle) {
-        polygons_id =
-            vd.cutPolygonsWithCircle(polygons_id, XInFrame, YInFrame, _cutRadius, _circleEdges);
-    }
-    //todo HH
-    polygons_id = vd.cutPolygonsWithGeometry(polygons_id, _geoPoly, XInFrame, YInFrame);
-    // todo HH
-    for(auto && p : polygons_id) {
-        poly = p.first;
-        ReducePrecision(poly);
-        // TODO update polygon_id?
-    }
-    return polygons_id;
-}
-
 void Method_I::GetIndividualFD(
     const vector<polygon_2d> & polygon,
     const vector<double> & Velocity,
@@ -262,7 +233,8 @@ void Method_I::GetIndividualFD(
     const string & frid,
     vector<double> & XInFrame,
     vector<double> & YInFrame,
-    vector<double> & ZInFrame)
+    vector<double> & ZInFrame,
+    VoronoiFrameResults & results)
 {
     double uniquedensity  = 0;
     double uniquevelocity = 0;
@@ -277,8 +249,7 @@ void Method_I::GetIndividualFD(
         x                  = XInFrame[temp] * CMtoM;
         y                  = YInFrame[temp] * CMtoM;
         z                  = ZInFrame[temp] * CMtoM;
-        fprintf(
-            _fIndividualFD,
+        results.individualFD += fmt::sprintf(
             "%s\t %d\t %.4f\t %.4f\t %.4f\t %.4f\t %.4f\t %s\n",
             frid.c_str(),
             uniqueId,
@@ -307,18 +278,6 @@ void Method_I::SetStopFrame(int stopFrame)
     _stopFrame = stopFrame;
 }
 
-void Method_I::Setcutbycircle(double radius, int edges)
-{
-    _cutByCircle = true;
-    _cutRadius   = radius;
-    _circleEdges = edges;
-}
-
-void Method_I::SetGeometryPolygon(polygon_2d geometryPolygon)
-{
-    _geoPoly = geometryPolygon;
-}
-
 void Method_I::SetGeometryBoundaries(double minX, double minY, double maxX, double maxY)
 {
     _geoMinX = minX;
@@ -358,20 +317,13 @@ void Method_I::SetDimensional(bool dimension)
     _isOneDimensional = dimension;
 }
 
-void Method_I::ReducePrecision(polygon_2d & polygon)
-{
-    for(auto && point : polygon.outer()) {
-        point.x(round(point.x() * 100000000000.0) / 100000000000.0);
-        point.y(round(point.y() * 100000000000.0) / 100000000000.0);
-    }
-}
-
 void Method_I::CalcVoronoiResults1D(
     vector<double> & XInFrame,
     vector<double> & VInFrame,
     vector<int> & IdInFrame,
     const polygon_2d & measureArea,
-    const string & frid)
+    const string & frid,
+    VoronoiFrameResults & results)
 {
     vector<double> measurearea_x;
     for(unsigned int i = 0; i < measureArea.outer().size(); i++) {
@@ -423,8 +375,7 @@ void Method_I::CalcVoronoiResults1D(
         if(_calcIndividualFD) {
             double headway           = (XRightNeighbor[i] - XInFrame[i]) * CMtoM;
             double individualDensity = 2.0 / ((XRightNeighbor[i] - XLeftNeighbor[i]) * CMtoM);
-            fprintf(
-                _fIndividualFD,
+            results.individualFD += fmt::sprintf(
                 "%s\t%d\t%.3f\t%.3f\t%.3f\n",
                 frid.c_str(),
                 IdInFrame[i],
@@ -435,7 +386,8 @@ void Method_I::CalcVoronoiResults1D(
     }
     VoronoiDensity /= ((right_boundary - left_boundary) * CMtoM);
     VoronoiVelocity /= ((right_boundary - left_boundary) * CMtoM);
-    fprintf(_fVoronoiRhoV, "%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
+    results.voronoiResults +=
+        fmt::sprintf("%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
 }
 
 double Method_I::getOverlapRatio(
@@ -458,29 +410,3 @@ double Method_I::getOverlapRatio(
     }
     return OverlapRatio;
 }
-
-bool Method_I::IsPointsOnOneLine(vector<double> & XInFrame, vector<double> & YInFrame)
-{
-    double deltaX    = XInFrame[1] - XInFrame[0];
-    bool isOnOneLine = true;
-    if(fabs(deltaX) < dmin) {
-        for(unsigned int i = 2; i < XInFrame.size(); i++) {
-            if(fabs(XInFrame[i] - XInFrame[0]) > dmin) {
-                isOnOneLine = false;
-                break;
-            }
-        }
-    } else {
-        double slope     = (YInFrame[1] - YInFrame[0]) / deltaX;
-        double intercept = YInFrame[0] - slope * XInFrame[0];
-        for(unsigned int i = 2; i < XInFrame.size(); i++) {
-            double dist =
-                fabs(slope * XInFrame[i] - YInFrame[i] + intercept) / sqrt(slope * slope + 1);
-            if(dist > dmin) {
-                isOnOneLine = false;
-                break;
-            }
-        }
-    }
-    return isOnOneLine;
-}
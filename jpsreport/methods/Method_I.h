@@ -31,25 +31,23 @@
 #include "../Analysis.h"
 #include "PedData.h"
 #include "VoronoiDiagram.h"
+#include "VoronoiPipeline.h"
 
 
-//handle more than two person are in one line
-#define dmin 200
-#define offset 200
-
-
-class Method_I
+class Method_I : public VoronoiMethod
 {
 public:
     Method_I();
     virtual ~Method_I();
-    bool Process(
+    bool Prepare(
         const PedData & peddata,
         const fs::path & scriptsLocation,
-        const double & zPos_measureArea);
+        const double & zPos_measureArea) override;
+    bool IsFrameAnalysed(int frameNr) const override;
+    void AnalyseFrame(VoronoiFrame & frame, VoronoiFrameResults & results) override;
+    void WriteFrameResults(const VoronoiFrameResults & results) override;
+    void Finish() override;
     void SetCalculateIndividualFD(bool individualFD);
-    void Setcutbycircle(double radius, int edges);
-    void SetGeometryPolygon(polygon_2d geometryPolygon);
     void SetGeometryFileName(const fs::path & geometryFile);
     void SetGeometryBoundaries(double minX, double minY, double maxX, double maxY);
     void SetGridSize(double x, double y);
@@ -74,10 +72,6 @@ private:
     bool _getProfile;             // ToDo: obsolete ?
     bool _outputVoronoiCellData;  // ToDo: obsolete ?
     bool _isOneDimensional;
-    bool _cutByCircle; //Adjust whether cut each original voronoi cell by a circle
-    double _cutRadius;
-    int _circleEdges;
-    polygon_2d _geoPoly;
     double _geoMinX; // LOWest vertex of the geometry (x coordinate)
     double _geoMinY; //  LOWest vertex of the geometry (y coordinate)
     double _geoMaxX; // Highest vertex of the geometry
@@ -93,13 +87,9 @@ private:
     fs::path _trajectoryPath;
     int _startFrame;
     int _stopFrame;
+    int _minFrame;
 
 
-    std::vector<std::pair<polygon_2d, int>> GetPolygons(
-        std::vector<double> & XInFrame,
-        std::vector<double> & YInFrame,
-        std::vector<double> & VInFrame,
-        std::vector<int> & IdInFrame);
     // ToDo: This functions are obsolete.
     void OutputVoronoiResults(
         const std::vector<polygon_2d> & polygons,
@@ -131,18 +121,15 @@ private:
         const std::string & frid,
         std::vector<double> & XInFrame,
         std::vector<double> & YInFrame,
-        std::vector<double> & ZInFrame);
-    /**
-      * Reduce the precision of the points to two digits
-      * @param polygon
-      */
+        std::vector<double> & ZInFrame,
+        VoronoiFrameResults & results);
     void CalcVoronoiResults1D(
         std::vector<double> & XInFrame,
         std::vector<double> & VInFrame,
         std::vector<int> & IdInFrame,
         const polygon_2d & measureArea,
-        const std::string & frid);
-    void ReducePrecision(polygon_2d & polygon);
+        const std::string & frid,
+        VoronoiFrameResults & results);
 
     // ToDo: This function is obsolete.
     bool IsPedInGeometry(
@@ -158,7 +145,6 @@ private:
         const double & right,
         const double & measurearea_left,
         const double & measurearea_right);
-    bool IsPointsOnOneLine(std::vector<double> & XInFrame, std::vector<double> & YInFrame);
 };
 
 #endif /* Method_I_H_ */
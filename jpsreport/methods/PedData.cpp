@@ -28,7 +28,10 @@
 
 #include "PedData.h"
 
+#include "../IO/TrajectoriesBinaryReader.h"
+
 #include <cmath>
+#include <cstdint>
 #include <set>
 #include <string>
 
@@ -83,6 +86,10 @@ bool PedData::ReadData(
     else if(trajformat == FORMAT_PLAIN) {
         result = InitializeVariables(fullTrajectoriesPathName);
     }
+
+    else if(trajformat == FORMAT_BINARY) {
+        result = InitializeVariablesBinary(fullTrajectoriesPathName);
+    }
     return result;
 }
 
@@ -457,6 +464,105 @@ bool PedData::InitializeVariables(TiXmlElement * xRootNode)
     return true;
 }
 
+// initialize the global variables. binary format of jpscore (TrajectoriesBinary)
+bool PedData::InitializeVariablesBinary(const fs::path & filename)
+{
+    ifstream fdata(filename, std::ios::in | std::ios::binary);
+    if(!fdata.is_open()) {
+        Log->Write(
+            "ERROR: \t could not open the trajectories file <%s>", filename.string().c_str());
+        return false;
+    }
+    BinaryTrajectories trajectories;
+    const string error = ReadBinaryTrajectories(fdata, trajectories);
+    fdata.close();
+    if(!error.empty()) {
+        Log->Write("ERROR:\t%s <%s>", error.c_str(), filename.string().c_str());
+        return false;
+    }
+    if(trajectories.truncatedFrame != -1) {
+        Log->Write(
+            "WARNING:\tincomplete frame <%d> at the end of the file", trajectories.truncatedFrame);
+    }
+    if(trajectories.fps <= 0) {
+        Log->Write("ERROR:\tFrame rate fps not defined");
+        return false;
+    }
+    _fps = trajectories.fps;
+    Log->Write("INFO:\tFrame rate fps: <%.2f>", _fps);
+    Log->Write("INFO:\tgeometry: <%s>", trajectories.geometry.c_str());
+    Log->Write("INFO:\t Finished reading the data");
+
+    const vector<int> & frames             = trajectories.frames;
+    const vector<std::size_t> & frameStart = trajectories.frameStart;
+    const vector<std::int32_t> & ids       = trajectories.ids;
+    const vector<float> & xs               = trajectories.xs;
+    const vector<float> & ys               = trajectories.ys;
+    const vector<float> & zs               = trajectories.zs;
+
+    if(ids.empty()) {
+        Log->Write("ERROR: \tThe trajectories should have at least one agent");
+        return false;
+    }
+    if(_vComponent == "F") {
+        Log->Write("ERROR:\t There is no indicator for velocity component in binary trajectory "
+                   "files!!");
+        return false;
+    }
+
+    _minID    = *min_element(ids.begin(), ids.end());
+    _maxID    = *max_element(ids.begin(), ids.end());
+    _minFrame = *min_element(frames.begin(), frames.end());
+    Log->Write("INFO: minID: %d", _minID);
+    Log->Write("INFO: maxID: %d", _maxID);
+    Log->Write("INFO: minFrame: %d", _minFrame);
+    _numFrames = *max_element(frames.begin(), frames.end()) - _minFrame + 1;
+    Log->Write("INFO: numFrames: %d", _numFrames);
+
+    // position of each id in the matrices, ids are not necessarily continuous
+    vector<int> uniqueIds(ids.begin(), ids.end());
+    std::sort(uniqueIds.begin(), uniqueIds.end());
+    uniqueIds.erase(std::unique(uniqueIds.begin(), uniqueIds.end()), uniqueIds.end());
+    _numPeds = uniqueIds.size();
+    Log->Write("INFO: Total number of Agents: %d", _numPeds);
+    CreateGlobalVariables(_numPeds, _numFrames);
+
+    vector<int> totalframes(_numPeds, 0);
+    for(std::size_t f = 0; f < frames.size(); ++f) {
+        const int frm = frames[f] - _minFrame;
+        for(std::size_t i = frameStart[f]; i < frameStart[f + 1]; ++i) {
+            const int idPos =
+                std::lower_bound(uniqueIds.begin(), uniqueIds.end(), ids[i]) - uniqueIds.begin();
+            _peds_t[frm].push_back(idPos);
+            _xCor(idPos, frm)  = xs[i] * M2CM;
+            _yCor(idPos, frm)  = ys[i] * M2CM;
+            _zCor(idPos, frm)  = zs[i] * M2CM;
+            _id(idPos, frm)    = ids[i];
+            _vComp(idPos, frm) = _vComponent;
+            _firstFrame[idPos] = std::min(_firstFrame[idPos], frm);
+            _lastFrame[idPos]  = std::max(_lastFrame[idPos], frm);
+            totalframes[idPos] += 1;
+        }
+    }
+
+    for(int idPos = 0; idPos < _numPeds; idPos++) {
+        int actual_totalframe = totalframes[idPos];
+        int expect_totalframe = _lastFrame[idPos] - _firstFrame[idPos] + 1;
+        if(actual_totalframe != expect_totalframe) {
+            Log->Write(
+                "Error:\tThe trajectory of ped with ID <%d> is not continuous. Please modify the "
+                "trajectory file!",
+                uniqueIds[idPos]);
+            Log->Write(
+                "Error:\t actual_totalfame = <%d>, expected_totalframe = <%d> ",
+                actual_totalframe,
+                expect_totalframe);
+            return false;
+        }
+    }
+    return true;
+}
+
 vector<double> PedData::GetVInFrame(int frame, const vector<int> & ids, double zPos) const
 {
     vector<double> VInFrame;
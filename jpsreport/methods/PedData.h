@@ -94,6 +94,7 @@ public:
 private:
     bool InitializeVariables(const fs::path & filename);
     bool InitializeVariables(TiXmlElement * xRootNode);
+    bool InitializeVariablesBinary(const fs::path & filename);
     void CreateGlobalVariables(int numPeds, int numFrames);
     double GetInstantaneousVelocity(
         int Tnow,
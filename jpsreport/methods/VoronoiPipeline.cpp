@@ -0,0 +1,245 @@
+/**
+ * \file        VoronoiPipeline.cpp
+ * \copyright   <2009-2022> Forschungszentrum Juelich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Frame loop of the Voronoi methods D, I and J.
+ *
+ **/
+
+#include "VoronoiPipeline.h"
+
+#include "VoronoiDiagram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+using namespace std;
+
+//handle more than two person are in one line
+#define dmin 200
+#define offset 200
+
+// number of frames analysed before their results are written
+constexpr size_t FRAMES_PER_BLOCK = 256;
+
+VoronoiFrame::VoronoiFrame(
+    const PedData & peddata,
+    int frameNr,
+    const vector<int> & ids,
+    double zPos,
+    const polygon_2d & geoPoly,
+    const VoronoiPipeline & pipeline) :
+    frameNr(frameNr), _pipeline(pipeline), _geoPoly(geoPoly), _hasPolygons(false)
+{
+    IdInFrame = peddata.GetIdInFrame(frameNr, ids, zPos);
+    XInFrame  = peddata.GetXInFrame(frameNr, ids, zPos);
+    YInFrame  = peddata.GetYInFrame(frameNr, ids, zPos);
+    ZInFrame  = peddata.GetZInFrame(frameNr, ids, zPos);
+    VInFrame  = peddata.GetVInFrame(frameNr, ids, zPos);
+    //------------------------------Remove peds outside geometry------------------------------------------
+    for(int i = 0; i < (int) IdInFrame.size(); i++) {
+        if(false == within(point_2d(round(XInFrame[i]), round(YInFrame[i])), _geoPoly)) {
+            XOutside.push_back(XInFrame[i]);
+            YOutside.push_back(YInFrame[i]);
+            ZOutside.push_back(ZInFrame[i]);
+            IdInFrame.erase(IdInFrame.begin() + i);
+            XInFrame.erase(XInFrame.begin() + i);
+            YInFrame.erase(YInFrame.begin() + i);
+            ZInFrame.erase(ZInFrame.begin() + i);
+            VInFrame.erase(VInFrame.begin() + i);
+            i--;
+        }
+    }
+    numPeds = IdInFrame.size();
+}
+
+const vector<polygon_2d> & VoronoiFrame::GetPolygons()
+{
+    if(!_hasPolygons) {
+        if(_pipeline.IsPointsOnOneLine(XInFrame, YInFrame)) {
+            if(fabs(XInFrame[1] - XInFrame[0]) < dmin) {
+                XInFrame[1] += offset;
+            } else {
+                YInFrame[1] += offset;
+            }
+        }
+        for(auto && p : _pipeline.GetPolygons(XInFrame, YInFrame, VInFrame, IdInFrame, _geoPoly)) {
+            _polygons.push_back(p.first);
+        }
+        _hasPolygons = true;
+    }
+    return _polygons;
+}
+
+VoronoiPipeline::VoronoiPipeline()
+{
+    _cutByCircle = false;
+    _cutRadius   = -1;
+    _circleEdges = -1;
+    _geoMinX     = 0;
+    _geoMinY     = 0;
+    _geoMaxX     = 0;
+    _geoMaxY     = 0;
+}
+
+void VoronoiPipeline::Setcutbycircle(double radius, int edges)
+{
+    _cutByCircle = true;
+    _cutRadius   = radius;
+    _circleEdges = edges;
+}
+
+void VoronoiPipeline::SetGeometryBoundaries(double minX, double minY, double maxX, double maxY)
+{
+    _geoMinX = minX;
+    _geoMinY = minY;
+    _geoMaxX = maxX;
+    _geoMaxY = maxY;
+}
+
+void VoronoiPipeline::AddMethod(
+    VoronoiMethod * method,
+    const polygon_2d & geometryPolygon,
+    double zPos)
+{
+    _methods.push_back(method);
+    for(auto && tessellation : _tessellations) {
+        if(tessellation.zPos == zPos && equals(tessellation.geoPoly, geometryPolygon)) {
+            tessellation.methods.push_back(_methods.size() - 1);
+            return;
+        }
+    }
+    _tessellations.push_back({geometryPolygon, zPos, {_methods.size() - 1}});
+}
+
+void VoronoiPipeline::Run(const PedData & peddata)
+{
+    const map<int, vector<int>> peds_t = peddata.GetPedsFrame();
+    vector<int> frames;
+    for(auto && ite : peds_t) {
+        if(any_of(_methods.begin(), _methods.end(), [&](const VoronoiMethod * method) {
+               return method->IsFrameAnalysed(ite.first);
+           })) {
+            frames.push_back(ite.first);
+        }
+    }
+
+    // the frames of a block are analysed in parallel, the results are written in frame order
+    for(size_t begin = 0; begin < frames.size(); begin += FRAMES_PER_BLOCK) {
+        const int numFrames = min(FRAMES_PER_BLOCK, frames.size() - begin);
+        vector<vector<VoronoiFrameResults>> results(
+            numFrames, vector<VoronoiFrameResults>(_methods.size()));
+#pragma omp parallel for schedule(dynamic)
+        for(int i = 0; i < numFrames; i++) {
+            const int frameNr = frames[begin + i];
+            for(auto && tessellation : _tessellations) {
+                if(none_of(
+                       tessellation.methods.begin(), tessellation.methods.end(), [&](size_t m) {
+                           return _methods[m]->IsFrameAnalysed(frameNr);
+                       })) {
+                    continue;
+                }
+                VoronoiFrame frame(
+                    peddata,
+                    frameNr,
+                    peds_t.at(frameNr),
+                    tessellation.zPos,
+                    tessellation.geoPoly,
+                    *this);
+                for(size_t m : tessellation.methods) {
+                    if(_methods[m]->IsFrameAnalysed(frameNr)) {
+                        _methods[m]->AnalyseFrame(frame, results[i][m]);
+                    }
+                }
+            }
+        }
+        for(int i = 0; i < numFrames; i++) {
+            for(size_t m = 0; m < _methods.size(); m++) {
+                if(_methods[m]->IsFrameAnalysed(frames[begin + i])) {
+                    _methods[m]->WriteFrameResults(results[i][m]);
+                }
+            }
+        }
+    }
+}
+
+vector<pair<polygon_2d, int>> VoronoiPipeline::GetPolygons(
+    vector<double> & XInFrame,
+    vector<double> & YInFrame,
+    vector<double> & VInFrame,
+    vector<int> & IdInFrame,
+    const polygon_2d & geoPoly) const
+{
+    VoronoiDiagram vd;
+    double boundpoint =
+        10 * max(max(fabs(_geoMinX), fabs(_geoMinY)), max(fabs(_geoMaxX), fabs(_geoMaxY)));
+    vector<pair<polygon_2d, int>> polygons_id;
+    polygons_id = vd.getVoronoiPolygons(XInFrame, YInFrame, VInFrame, IdInFrame, boundpoint);
+
+    polygon_2d poly;
+    if(_cutByCircle) {
+        polygons_id =
+            vd.cutPolygonsWithCircle(polygons_id, XInFrame, YInFrame, _cutRadius, _circleEdges);
+    }
+
+    polygons_id = vd.cutPolygonsWithGeometry(polygons_id, geoPoly, XInFrame, YInFrame);
+
+    for(auto && p : polygons_id) {
+        poly = p.first;
+        ReducePrecision(poly);
+        // TODO update polygon_id?
+    }
+    return polygons_id;
+}
+
+void VoronoiPipeline::ReducePrecision(polygon_2d & polygon) const
+{
+    for(auto && point : polygon.outer()) {
+        point.x(round(point.x() * 100000000000.0) / 100000000000.0);
+        point.y(round(point.y() * 100000000000.0) / 100000000000.0);
+    }
+}
+
+bool VoronoiPipeline::IsPointsOnOneLine(vector<double> & XInFrame, vector<double> & YInFrame) const
+{
+    double deltaX    = XInFrame[1] - XInFrame[0];
+    bool isOnOneLine = true;
+    if(fabs(deltaX) < dmin) {
+        for(unsigned int i = 2; i < XInFrame.size(); i++) {
+            if(fabs(XInFrame[i] - XInFrame[0]) > dmin) {
+                isOnOneLine = false;
+                break;
+            }
+        }
+    } else {
+        double slope     = (YInFrame[1] - YInFrame[0]) / deltaX;
+        double intercept = YInFrame[0] - slope * XInFrame[0];
+        for(unsigned int i = 2; i < XInFrame.size(); i++) {
+            double dist =
+                fabs(slope * XInFrame[i] - YInFrame[i] + intercept) / sqrt(slope * slope + 1);
+            if(dist > dmin) {
+                isOnOneLine = false;
+                break;
+            }
+        }
+    }
+    return isOnOneLine;
+}
@@ -0,0 +1,155 @@
+/**
+ * \file        VoronoiPipeline.h
+ * \copyright   <2009-2022> Forschungszentrum Juelich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Frame loop of the Voronoi methods D, I and J. The Voronoi cells of a frame
+ * are calculated once for all measurement areas in the same geometry, the
+ * frames are analysed in parallel and the results are written in frame order.
+ *
+ **/
+
+#ifndef VORONOIPIPELINE_H_
+#define VORONOIPIPELINE_H_
+
+#include "../Analysis.h"
+#include "PedData.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class VoronoiPipeline;
+
+/**
+ * Pedestrians of one frame within the geometry of a measurement area. The
+ * Voronoi cells are calculated on the first call of GetPolygons() and reused by
+ * all methods analysing the frame.
+ */
+class VoronoiFrame
+{
+public:
+    VoronoiFrame(
+        const PedData & peddata,
+        int frameNr,
+        const std::vector<int> & ids,
+        double zPos,
+        const polygon_2d & geoPoly,
+        const VoronoiPipeline & pipeline);
+
+    const std::vector<polygon_2d> & GetPolygons();
+
+    int frameNr;
+    int numPeds; // before the Voronoi calculation adds pedestrians to small groups
+    std::vector<int> IdInFrame;
+    std::vector<double> XInFrame;
+    std::vector<double> YInFrame;
+    std::vector<double> ZInFrame;
+    std::vector<double> VInFrame;
+    // pedestrians of the frame that are not in the geometry
+    std::vector<double> XOutside;
+    std::vector<double> YOutside;
+    std::vector<double> ZOutside;
+
+private:
+    const VoronoiPipeline & _pipeline;
+    const polygon_2d & _geoPoly;
+    bool _hasPolygons;
+    std::vector<polygon_2d> _polygons;
+};
+
+/**
+ * Output of one method for one frame
+ */
+struct VoronoiFrameResults {
+    std::string voronoiResults; // lines of the density and velocity file
+    std::string individualFD;   // lines of the individual fundamental diagram file
+    std::vector<std::string> logMessages;
+};
+
+/**
+ * Interface of the methods analysing the Voronoi cells frame by frame
+ */
+class VoronoiMethod
+{
+public:
+    virtual ~VoronoiMethod() = default;
+    /**
+     * Selects the frames to analyse and opens the output files
+     */
+    virtual bool Prepare(
+        const PedData & peddata,
+        const fs::path & scriptsLocation,
+        const double & zPos_measureArea) = 0;
+    virtual bool IsFrameAnalysed(int frameNr) const = 0;
+    /**
+     * Analyses one frame. Different frames are analysed concurrently, the
+     * results are only written by WriteFrameResults().
+     */
+    virtual void AnalyseFrame(VoronoiFrame & frame, VoronoiFrameResults & results) = 0;
+    virtual void WriteFrameResults(const VoronoiFrameResults & results) = 0;
+    virtual void Finish() = 0;
+};
+
+class VoronoiPipeline
+{
+public:
+    VoronoiPipeline();
+    void Setcutbycircle(double radius, int edges);
+    void SetGeometryBoundaries(double minX, double minY, double maxX, double maxY);
+    /**
+     * Adds a prepared method. Methods with the same geometry polygon and
+     * height share the Voronoi cells of each frame.
+     */
+    void AddMethod(VoronoiMethod * method, const polygon_2d & geometryPolygon, double zPos);
+    void Run(const PedData & peddata);
+    std::vector<std::pair<polygon_2d, int>> GetPolygons(
+        std::vector<double> & XInFrame,
+        std::vector<double> & YInFrame,
+        std::vector<double> & VInFrame,
+        std::vector<int> & IdInFrame,
+        const polygon_2d & geoPoly) const;
+
+private:
+    struct Tessellation {
+        polygon_2d geoPoly;
+        double zPos;
+        std::vector<std::size_t> methods;
+    };
+    std::vector<VoronoiMethod *> _methods;
+    std::vector<Tessellation> _tessellations;
+    bool _cutByCircle; //Adjust whether cut each original voronoi cell by a circle
+    double _cutRadius;
+    int _circleEdges;
+    double _geoMinX; // LOWest vertex of the geometry (x coordinate)
+    double _geoMinY; //  LOWest vertex of the geometry (y coordinate)
+    double _geoMaxX; // Highest vertex of the geometry
+    double _geoMaxY;
+
+    /**
+      * Reduce the precision of the points to two digits
+      * @param polygon
+      */
+    void ReducePrecision(polygon_2d & polygon) const;
+    bool IsPointsOnOneLine(std::vector<double> & XInFrame, std::vector<double> & YInFrame) const;
+
+    friend class VoronoiFrame;
+};
+
+#endif /* VORONOIPIPELINE_H_ */
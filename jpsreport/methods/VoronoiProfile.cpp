@@ -0,0 +1,195 @@
+/**
+ * \file        VoronoiProfile.cpp
+ * \copyright   <2009-2022> Forschungszentrum Juelich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Density and velocity profiles of one frame on the field grid.
+ *
+ **/
+
+#include "VoronoiProfile.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// smaller overlaps of a Voronoi cell and a grid cell (fraction of the grid cell) are rounding errors
+// of Voronoi cells touching the grid cell
+constexpr double MIN_COVERED_FRACTION = 1e-9;
+
+namespace
+{
+/**
+ * Clips the ring against one side of an axis parallel rectangle (Sutherland-Hodgman)
+ * @param inside true for points on the inner side
+ * @param intersect intersection of a segment crossing the side
+ */
+template <typename Inside, typename Intersect>
+vector<point_2d> ClipSide(const vector<point_2d> & points, Inside inside, Intersect intersect)
+{
+    vector<point_2d> clipped;
+    if(points.empty()) {
+        return clipped;
+    }
+    point_2d previous = points.back();
+    for(const auto & point : points) {
+        if(inside(point)) {
+            if(!inside(previous)) {
+                clipped.push_back(intersect(previous, point));
+            }
+            clipped.push_back(point);
+        } else if(inside(previous)) {
+            clipped.push_back(intersect(previous, point));
+        }
+        previous = point;
+    }
+    return clipped;
+}
+
+/**
+ * Area of the part of the ring within [x0, x1] x [y0, y1]
+ */
+double ClippedArea(const ring & polygonRing, double x0, double y0, double x1, double y1)
+{
+    vector<point_2d> points(polygonRing.begin(), polygonRing.end());
+    // the closing point equals the first point
+    if(points.size() > 1 && equals(points.front(), points.back())) {
+        points.pop_back();
+    }
+    auto atX = [](const point_2d & p, const point_2d & q, double x) {
+        return point_2d(x, p.y() + (q.y() - p.y()) * (x - p.x()) / (q.x() - p.x()));
+    };
+    auto atY = [](const point_2d & p, const point_2d & q, double y) {
+        return point_2d(p.x() + (q.x() - p.x()) * (y - p.y()) / (q.y() - p.y()), y);
+    };
+    points = ClipSide(
+        points,
+        [x0](const point_2d & p) { return p.x() >= x0; },
+        [&](const point_2d & p, const point_2d & q) { return atX(p, q, x0); });
+    points = ClipSide(
+        points,
+        [x1](const point_2d & p) { return p.x() <= x1; },
+        [&](const point_2d & p, const point_2d & q) { return atX(p, q, x1); });
+    points = ClipSide(
+        points,
+        [y0](const point_2d & p) { return p.y() >= y0; },
+        [&](const point_2d & p, const point_2d & q) { return atY(p, q, y0); });
+    points = ClipSide(
+        points,
+        [y1](const point_2d & p) { return p.y() <= y1; },
+        [&](const point_2d & p, const point_2d & q) { return atY(p, q, y1); });
+
+    // shoelace formula, relative to the corner of the grid cell to keep the rounding errors small
+    double doubleArea = 0;
+    for(size_t i = 0; i < points.size(); i++) {
+        const point_2d & p = points[i];
+        const point_2d & q = points[(i + 1) % points.size()];
+        doubleArea += (p.x() - x0) * (q.y() - y0) - (q.x() - x0) * (p.y() - y0);
+    }
+    return fabs(doubleArea) / 2;
+}
+} // namespace
+
+VoronoiProfile::VoronoiProfile(
+    double minX,
+    double minY,
+    double maxX,
+    double maxY,
+    double gridSizeX,
+    double gridSizeY) :
+    _minX(minX), _maxY(maxY), _gridSizeX(gridSizeX), _gridSizeY(gridSizeY)
+{
+    // the number of rows and columns that the geometry will be discretized for field analysis
+    _numRows    = (int) ceil((maxY - minY) / gridSizeY);
+    _numColumns = (int) ceil((maxX - minX) / gridSizeX);
+    _density.assign(_numRows * _numColumns, 0);
+    _velocityArea.assign(_numRows * _numColumns, 0);
+    _velocitySum.assign(_numRows * _numColumns, 0);
+    _numPeds.assign(_numRows * _numColumns, 0);
+}
+
+void VoronoiProfile::AddPolygon(const polygon_2d & polygon, double velocity)
+{
+    model::box<point_2d> box;
+    envelope(polygon, box);
+    // grid cells overlapping the bounding box of the Voronoi cell
+    const int firstColumn = max(0, (int) floor((box.min_corner().x() - _minX) / _gridSizeX));
+    const int lastColumn =
+        min(_numColumns - 1, (int) floor((box.max_corner().x() - _minX) / _gridSizeX));
+    const int firstRow = max(0, (int) floor((_maxY - box.max_corner().y()) / _gridSizeY));
+    const int lastRow =
+        min(_numRows - 1, (int) floor((_maxY - box.min_corner().y()) / _gridSizeY));
+
+    const double polygonArea = area(polygon);
+    for(int row_i = firstRow; row_i <= lastRow; row_i++) {
+        const double y1 = _maxY - row_i * _gridSizeY;
+        const double y0 = y1 - _gridSizeY;
+        for(int colum_j = firstColumn; colum_j <= lastColumn; colum_j++) {
+            const double x0 = _minX + colum_j * _gridSizeX;
+            const double x1 = x0 + _gridSizeX;
+            double coveredArea = ClippedArea(polygon.outer(), x0, y0, x1, y1);
+            for(const auto & inner : polygon.inners()) {
+                coveredArea -= ClippedArea(inner, x0, y0, x1, y1);
+            }
+            if(coveredArea <= MIN_COVERED_FRACTION * GetCellArea()) {
+                continue;
+            }
+            const int index = row_i * _numColumns + colum_j;
+            _density[index] += coveredArea / polygonArea;
+            _velocityArea[index] += velocity * coveredArea;
+            _velocitySum[index] += velocity;
+            _numPeds[index]++;
+        }
+    }
+}
+
+int VoronoiProfile::GetNumRows() const
+{
+    return _numRows;
+}
+
+int VoronoiProfile::GetNumColumns() const
+{
+    return _numColumns;
+}
+
+double VoronoiProfile::GetDensity(int row, int column) const
+{
+    return _density[row * _numColumns + column] / (GetCellArea() * CMtoM * CMtoM);
+}
+
+double VoronoiProfile::GetAreaWeightedVelocity(int row, int column) const
+{
+    return _velocityArea[row * _numColumns + column] / GetCellArea();
+}
+
+double VoronoiProfile::GetMeanVelocity(int row, int column) const
+{
+    const int index = row * _numColumns + column;
+    if(_numPeds[index] == 0) {
+        return 0;
+    }
+    return _velocitySum[index] / _numPeds[index];
+}
+
+double VoronoiProfile::GetCellArea() const
+{
+    return _gridSizeX * _gridSizeY;
+}
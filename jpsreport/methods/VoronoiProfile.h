@@ -0,0 +1,82 @@
+/**
+ * \file        VoronoiProfile.h
+ * \copyright   <2009-2022> Forschungszentrum Juelich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Density and velocity profiles of one frame on the field grid. Each Voronoi
+ * cell is clipped against the grid cells of its bounding box only, instead of
+ * intersecting every grid cell with every Voronoi cell.
+ *
+ **/
+
+#ifndef VORONOIPROFILE_H_
+#define VORONOIPROFILE_H_
+
+#include "../Analysis.h"
+
+#include <vector>
+
+class VoronoiProfile
+{
+public:
+    /**
+     * The grid starts at the upper left corner (minX, maxY) of the geometry,
+     * rows are counted downwards.
+     */
+    VoronoiProfile(
+        double minX,
+        double minY,
+        double maxX,
+        double maxY,
+        double gridSizeX,
+        double gridSizeY);
+
+    void AddPolygon(const polygon_2d & polygon, double velocity);
+
+    int GetNumRows() const;
+    int GetNumColumns() const;
+    /**
+     * Voronoi density (m^(-2)) in the grid cell
+     */
+    double GetDensity(int row, int column) const;
+    /**
+     * Velocities weighted with the area of the Voronoi cells in the grid cell (method D)
+     */
+    double GetAreaWeightedVelocity(int row, int column) const;
+    /**
+     * Mean velocity of the pedestrians whose Voronoi cells overlap the grid cell (method J)
+     */
+    double GetMeanVelocity(int row, int column) const;
+
+private:
+    double _minX;
+    double _maxY;
+    double _gridSizeX;
+    double _gridSizeY;
+    int _numRows;
+    int _numColumns;
+    std::vector<double> _density;      // sum of the covered fractions of the Voronoi cells
+    std::vector<double> _velocityArea; // sum of velocity times covered area
+    std::vector<double> _velocitySum;
+    std::vector<int> _numPeds;
+
+    double GetCellArea() const;
+};
+
+#endif /* VORONOIPROFILE_H_ */
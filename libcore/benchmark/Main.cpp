@@ -0,0 +1,27 @@
+#define CATCH_CONFIG_RUNNER
+#include "IO/OutputHandler.h"
+#include "general/Logger.h"
+
+#include <catch2/catch.hpp>
+
+class NullOutputHandler : public OutputHandler
+{
+public:
+    void Write(const std::string &) override{};
+    void Write(const char *, ...) override{};
+};
+
+// the global Log is defined in the core library
+extern OutputHandler * Log;
+
+int main(int argc, char * argv[])
+{
+    Logging::Guard guard;
+    Logging::SetLogLevel(Logging::Level::Off);
+    NullOutputHandler handler;
+    Log = &handler;
+
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
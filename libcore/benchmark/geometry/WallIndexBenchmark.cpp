@@ -0,0 +1,221 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "IO/GeoFileParser.h"
+#include "IO/IniFileParser.h"
+#include "general/Configuration.h"
+#include "general/Filesystem.h"
+#include "geometry/Building.h"
+#include "geometry/Obstacle.h"
+#include "geometry/SubRoom.h"
+#include "geometry/Wall.h"
+#include "geometry/WallIndex.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cfloat>
+#include <exception>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// distance of the neighbours found with the default linked cell size
+constexpr double NEIGHBOUR_DISTANCE = 2.2;
+/// visibility checks per subroom, roughly the neighbour pairs of a crowded step
+constexpr std::size_t PAIRS_PER_SUBROOM = 2000;
+
+struct SubRoomSample {
+    SubRoom * subroom = nullptr;
+    std::vector<Line> walls;
+    WallIndex index;
+    std::vector<std::pair<Point, Point>> pairs;
+};
+
+/// walls and obstacle walls, i.e. the segments SubRoom::IsVisible() tests
+std::vector<Line> VisibilityWalls(const SubRoom & subroom)
+{
+    std::vector<Line> lines(subroom.GetAllWalls().begin(), subroom.GetAllWalls().end());
+    for(const auto & obstacle : subroom.GetAllObstacles()) {
+        const auto & walls = obstacle->GetAllWalls();
+        lines.insert(lines.end(), walls.begin(), walls.end());
+    }
+    return lines;
+}
+
+/// random positions inside the subroom with a neighbour close by
+std::vector<std::pair<Point, Point>> SamplePairs(const SubRoom & subroom, std::mt19937 & gen)
+{
+    double xMin = DBL_MAX;
+    double yMin = DBL_MAX;
+    double xMax = -DBL_MAX;
+    double yMax = -DBL_MAX;
+    for(const auto & p : subroom.GetPolygon()) {
+        xMin = std::min(xMin, p._x);
+        yMin = std::min(yMin, p._y);
+        xMax = std::max(xMax, p._x);
+        yMax = std::max(yMax, p._y);
+    }
+    std::uniform_real_distribution<double> x(xMin, xMax);
+    std::uniform_real_distribution<double> y(yMin, yMax);
+    std::uniform_real_distribution<double> offset(-NEIGHBOUR_DISTANCE, NEIGHBOUR_DISTANCE);
+
+    std::vector<std::pair<Point, Point>> pairs;
+    for(std::size_t attempt = 0;
+        attempt < 20 * PAIRS_PER_SUBROOM && pairs.size() < PAIRS_PER_SUBROOM;
+        ++attempt) {
+        const Point p1(x(gen), y(gen));
+        const Point p2 = p1 + Point(offset(gen), offset(gen));
+        if(subroom.IsInSubRoom(p1) && subroom.IsInSubRoom(p2)) {
+            pairs.emplace_back(p1, p2);
+        }
+    }
+    return pairs;
+}
+
+bool BruteForceIsVisible(const std::vector<Line> & walls, const Point & p1, const Point & p2)
+{
+    for(const auto & wall : walls) {
+        if(wall.IntersectionWith(p1, p2)) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("geometry/WallIndex IsVisible", "[geometry][WallIndex]")
+{
+    const fs::path demos = JPS_DEMOS_DIR;
+    const std::vector<std::string> projects{
+        "scenario_1_corridor/corridor_ini.xml",
+        "scenario_2_bottleneck/bottleneck_ini.xml",
+        "scenario_3_corner/corner_ini.xml",
+        "scenario_7_floorfield/ffRouter_ini.xml",
+        "scenario_10_big_room/inifile_big.xml",
+        "scenario_12_waiting_area/wa_triangle_ini.xml",
+        "scenario_13_schedule/schedule_ini.xml"};
+
+    for(const auto & project : projects) {
+        Configuration config;
+        try {
+            IniFileParser parser(&config);
+            parser.Parse(demos / project);
+        } catch(const std::exception & e) {
+            WARN(project << ": " << e.what());
+            continue;
+        }
+        Building building;
+        {
+            GeoFileParser geoParser(&config);
+            geoParser.LoadBuilding(&building);
+        }
+        REQUIRE(building.InitGeometry());
+
+        std::mt19937 gen(42);
+        std::vector<SubRoomSample> samples;
+        std::size_t nSubRooms     = 0;
+        std::size_t nConvexFree   = 0;
+        std::size_t nChecks       = 0;
+        std::size_t testsAllWalls = 0;
+        std::size_t testsIndex    = 0;
+        for(const auto & room : building.GetAllRooms()) {
+            for(const auto & [id, subroom] : room.second->GetAllSubRooms()) {
+                ++nSubRooms;
+                if(subroom->IsConvexWithoutObstacles()) {
+                    ++nConvexFree;
+                }
+                SubRoomSample sample;
+                sample.subroom = subroom.get();
+                sample.walls = VisibilityWalls(*subroom);
+                sample.pairs = SamplePairs(*subroom, gen);
+                if(sample.walls.size() >= WallIndex::MIN_LINES) {
+                    sample.index.Build(sample.walls);
+                }
+                // number of segment tests if the line of sight is free
+                for(const auto & [p1, p2] : sample.pairs) {
+                    testsAllWalls += sample.walls.size();
+                    testsIndex += sample.index.IsEmpty() ? sample.walls.size() :
+                                                           sample.index.CountCandidates(p1, p2);
+                }
+                nChecks += sample.pairs.size();
+                samples.push_back(std::move(sample));
+            }
+        }
+        if(nChecks == 0) {
+            continue;
+        }
+
+        const std::string name = fs::path(project).parent_path().string();
+        WARN(
+            name << ": " << nSubRooms << " subrooms (" << nConvexFree
+                 << " convex without obstacles), segment tests per visibility check: "
+                 << static_cast<double>(testsAllWalls) / nChecks << " all walls, "
+                 << static_cast<double>(testsIndex) / nChecks << " wall index");
+
+        BENCHMARK(name + " all walls")
+        {
+            std::size_t visible = 0;
+            for(const auto & sample : samples) {
+                for(const auto & [p1, p2] : sample.pairs) {
+                    visible += BruteForceIsVisible(sample.walls, p1, p2);
+                }
+            }
+            return visible;
+        };
+
+        BENCHMARK(name + " wall index")
+        {
+            std::size_t visible = 0;
+            for(const auto & sample : samples) {
+                for(const auto & [p1, p2] : sample.pairs) {
+                    visible += sample.index.IsEmpty() ?
+                                   BruteForceIsVisible(sample.walls, p1, p2) :
+                                   !sample.index.IntersectsAny(p1, p2);
+                }
+            }
+            return visible;
+        };
+
+        // the visibility test of GCFM: all walls of the building against the
+        // walls of the subroom and its neighbours
+        BENCHMARK(name + " building all subrooms")
+        {
+            const std::vector<SubRoom *> all;
+            std::size_t visible = 0;
+            for(const auto & sample : samples) {
+                for(const auto & [p1, p2] : sample.pairs) {
+                    visible += building.IsVisible(p1, p2, all, false);
+                }
+            }
+            return visible;
+        };
+
+        BENCHMARK(name + " building local")
+        {
+            std::size_t visible = 0;
+            for(const auto & sample : samples) {
+                for(const auto & [p1, p2] : sample.pairs) {
+                    visible += building.IsVisibleLocal(p1, p2, sample.subroom, sample.subroom);
+                }
+            }
+            return visible;
+        };
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "AllocationCounter.h"
+#include "IO/IniFileParser.h"
+#include "Simulation.h"
+#include "general/Configuration.h"
+#include "general/Filesystem.h"
+#include "math/OperationalModel.h"
+
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <string>
+
+namespace
+{
+/// room of 40 m x 20 m with one exit, nPeds agents of the velocity model
+fs::path WriteScenario(int nPeds)
+{
+    const fs::path dir = fs::temp_directory_path() / "jps_velocity_model_benchmark";
+    fs::create_directories(dir);
+
+    std::ofstream geometry((dir / "geometry.xml").string());
+    geometry << R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<geometry version="0.8" caption="room" unit="m">
+  <rooms>
+    <room id="0" caption="room">
+      <subroom id="0" closed="0" class="subroom">
+        <polygon caption="wall">
+          <vertex px="40" py="9"/>
+          <vertex px="40" py="0"/>
+          <vertex px="0" py="0"/>
+          <vertex px="0" py="20"/>
+          <vertex px="40" py="20"/>
+          <vertex px="40" py="11"/>
+        </polygon>
+      </subroom>
+    </room>
+  </rooms>
+  <transitions>
+    <transition id="0" caption="exit" type="emergency"
+                room1_id="0" subroom1_id="0" room2_id="-1" subroom2_id="-1">
+      <vertex px="40" py="9"/>
+      <vertex px="40" py="11"/>
+    </transition>
+  </transitions>
+</geometry>
+)";
+    geometry.close();
+
+    std::ofstream ini((dir / "ini.xml").string());
+    ini << R"(<?xml version="1.0" encoding="UTF-8" ?>
+<JuPedSim project="JPS-Project" version="0.7">
+  <seed>1234</seed>
+  <max_sim_time>100</max_sim_time>
+  <geometry>geometry.xml</geometry>
+  <trajectories format="plain" fps="8">
+    <file location="traj.txt"/>
+  </trajectories>
+  <agents operational_model_id="3">
+    <agents_distribution>
+      <group group_id="1" agent_parameter_id="1" room_id="0" subroom_id="0" number=")"
+        << nPeds << R"(" goal_id="-1" router_id="1"/>
+    </agents_distribution>
+  </agents>
+  <operational_models>
+    <model operational_model_id="3" description="Tordeux2015">
+      <model_parameters>
+        <solver>euler</solver>
+        <stepsize>0.01</stepsize>
+        <exit_crossing_strategy>3</exit_crossing_strategy>
+        <linkedcells enabled="true" cell_size="2.2"/>
+        <force_ped a="8" D="0.1"/>
+        <force_wall a="5" D="0.02"/>
+      </model_parameters>
+      <agent_parameters agent_parameter_id="1">
+        <v0 mu="1.0" sigma="0.001"/>
+        <bmax mu="0.15" sigma="0.0"/>
+        <bmin mu="0.15" sigma="0.0"/>
+        <amin mu="0.15" sigma="0.0"/>
+        <tau mu="0.5" sigma="0.001"/>
+        <atau mu="0.0" sigma="0.0"/>
+        <T mu="1" sigma="0.001"/>
+      </agent_parameters>
+    </model>
+  </operational_models>
+  <route_choice_models>
+    <router router_id="1" description="global_shortest"/>
+  </route_choice_models>
+</JuPedSim>
+)";
+    ini.close();
+    return dir / "ini.xml";
+}
+} // namespace
+
+TEST_CASE("math/VelocityModel ComputeNextTimeStep", "[math][VelocityModel]")
+{
+    const int nPeds = 2000;
+    Configuration config;
+    IniFileParser parser(&config);
+    parser.Parse(WriteScenario(nPeds));
+    Simulation simulation(&config);
+    REQUIRE(simulation.InitArgs());
+
+    Building * building = simulation.GetBuilding();
+    auto model          = config.GetModel();
+    const double dt     = config.Getdt();
+    double time         = 0;
+    auto step           = [&]() {
+        building->UpdateGrid();
+        model->ComputeNextTimeStep(time, dt, building, 0);
+        time += dt;
+    };
+
+    // the first step sizes the reusable buffers
+    step();
+    const std::size_t before = AllocationCount();
+    step();
+    const std::size_t allocations = AllocationCount() - before;
+    INFO(
+        "VelocityModel: " << allocations << " allocations per step with "
+                          << building->GetAllPedestrians().size() << " agents");
+    CHECK(allocations == 0);
+
+    BENCHMARK("ComputeNextTimeStep " + std::to_string(nPeds) + " agents")
+    {
+        step();
+        return time;
+    };
+}
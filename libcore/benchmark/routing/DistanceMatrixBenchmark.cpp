@@ -0,0 +1,57 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "routing/DistanceMatrix.h"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+
+namespace
+{
+/// door graph of a building where each door connects to a few doors nearby
+DistanceMatrix CreateDoorGraph(int nDoors)
+{
+    DistanceMatrix matrix;
+    matrix.Reset(static_cast<std::size_t>(nDoors));
+    std::mt19937 gen(nDoors);
+    std::uniform_int_distribution<int> offset(1, 8);
+    std::uniform_real_distribution<double> length(1., 25.);
+    for(int door = 0; door < nDoors; ++door) {
+        for(int e = 0; e < 4; ++e) {
+            const int other = (door + offset(gen)) % nDoors;
+            const double d  = length(gen);
+            matrix.SetDistance(door, other, d);
+            matrix.SetDistance(other, door, d);
+        }
+    }
+    return matrix;
+}
+} // namespace
+
+TEST_CASE("routing/DistanceMatrix FloydWarshall", "[routing][DistanceMatrix]")
+{
+    for(int nDoors : {250, 500, 1000, 2000}) {
+        const DistanceMatrix graph = CreateDoorGraph(nDoors);
+        BENCHMARK("FloydWarshall " + std::to_string(nDoors) + " doors")
+        {
+            DistanceMatrix matrix = graph;
+            matrix.FloydWarshall();
+            return matrix.GetDistance(0, nDoors - 1);
+        };
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "IO/GeoFileParser.h"
+#include "IO/IniFileParser.h"
+#include "general/Configuration.h"
+#include "general/Filesystem.h"
+#include "general/Macros.h"
+#include "geometry/Building.h"
+#include "routing/ff_router/UnivFFviaFM.h"
+#include "routing/ff_router/mesh/RectGrid.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+/// grid spacing of the floor fields of the ff router [m]
+constexpr double SPACING = 0.125;
+
+/// floor fields to all doors of all rooms, set up like FFRouter::Init()
+std::vector<std::unique_ptr<UnivFFviaFM>>
+CreateFloorFields(Building & building, Configuration & config, int fmQueue)
+{
+    config.set_fm_queue(fmQueue);
+    std::vector<std::unique_ptr<UnivFFviaFM>> fields;
+    for(auto & [id, room] : building.GetAllRooms()) {
+        auto field = std::make_unique<UnivFFviaFM>(room.get(), &config, SPACING, 0.0, false);
+        field->setUser(DISTANCE_MEASUREMENTS_ONLY);
+        field->setMode(CENTERPOINT);
+        field->setSpeedMode(FF_HOMO_SPEED);
+        field->addAllTargetsParallel();
+        fields.push_back(std::move(field));
+    }
+    return fields;
+}
+} // namespace
+
+TEST_CASE("routing/UnivFFviaFM fast marching queue", "[routing][UnivFFviaFM]")
+{
+    const fs::path demos = JPS_DEMOS_DIR;
+    const std::vector<std::string> projects{
+        "scenario_2_bottleneck/bottleneck_ini.xml",
+        "scenario_7_floorfield/ffRouter_ini.xml",
+                "scenario_10_big_room/inifile_big.xml",
+        "scenario_12_waiting_area/wa_triangle_ini.xml"};
+
+    for(const auto & project : projects) {
+        Configuration config;
+        try {
+            IniFileParser parser(&config);
+            parser.Parse(demos / project);
+        } catch(const std::exception & e) {
+            WARN(project << ": " << e.what());
+            continue;
+        }
+        Building building;
+        {
+            GeoFileParser geoParser(&config);
+            geoParser.LoadBuilding(&building);
+        }
+        REQUIRE(building.InitGeometry());
+
+        // error of the bucket queue against the exact solver, on all grid
+        // points of the subrooms reached by the front
+        const auto heap   = CreateFloorFields(building, config, FM_QUEUE_HEAP);
+        const auto bucket = CreateFloorFields(building, config, FM_QUEUE_BUCKET);
+        REQUIRE(heap.size() == bucket.size());
+        std::size_t nValues = 0;
+        double maxError     = 0.;
+        double sumError     = 0.;
+        double maxCost      = 0.;
+        for(std::size_t i = 0; i < heap.size(); ++i) {
+            RectGrid * grid     = heap[i]->getGrid();
+            SubRoom ** subrooms = heap[i]->getSubRoomFF();
+            for(int uid : heap[i]->getKnownDoorUIDs()) {
+                for(long int key = 0; key < grid->GetnPoints(); ++key) {
+                    if(!subrooms[key]) {
+                        continue;
+                    }
+                    const Point pos    = grid->getPointFromKey(key);
+                    const double exact = heap[i]->getCostToDestination(uid, pos);
+                    const double cost  = bucket[i]->getCostToDestination(uid, pos);
+                    REQUIRE((exact < 0.) == (cost < 0.));
+                    if(exact < 0.) {
+                        continue;
+                    }
+                    const double error = std::fabs(cost - exact);
+                    maxError           = std::max(maxError, error);
+                    maxCost            = std::max(maxCost, exact);
+                    sumError += error;
+                    ++nValues;
+                }
+            }
+        }
+        if(nValues == 0) {
+            continue;
+        }
+
+        const std::string name = fs::path(project).parent_path().string();
+        WARN(
+            name << ": " << nValues << " values, max cost " << maxCost << " m, error of the "
+                 << "bucket queue: max " << maxError << " m, mean " << sumError / nValues
+                 << " m");
+        // the buckets are not wider than the smallest cost step, the points
+        // of one bucket only differ in the order their neighbours are updated
+        REQUIRE(maxError <= SPACING);
+
+        BENCHMARK(name + " heap")
+        {
+            return CreateFloorFields(building, config, FM_QUEUE_HEAP).size();
+        };
+
+        BENCHMARK(name + " bucket")
+        {
+            return CreateFloorFields(building, config, FM_QUEUE_BUCKET).size();
+        };
+    }
+}
@@ -0,0 +1,198 @@
+/**
+ * \file        AsyncTrajectories.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "AsyncTrajectories.h"
+
+#include <algorithm>
+#include <utility>
+
+AsyncTrajectories::AsyncTrajectories(
+    std::unique_ptr<Trajectories> writer,
+    std::size_t queueDepth) :
+    _writer(std::move(writer)), _frames(std::max<std::size_t>(queueDepth, 1))
+{
+    for(auto & frame : _frames) {
+        _freeFrames.push_back(&frame);
+    }
+    _thread = std::thread(&AsyncTrajectories::Run, this);
+}
+
+AsyncTrajectories::~AsyncTrajectories()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _taskQueued.notify_one();
+    _thread.join();
+}
+
+void AsyncTrajectories::WriteHeader(
+    long nPeds,
+    double fps,
+    Building * building,
+    int seed,
+    int count)
+{
+    Flush();
+    _writer->WriteHeader(nPeds, fps, building, seed, count);
+}
+
+void AsyncTrajectories::WriteGeometry(Building * building)
+{
+    Flush();
+    _writer->WriteGeometry(building);
+}
+
+void AsyncTrajectories::WriteFooter()
+{
+    Flush();
+    _writer->WriteFooter();
+}
+
+void AsyncTrajectories::WriteSources(const std::vector<std::shared_ptr<AgentsSource>> & sources)
+{
+    Flush();
+    _writer->WriteSources(sources);
+}
+
+void AsyncTrajectories::WriteFrame(int frameNr, Building * building)
+{
+    TrajectoryFrame * frame = AcquireFrame();
+    // the optional output functions of the wrapped writer are only read here
+    _writer->CollectFrame(frameNr, building, *frame);
+    Enqueue({frame, {}});
+}
+
+void AsyncTrajectories::WriteFrame(const TrajectoryFrame & frame)
+{
+    TrajectoryFrame * copy = AcquireFrame();
+    copy->frameNr          = frame.frameNr;
+    copy->agents.assign(frame.agents.begin(), frame.agents.end());
+    Enqueue({copy, {}});
+}
+
+void AsyncTrajectories::Post(const std::function<void(Trajectories &)> & task)
+{
+    Enqueue({nullptr, task});
+}
+
+void AsyncTrajectories::AddOptionalOutput(OptionalOutput option)
+{
+    Flush();
+    _writer->AddOptionalOutput(option);
+}
+
+void AsyncTrajectories::SetOptionalOutput(std::set<OptionalOutput> options)
+{
+    Flush();
+    _writer->SetOptionalOutput(std::move(options));
+}
+
+void AsyncTrajectories::SetOutputHandler(std::shared_ptr<OutputHandler> outputHandler)
+{
+    Flush();
+    _writer->SetOutputHandler(std::move(outputHandler));
+}
+
+void AsyncTrajectories::Flush()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _taskDone.wait(lock, [this]() { return (_tasks.empty() && !_busy) || _error; });
+    RethrowError();
+}
+
+TrajectoryFrame * AsyncTrajectories::AcquireFrame()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _taskDone.wait(lock, [this]() { return !_freeFrames.empty() || _error; });
+    RethrowError();
+    TrajectoryFrame * frame = _freeFrames.back();
+    _freeFrames.pop_back();
+    return frame;
+}
+
+void AsyncTrajectories::Enqueue(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_error) {
+            if(task.frame) {
+                _freeFrames.push_back(task.frame);
+            }
+            RethrowError();
+        }
+        _tasks.push_back(std::move(task));
+    }
+    _taskQueued.notify_one();
+}
+
+void AsyncTrajectories::RethrowError()
+{
+    // called with _mutex locked, the error is reported only once
+    if(_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+}
+
+void AsyncTrajectories::Run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(true) {
+        _taskQueued.wait(lock, [this]() { return !_tasks.empty() || _stop; });
+        if(_tasks.empty()) {
+            // stop only after all queued output is written
+            return;
+        }
+        Task task = std::move(_tasks.front());
+        _tasks.pop_front();
+        _busy = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            if(task.frame) {
+                _writer->WriteFrame(*task.frame);
+            } else {
+                task.post(*_writer);
+            }
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if(task.frame) {
+            _freeFrames.push_back(task.frame);
+        }
+        if(error) {
+            // the output is broken, drop what is still queued
+            _error = error;
+            for(const auto & pending : _tasks) {
+                if(pending.frame) {
+                    _freeFrames.push_back(pending.frame);
+                }
+            }
+            _tasks.clear();
+        }
+        _busy = false;
+        _taskDone.notify_all();
+    }
+}
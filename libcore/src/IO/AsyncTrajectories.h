@@ -0,0 +1,121 @@
+/**
+ * \file        AsyncTrajectories.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Writes the frames of any trajectory format on a background thread, so the
+ * simulation does not wait for formatting and disk I/O.
+ *
+ **/
+#pragma once
+
+#include "Trajectories.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \class AsyncTrajectories
+ *
+ * \brief Decorator running the frame output of another writer on a thread.
+ *
+ * WriteFrame() only copies the agents into one of queueDepth preallocated
+ * frame buffers and returns, the wrapped writer formats and writes the frame
+ * on the writer thread. If all buffers are queued, WriteFrame() blocks until
+ * the writer released one (back pressure).
+ *
+ * Frames and tasks passed to Post() are processed in order. Header, geometry,
+ * sources and footer are written on the calling thread after all queued
+ * frames, as are changes of the output handler and the optional output.
+ *
+ * Errors of the writer thread are rethrown by the next call on the
+ * simulation thread.
+ */
+class AsyncTrajectories : public Trajectories
+{
+public:
+    /// two buffers: one is filled by the simulation while the other is written
+    static constexpr std::size_t DEFAULT_QUEUE_DEPTH = 2;
+
+    explicit AsyncTrajectories(
+        std::unique_ptr<Trajectories> writer,
+        std::size_t queueDepth = DEFAULT_QUEUE_DEPTH);
+
+    /**
+     * Writes all queued frames and stops the writer thread
+     */
+    ~AsyncTrajectories() override;
+
+    AsyncTrajectories(const AsyncTrajectories &) = delete;
+    AsyncTrajectories & operator=(const AsyncTrajectories &) = delete;
+
+    void WriteHeader(long nPeds, double fps, Building * building, int seed, int count) override;
+    void WriteGeometry(Building * building) override;
+    void WriteFooter() override;
+    void WriteSources(const std::vector<std::shared_ptr<AgentsSource>> & sources) override;
+
+    void WriteFrame(int frameNr, Building * building) override;
+    void WriteFrame(const TrajectoryFrame & frame) override;
+
+    void Post(const std::function<void(Trajectories &)> & task) override;
+
+    void AddOptionalOutput(OptionalOutput option) override;
+    void SetOptionalOutput(std::set<OptionalOutput> options) override;
+    void SetOutputHandler(std::shared_ptr<OutputHandler> outputHandler) override;
+
+    /**
+     * Block until all queued frames and tasks are processed
+     */
+    void Flush();
+
+private:
+    struct Task {
+        /// frame to write, nullptr for tasks passed to Post()
+        TrajectoryFrame * frame = nullptr;
+        std::function<void(Trajectories &)> post;
+    };
+
+    /// wait for a free frame buffer, rethrows errors of the writer thread
+    TrajectoryFrame * AcquireFrame();
+    void Enqueue(Task task);
+    void RethrowError();
+    void Run();
+
+    std::unique_ptr<Trajectories> _writer;
+    std::vector<TrajectoryFrame> _frames;
+    std::vector<TrajectoryFrame *> _freeFrames;
+    std::deque<Task> _tasks;
+    bool _busy = false;
+    bool _stop = false;
+    std::exception_ptr _error;
+
+    std::mutex _mutex;
+    /// signals the writer thread new tasks or the stop request
+    std::condition_variable _taskQueued;
+    /// signals the simulation thread released frames and the end of a task
+    std::condition_variable _taskDone;
+    std::thread _thread;
+};
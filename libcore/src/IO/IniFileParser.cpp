@@ -237,12 +237,43 @@ bool IniFileParser::ParseHeader(TiXmlNode * xHeader)
             omp_set_num_threads(xmltoi(numthreads->Value()));
 #endif
         }
+
+        // distribution of the pedestrians to the threads
+        TiXmlElement * xNumThreads = xHeader->FirstChildElement("num_threads");
+        if(const char * schedule = xNumThreads->Attribute("schedule")) {
+            const std::string mode = schedule;
+            if(mode == "static") {
+                _config->SetScheduleMode(ScheduleMode::Static);
+            } else if(mode == "dynamic") {
+                _config->SetScheduleMode(ScheduleMode::Dynamic);
+            } else if(mode == "cells") {
+                _config->SetScheduleMode(ScheduleMode::Cells);
+            } else {
+                Logging::Error(fmt::format(
+                    check_fmt("Unknown schedule <{}>. Choose static, dynamic or cells"), mode));
+                throw std::logic_error("Parsing num_threads failed.");
+            }
+        }
+        if(xNumThreads->Attribute("chunk_size")) {
+            const int chunk = xmltoi(xNumThreads->Attribute("chunk_size"), 0);
+            if(chunk < 1) {
+                Logging::Error("The chunk_size of num_threads must be a positive number");
+                throw std::logic_error("Parsing num_threads failed.");
+            }
+            _config->SetScheduleChunk(chunk);
+        }
     }
     _config->SetMaxOpenMPThreads(omp_get_max_threads());
     Logging::Info(fmt::format(
         check_fmt("Using {} OpenMP threads, {} available."),
         _config->GetMaxOpenMPThreads(),
         max_threads));
+    if(_config->GetScheduleMode() != ScheduleMode::Static) {
+        Logging::Info(fmt::format(
+            check_fmt("Threads get chunks of {} pedestrians{}"),
+            _config->GetScheduleChunk(),
+            _config->GetScheduleMode() == ScheduleMode::Cells ? ", ordered by cell" : ""));
+    }
 
     //display statistics
     if(xHeader->FirstChild("show_statistics")) {
@@ -267,11 +298,21 @@ bool IniFileParser::ParseHeader(TiXmlNode * xHeader)
             _config->SetFileFormat(FileFormat::XML);
         } else if(format == "plain") {
             _config->SetFileFormat(FileFormat::TXT);
+        } else if(format == "binary") {
+            _config->SetFileFormat(FileFormat::BINARY);
         } else {
             Logging::Warning("no output format specified. Using default: TXT");
             _config->SetFileFormat(FileFormat::TXT);
         }
 
+        // write the trajectories on a separate thread
+        std::string async = xHeader->FirstChildElement("trajectories")->Attribute("async") ?
+                                xHeader->FirstChildElement("trajectories")->Attribute("async") :
+                                "true";
+        std::transform(async.begin(), async.end(), async.begin(), ::tolower);
+        _config->SetAsyncOutput(async == "true");
+        Logging::Info(fmt::format(check_fmt("Asynchronous trajectory output: {}"), async));
+
         //color mode
         std::string color_mode =
             xHeader->FirstChildElement("trajectories")->Attribute("color_mode") ?
@@ -326,6 +367,13 @@ bool IniFileParser::ParseHeader(TiXmlNode * xHeader)
 
                         break;
                     }
+                    case FileFormat::BINARY: {
+                        if(extension != ".bin") {
+                            canonicalTrajPath.replace_extension(".bin");
+                            Logging::Warning("replaced output file extension with: .bin");
+                        }
+                        break;
+                    }
                 }
                 _config->SetTrajectoriesFile(canonicalTrajPath);
                 _config->SetOriginalTrajectoriesFile(canonicalTrajPath);
@@ -500,6 +548,10 @@ bool IniFileParser::ParseGCFMModel(TiXmlElement * xGCFM, TiXmlElement * xMainNod
     if(!ParseLinkedCells(*xModelPara))
         return false;
 
+    //visibility inside convex subrooms
+    if(!ParseConvexVisibility(*xModelPara))
+        return false;
+
     //force_ped
     if(xModelPara->FirstChild("force_ped")) {
         std::string nu       = xModelPara->FirstChildElement("force_ped")->Attribute("nu");
@@ -600,6 +652,10 @@ bool IniFileParser::ParseVelocityModel(TiXmlElement * xVelocity, TiXmlElement *
     if(!ParseLinkedCells(*xModelPara))
         return false;
 
+    //visibility inside convex subrooms
+    if(!ParseConvexVisibility(*xModelPara))
+        return false;
+
     //periodic
     if(!ParsePeriodic(*xModelPara))
         return false;
@@ -966,6 +1022,41 @@ bool IniFileParser::ParseFfRouterOps(TiXmlNode * routingNode, RoutingStrategy s)
                 pParametersForAllFF->FirstChild("write_VTK_files")->FirstChild()->Value(), "true");
             _config->set_write_VTK_files(tmp_write_VTK);
         }
+        if(pParametersForAllFF->FirstChild("incremental_update")) {
+            bool incremental = !std::strcmp(
+                pParametersForAllFF->FirstChild("incremental_update")->FirstChild()->Value(),
+                "true");
+            _config->set_incremental_update(incremental);
+            if(incremental && s == ROUTING_FF_QUICKEST) {
+                Logging::Warning("incremental_update is ignored by the ff_quickest router");
+            }
+        }
+        if(pParametersForAllFF->FirstChild("fast_marching_queue")) {
+            const char * queue =
+                pParametersForAllFF->FirstChild("fast_marching_queue")->FirstChild()->Value();
+            if(!std::strcmp(queue, "heap")) {
+                _config->set_fm_queue(FM_QUEUE_HEAP);
+            } else if(!std::strcmp(queue, "bucket")) {
+                _config->set_fm_queue(FM_QUEUE_BUCKET);
+            } else {
+                Logging::Error(fmt::format(
+                    check_fmt("Unknown fast_marching_queue <{}>, use heap or bucket."), queue));
+                return false;
+            }
+        }
+        if(pParametersForAllFF->FirstChild("floorfield_cache")) {
+            fs::path cacheDir =
+                pParametersForAllFF->FirstChild("floorfield_cache")->FirstChild()->Value();
+            if(cacheDir.is_relative()) {
+                cacheDir = _config->GetProjectRootDir() / cacheDir;
+            }
+            _config->set_ff_cache_dir(cacheDir);
+            Logging::Info(
+                fmt::format(check_fmt("Floor fields are cached in <{}>"), cacheDir.string()));
+        }
+        if(!ParseFfMemoryOpts(*pParametersForAllFF)) {
+            return false;
+        }
     }
     FFRouter * r =
         static_cast<FFRouter *>(_config->GetRoutingEngine()->GetAvailableRouters().back());
@@ -1107,6 +1198,27 @@ bool IniFileParser::ParsePeriodic(TiXmlNode & Node)
     return true; //default is periodic=0. If not specified than is OK
 }
 
+bool IniFileParser::ParseConvexVisibility(const TiXmlNode & Node)
+{
+    if(Node.FirstChildElement("convex_visibility")) {
+        const char * convex = Node.FirstChildElement("convex_visibility")->GetText();
+        if(convex && std::string(convex) == "true") {
+            _config->SetConvexVisibility(true);
+        } else if(convex && std::string(convex) == "false") {
+            _config->SetConvexVisibility(false);
+        } else {
+            Logging::Error("Invalid value for convex_visibility, use true or false");
+            return false;
+        }
+        Logging::Info(fmt::format(
+            check_fmt("Convex visibility <{}>"),
+            _config->GetConvexVisibility()));
+        return true;
+    }
+    _config->SetConvexVisibility(false);
+    return true; //default is to test all walls. If not specified than is OK
+}
+
 bool IniFileParser::ParseNodeToSolver(const TiXmlNode & solverNode)
 {
     if(solverNode.FirstChild("solver")) {
@@ -1329,5 +1441,65 @@ bool IniFileParser::ParseFfOpts(const TiXmlNode & strategyNode)
         else
             Logging::Info("UseWAD:\t no");
     }
+    return ParseFfMemoryOpts(strategyNode);
+}
+
+bool IniFileParser::ParseFfMemoryOpts(const TiXmlNode & node)
+{
+    if(node.FirstChild("lazy_floorfields")) {
+        std::string lazy = node.FirstChild("lazy_floorfields")->FirstChild()->Value();
+        _config->set_ff_lazy(lazy == "true");
+    }
+    if(node.FirstChild("floorfield_memory_budget")) {
+        double budget = atof(node.FirstChild("floorfield_memory_budget")->FirstChild()->Value());
+        if(budget < 0.) {
+            Logging::Error(
+                fmt::format(check_fmt("Negative floorfield_memory_budget <{}> MB."), budget));
+            return false;
+        }
+        _config->set_ff_memory_budget(static_cast<std::size_t>(budget * 1024 * 1024));
+        if(!_config->get_ff_lazy()) {
+            Logging::Warning("floorfield_memory_budget is ignored without lazy_floorfields");
+        }
+    }
+    if(node.FirstChild("floorfield_storage")) {
+        std::string storage = node.FirstChild("floorfield_storage")->FirstChild()->Value();
+        if(storage == "double") {
+            _config->set_ff_storage(FF_STORAGE_DOUBLE);
+        } else if(storage == "compact") {
+            _config->set_ff_storage(FF_STORAGE_COMPACT);
+            Logging::Info("Floor fields are stored compactly (float costs, int16 directions)");
+        } else if(storage == "multilevel") {
+            _config->set_ff_storage(FF_STORAGE_MULTILEVEL);
+        } else {
+            Logging::Error(fmt::format(
+                check_fmt("Unknown floorfield_storage <{}>, use double, compact or multilevel."),
+                storage));
+            return false;
+        }
+    }
+    if(node.FirstChild("floorfield_block_size")) {
+        int blockSize = atoi(node.FirstChild("floorfield_block_size")->FirstChild()->Value());
+        if(blockSize < 2) {
+            Logging::Error(fmt::format(
+                check_fmt("floorfield_block_size <{}> must be at least 2 grid cells."), blockSize));
+            return false;
+        }
+        _config->set_ff_block_size(blockSize);
+    }
+    if(_config->get_ff_storage() == FF_STORAGE_MULTILEVEL) {
+        Logging::Info(fmt::format(
+            check_fmt("Floor fields use coarse blocks of {} grid cells in open space"),
+            _config->get_ff_block_size()));
+    }
+    if(_config->get_ff_lazy()) {
+        if(_config->get_ff_memory_budget() > 0) {
+            Logging::Info(fmt::format(
+                check_fmt("Lazy floor fields, memory budget: {:.1f} MB"),
+                _config->get_ff_memory_budget() / 1048576.));
+        } else {
+            Logging::Info("Lazy floor fields, no memory budget");
+        }
+    }
     return true;
 }
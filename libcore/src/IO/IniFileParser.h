@@ -63,12 +63,16 @@ private:
 
     bool ParsePeriodic(TiXmlNode & Node);
 
+    bool ParseConvexVisibility(const TiXmlNode & Node);
+
     bool ParseNodeToSolver(const TiXmlNode & solverNode);
 
     bool ParseStrategyNodeToObject(const TiXmlNode & strategyNode);
 
     bool ParseFfOpts(const TiXmlNode & strategyNode);
 
+    bool ParseFfMemoryOpts(const TiXmlNode & node);
+
     Configuration * _config;
     int _model;
     std::shared_ptr<DirectionStrategy> _directionStrategy;
@@ -122,6 +122,12 @@ void OutputHandler::Write(const char * message, ...)
     }
 }
 
+void OutputHandler::WriteBinary(const char * data, std::size_t size)
+{
+    std::cout.write(data, size);
+    std::cout.flush();
+}
+
 void STDIOHandler::Write(const std::string & str)
 {
     if(str.find("ERROR") != std::string::npos) {
@@ -138,9 +144,9 @@ void STDIOHandler::Write(const std::string & str)
     }
 }
 
-FileHandler::FileHandler(const fs::path & path)
+FileHandler::FileHandler(const fs::path & path, bool binary)
 {
-    _pfp.open(path.string());
+    _pfp.open(path.string(), binary ? std::ios::out | std::ios::binary : std::ios::out);
     if(!_pfp.is_open()) {
         std::cerr << "Error!!! File " << path << " could not be opened" << std::endl;
         exit(0);
@@ -164,6 +170,12 @@ void FileHandler::Write(const std::string & str)
     }
 }
 
+void FileHandler::WriteBinary(const char * data, std::size_t size)
+{
+    _pfp.write(data, size);
+    _pfp.flush();
+}
+
 void FileHandler::Write(const char * str_msg, ...)
 {
     char msg[CLENGTH] = "";
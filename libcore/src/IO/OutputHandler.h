@@ -32,6 +32,7 @@
 #include "IO/TraVisToClient.h"
 #endif
 
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -62,6 +63,11 @@ public:
 
     virtual void Write(const std::string & str);
     virtual void Write(const char * string, ...);
+
+    /**
+     * Write raw bytes without any formatting or line break
+     */
+    virtual void WriteBinary(const char * data, std::size_t size);
 };
 
 class STDIOHandler : public OutputHandler
@@ -76,10 +82,14 @@ private:
     std::ofstream _pfp;
 
 public:
-    FileHandler(const fs::path & path);
+    /**
+     * @param binary open the file in binary mode, used with WriteBinary()
+     */
+    FileHandler(const fs::path & path, bool binary = false);
     ~FileHandler() override;
     void Write(const std::string & str) override;
     void Write(const char * string, ...) override;
+    void WriteBinary(const char * data, std::size_t size) override;
 };
 
 #ifdef _SIMULATOR
@@ -6,6 +6,7 @@
 #include "mpi/LCGrid.h"
 #include "pedestrian/Pedestrian.h"
 
+#include <iterator>
 #include <tinyxml.h>
 
 static fs::path getSourceFileName(const fs::path & projectFile)
@@ -132,6 +133,38 @@ static fs::path getGoalFileName(const fs::path & projectFile)
     return ret;
 }
 
+void Trajectories::WriteFrame(int frameNr, Building * building)
+{
+    CollectFrame(frameNr, building, _frame);
+    WriteFrame(_frame);
+}
+
+void Trajectories::CollectFrame(int frameNr, Building * building, TrajectoryFrame & frame) const
+{
+    const double RAD2DEG                      = 180.0 / M_PI;
+    const std::vector<Pedestrian *> & allPeds = building->GetAllPedestrians();
+
+    frame.frameNr = frameNr;
+    frame.agents.resize(allPeds.size());
+    for(std::size_t i = 0; i < allPeds.size(); ++i) {
+        Pedestrian * ped       = allPeds[i];
+        AgentFrameData & agent = frame.agents[i];
+        agent.id               = ped->GetID();
+        agent.color            = ped->GetColor();
+        agent.x                = ped->GetPos()._x;
+        agent.y                = ped->GetPos()._y;
+        agent.z                = ped->GetElevation();
+        agent.a                = ped->GetLargerAxis();
+        agent.b                = ped->GetSmallerAxis();
+        agent.angle =
+            atan2(ped->GetEllipse().GetSinPhi(), ped->GetEllipse().GetCosPhi()) * RAD2DEG;
+        agent.optionalOutput.clear();
+        for(const auto & option : _optionalOutputOptions) {
+            agent.optionalOutput.append(_optionalOutput.at(option)(ped));
+        }
+    }
+}
+
 /**
  * TXT format implementation
  */
@@ -267,36 +300,22 @@ void TrajectoriesTXT::WriteHeader(long, double fps, Building * building, int, in
 
 void TrajectoriesTXT::WriteGeometry(Building *) {}
 
-void TrajectoriesTXT::WriteFrame(int frameNr, Building * building)
+void TrajectoriesTXT::WriteFrame(const TrajectoryFrame & frame)
 {
-    const std::vector<Pedestrian *> & allPeds = building->GetAllPedestrians();
-    for(auto ped : allPeds) {
-        double x       = ped->GetPos()._x;
-        double y       = ped->GetPos()._y;
-        double z       = ped->GetElevation();
-        int color      = ped->GetColor();
-        double a       = ped->GetLargerAxis();
-        double b       = ped->GetSmallerAxis();
-        double phi     = atan2(ped->GetEllipse().GetSinPhi(), ped->GetEllipse().GetCosPhi());
-        double RAD2DEG = 180.0 / M_PI;
-
-        std::string frame = fmt::format(
+    for(const auto & agent : frame.agents) {
+        std::string line = fmt::format(
             "{:d}\t{:d}\t{:0.2f}\t{:0.2f}\t{:0.2f}\t{:0.2f}\t{:0.2f}\t{:0.2f}\t{:d}\t",
-            ped->GetID(),
-            frameNr,
-            x,
-            y,
-            z,
-            a,
-            b,
-            phi * RAD2DEG,
-            color);
-
-        for(const auto & option : _optionalOutputOptions) {
-            frame.append(_optionalOutput[option](ped));
-        }
-
-        Write(frame);
+            agent.id,
+            frame.frameNr,
+            agent.x,
+            agent.y,
+            agent.z,
+            agent.a,
+            agent.b,
+            agent.angle,
+            agent.color);
+        line.append(agent.optionalOutput);
+        Write(line);
     }
 }
 
@@ -382,25 +401,16 @@ void TrajectoriesXML::WriteGeometry(Building * building)
     _outputHandler->Write("\t</AttributeDescription>\n");
 }
 
-void TrajectoriesXML::WriteFrame(int frameNr, Building * building)
+void TrajectoriesXML::WriteFrame(const TrajectoryFrame & frame)
 {
     std::string data;
     char tmp[CLENGTH] = "";
-    double RAD2DEG    = 180.0 / M_PI;
 
-    sprintf(tmp, "<frame ID=\"%d\">\n", frameNr);
+    sprintf(tmp, "<frame ID=\"%d\">\n", frame.frameNr);
     data.append(tmp);
 
-    const std::vector<Pedestrian *> & allPeds = building->GetAllPedestrians();
-    for(unsigned int p = 0; p < allPeds.size(); p++) {
-        Pedestrian * ped    = allPeds[p];
-        Room * r            = building->GetRoom(ped->GetRoomID());
-        std::string caption = r->GetCaption();
-        char s[CLENGTH]     = "";
-        int color           = ped->GetColor();
-        double a            = ped->GetLargerAxis();
-        double b            = ped->GetSmallerAxis();
-        double phi          = atan2(ped->GetEllipse().GetSinPhi(), ped->GetEllipse().GetCosPhi());
+    for(const auto & agent : frame.agents) {
+        char s[CLENGTH] = "";
         sprintf(
             s,
             "<agent ID=\"%d\"\t"
@@ -408,14 +418,14 @@ void TrajectoriesXML::WriteFrame(int frameNr, Building * building)
             "z=\"%.6f\"\t"
             "rA=\"%.2f\"\trB=\"%.2f\"\t"
             "eO=\"%.2f\" eC=\"%d\"/>\n",
-            ped->GetID(),
-            (ped->GetPos()._x) * FAKTOR,
-            (ped->GetPos()._y) * FAKTOR,
-            (ped->GetElevation()) * FAKTOR,
-            a * FAKTOR,
-            b * FAKTOR,
-            phi * RAD2DEG,
-            color);
+            agent.id,
+            agent.x * FAKTOR,
+            agent.y * FAKTOR,
+            agent.z * FAKTOR,
+            agent.a * FAKTOR,
+            agent.b * FAKTOR,
+            agent.angle,
+            agent.color);
         data.append(s);
     }
     data.append("</frame>\n");
@@ -426,3 +436,60 @@ void TrajectoriesXML::WriteFooter()
 {
     _outputHandler->Write("</trajectories>\n");
 }
+
+/**
+ * Binary format implementation
+ */
+template <typename T>
+static void appendBinary(std::vector<char> & buffer, T value)
+{
+    const auto * bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void TrajectoriesBinary::WriteHeader(long, double fps, Building * building, int seed, int count)
+{
+    const fs::path tmpGeo = building->GetProjectRootDir() / building->GetGeometryFilename();
+    const std::string geometry = tmpGeo.string();
+
+    _buffer.clear();
+    _buffer.insert(_buffer.end(), std::begin(MAGIC), std::end(MAGIC));
+    appendBinary(_buffer, BYTE_ORDER_MARK);
+    appendBinary(_buffer, VERSION);
+    appendBinary(_buffer, static_cast<std::int32_t>(count));
+    appendBinary(_buffer, static_cast<std::int32_t>(seed));
+    appendBinary(_buffer, fps);
+    appendBinary(_buffer, static_cast<std::uint32_t>(geometry.size()));
+    _buffer.insert(_buffer.end(), geometry.begin(), geometry.end());
+    _outputHandler->WriteBinary(_buffer.data(), _buffer.size());
+}
+
+void TrajectoriesBinary::WriteFrame(const TrajectoryFrame & frame)
+{
+    const auto nPeds = static_cast<std::uint32_t>(frame.agents.size());
+
+    _buffer.clear();
+    _buffer.reserve(
+        sizeof(std::int32_t) + sizeof(std::uint32_t) +
+        nPeds * (sizeof(std::int32_t) + 4 * sizeof(float)));
+    appendBinary(_buffer, static_cast<std::int32_t>(frame.frameNr));
+    appendBinary(_buffer, nPeds);
+
+    // columnar layout, each quantity is stored contiguously for all agents
+    for(const auto & agent : frame.agents) {
+        appendBinary(_buffer, static_cast<std::int32_t>(agent.id));
+    }
+    for(const auto & agent : frame.agents) {
+        appendBinary(_buffer, static_cast<float>(agent.x));
+    }
+    for(const auto & agent : frame.agents) {
+        appendBinary(_buffer, static_cast<float>(agent.y));
+    }
+    for(const auto & agent : frame.agents) {
+        appendBinary(_buffer, static_cast<float>(agent.z));
+    }
+    for(const auto & agent : frame.agents) {
+        appendBinary(_buffer, static_cast<float>(agent.angle));
+    }
+    _outputHandler->WriteBinary(_buffer.data(), _buffer.size());
+}
@@ -23,6 +23,12 @@
  * TrajectoriesXML: xml output
  *
  * TrajectoriesTXT: txt output
+ *
+ * TrajectoriesBinary: binary output
+ *
+ * The agents of a frame are first collected into a TrajectoryFrame, the
+ * formats only write this snapshot. This allows writing the frames on another
+ * thread, see AsyncTrajectories.
  **/
 #pragma once
 
@@ -30,9 +36,35 @@
 #include "geometry/Building.h"
 #include "pedestrian/AgentsSource.h"
 
+#include <cstdint>
 #include <functional>
+#include <string>
 #include <vector>
 
+/**
+ * State of one agent as written to the trajectories
+ */
+struct AgentFrameData {
+    int id;
+    int color;
+    double x;
+    double y;
+    double z;
+    double a;     ///< larger semi-axis of the ellipse
+    double b;     ///< smaller semi-axis of the ellipse
+    double angle; ///< orientation of the ellipse in degrees
+    /// formatted values of the selected optional output options
+    std::string optionalOutput;
+};
+
+/**
+ * Snapshot of all agents in one frame
+ */
+struct TrajectoryFrame {
+    int frameNr = 0;
+    std::vector<AgentFrameData> agents;
+};
+
 class Trajectories
 {
 protected:
@@ -41,15 +73,39 @@ protected:
     std::map<OptionalOutput, std::function<std::string(Pedestrian *)>> _optionalOutput;
     std::map<OptionalOutput, std::string> _optionalOutputHeader;
     std::map<OptionalOutput, std::string> _optionalOutputInfo;
+    /// reused by WriteFrame(int, Building *)
+    TrajectoryFrame _frame;
 
 public:
     Trajectories()          = default;
     virtual ~Trajectories() = default;
     virtual void WriteHeader(long nPeds, double fps, Building * building, int seed, int count) = 0;
     virtual void WriteGeometry(Building * building)                                            = 0;
-    virtual void WriteFrame(int frameNr, Building * building)                                  = 0;
     virtual void WriteFooter()                                                                 = 0;
     virtual void WriteSources(const std::vector<std::shared_ptr<AgentsSource>> &)              = 0;
+
+    /**
+     * Write all agents of the building as frame frameNr
+     */
+    virtual void WriteFrame(int frameNr, Building * building);
+
+    /**
+     * Write a frame collected with CollectFrame()
+     */
+    virtual void WriteFrame(const TrajectoryFrame & frame) = 0;
+
+    /**
+     * Copy the state of all agents of the building into frame, the memory of
+     * frame is reused. The optional output is evaluated here as well.
+     */
+    void CollectFrame(int frameNr, Building * building, TrajectoryFrame & frame) const;
+
+    /**
+     * Run task after all output passed before has been written. Asynchronous
+     * writers run it on their writer thread, all others immediately.
+     */
+    virtual void Post(const std::function<void(Trajectories &)> & task) { task(*this); }
+
     virtual void AddOptionalOutput(OptionalOutput option) { _optionalOutputOptions.insert(option); }
     virtual void SetOptionalOutput(std::set<OptionalOutput> options)
     {
@@ -58,7 +114,7 @@ public:
 
     void Write(const std::string & str) { _outputHandler->Write(str); }
 
-    void SetOutputHandler(std::shared_ptr<OutputHandler> outputHandler)
+    virtual void SetOutputHandler(std::shared_ptr<OutputHandler> outputHandler)
     {
         _outputHandler = std::move(outputHandler);
     }
@@ -71,7 +127,8 @@ public:
 
     void WriteHeader(long nPeds, double fps, Building * building, int seed, int count) override;
     void WriteGeometry(Building * building) override;
-    void WriteFrame(int frameNr, Building * building) override;
+    using Trajectories::WriteFrame;
+    void WriteFrame(const TrajectoryFrame & frame) override;
     void WriteFooter() override;
     void WriteSources(const std::vector<std::shared_ptr<AgentsSource>> &) override;
 };
@@ -84,7 +141,45 @@ public:
 
     void WriteHeader(long nPeds, double fps, Building * building, int seed, int count) override;
     void WriteGeometry(Building * building) override;
-    void WriteFrame(int frameNr, Building * building) override;
+    using Trajectories::WriteFrame;
+    void WriteFrame(const TrajectoryFrame & frame) override;
     void WriteFooter() override{};
     void WriteSources(const std::vector<std::shared_ptr<AgentsSource>> &) override{};
-};
\ No newline at end of file
+};
+
+/**
+ * Compact binary format, one record per frame written in a single call.
+ * All values are stored in native byte order (little endian on all supported
+ * platforms). Readers compare the byte order mark with their own byte order.
+ *
+ * header: char[4] magic "JPSB", uint32 byte order mark 0x01020304,
+ *         uint32 version, int32 count, int32 seed, float64 framerate,
+ *         uint32 length + characters of the geometry file
+ * frame:  int32 frame, uint32 n, int32 id[n], float32 x[n], float32 y[n],
+ *         float32 z[n], float32 angle[n]
+ *
+ * Positions are in metres, the angle is the orientation of the ellipse in
+ * degrees. There is no footer, a file ends after the last complete frame.
+ * Optional output is not supported. jpsreport reads the format with
+ * ReadBinaryTrajectories() in jpsreport/IO/TrajectoriesBinaryReader.h.
+ */
+class TrajectoriesBinary : public Trajectories
+{
+public:
+    static constexpr char MAGIC[4]                 = {'J', 'P', 'S', 'B'};
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr std::uint32_t VERSION         = 2;
+
+    TrajectoriesBinary() = default;
+
+    void WriteHeader(long nPeds, double fps, Building * building, int seed, int count) override;
+    void WriteGeometry(Building *) override{};
+    using Trajectories::WriteFrame;
+    void WriteFrame(const TrajectoryFrame & frame) override;
+    void WriteFooter() override{};
+    void WriteSources(const std::vector<std::shared_ptr<AgentsSource>> &) override{};
+
+private:
+    /// record of the current frame, kept to reuse the allocation
+    std::vector<char> _buffer;
+};
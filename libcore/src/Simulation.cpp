@@ -30,6 +30,7 @@
 
 #include "Simulation.h"
 
+#include "IO/AsyncTrajectories.h"
 #include "IO/Trajectories.h"
 #include "IO/progress_bar.h"
 #include "general/Filesystem.h"
@@ -117,6 +118,9 @@ bool Simulation::InitArgs()
             case FileFormat::TXT:
                 Logging::Warning("Format plain not yet supported in streaming");
                 return false;
+            case FileFormat::BINARY:
+                Logging::Warning("Format binary not yet supported in streaming");
+                return false;
             default:
                 return false;
         }
@@ -131,6 +135,10 @@ bool Simulation::InitArgs()
                     _iod = std::make_unique<TrajectoriesTXT>(TrajectoriesTXT());
                     break;
 
+                case FileFormat::BINARY:
+                    _iod = std::make_unique<TrajectoriesBinary>();
+                    break;
+
                 default:
                     break;
             }
@@ -141,15 +149,21 @@ bool Simulation::InitArgs()
         if(!trajParentPath.empty()) {
             fs::create_directories(trajParentPath);
         }
-        auto file = std::make_shared<FileHandler>(trajPath.c_str());
+        auto file = std::make_shared<FileHandler>(
+            trajPath.c_str(), _config->GetFileFormat() == FileFormat::BINARY);
         _iod->SetOutputHandler(file);
         _iod->SetOptionalOutput(_config->GetOptionalOutputOptions());
+        if(_config->GetAsyncOutput()) {
+            _iod = std::make_unique<AsyncTrajectories>(std::move(_iod));
+        }
     }
 
     _operationalModel = _config->GetModel();
     _deltaT           = _config->Getdt();
     _maxSimTime       = _config->GetTmax();
     _periodic         = _config->IsPeriodic();
+    _operationalModel->GetSchedule().SetMode(
+        _config->GetScheduleMode(), _config->GetScheduleChunk());
     _fps              = _config->GetFps();
 
     _routingEngine   = _config->GetRoutingEngine();
@@ -250,6 +264,9 @@ bool Simulation::InitArgs()
 
 double Simulation::RunStandardSimulation(double maxSimTime)
 {
+    if(_gotSources) {
+        _agentSrcManager.Start();
+    }
     RunHeader(_nPeds + _agentSrcManager.GetMaxAgentNumber());
     double t = RunBody(maxSimTime);
     RunFooter();
@@ -645,25 +662,30 @@ double Simulation::RunBody(double maxSimTime)
 void Simulation::RotateOutputFile()
 {
     // FIXME ??????
-    if(_config->GetFileFormat() != FileFormat::TXT) {
+    if(_config->GetFileFormat() == FileFormat::XML) {
         return;
     }
-    static const fs::path & p       = _config->GetTrajectoriesFile();
-    static const fs::path stem      = p.stem();
-    static const fs::path extension = p.extension();
-    static const fs::path parent    = p.parent_path();
-
-    if(fs::file_size(_currentTrajectoriesFile) > _maxFileSize) {
-        incrementCountTraj();
-        _currentTrajectoriesFile =
-            parent / fs::path(fmt::format(
-                         check_fmt("{}_{}{}"), stem.string(), _countTraj, extension.string()));
-        Logging::Info(
-            fmt::format(check_fmt("New trajectory file <{}>"), _currentTrajectoriesFile.string()));
-        auto file = std::make_shared<FileHandler>(_currentTrajectoriesFile);
-        _iod->SetOutputHandler(file);
-        _iod->WriteHeader(_nPeds, _fps, _building.get(), _seed, _countTraj);
-    }
+    // the size is checked after the preceding frame has been written, which
+    // may happen later on the writer thread of AsyncTrajectories
+    _iod->Post([this, nPeds = _nPeds](Trajectories & trajectories) {
+        static const fs::path & p       = _config->GetTrajectoriesFile();
+        static const fs::path stem      = p.stem();
+        static const fs::path extension = p.extension();
+        static const fs::path parent    = p.parent_path();
+
+        if(fs::file_size(_currentTrajectoriesFile) > _maxFileSize) {
+            incrementCountTraj();
+            _currentTrajectoriesFile =
+                parent / fs::path(fmt::format(
+                             check_fmt("{}_{}{}"), stem.string(), _countTraj, extension.string()));
+            Logging::Info(fmt::format(
+                check_fmt("New trajectory file <{}>"), _currentTrajectoriesFile.string()));
+            auto file = std::make_shared<FileHandler>(
+                _currentTrajectoriesFile, _config->GetFileFormat() == FileFormat::BINARY);
+            trajectories.SetOutputHandler(file);
+            trajectories.WriteHeader(nPeds, _fps, _building.get(), _seed, _countTraj);
+        }
+    });
 }
 
 //      |             |
@@ -932,6 +954,9 @@ void Simulation::RunFooter()
 {
     // writing the footer
     _iod->WriteFooter();
+
+    // how well the work was balanced between the threads
+    _operationalModel->GetSchedule().LogThreadLoad();
 }
 
 void Simulation::ProcessAgentsQueue()
@@ -941,6 +966,11 @@ void Simulation::ProcessAgentsQueue()
     /* for(auto pp: _building->GetAllPedestrians()) */
     /*           std::cout<< KBLU << "BUL: Simulation: " << pp->GetPos()._x << ", " << pp->GetPos()._y << RESET << std::endl; */
 
+    //release the agents of the sources due at the current time
+    if(_gotSources) {
+        _agentSrcManager.Update(Pedestrian::GetGlobalTime());
+    }
+
     //incoming pedestrians
     std::vector<Pedestrian *> peds;
     //  std::cout << ">>> peds " << peds.size() << RESET<< std::endl;
@@ -1083,6 +1113,7 @@ bool Simulation::TrainTraffic()
         }
     }
     if(trainHere || trainLeave) {
+        _building->UpdateWallIndex();
         return true;
     }
 
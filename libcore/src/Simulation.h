@@ -172,7 +172,8 @@ public:
     AgentsSourcesManager & GetAgentSrcManager();
 
     /**
-     * Check if any agents are waiting to enter the simulation
+     * Let the agent sources release the agents due at the current time and
+     * add all agents waiting to enter the simulation
      */
     void ProcessAgentsQueue();
 
@@ -199,7 +200,7 @@ public:
 
     /**
      * Updates the output filename if the current file exceeds 10MB.
-     * Works only for FileFormat::TXT.
+     * Works only for FileFormat::TXT and FileFormat::BINARY.
      */
     void RotateOutputFile();
     bool TrainTraffic();
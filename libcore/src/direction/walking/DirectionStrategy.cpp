@@ -313,7 +313,11 @@ void DirectionLocalFloorfield::Init(Building * building)
         } else {
             newfield->setSpeedMode(FF_HOMO_SPEED);
         }
-        newfield->addAllTargetsParallel();
+    }
+    if(building->GetConfig()->get_ff_lazy()) {
+        UnivFFviaFM::setLazy(_locffviafm, building->GetConfig()->get_ff_memory_budget());
+    } else {
+        UnivFFviaFM::addAllTargetsParallel(_locffviafm);
     }
 
     //TODO check writing of ff (TS)
@@ -391,9 +395,13 @@ void DirectionSubLocalFloorfield::Init(Building * building)
             } else {
                 floorfield->setSpeedMode(FF_HOMO_SPEED);
             }
-            floorfield->addAllTargetsParallel();
         }
     }
+    if(building->GetConfig()->get_ff_lazy()) {
+        UnivFFviaFM::setLazy(_locffviafm, building->GetConfig()->get_ff_memory_budget());
+    } else {
+        UnivFFviaFM::addAllTargetsParallel(_locffviafm);
+    }
 
     //TODO check writing of ff (TS)
     if(_building->GetConfig()->get_write_VTK_files_direction()) {
@@ -29,15 +29,19 @@
 #include "Event.h"
 #include "general/Format.h"
 #include "general/Logger.h"
+#include "geometry/Crossing.h"
 #include "geometry/SubRoom.h"
 #include "mpi/LCGrid.h"
 #include "pedestrian/Knowledge.h"
 #include "pedestrian/Pedestrian.h"
+#include "routing/ff_router/FloorfieldStore.h"
 #include "routing/ff_router/ffRouter.h"
 #include "routing/global_shortest/GlobalRouter.h"
 #include "routing/quickest/QuickestPathRouter.h"
 #include "routing/smoke_router/SmokeRouter.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -64,11 +68,23 @@ EventManager::EventManager(Configuration * config, Building * _b, unsigned int s
     _rdDistribution = std::uniform_real_distribution<double>(0, 1);
     //std::random_device rd;
     //_rdGenerator=std::mt19937(rd());
-    _rdGenerator = std::mt19937(seed);
-    _file        = nullptr;
+    _rdGenerator     = std::mt19937(seed);
+    _file            = nullptr;
+    _floorfieldStore = std::make_shared<FloorfieldStore>();
     //save the first graph
     CreateRoutingEngine(_b, true);
 
+    //the ff routers only depend on the geometry and the door states, their engines for the
+    //events are created in the background. Trains change the geometry, the vtk files of the
+    //routers are named by the time.
+    auto isFFRouter = [](RoutingStrategy strategy) {
+        return strategy == ROUTING_FF_GLOBAL_SHORTEST || strategy == ROUTING_FF_QUICKEST;
+    };
+    _precomputedUntil = -1.;
+    _precompute       = !_availableRouters.empty() &&
+                  std::all_of(_availableRouters.begin(), _availableRouters.end(), isFFRouter) &&
+                  _b->GetTrainTimeTables().empty() && !_config->get_write_VTK_files();
+
     //create some events
     //CreateSomeEngine();
 }
@@ -78,6 +94,11 @@ EventManager::~EventManager()
     if(_file)
         fclose(_file);
 
+    //waits for the engines still created in the background
+    for(auto & precomputed : _precomputedEngines) {
+        precomputed.initialized.wait();
+        delete precomputed.engine;
+    }
     _eventEngineStorage.clear();
 }
 
@@ -203,8 +224,12 @@ void EventManager::ReadEventsTxt(double time)
 
 bool EventManager::CollectNewKnowledge(Building * _b)
 {
-    //#pragma omp parallel for
-    for(auto && ped : _b->GetAllPedestrians()) {
+    //each pedestrian only changes its own knowledge and router
+    const std::vector<Pedestrian *> & allPeds = _b->GetAllPedestrians();
+    const long int nPeds                      = allPeds.size();
+#pragma omp parallel for schedule(dynamic)
+    for(long int i = 0; i < nPeds; ++i) {
+        Pedestrian * ped = allPeds[i];
         for(auto && door : _b->GetAllTransitions()) {
             if(door.second->DistTo(ped->GetPos()) < 0.5) //distance to door to register its state
             {
@@ -227,30 +252,47 @@ bool EventManager::CollectNewKnowledge(Building * _b)
 
 bool EventManager::DisseminateKnowledge(Building * _b)
 {
-    for(auto && ped : _b->GetAllPedestrians()) {
+    const std::vector<Pedestrian *> & allPeds = _b->GetAllPedestrians();
+    const long int nPeds                      = allPeds.size();
+#pragma omp parallel for
+    for(long int i = 0; i < nPeds; ++i) {
         //update the latency for new and old information
-        for(auto && info : ped->GetKnownledge()) {
+        for(auto && info : allPeds[i]->GetKnownledge()) {
             info.second.DecreaseLatency(_updateFrequency);
         }
     }
 
-    for(auto && ped1 : _b->GetAllPedestrians()) {
-        std::vector<Pedestrian *> neighbourhood;
-        _b->GetGrid()->GetNeighbourhood(ped1, neighbourhood);
-        for(auto && ped2 : neighbourhood) {
-            if((ped1->GetPos() - ped2->GetPos()).Norm() < _updateRadius) {
-                //maybe same room and subroom ?
-                std::vector<SubRoom *> empty;
-                if(_b->IsVisible(ped1->GetPos(), ped2->GetPos(), empty)) {
-                    //if(!SynchronizeKnowledge(ped1, ped2))  //ped1->SetSpotlight(true);
-                    //if(!MergeKnowledgeUsingProbability(ped1, ped2))
-                    if(!MergeKnowledge(ped1, ped2)) {
-                        //p2 is now an informant
-                        //Log->Write("INFO:\tthe information was refused by ped %d",ped2->GetID());
-                        //ped2->SetSpotlight(true);
-                        //Pedestrian::SetColorMode(AgentColorMode::BY_SPOTLIGHT);
-                    }
-                }
+    //the neighbours in reach are searched in parallel, the knowledge is merged in the order of the
+    //pedestrians afterwards. Every visible pair draws a random number in MergeKnowledge(), also
+    //if the informant knows nothing yet, so the numbers are drawn in the same order as in a serial
+    //pass with any number of threads, and information is passed on in the pass it is received.
+    std::vector<std::vector<Pedestrian *>> informed(nPeds);
+#pragma omp parallel for schedule(dynamic)
+    for(long int i = 0; i < nPeds; ++i) {
+        Pedestrian * ped1 = allPeds[i];
+        SubRoom * sub1 = _b->GetRoom(ped1->GetRoomID())->GetSubRoom(ped1->GetSubRoomID());
+        for(const auto & neighbour : _b->GetGrid()->GetNeighbours(ped1)) {
+            Pedestrian * ped2 = neighbour.ped;
+            if((ped1->GetPos() - ped2->GetPos()).Norm() >= _updateRadius) {
+                continue;
+            }
+            //only the walls around the two subrooms can block the line of sight
+            SubRoom * sub2 = _b->GetRoom(ped2->GetRoomID())->GetSubRoom(ped2->GetSubRoomID());
+            if(_b->IsVisibleLocal(ped1->GetPos(), ped2->GetPos(), sub1, sub2)) {
+                informed[i].push_back(ped2);
+            }
+        }
+    }
+
+    for(long int i = 0; i < nPeds; ++i) {
+        for(Pedestrian * ped2 : informed[i]) {
+            //if(!SynchronizeKnowledge(ped1, ped2))  //ped1->SetSpotlight(true);
+            //if(!MergeKnowledgeUsingProbability(ped1, ped2))
+            if(!MergeKnowledge(allPeds[i], ped2)) {
+                //p2 is now an informant
+                //Log->Write("INFO:\tthe information was refused by ped %d",ped2->GetID());
+                //ped2->SetSpotlight(true);
+                //Pedestrian::SetColorMode(AgentColorMode::BY_SPOTLIGHT);
             }
         }
     }
@@ -295,8 +337,9 @@ bool EventManager::UpdateRoute(Pedestrian * ped)
     //          }
     //     }
 
-    if(_eventEngineStorage.count(key) > 0) {
-        RoutingEngine * engine = _eventEngineStorage[key];
+    auto stored = _eventEngineStorage.find(key);
+    if(stored != _eventEngineStorage.end()) {
+        RoutingEngine * engine = stored->second;
         //retrieve the old strategy
         RoutingStrategy strategy = ped->GetRouter()->GetStrategy();
         //retrieve the new router
@@ -523,6 +566,11 @@ void EventManager::ProcessEvent()
         }
     }
 
+    //prepare the routing engines of the next events while the simulation goes on
+    if(_precompute && current_time_d + J_EPS_EVENT > _precomputedUntil) {
+        PrecomputeRoutingEngines(current_time_d);
+    }
+
     if(_dynamic)
         ReadEventsTxt(current_time);
 }
@@ -606,23 +654,8 @@ void EventManager::GetEvent(char * c)
 
 bool EventManager::CreateRoutingEngine(Building * _b, int first_engine)
 {
-    std::vector<int> closed_doors;
-    closed_doors.clear();
-
-    for(auto && t : _b->GetAllTransitions()) {
-        if(!t.second->IsClose())
-            closed_doors.push_back(t.second->GetID());
-    }
-    std::sort(closed_doors.begin(), closed_doors.end());
-
-    //create the key as string.
-    std::string key = "";
-    for(int door : closed_doors) {
-        if(key.empty())
-            key.append(std::to_string(door));
-        else
-            key.append(":" + std::to_string(door));
-    }
+    const std::map<int, DoorState> doorStates = GetDoorStates();
+    const std::string key                     = GetEngineKey(doorStates);
 
     //the first (default) engine was created in the simulation
     // collect the defined routers
@@ -632,6 +665,10 @@ bool EventManager::CreateRoutingEngine(Building * _b, int first_engine)
 
         for(auto && rout : engine->GetAvailableRouters()) {
             _availableRouters.push_back(rout->GetStrategy());
+            //the engines for other door states take the floor fields of unchanged rooms
+            if(auto * ffRouter = dynamic_cast<FFRouter *>(rout)) {
+                ffRouter->SetFloorfieldStore(_floorfieldStore);
+            }
         }
         Logging::Warning(fmt::format(check_fmt("Adding new routing engine with key {}"), key));
 
@@ -642,16 +679,18 @@ bool EventManager::CreateRoutingEngine(Building * _b, int first_engine)
     // the engine was not created
     // create a new one with the actual configuration
     if(_eventEngineStorage.count(key) == 0) {
-        //populate the engine with the routers defined in the ini file
-        //and initialize
-        RoutingEngine * engine = new RoutingEngine();
-        for(auto && rout : _availableRouters) {
-            engine->AddRouter(CreateRouter(rout));
+        RoutingEngine * engine = TakePrecomputedEngine(doorStates);
+        if(engine) {
+            Logging::Info(
+                fmt::format(check_fmt("Routing engine with key {} created in advance"), key));
+        } else {
+            //populate the engine with the routers defined in the ini file
+            //and initialize
+            engine = CreateRoutingEngineRouters();
+            if(engine->Init(_b) == false)
+                return false;
         }
 
-        if(engine->Init(_b) == false)
-            return false;
-
         //save the configuration
         _eventEngineStorage[key] = engine;
         Logging::Warning(fmt::format(check_fmt("Adding new routing engine with key {}"), key));
@@ -662,6 +701,144 @@ bool EventManager::CreateRoutingEngine(Building * _b, int first_engine)
     return true;
 }
 
+RoutingEngine * EventManager::CreateRoutingEngineRouters()
+{
+    RoutingEngine * engine = new RoutingEngine();
+    for(auto && rout : _availableRouters) {
+        Router * router = CreateRouter(rout);
+        if(auto * ffRouter = dynamic_cast<FFRouter *>(router)) {
+            ffRouter->SetFloorfieldStore(_floorfieldStore);
+        }
+        engine->AddRouter(router);
+    }
+    return engine;
+}
+
+std::map<int, DoorState> EventManager::GetDoorStates() const
+{
+    std::map<int, DoorState> doorStates;
+    for(auto && t : _building->GetAllTransitions()) {
+        doorStates[t.second->GetUniqueID()] = t.second->GetState();
+    }
+    for(auto && c : _building->GetAllCrossings()) {
+        doorStates[c.second->GetUniqueID()] = c.second->GetState();
+    }
+    return doorStates;
+}
+
+std::string EventManager::GetEngineKey(const std::map<int, DoorState> & doorStates) const
+{
+    std::vector<int> closed_doors;
+    for(auto && t : _building->GetAllTransitions()) {
+        if(doorStates.at(t.second->GetUniqueID()) != DoorState::CLOSE)
+            closed_doors.push_back(t.second->GetID());
+    }
+    std::sort(closed_doors.begin(), closed_doors.end());
+
+    //create the key as string.
+    std::string key = "";
+    for(int door : closed_doors) {
+        if(key.empty())
+            key.append(std::to_string(door));
+        else
+            key.append(":" + std::to_string(door));
+    }
+    return key;
+}
+
+void EventManager::PrecomputeRoutingEngines(double time)
+{
+    //the engines for the events until now that were not taken predicted door states that did not
+    //come up, they would keep their routers and floor fields alive
+    for(auto precomputed = _precomputedEngines.begin(); precomputed != _precomputedEngines.end();) {
+        if(precomputed->time > time + J_EPS_EVENT) {
+            ++precomputed;
+            continue;
+        }
+        precomputed->initialized.wait();
+        delete precomputed->engine;
+        precomputed = _precomputedEngines.erase(precomputed);
+    }
+
+    double nextTime = DBL_MAX;
+    for(const auto & event : _events) {
+        if(event.GetTime() > time + J_EPS_EVENT) {
+            nextTime = std::min(nextTime, event.GetTime());
+        }
+    }
+    _precomputedUntil = nextTime;
+    if(nextTime == DBL_MAX) {
+        return;
+    }
+
+    //apply the next events to the current door states like ProcessEvent(), each event
+    //creates the engine for the door states after it
+    std::map<int, DoorState> doorStates = GetDoorStates();
+    for(const auto & event : _events) {
+        if(fabs(event.GetTime() - nextTime) >= J_EPS_EVENT) {
+            continue;
+        }
+        auto transition = _building->GetAllTransitions().find(event.GetId());
+        if(transition == _building->GetAllTransitions().end()) {
+            continue;
+        }
+        DoorState & state = doorStates[transition->second->GetUniqueID()];
+        switch(event.GetAction()) {
+            case EventAction::OPEN:
+                state = DoorState::OPEN;
+                break;
+            case EventAction::CLOSE:
+                state = DoorState::CLOSE;
+                break;
+            case EventAction::TEMP_CLOSE:
+                state = DoorState::TEMP_CLOSE;
+                break;
+            case EventAction::RESET_USAGE:
+            case EventAction::NOTHING:
+                continue;
+        }
+
+        const std::string key = GetEngineKey(doorStates);
+        if(_eventEngineStorage.count(key) > 0 ||
+           std::any_of(
+               _precomputedEngines.begin(),
+               _precomputedEngines.end(),
+               [&](const PrecomputedEngine & precomputed) {
+                   return GetEngineKey(precomputed.doorStates) == key;
+               })) {
+            continue;
+        }
+
+        //the routers are created here, only their initialization runs in the background
+        RoutingEngine * engine = CreateRoutingEngineRouters();
+        _precomputedEngines.push_back(
+            {doorStates, nextTime, engine, engine->InitAsync(_building, doorStates)});
+    }
+}
+
+RoutingEngine * EventManager::TakePrecomputedEngine(const std::map<int, DoorState> & doorStates)
+{
+    //an engine of other door states (e.g. a door was closed by the flow regulation meanwhile)
+    //may differ from the engine created now, it is only used if these states come up
+    auto precomputed = std::find_if(
+        _precomputedEngines.begin(),
+        _precomputedEngines.end(),
+        [&doorStates](const PrecomputedEngine & candidate) {
+            return candidate.doorStates == doorStates;
+        });
+    if(precomputed == _precomputedEngines.end()) {
+        return nullptr;
+    }
+    RoutingEngine * engine = precomputed->engine;
+    const bool initialized = precomputed->initialized.get();
+    _precomputedEngines.erase(precomputed);
+    if(!initialized) {
+        delete engine;
+        return nullptr;
+    }
+    return engine;
+}
+
 Router * EventManager::CreateRouter(const RoutingStrategy & strategy)
 {
     Router * rout = nullptr;
@@ -31,11 +31,15 @@
 #include "general/Filesystem.h"
 #include "general/Macros.h"
 
+#include <future>
+#include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
 
 class Building;
+class FloorfieldStore;
 class Pedestrian;
 class Router;
 class RoutingEngine;
@@ -90,13 +94,44 @@ public:
     void GetEvent(char * c);
 
 
-private:
+protected:
     /**
       * collect the close doors and generate a new graph
       * @param _building
       */
     bool CreateRoutingEngine(Building * _b, int first_engine = false);
 
+    /**
+      * Create an engine with the routers defined in the simulation, not initialized yet
+      */
+    RoutingEngine * CreateRoutingEngineRouters();
+
+    /**
+      * @return the current state of all doors by unique ID
+      */
+    std::map<int, DoorState> GetDoorStates() const;
+
+    /**
+      * The key of the routing engine for the given door states in _eventEngineStorage
+      * @param doorStates state of all doors by unique ID
+      */
+    std::string GetEngineKey(const std::map<int, DoorState> & doorStates) const;
+
+    /**
+      * Start to create the routing engines for the door states after the next
+      * events in the background. The states are predicted from the current ones.
+      * The engines of the events until time that were not taken are deleted.
+      * @param time current time, the events at this time are processed already
+      */
+    void PrecomputeRoutingEngines(double time);
+
+    /**
+      * Take the engine created in the background for doorStates. Waits if it
+      * is not finished yet.
+      * @return the initialized engine, nullptr if there is none or its initialization failed
+      */
+    RoutingEngine * TakePrecomputedEngine(const std::map<int, DoorState> & doorStates);
+
     /**
       * Create a router corresponding to the given strategy
       * @param strategy
@@ -151,7 +186,7 @@ private:
 
     void CreateSomeEngines();
 
-private:
+protected:
     Configuration * _config;
     std::vector<Event> _events;
     Building * _building;
@@ -167,6 +202,21 @@ private:
     std::map<std::string, RoutingEngine *> _eventEngineStorage;
     //save the available routers defined in the simulation
     std::vector<RoutingStrategy> _availableRouters;
+    //room floor fields shared by the ff routers of all engines
+    std::shared_ptr<FloorfieldStore> _floorfieldStore;
+    //routing engine created in the background for predicted door states
+    struct PrecomputedEngine {
+        std::map<int, DoorState> doorStates;
+        //time of the event the door states are predicted for
+        double time;
+        RoutingEngine * engine;
+        std::future<bool> initialized;
+    };
+    std::vector<PrecomputedEngine> _precomputedEngines;
+    //the engines for the events until this time are precomputed
+    double _precomputedUntil;
+    //the routing engines can be created before the events
+    bool _precompute;
 
     // random number generator
     std::mt19937 _rdGenerator;
@@ -40,6 +40,11 @@ Logging::Level ArgumentParser::LogLevel() const
     return logLevel;
 }
 
+bool ArgumentParser::RebuildFloorfieldCache() const
+{
+    return rebuildFloorfieldCache;
+}
+
 std::tuple<ArgumentParser::Execution, int> ArgumentParser::Parse(int argc, char * argv[])
 {
     // Silence warnigns about unused member. Opts are keept as class members
@@ -47,6 +52,7 @@ std::tuple<ArgumentParser::Execution, int> ArgumentParser::Parse(int argc, char
     // file
     (void) iniFilePathOpt;
     (void) logLevelOpt;
+    (void) rebuildFloorfieldCacheOpt;
     try {
         app.parse(argc, argv);
     } catch(const CLI::ParseError & e) {
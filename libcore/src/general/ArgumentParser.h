@@ -43,6 +43,7 @@ private:
 
     fs::path iniFilePath{"ini.xml"};
     Logging::Level logLevel{Logging::Level::Info};
+    bool rebuildFloorfieldCache{false};
 
     CLI::App app{"JuPedSim"};
     CLI::Option * iniFilePathOpt =
@@ -54,6 +55,10 @@ private:
                logLevel,
                "Minimum level of log messages to show. Defaults to 'info'")
             ->transform(CLI::CheckedTransformer(logLevelMapping, CLI::ignore_case));
+    CLI::Option * rebuildFloorfieldCacheOpt = app.add_flag(
+        "--rebuild-ff-cache",
+        rebuildFloorfieldCache,
+        "Recalculate the floor fields of the ff router and replace their cache file");
 
 public:
     enum class Execution { CONTINUE, ABORT };
@@ -64,6 +69,9 @@ public:
     /// @return desired log level. If none was parsed this defauls to 'Info'
     Logging::Level LogLevel() const;
 
+    /// @return true if the floor field cache shall be rebuilt. Defaults to false
+    bool RebuildFloorfieldCache() const;
+
     /// Parses command line arguments
     /// Parsing ends in one of three states:
     ///     1) Everything parsed, all ok -> returns [CONTINUE, 0]
@@ -30,6 +30,7 @@
 #include "randomnumbergenerator.h"
 #include "routing/RoutingEngine.h"
 
+#include <cstddef>
 #include <cstdlib>
 #include <memory>
 #include <set>
@@ -47,6 +48,8 @@ public:
         _solver           = 1;
         _routingEngine    = std::shared_ptr<RoutingEngine>(new RoutingEngine());
         _maxOpenMPThreads = 1;
+        _scheduleMode     = ScheduleMode::Static;
+        _scheduleChunk    = 64;
         _log              = 0;
         _port             = -1;
         _seed             = 0;
@@ -57,6 +60,7 @@ public:
         _PRB              = false;
         _dT               = 0.01;
         _isPeriodic       = 0; // use only for Tordeux2015 with "trivial" geometries
+        _convexVisibility = false;
         // ----------- GCFM repulsive force ------
         _nuPed  = 0.4;
         _nuWall = 0.2;
@@ -90,11 +94,16 @@ public:
         _projectRootDir           = ".";
         _showStatistics           = false;
         _fileFormat               = FileFormat::TXT;
+        _asyncOutput              = true;
         _agentsParameters         = std::map<int, std::shared_ptr<AgentsParameters>>();
         // ---------- floorfield
         _deltaH              = 0.0625;
         _wall_avoid_distance = 0.4;
         _use_wall_avoidance  = true;
+        _ff_lazy             = false;
+        _ff_memory_budget    = 0;
+        _ff_storage          = FF_STORAGE_DOUBLE;
+        _ff_block_size       = 8;
 
         // ff router quickest
         _recalc_interval = 3;
@@ -103,6 +112,9 @@ public:
         _has_specific_goals         = false;
         _has_directional_escalators = false;
         _write_VTK_files            = false;
+        _incremental_update         = false;
+        _fm_queue                   = FM_QUEUE_HEAP;
+        _ff_cache_rebuild           = false;
         _exit_strat                 = 9;
         _write_VTK_files_direction  = false;
         //          _dirSubLocal = nullptr;
@@ -135,6 +147,14 @@ public:
 
     void SetMaxOpenMPThreads(int maxOpenMPThreads) { _maxOpenMPThreads = maxOpenMPThreads; };
 
+    ScheduleMode GetScheduleMode() const { return _scheduleMode; };
+
+    void SetScheduleMode(ScheduleMode scheduleMode) { _scheduleMode = scheduleMode; };
+
+    int GetScheduleChunk() const { return _scheduleChunk; };
+
+    void SetScheduleChunk(int scheduleChunk) { _scheduleChunk = scheduleChunk; };
+
     int GetLog() const { return _log; };
 
     void SetLog(int log) { _log = log; };
@@ -174,6 +194,10 @@ public:
 
     void SetIsPeriodic(int isPeriodic) { _isPeriodic = isPeriodic; };
 
+    bool GetConvexVisibility() const { return _convexVisibility; };
+
+    void SetConvexVisibility(bool convexVisibility) { _convexVisibility = convexVisibility; };
+
     double GetNuPed() const { return _nuPed; };
 
     void SetNuPed(double nuPed) { _nuPed = nuPed; };
@@ -256,6 +280,27 @@ public:
         _use_wall_avoidance = use_wall_avoidance;
     }
 
+    bool get_ff_lazy() const { return _ff_lazy; }
+
+    void set_ff_lazy(bool ff_lazy) { _ff_lazy = ff_lazy; }
+
+    /// bytes the door fields of a lazy floor field user may keep, 0 if unlimited
+    std::size_t get_ff_memory_budget() const { return _ff_memory_budget; }
+
+    void set_ff_memory_budget(std::size_t ff_memory_budget)
+    {
+        _ff_memory_budget = ff_memory_budget;
+    }
+
+    int get_ff_storage() const { return _ff_storage; }
+
+    void set_ff_storage(int ff_storage) { _ff_storage = ff_storage; }
+
+    /// grid cells per side of the coarse blocks of FF_STORAGE_MULTILEVEL
+    int get_ff_block_size() const { return _ff_block_size; }
+
+    void set_ff_block_size(int ff_block_size) { _ff_block_size = ff_block_size; }
+
     double get_recalc_interval() const { return _recalc_interval; }
 
     void set_recalc_interval(double recalc_interval) { _recalc_interval = recalc_interval; }
@@ -277,6 +322,26 @@ public:
 
     bool get_write_VTK_files() const { return _write_VTK_files; }
 
+    void set_incremental_update(bool incremental_update)
+    {
+        _incremental_update = incremental_update;
+    }
+
+    bool get_incremental_update() const { return _incremental_update; }
+
+    void set_fm_queue(int fm_queue) { _fm_queue = fm_queue; }
+
+    int get_fm_queue() const { return _fm_queue; }
+
+    void set_ff_cache_dir(const fs::path & ff_cache_dir) { _ff_cache_dir = ff_cache_dir; }
+
+    /// directory of the floor field cache of the ff router, empty if it is not used
+    const fs::path & get_ff_cache_dir() const { return _ff_cache_dir; }
+
+    void set_ff_cache_rebuild(bool ff_cache_rebuild) { _ff_cache_rebuild = ff_cache_rebuild; }
+
+    bool get_ff_cache_rebuild() const { return _ff_cache_rebuild; }
+
     void set_exit_strat(int e_strat) { _exit_strat = e_strat; }
 
     int get_exit_strat() const { return _exit_strat; }
@@ -352,6 +417,10 @@ public:
 
     void SetFileFormat(FileFormat fileFormat) { _fileFormat = fileFormat; };
 
+    bool GetAsyncOutput() const { return _asyncOutput; };
+
+    void SetAsyncOutput(bool asyncOutput) { _asyncOutput = asyncOutput; };
+
     const std::map<int, std::shared_ptr<AgentsParameters>> & GetAgentsParameters() const
     {
         return _agentsParameters;
@@ -374,6 +443,8 @@ private:
     int _solver;
     std::shared_ptr<RoutingEngine> _routingEngine;
     int _maxOpenMPThreads;
+    ScheduleMode _scheduleMode;
+    int _scheduleChunk;
     int _log;
     int _port;
     unsigned int _seed;
@@ -384,6 +455,7 @@ private:
     bool _PRB;
     double _dT;
     int _isPeriodic;
+    bool _convexVisibility; // skip wall tests inside convex subrooms without obstacles
     double _nuPed;
     double _nuWall;
     double _aPed;
@@ -404,6 +476,10 @@ private:
     double _deltaH;
     double _wall_avoid_distance;
     bool _use_wall_avoidance;
+    bool _ff_lazy;
+    std::size_t _ff_memory_budget;
+    int _ff_storage;
+    int _ff_block_size;
 
     // ff router quickest
     double _recalc_interval;
@@ -412,6 +488,10 @@ private:
     bool _has_specific_goals;
     bool _has_directional_escalators;
     bool _write_VTK_files;
+    bool _incremental_update;
+    int _fm_queue;
+    fs::path _ff_cache_dir;
+    bool _ff_cache_rebuild;
     bool _write_VTK_files_direction;
 
     int _exit_strat;
@@ -430,6 +510,7 @@ private:
     mutable RandomNumberGenerator _rdGenerator;
 
     FileFormat _fileFormat;
+    bool _asyncOutput; // write the trajectories on a separate thread
     std::map<int, std::shared_ptr<AgentsParameters>> _agentsParameters;
 
     std::set<OptionalOutput> _optionalOutput;
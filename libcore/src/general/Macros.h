@@ -96,7 +96,10 @@ enum RoomState { ROOM_CLEAN = 0, ROOM_SMOKED = 1 };
 
 enum AgentType { MALE = 0, FEMALE, CHILD, ELDERLY };
 
-enum class FileFormat { XML, TXT };
+enum class FileFormat { XML, TXT, BINARY };
+
+/// distribution of the pedestrians to the threads in the operational models
+enum class ScheduleMode { Static, Dynamic, Cells };
 
 enum RoutingStrategy {
     ROUTING_LOCAL_SHORTEST = 1,
@@ -184,6 +187,13 @@ enum SPEEDFIELD {        //this enum is used as index in _speedFieldSelector
 
 enum TARGETMODE { LINESEGMENT = 0, CENTERPOINT };
 
+/// priority queue of the fast marching method in UnivFFviaFM
+enum FMQUEUE { FM_QUEUE_HEAP = 0, FM_QUEUE_BUCKET };
+
+/// storage of the door fields of UnivFFviaFM: double, float costs and int16 directions, or coarse
+/// blocks in open space
+enum FFSTORAGE { FF_STORAGE_DOUBLE = 0, FF_STORAGE_COMPACT, FF_STORAGE_MULTILEVEL };
+
 enum USERMODE { DISTANCE_MEASUREMENTS_ONLY, DISTANCE_AND_DIRECTIONS_USED };
 
 enum class OptionalOutput {
@@ -30,6 +30,7 @@
 #include "geometry/SubRoom.h"
 #include "geometry/Wall.h"
 
+#include <algorithm>
 #include <chrono>
 #include <tinyxml.h>
 
@@ -49,6 +50,7 @@ Building::Building()
 {
     _caption          = "no_caption";
     _geometryFilename = "";
+    _configuration    = nullptr;
     _routingEngine    = nullptr;
     _linkedCellGrid   = nullptr;
     _savePathway      = false;
@@ -150,6 +152,13 @@ Configuration * Building::GetConfig() const
     return _configuration;
 }
 
+void Building::SetConfig(Configuration * config)
+{
+    //like the constructor, the routing engine is the one of the configuration
+    _configuration = config;
+    _routingEngine = config->GetRoutingEngine();
+}
+
 ///************************************************************
 // setters
 // ************************************************************/
@@ -365,6 +374,8 @@ bool Building::InitGeometry()
 
     InitInsideGoals();
     InitPlatforms();
+    UpdateWallIndex();
+    UpdateSubRoomIndex();
     //---
     for(auto platform : _platforms) {
         std::cout << "\n platform " << platform.first << ", " << platform.second->id << "\n";
@@ -1407,6 +1418,16 @@ bool Building::IsVisible(
             }
         }
     } else {
+        // nothing can block the line of sight inside a convex subroom
+        if(!considerHlines && _configuration && _configuration->GetConvexVisibility()) {
+            SubRoom * sub = subrooms.front();
+            bool convex   = sub && sub->IsConvexWithoutObstacles();
+            for(auto && other : subrooms) {
+                convex = convex && other == sub;
+            }
+            if(convex)
+                return true;
+        }
         for(auto && sub : subrooms) {
             if(sub && !sub->IsVisible(p1, p2, considerHlines))
                 return false;
@@ -1416,6 +1437,87 @@ bool Building::IsVisible(
     return true;
 }
 
+bool Building::IsVisibleLocal(const Point & p1, const Point & p2, SubRoom * sub1, SubRoom * sub2)
+    const
+{
+    // nothing can block the line of sight inside a convex subroom
+    if(sub1 == sub2 && _configuration && _configuration->GetConvexVisibility() &&
+       sub1->IsConvexWithoutObstacles()) {
+        return true;
+    }
+
+    const auto scope1 = _visibilityScopes.find(sub1->GetUID());
+    const auto scope2 = _visibilityScopes.find(sub2->GetUID());
+    if(scope1 == _visibilityScopes.end() || scope2 == _visibilityScopes.end()) {
+        // the index is not up to date, check the subrooms one by one
+        for(SubRoom * sub : {sub1, sub2}) {
+            if(!sub->IsVisible(p1, p2, false)) {
+                return false;
+            }
+            for(SubRoom * neighbor : sub->GetNeighbors()) {
+                if(!neighbor->IsVisible(p1, p2, false)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const std::vector<int> & owners1 = scope1->second;
+    const std::vector<int> & owners2 = scope2->second;
+    return !_wallIndex.IntersectsAny(p1, p2, [&owners1, &owners2](int owner) {
+        return std::binary_search(owners1.begin(), owners1.end(), owner) ||
+               std::binary_search(owners2.begin(), owners2.end(), owner);
+    });
+}
+
+void Building::UpdateWallIndex()
+{
+    std::vector<Line> lines;
+    std::vector<int> owners;
+    _visibilityScopes.clear();
+    for(auto && itr_room : _rooms) {
+        for(auto && itr_subroom : itr_room.second->GetAllSubRooms()) {
+            SubRoom * sub = itr_subroom.second.get();
+            sub->UpdateWallIndex();
+
+            const int uid = sub->GetUID();
+            for(const auto & wall : sub->GetAllWalls()) {
+                lines.push_back(wall);
+                owners.push_back(uid);
+            }
+            for(const auto & obstacle : sub->GetAllObstacles()) {
+                for(const auto & wall : obstacle->GetAllWalls()) {
+                    lines.push_back(wall);
+                    owners.push_back(uid);
+                }
+            }
+
+            std::vector<int> & scope = _visibilityScopes[uid];
+            scope.push_back(uid);
+            for(const SubRoom * neighbor : sub->GetNeighbors()) {
+                if(neighbor) {
+                    scope.push_back(neighbor->GetUID());
+                }
+            }
+            std::sort(scope.begin(), scope.end());
+            scope.erase(std::unique(scope.begin(), scope.end()), scope.end());
+        }
+    }
+    _wallIndex.Build(lines, owners);
+}
+
+void Building::UpdateSubRoomIndex()
+{
+    std::vector<SubRoom *> subrooms;
+    for(auto && itr_room : _rooms) {
+        for(auto && itr_subroom : itr_room.second->GetAllSubRooms()) {
+            subrooms.push_back(itr_subroom.second.get());
+        }
+    }
+    _subRoomIndex.Build(subrooms);
+}
+
 bool Building::Triangulate()
 {
     Logging::Info("Triangulating the geometry.");
@@ -1477,7 +1579,7 @@ bool Building::SanityCheck()
 void Building::UpdateGrid()
 {
     //     std::cout << Pedestrian::GetGlobalTime() <<":\t\tBuilding::UpdateGrid from: " << std::this_thread::get_id() <<std::endl;
-    _linkedCellGrid->Update(_allPedestrians);
+    _linkedCellGrid->Update(_kinematics);
 }
 
 void Building::InitGrid()
@@ -1539,7 +1641,6 @@ void Building::InitGrid()
     //int nped= Pedestrian::GetAgentsCreated() +  for src:sources  src->GetMaxAgents()
 
     _linkedCellGrid = new LCGrid(boundaries, cellSize, Pedestrian::GetAgentsCreated());
-    _linkedCellGrid->ShallowCopy(_allPedestrians);
 
     Logging::Info("Done with Initializing the grid");
 }
@@ -1580,6 +1681,7 @@ void Building::DeletePedestrian(Pedestrian *& ped)
     //          // he will remain in the simulation in that case
     //          //if(trans->IsOpen()==false) return;
     //     }
+    _kinematics.Remove(static_cast<std::size_t>(it - _allPedestrians.begin()));
     _allPedestrians.erase(it);
     delete ped;
 }
@@ -1589,6 +1691,11 @@ const std::vector<Pedestrian *> & Building::GetAllPedestrians() const
     return _allPedestrians;
 }
 
+const PedestrianKinematics & Building::GetKinematics() const
+{
+    return _kinematics;
+}
+
 void Building::AddPedestrian(Pedestrian * ped)
 {
     for(unsigned int p = 0; p < _allPedestrians.size(); p++) {
@@ -1599,6 +1706,7 @@ void Building::AddPedestrian(Pedestrian * ped)
         }
     }
     _allPedestrians.push_back(ped);
+    _kinematics.Add(ped);
 }
 
 void Building::GetPedestrians(int room, int subroom, std::vector<Pedestrian *> & peds) const
@@ -31,9 +31,12 @@
 #include "NavLine.h"
 #include "Obstacle.h"
 #include "Room.h"
+#include "SubRoomIndex.h"
 #include "Transition.h"
+#include "WallIndex.h"
 #include "general/Configuration.h"
 #include "general/Filesystem.h"
+#include "pedestrian/PedestrianKinematics.h"
 
 typedef std::pair<Point, Wall> PointWall;
 
@@ -92,6 +95,7 @@ private:
     std::string _geometryFilename;
     LCGrid * _linkedCellGrid;
     std::vector<Pedestrian *> _allPedestrians;
+    PedestrianKinematics _kinematics; // same order as _allPedestrians
     std::map<int, std::shared_ptr<Room>> _rooms;
     std::map<int, Crossing *> _crossings;
     std::map<int, Transition *> _transitions;
@@ -100,6 +104,12 @@ private:
     std::map<std::string, std::shared_ptr<TrainType>> _trainTypes;
     std::map<int, std::shared_ptr<TrainTimeTable>> _trainTimeTables;
     std::map<int, std::shared_ptr<Platform>> _platforms;
+    /// walls and obstacle walls of all subrooms, the owners are the subroom UIDs
+    WallIndex _wallIndex;
+    /// sorted UIDs of a subroom and its neighbours, by subroom UID
+    std::map<int, std::vector<int>> _visibilityScopes;
+    /// polygons of all subrooms, in the order of the rooms and subrooms
+    SubRoomIndex _subRoomIndex;
     /// pedestrians pathway
     bool _savePathway;
     std::ofstream _pathWayStream;
@@ -118,6 +128,9 @@ public:
 
     Configuration * GetConfig() const;
 
+    /// replaces the configuration, e.g. of a building constructed without one
+    void SetConfig(Configuration * config);
+
     void SetCaption(const std::string & s);
 
     /// delete the ped from the ped vector
@@ -134,6 +147,9 @@ public:
     const std::map<int, std::shared_ptr<Room>> & GetAllRooms() const;
     const std::vector<Pedestrian *> & GetAllPedestrians() const;
 
+    /// kinematic state of all pedestrians, indexed like GetAllPedestrians()
+    const PedestrianKinematics & GetKinematics() const;
+
     Pedestrian * GetPedestrian(int pedID) const;
 
     int GetNumberOfRooms() const;
@@ -179,6 +195,8 @@ public:
       * @return true if the two points are visible from each other.
       * Alls walls and transitions and crossings are used in this check.
       * The use of hlines is optional, because they are not real, can be considered transparent
+      * If convex visibility is enabled in the configuration, the test is skipped
+      * when all subrooms are the same convex subroom without obstacles.
       */
     bool IsVisible(
         const Point & p1,
@@ -186,6 +204,27 @@ public:
         const std::vector<SubRoom *> & subrooms,
         bool considerHlines = false);
 
+    /**
+      * @return true if the two points are visible from each other.
+      * Only the walls and obstacles of sub1, sub2 and their neighbouring subrooms
+      * are checked, so the cost does not depend on the size of the building.
+      * The convex shortcut of the configuration applies as for IsVisible().
+      */
+    bool IsVisibleLocal(const Point & p1, const Point & p2, SubRoom * sub1, SubRoom * sub2) const;
+
+    /**
+      * @return the subroom containing pos that is accepted by accept(subroom),
+      * nullptr if there is none. Where subrooms of different floors overlap,
+      * the one whose elevation is closest to the given elevation is returned,
+      * otherwise the first in the order of the rooms and their subrooms.
+      * Only the subrooms close to pos are tested (see UpdateSubRoomIndex()).
+      */
+    template <typename Accept>
+    SubRoom * FindSubRoom(const Point & pos, double elevation, Accept accept) const
+    {
+        return _subRoomIndex.Find(pos, elevation, accept);
+    }
+
     /**
       * @return a crossing or a transition matching the given caption.
       * Return NULL if none is found
@@ -226,6 +265,19 @@ public:
 
     void UpdateGrid();
 
+    /**
+      * Rebuild the wall index of all subrooms and of the building used for the
+      * visibility tests. Has to be called after walls, obstacles or doors were
+      * added or removed.
+      */
+    void UpdateWallIndex();
+
+    /**
+      * Rebuild the index used by FindSubRoom(). Has to be called after rooms
+      * or subrooms were added or removed.
+      */
+    void UpdateSubRoomIndex();
+
     void
     AddSurroundingRoom(); // add a final room (outside or world), that encompasses the complete geometry
 
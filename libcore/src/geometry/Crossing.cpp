@@ -30,6 +30,7 @@
 #include "general/Format.h"
 #include "general/Logger.h"
 
+thread_local const std::map<int, DoorState> * Crossing::_assumedDoorStates = nullptr;
 
 Crossing::Crossing()
 {
@@ -55,17 +56,17 @@ bool Crossing::IsExit() const
 
 bool Crossing::IsOpen() const
 {
-    return _state == DoorState::OPEN;
+    return GetState() == DoorState::OPEN;
 }
 
 bool Crossing::IsClose() const
 {
-    return _state == DoorState::CLOSE;
+    return GetState() == DoorState::CLOSE;
 }
 
 bool Crossing::IsTempClose() const
 {
-    return _state == DoorState::TEMP_CLOSE;
+    return GetState() == DoorState::TEMP_CLOSE;
 }
 
 bool Crossing::IsTransition() const
@@ -362,6 +363,12 @@ void Crossing::UpdateTemporaryState(double dt)
 
 DoorState Crossing::GetState() const
 {
+    if(_assumedDoorStates) {
+        auto assumed = _assumedDoorStates->find(GetUniqueID());
+        if(assumed != _assumedDoorStates->end()) {
+            return assumed->second;
+        }
+    }
     return _state;
 }
 
@@ -370,6 +377,11 @@ void Crossing::SetState(DoorState state)
     Crossing::_state = state;
 }
 
+void Crossing::AssumeDoorStates(const std::map<int, DoorState> * states)
+{
+    _assumedDoorStates = states;
+}
+
 std::string Crossing::toString() const
 {
     std::stringstream tmp;
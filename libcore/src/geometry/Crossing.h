@@ -28,6 +28,8 @@
 
 #include "Hline.h"
 
+#include <map>
+
 class SubRoom;
 
 class Crossing : public Hline
@@ -99,6 +101,11 @@ private:
      */
     bool _closeByEvent = false;
 
+    /**
+     * States the calling thread assumes for the doors, see AssumeDoorStates().
+     */
+    static thread_local const std::map<int, DoorState> * _assumedDoorStates;
+
 public:
     /**
      * Constructor
@@ -337,6 +344,14 @@ public:
      */
     void SetState(DoorState state);
 
+    /**
+     * Lets the calling thread see the doors in the given states instead of their current
+     * states, e.g. to prepare routers for the door states of scheduled events.
+     * @param states states by unique ID of the doors, doors not contained keep their current
+     * state. nullptr to see the current states again.
+     */
+    static void AssumeDoorStates(const std::map<int, DoorState> * states);
+
     /**
      * Returns a std::string representation of the door.
      * @return formatted string representing the door
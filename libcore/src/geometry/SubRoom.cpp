@@ -195,6 +195,8 @@ bool SubRoom::RemoveWall(const Wall & w)
     auto it = std::find(_walls.begin(), _walls.end(), w);
     if(it != _walls.end()) {
         _walls.erase(it);
+        _wallIndex.Clear();
+        _convexWithoutObstacles = false;
         return true;
     }
     return false;
@@ -212,6 +214,8 @@ bool SubRoom::AddWall(const Wall & w)
         return false;
     }
     _walls.push_back(w);
+    _wallIndex.Clear();
+    _convexWithoutObstacles = false;
     return true;
 }
 
@@ -219,6 +223,8 @@ bool SubRoom::AddWall(const Wall & w)
 void SubRoom::AddObstacle(Obstacle * obs)
 {
     _obstacles.push_back(obs);
+    _wallIndex.Clear();
+    _convexWithoutObstacles = false;
     CheckObstacles();
 }
 
@@ -473,21 +479,28 @@ bool SubRoom::IsVisible(const Line & wall, const Point & position)
 // with the nearest point on the wall IS intersecting with the wall.
 bool SubRoom::IsVisible(const Point & p1, const Point & p2, bool considerHlines)
 {
-    //check intersection with Walls
-    for(const auto & wall : _walls) {
-        if(wall.IntersectionWith(p1, p2)) {
+    if(!_wallIndex.IsEmpty()) {
+        //check intersection with the walls and obstacles close to the line of sight
+        if(_wallIndex.IntersectsAny(p1, p2)) {
             return false;
         }
-    }
-
-    // printf("\t\t -- ped_is_visible; check obstacles\n");
-    //check intersection with obstacles
-    for(const auto & obstacle : _obstacles) {
-        for(const auto & wall : obstacle->GetAllWalls()) {
+    } else {
+        //check intersection with Walls
+        for(const auto & wall : _walls) {
             if(wall.IntersectionWith(p1, p2)) {
                 return false;
             }
         }
+
+        // printf("\t\t -- ped_is_visible; check obstacles\n");
+        //check intersection with obstacles
+        for(const auto & obstacle : _obstacles) {
+            for(const auto & wall : obstacle->GetAllWalls()) {
+                if(wall.IntersectionWith(p1, p2)) {
+                    return false;
+                }
+            }
+        }
     }
 
     if(considerHlines) {
@@ -504,6 +517,24 @@ bool SubRoom::IsVisible(const Point & p1, const Point & p2, bool considerHlines)
     return true;
 }
 
+void SubRoom::UpdateWallIndex()
+{
+    std::vector<Line> lines(_walls.begin(), _walls.end());
+    for(const auto & obstacle : _obstacles) {
+        const auto & obstacleWalls = obstacle->GetAllWalls();
+        lines.insert(lines.end(), obstacleWalls.begin(), obstacleWalls.end());
+    }
+
+    // for a few walls testing all of them is faster than the grid
+    if(lines.size() < WallIndex::MIN_LINES) {
+        _wallIndex.Clear();
+    } else {
+        _wallIndex.Build(lines);
+    }
+
+    _convexWithoutObstacles = _obstacles.empty() && !_poly.empty() && IsConvex();
+}
+
 // this is the case if they share a transition or crossing
 bool SubRoom::IsDirectlyConnectedWith(SubRoom * sub) const
 {
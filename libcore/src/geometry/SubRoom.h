@@ -26,6 +26,7 @@
  **/
 #pragma once
 
+#include "WallIndex.h"
 #include "general/Macros.h"
 #include "routing/global_shortest/DTriangulation.h"
 
@@ -96,6 +97,9 @@ protected:
     std::vector<double> _poly_help_multiple;  //for the function IsInsidePolygon, a.brkic
     std::vector<Obstacle *> _obstacles;
 
+    WallIndex _wallIndex; // walls and obstacle walls for IsVisible()
+    bool _convexWithoutObstacles = false;
+
 public:
     /**
       * Constructor
@@ -371,6 +375,21 @@ public:
       */
     bool IsVisible(const Line & wall, const Point & p2);
 
+    /**
+      * Build the spatial index over all walls and obstacle walls used by
+      * IsVisible() and check whether the subroom is convex without obstacles.
+      * Adding or removing walls drops the index, until the next call all
+      * walls are tested.
+      */
+    void UpdateWallIndex();
+
+    /**
+      * @return true if two points inside the subroom always see each other,
+      * i.e. the subroom is convex and has no obstacles (as of the last
+      * UpdateWallIndex())
+      */
+    bool IsConvexWithoutObstacles() const { return _convexWithoutObstacles; }
+
     // virtual functions
     virtual std::string WriteSubRoom() const  = 0;
     virtual std::string WritePolyLine() const = 0;
@@ -0,0 +1,154 @@
+/**
+ * \file        SubRoomIndex.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "SubRoomIndex.h"
+
+#include "general/Macros.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+/// smallest edge length of a cell [m]
+constexpr double MIN_CELL_SIZE = 1.;
+/// upper bound for the number of cells in x and y direction
+constexpr int MAX_CELLS_PER_AXIS = 256;
+
+struct BoundingBox {
+    double xMin;
+    double yMin;
+    double xMax;
+    double yMax;
+};
+} // namespace
+
+void SubRoomIndex::Build(const std::vector<SubRoom *> & subrooms)
+{
+    Clear();
+
+    // subrooms without polygon can not contain any point
+    std::vector<BoundingBox> boxes;
+    for(SubRoom * sub : subrooms) {
+        const std::vector<Point> & polygon = sub->GetPolygon();
+        if(polygon.empty()) {
+            continue;
+        }
+        BoundingBox box{DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX};
+        for(const Point & p : polygon) {
+            box.xMin = std::min(box.xMin, p._x - J_EPS);
+            box.yMin = std::min(box.yMin, p._y - J_EPS);
+            box.xMax = std::max(box.xMax, p._x + J_EPS);
+            box.yMax = std::max(box.yMax, p._y + J_EPS);
+        }
+        _subrooms.push_back(sub);
+        boxes.push_back(box);
+    }
+    if(_subrooms.empty()) {
+        return;
+    }
+
+    _xMin       = DBL_MAX;
+    _yMin       = DBL_MAX;
+    double xMax = -DBL_MAX;
+    double yMax = -DBL_MAX;
+    for(const auto & box : boxes) {
+        _xMin = std::min(_xMin, box.xMin);
+        _yMin = std::min(_yMin, box.yMin);
+        xMax  = std::max(xMax, box.xMax);
+        yMax  = std::max(yMax, box.yMax);
+    }
+
+    const double width  = xMax - _xMin;
+    const double height = yMax - _yMin;
+
+    // about one subroom per cell
+    _cellSize = std::max(MIN_CELL_SIZE, std::sqrt(width * height / _subrooms.size()));
+    _cellSize = std::max(_cellSize, std::max(width, height) / MAX_CELLS_PER_AXIS);
+    _nx       = static_cast<int>(width / _cellSize) + 1;
+    _ny       = static_cast<int>(height / _cellSize) + 1;
+
+    auto cellX = [this](double x) {
+        return std::clamp(static_cast<int>(std::floor((x - _xMin) / _cellSize)), 0, _nx - 1);
+    };
+    auto cellY = [this](double y) {
+        return std::clamp(static_cast<int>(std::floor((y - _yMin) / _cellSize)), 0, _ny - 1);
+    };
+
+    // counting sort of the (cell, subroom) pairs, the subrooms keep their order
+    // within each cell
+    _cellStart.assign(static_cast<std::size_t>(_nx) * _ny + 1, 0);
+    for(const auto & box : boxes) {
+        for(int y = cellY(box.yMin); y <= cellY(box.yMax); ++y) {
+            for(int x = cellX(box.xMin); x <= cellX(box.xMax); ++x) {
+                ++_cellStart[y * _nx + x + 1];
+            }
+        }
+    }
+    for(std::size_t c = 1; c < _cellStart.size(); ++c) {
+        _cellStart[c] += _cellStart[c - 1];
+    }
+
+    _cellEntries.resize(_cellStart.back());
+    std::vector<int> next(_cellStart.begin(), _cellStart.end() - 1);
+    for(std::size_t i = 0; i < boxes.size(); ++i) {
+        const BoundingBox & box = boxes[i];
+        for(int y = cellY(box.yMin); y <= cellY(box.yMax); ++y) {
+            for(int x = cellX(box.xMin); x <= cellX(box.xMax); ++x) {
+                _cellEntries[next[y * _nx + x]++] = static_cast<int>(i);
+            }
+        }
+    }
+}
+
+void SubRoomIndex::Clear()
+{
+    _subrooms.clear();
+    _cellEntries.clear();
+    _cellStart.clear();
+    _nx = 0;
+    _ny = 0;
+}
+
+std::size_t SubRoomIndex::CountCandidates(const Point & pos) const
+{
+    const int cell = Cell(pos);
+    if(cell < 0) {
+        return 0;
+    }
+    return static_cast<std::size_t>(_cellStart[cell + 1] - _cellStart[cell]);
+}
+
+int SubRoomIndex::Cell(const Point & pos) const
+{
+    if(_subrooms.empty()) {
+        return -1;
+    }
+    // the bounding boxes of all subrooms are within the grid, points outside
+    // of it are in no subroom
+    const double x = std::floor((pos._x - _xMin) / _cellSize);
+    const double y = std::floor((pos._y - _yMin) / _cellSize);
+    if(!(x >= 0. && x < _nx && y >= 0. && y < _ny)) {
+        return -1;
+    }
+    return static_cast<int>(y) * _nx + static_cast<int>(x);
+}
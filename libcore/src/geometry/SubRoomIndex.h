@@ -0,0 +1,119 @@
+/**
+ * \file        SubRoomIndex.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Uniform grid over the polygons of all subrooms of a building. Used to find
+ * the subroom a pedestrian is in without testing all subrooms.
+ *
+ **/
+#pragma once
+
+#include "Point.h"
+#include "SubRoom.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/*!
+ * \class SubRoomIndex
+ *
+ * \brief Read only bucket grid over the bounding boxes of subroom polygons.
+ *
+ * Every cell lists the subrooms whose bounding box overlaps it, in the order
+ * they were given to Build(). A point query only tests the subrooms of the
+ * cell containing the point, the result is the same as testing all subrooms
+ * in the given order.
+ *
+ * Subrooms on different floors may overlap in the plane, they are all listed
+ * in the cells. The caller tells them apart, e.g. by their elevation or by
+ * the connection to the subroom the pedestrian was in before.
+ *
+ * The index keeps pointers to the subrooms, it has to be rebuilt when
+ * subrooms are added or removed.
+ */
+class SubRoomIndex
+{
+public:
+    /**
+      * Build the grid over the given subrooms, replaces the previous content
+      */
+    void Build(const std::vector<SubRoom *> & subrooms);
+
+    /**
+      * Release all subrooms, IsEmpty() is true afterwards
+      */
+    void Clear();
+
+    bool IsEmpty() const { return _subrooms.empty(); }
+    std::size_t GetNumberOfSubRooms() const { return _subrooms.size(); }
+
+    /**
+      * @return the subroom accepted by accept(subroom) that contains pos,
+      * nullptr if there is none. If several subrooms contain pos (stacked
+      * floors), the one whose elevation at pos is closest to the given
+      * elevation is returned, on a tie the first in the order given to Build().
+      */
+    template <typename Accept>
+    SubRoom * Find(const Point & pos, double elevation, Accept accept) const;
+
+    /**
+      * @return number of subrooms tested by Find()
+      */
+    std::size_t CountCandidates(const Point & pos) const;
+
+private:
+    /// cell containing pos, -1 outside of the grid
+    int Cell(const Point & pos) const;
+
+    std::vector<SubRoom *> _subrooms;
+    /// indices into _subrooms, the entries of cell c are [_cellStart[c], _cellStart[c+1])
+    std::vector<int> _cellEntries;
+    std::vector<int> _cellStart;
+    double _xMin     = 0.;
+    double _yMin     = 0.;
+    double _cellSize = 1.;
+    int _nx          = 0;
+    int _ny          = 0;
+};
+
+template <typename Accept>
+SubRoom * SubRoomIndex::Find(const Point & pos, double elevation, Accept accept) const
+{
+    const int cell = Cell(pos);
+    if(cell < 0) {
+        return nullptr;
+    }
+    SubRoom * found = nullptr;
+    double minDelta = DBL_MAX;
+    for(int k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k) {
+        SubRoom * sub = _subrooms[_cellEntries[k]];
+        if(!accept(sub) || !sub->IsInSubRoom(pos)) {
+            continue;
+        }
+        const double delta = std::fabs(sub->GetElevation(pos) - elevation);
+        if(!found || delta < minDelta) {
+            found    = sub;
+            minDelta = delta;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,171 @@
+/**
+ * \file        WallIndex.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "WallIndex.h"
+
+#include "general/Macros.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+/// smallest edge length of a cell [m]
+constexpr double MIN_CELL_SIZE = 0.5;
+/// upper bound for the number of cells in x and y direction
+constexpr int MAX_CELLS_PER_AXIS = 256;
+/// Line::IntersectionWith() also reports intersections slightly behind p1
+constexpr double BACKWARD_TOLERANCE = 0.05;
+} // namespace
+
+void WallIndex::Build(const std::vector<Line> & lines)
+{
+    Build(lines, std::vector<int>(lines.size(), -1));
+}
+
+void WallIndex::Build(const std::vector<Line> & lines, const std::vector<int> & owners)
+{
+    Clear();
+    if(lines.empty()) {
+        return;
+    }
+    _lines  = lines;
+    _owners = owners;
+    _owners.resize(_lines.size(), -1);
+
+    _xMin       = DBL_MAX;
+    _yMin       = DBL_MAX;
+    double xMax = -DBL_MAX;
+    double yMax = -DBL_MAX;
+    for(const auto & line : _lines) {
+        for(const Point & p : {line.GetPoint1(), line.GetPoint2()}) {
+            _xMin = std::min(_xMin, p._x);
+            _yMin = std::min(_yMin, p._y);
+            xMax  = std::max(xMax, p._x);
+            yMax  = std::max(yMax, p._y);
+        }
+    }
+
+    const double width  = xMax - _xMin;
+    const double height = yMax - _yMin;
+
+    // about one segment per cell
+    _cellSize = std::max(MIN_CELL_SIZE, std::sqrt(width * height / _lines.size()));
+    _cellSize = std::max(_cellSize, std::max(width, height) / MAX_CELLS_PER_AXIS);
+    _nx       = static_cast<int>(width / _cellSize) + 1;
+    _ny       = static_cast<int>(height / _cellSize) + 1;
+
+    // counting sort of the (cell, segment) pairs, each segment goes to all cells
+    // overlapping its bounding box
+    std::vector<CellRange> ranges;
+    ranges.reserve(_lines.size());
+    _cellStart.assign(static_cast<std::size_t>(_nx) * _ny + 1, 0);
+    for(const auto & line : _lines) {
+        const Point & p1 = line.GetPoint1();
+        const Point & p2 = line.GetPoint2();
+        ranges.push_back(
+            {CellX(std::min(p1._x, p2._x)),
+             CellY(std::min(p1._y, p2._y)),
+             CellX(std::max(p1._x, p2._x)),
+             CellY(std::max(p1._y, p2._y))});
+        const CellRange & range = ranges.back();
+        for(int y = range.yMin; y <= range.yMax; ++y) {
+            for(int x = range.xMin; x <= range.xMax; ++x) {
+                ++_cellStart[y * _nx + x + 1];
+            }
+        }
+    }
+    for(std::size_t c = 1; c < _cellStart.size(); ++c) {
+        _cellStart[c] += _cellStart[c - 1];
+    }
+
+    _cellEntries.resize(_cellStart.back());
+    std::vector<int> next(_cellStart.begin(), _cellStart.end() - 1);
+    for(std::size_t i = 0; i < ranges.size(); ++i) {
+        const CellRange & range = ranges[i];
+        for(int y = range.yMin; y <= range.yMax; ++y) {
+            for(int x = range.xMin; x <= range.xMax; ++x) {
+                _cellEntries[next[y * _nx + x]++] = static_cast<int>(i);
+            }
+        }
+    }
+}
+
+void WallIndex::Clear()
+{
+    _lines.clear();
+    _owners.clear();
+    _cellEntries.clear();
+    _cellStart.clear();
+    _nx = 0;
+    _ny = 0;
+}
+
+bool WallIndex::IntersectsAny(const Point & p1, const Point & p2) const
+{
+    return IntersectsAny(p1, p2, [](int) { return true; });
+}
+
+std::size_t WallIndex::CountCandidates(const Point & p1, const Point & p2) const
+{
+    if(_lines.empty()) {
+        return 0;
+    }
+
+    const CellRange range = QueryRange(p1, p2);
+    if(NumberOfCells(range) > MAX_QUERY_CELLS) {
+        return _lines.size();
+    }
+
+    std::size_t count = 0;
+    for(int y = range.yMin; y <= range.yMax; ++y) {
+        for(int x = range.xMin; x <= range.xMax; ++x) {
+            const int cell = y * _nx + x;
+            count += _cellStart[cell + 1] - _cellStart[cell];
+        }
+    }
+    return count;
+}
+
+WallIndex::CellRange WallIndex::QueryRange(const Point & p1, const Point & p2) const
+{
+    // the bounding box has to contain every point the intersection test can
+    // report, including the part behind p1 and the tolerance of Point::operator==
+    const Point behind = p1 - (p2 - p1) * BACKWARD_TOLERANCE;
+    return {
+        CellX(std::min(behind._x, p2._x) - J_EPS),
+        CellY(std::min(behind._y, p2._y) - J_EPS),
+        CellX(std::max(behind._x, p2._x) + J_EPS),
+        CellY(std::max(behind._y, p2._y) + J_EPS)};
+}
+
+int WallIndex::CellX(double x) const
+{
+    const double cell = std::floor((x - _xMin) / _cellSize);
+    return static_cast<int>(std::clamp(cell, 0., static_cast<double>(_nx - 1)));
+}
+
+int WallIndex::CellY(double y) const
+{
+    const double cell = std::floor((y - _yMin) / _cellSize);
+    return static_cast<int>(std::clamp(cell, 0., static_cast<double>(_ny - 1)));
+}
@@ -0,0 +1,167 @@
+/**
+ * \file        WallIndex.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Uniform grid over the wall segments of a subroom or of the whole building.
+ * Used by the visibility test between two pedestrians to only check the walls
+ * close to the line of sight instead of all walls.
+ *
+ **/
+#pragma once
+
+#include "Line.h"
+#include "Point.h"
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * \class WallIndex
+ *
+ * \brief Read only bucket grid over a set of line segments.
+ *
+ * Every segment is stored once and referenced from all cells its bounding box
+ * overlaps (cell lists in CSR layout). A query only tests the segments of the
+ * cells overlapping the bounding box of the line of sight, the result is the
+ * same as testing all segments with Line::IntersectionWith().
+ *
+ * Optionally every segment has an owner (e.g. the UID of its subroom), the
+ * queries can then be restricted to the segments of some owners.
+ *
+ * The index keeps copies of the segments, it has to be rebuilt when the
+ * geometry changes.
+ */
+class WallIndex
+{
+public:
+    /// smallest number of segments for which building the grid pays off
+    static constexpr std::size_t MIN_LINES = 16;
+
+    /// queries covering more cells than this test all segments
+    static constexpr std::size_t MAX_QUERY_CELLS = 64;
+
+    /**
+      * Build the grid over the given segments, replaces the previous content
+      */
+    void Build(const std::vector<Line> & lines);
+
+    /**
+      * Build the grid over the given segments, owners[i] is the owner of lines[i]
+      */
+    void Build(const std::vector<Line> & lines, const std::vector<int> & owners);
+
+    /**
+      * Release all segments, IsEmpty() is true afterwards
+      */
+    void Clear();
+
+    bool IsEmpty() const { return _lines.empty(); }
+    std::size_t GetNumberOfLines() const { return _lines.size(); }
+    double GetCellSize() const { return _cellSize; }
+
+    /**
+      * @return true if the segment [p1, p2] intersects with one of the indexed
+      * segments in the sense of Line::IntersectionWith(p1, p2)
+      */
+    bool IntersectsAny(const Point & p1, const Point & p2) const;
+
+    /**
+      * @return true if the segment [p1, p2] intersects with one of the indexed
+      * segments whose owner is accepted by accept(owner)
+      */
+    template <typename Accept>
+    bool IntersectsAny(const Point & p1, const Point & p2, Accept accept) const;
+
+    /**
+      * @return number of segment tests done by IntersectsAny(p1, p2) if no
+      * intersection is found
+      */
+    std::size_t CountCandidates(const Point & p1, const Point & p2) const;
+
+private:
+    struct CellRange {
+        int xMin;
+        int yMin;
+        int xMax;
+        int yMax;
+    };
+
+    /// cells overlapping the bounding box of the line of sight p1 -> p2
+    CellRange QueryRange(const Point & p1, const Point & p2) const;
+
+    std::size_t NumberOfCells(const CellRange & range) const
+    {
+        return static_cast<std::size_t>(range.xMax - range.xMin + 1) *
+               static_cast<std::size_t>(range.yMax - range.yMin + 1);
+    }
+
+    int CellX(double x) const;
+    int CellY(double y) const;
+
+    bool Intersects(std::size_t line, const Point & p1, const Point & p2) const
+    {
+        return _lines[line].IntersectionWith(p1, p2) != LineIntersectType::NO_INTERSECTION;
+    }
+
+    std::vector<Line> _lines;
+    /// owner of each segment, -1 if none was given
+    std::vector<int> _owners;
+    /// indices into _lines, the entries of cell c are [_cellStart[c], _cellStart[c+1])
+    std::vector<int> _cellEntries;
+    std::vector<int> _cellStart;
+    double _xMin     = 0.;
+    double _yMin     = 0.;
+    double _cellSize = 1.;
+    int _nx          = 0;
+    int _ny          = 0;
+};
+
+template <typename Accept>
+bool WallIndex::IntersectsAny(const Point & p1, const Point & p2, Accept accept) const
+{
+    if(_lines.empty()) {
+        return false;
+    }
+
+    const CellRange range = QueryRange(p1, p2);
+    if(NumberOfCells(range) > MAX_QUERY_CELLS) {
+        for(std::size_t i = 0; i < _lines.size(); ++i) {
+            if(accept(_owners[i]) && Intersects(i, p1, p2)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // a segment referenced by several cells may be tested more than once,
+    // this is cheaper than keeping track of the tested ones
+    for(int y = range.yMin; y <= range.yMax; ++y) {
+        for(int x = range.xMin; x <= range.xMax; ++x) {
+            const int cell = y * _nx + x;
+            for(int k = _cellStart[cell]; k < _cellStart[cell + 1]; ++k) {
+                const int line = _cellEntries[k];
+                if(accept(_owners[line]) && Intersects(line, p1, p2)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -110,30 +110,27 @@ void GCFMModel::ComputeNextTimeStep(
 
     // collect all pedestrians in the simulation.
     const std::vector<Pedestrian *> & allPeds = building->GetAllPedestrians();
+    const PedestrianKinematics & kinematics   = building->GetKinematics();
 
     unsigned int nSize = allPeds.size();
     int nThreads       = omp_get_max_threads();
 
 
-    int partSize;
-    partSize = ((int) nSize > nThreads) ? (int) (nSize / nThreads) : (int) nSize;
-    if(partSize == (int) nSize)
+    if((int) nSize <= nThreads)
         nThreads = 1; // not worthy to parallelize
 
+    _accelerations.resize(nSize);
+    if((int) _scratch.size() < nThreads)
+        _scratch.resize(nThreads);
+    _schedule.Prepare(nSize, nThreads, building->GetGrid());
+    const GCFMPedParameters pedParameters{_nuPed, _maxfPed, _intp_widthPed, _distEffMaxPed};
+
     int debugPed = -10;
     //building->GetGrid()->HighlightNeighborhood(debugPed, building);
 #pragma omp parallel default(shared) num_threads(nThreads)
     {
-        std::vector<Point> result_acc = std::vector<Point>();
-        result_acc.reserve(2200);
-
-        const int threadID = omp_get_thread_num();
-
-        int start = threadID * partSize;
-        int end;
-        end = (threadID < nThreads - 1) ? (threadID + 1) * partSize - 1 : (int) (nSize - 1);
-
-        for(int p = start; p <= end; ++p) {
+        ThreadScratch & scratch = _scratch[omp_get_thread_num()];
+        _schedule.ForEach([&](std::size_t p) {
             Pedestrian * ped  = allPeds[p];
             Room * room       = building->GetRoom(ped->GetRoomID());
             SubRoom * subroom = room->GetSubRoom(ped->GetSubRoomID());
@@ -160,36 +157,61 @@ void GCFMModel::ComputeNextTimeStep(
             }
 
             Point F_rep;
-            std::vector<Pedestrian *> neighbours;
-            building->GetGrid()->GetNeighbourhood(ped, neighbours);
             //if(ped->GetID()==61) building->GetGrid()->HighlightNeighborhood(ped,building);
-            std::vector<SubRoom *> emptyVector;
-
-            int neighborsSize = neighbours.size();
-            for(int i = 0; i < neighborsSize; i++) {
-                Pedestrian * ped1   = neighbours[i];
-                Point p1            = ped->GetPos();
-                Point p2            = ped1->GetPos();
-                bool ped_is_visible = building->IsVisible(p1, p2, emptyVector, false);
+            // pack the interacting neighbours, the pairs are evaluated in one batch below
+            NeighbourBlock & interacting = scratch.neighbours;
+            interacting.Clear();
+
+            const double axis = std::max(fabs(kinematics.GetEA(p)), fabs(kinematics.GetEB(p)));
+            for(const auto & neighbour : building->GetGrid()->GetNeighbours(ped)) {
+                Pedestrian * ped1   = neighbour.ped;
+                const std::size_t j = ped1->GetKinematicsIndex();
+                Point p1            = kinematics.GetPos(p);
+                Point p2            = kinematics.GetPos(j);
+                // the effective distance of the ellipses is at least the distance of the
+                // centres minus the larger semi-axes, beyond _distEffMaxPed there is no force
+                const double axis1 = std::max(fabs(kinematics.GetEA(j)), fabs(kinematics.GetEB(j)));
+                if((p2 - p1).Norm() - axis - axis1 >= _distEffMaxPed + J_EPS)
+                    continue;
+                // only the walls around the two subrooms can block the line of sight
+                SubRoom * sb2 = building->GetRoom(kinematics.GetRoomID(j))
+                                    ->GetSubRoom(kinematics.GetSubRoomID(j));
+                bool ped_is_visible = building->IsVisibleLocal(p1, p2, subroom, sb2);
                 if(!ped_is_visible)
                     continue;
                 // if(debugPed == ped->GetID())
                 // {
                 //      fprintf(stdout, "t=%f     %f    %f    %f     %f   %d  %d  %d\n", time,  p1._x, p1._y, p2._x, p2._y, isVisible, ped->GetID(), ped1->GetID());
                 // }
-                //if they are in the same subroom
-                if(ped->GetUniqueRoomID() == ped1->GetUniqueRoomID()) {
-                    F_rep = F_rep + ForceRepPed(ped, ped1);
-                } else {
-                    // or in neighbour subrooms
-                    SubRoom * sb2 =
-                        building->GetRoom(ped1->GetRoomID())->GetSubRoom(ped1->GetSubRoomID());
-                    if(subroom->IsDirectlyConnectedWith(sb2)) {
-                        F_rep = F_rep + ForceRepPed(ped, ped1);
-                    }
+                //if they are in the same subroom or in neighbour subrooms
+                if(kinematics.GetUniqueRoomID(p) == kinematics.GetUniqueRoomID(j) ||
+                   subroom->IsDirectlyConnectedWith(sb2)) {
+                    interacting.Add(j, ped1->GetV(), ped1->GetEllipse());
                 }
             } //for peds
 
+            const JEllipse & ellipse = ped->GetEllipse();
+            const GCFMAgent agent{
+                ped->GetV(),
+                ped->GetV0Norm(),
+                ped->GetMass(),
+                ellipse.GetCenter(),
+                ellipse.GetCosPhi(),
+                ellipse.GetSinPhi(),
+                ellipse.GetEA(),
+                ellipse.GetEB(),
+                ellipse.GetXp()};
+            PairResults & results = scratch.results;
+            GCFMRepulsion(agent, interacting, pedParameters, results);
+            for(std::size_t k = 0; k < interacting.Size(); ++k) {
+                // irregular pairs go through the scalar code, which reports them
+                const Point force =
+                    results.irregular[k] ?
+                        ForceRepPed(ped, kinematics.GetPedestrian(interacting.index[k])) :
+                        Point(results.fx[k], results.fy[k]);
+                F_rep = F_rep + force;
+            }
+
 
             //repulsive forces to the walls and transitions that are not my target
             Point repwall = ForceRepRoom(allPeds[p], subroom);
@@ -215,14 +237,14 @@ void GCFMModel::ComputeNextTimeStep(
                     repwall._y);
             }
 
-            result_acc.push_back(acc);
-        }
+            _accelerations[p] = acc;
+        });
 
 #pragma omp barrier
         // update
-        for(int p = start; p <= end; ++p) {
+        _schedule.ForEach([&](std::size_t p) {
             Pedestrian * ped = allPeds[p];
-            Point v_neu      = ped->GetV() + result_acc[p - start] * deltaT;
+            Point v_neu      = ped->GetV() + _accelerations[p] * deltaT;
             Point pos_neu    = ped->GetPos() + v_neu * deltaT;
 
             //Room* room = building->GetRoom(ped->GetRoomID());
@@ -239,7 +261,7 @@ void GCFMModel::ComputeNextTimeStep(
             ped->SetPos(pos_neu);
             ped->SetV(v_neu);
             ped->SetPhiPed();
-        }
+        });
 
     } //end parallel
 }
@@ -27,6 +27,7 @@
  **/
 #pragma once
 #include "OperationalModel.h"
+#include "PairwiseForces.h"
 #include "geometry/Building.h"
 
 #include <vector>
@@ -81,6 +82,16 @@ public:
     ComputeNextTimeStep(double current, double deltaT, Building * building, int periodic);
     virtual std::string GetDescription();
     virtual bool Init(Building * building);
+    /**
+     * Repulsive force between two pedestrians ped1 and ped2 according to
+     * the Generalized Centrifugal Force Model (chraibi2010a)
+     *
+     * @param ped1 Pointer to Pedestrian: First pedestrian
+     * @param ped2 Pointer to Pedestrian: Second pedestrian
+     *
+     * @return Point
+     */
+    Point ForceRepPed(Pedestrian * ped1, Pedestrian * ped2) const;
 
 private:
     // Modellparameter
@@ -92,6 +103,14 @@ private:
     double _maxfWall;
     double _distEffMaxPed;  // maximal effective distance
     double _distEffMaxWall; // maximal effective distance
+    /// acceleration of each pedestrian, reused in every step
+    std::vector<Point> _accelerations;
+    /// per thread buffers of ComputeNextTimeStep, reused in every step
+    struct ThreadScratch {
+        NeighbourBlock neighbours; // interacting neighbours of the current pedestrian
+        PairResults results;
+    };
+    std::vector<ThreadScratch> _scratch;
 
     // Private Funktionen
     /**
@@ -103,16 +122,6 @@ private:
      * @return Point
      */
     Point ForceDriv(Pedestrian * ped, Room * room) const;
-    /**
-     * Repulsive force between two pedestrians ped1 and ped2 according to
-     * the Generalized Centrifugal Force Model (chraibi2010a)
-     *
-     * @param ped1 Pointer to Pedestrian: First pedestrian
-     * @param ped2 Pointer to Pedestrian: Second pedestrian
-     *
-     * @return Point
-     */
-    Point ForceRepPed(Pedestrian * ped1, Pedestrian * ped2) const;
     /**
      * Repulsive force acting on pedestrian <ped> from the walls in
      * <subroom>. The sum of all repulsive forces of the walls in <subroom> is calculated
@@ -37,6 +37,8 @@
 /** @} */ // end of group
 #pragma once
 
+#include "ParallelSchedule.h"
+
 #include <memory>
 #include <string>
 
@@ -48,6 +50,8 @@ class OperationalModel
 protected:
     // define the strategy for crossing a door (used for calculating the driving force)
     std::shared_ptr<DirectionManager> _direction;
+    // distribution of the pedestrians to the threads in ComputeNextTimeStep
+    ParallelSchedule _schedule;
 
 public:
     /**
@@ -85,4 +89,6 @@ public:
     ComputeNextTimeStep(double current, double deltaT, Building * building, int periodic) = 0;
 
     std::shared_ptr<DirectionManager> GetDirection() { return _direction; };
+
+    ParallelSchedule & GetSchedule() { return _schedule; };
 };
\ No newline at end of file
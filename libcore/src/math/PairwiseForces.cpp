@@ -0,0 +1,364 @@
+/**
+ * \file        PairwiseForces.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "PairwiseForces.h"
+
+#include "general/Macros.h"
+#include "pedestrian/Ellipse.h"
+
+#include <cfloat>
+#include <cmath>
+
+// The kernels are written as branch free loops the compiler vectorizes. With
+// GCC on x86-64 they are compiled for AVX-512, AVX2 and the baseline, the best
+// version for the CPU is selected at load time. The arithmetic follows the
+// scalar code of the models operation by operation, so the results do not
+// depend on the version as long as no contraction to FMA is done (switched off
+// for this file in CMakeLists.txt).
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define JPS_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define JPS_SIMD_CLONES
+#endif
+
+namespace
+{
+/// JEllipse::PointOnEllipse(), p is given in the coordinates of the ellipse
+inline void PointOnEllipse(
+    double px,
+    double py,
+    double cx,
+    double cy,
+    double a,
+    double b,
+    double cphi,
+    double sphi,
+    double & rx,
+    double & ry)
+{
+    const double r2     = px * px + py * py;
+    const bool atCenter = r2 < J_EPS * J_EPS;
+    const double r      = std::sqrt(r2);
+    // (a, 0) if p is the center
+    const double sx = atCenter ? a : a * (px / r);
+    const double sy = atCenter ? 0. : b * (py / r);
+    rx              = sx * cphi - sy * sphi + cx;
+    ry              = sx * sphi + sy * cphi + cy;
+}
+
+/// same as hermite_interp() without the range checks
+inline double
+HermiteInterp(double t, double x1, double x2, double y1, double y2, double dy1, double dy2)
+{
+    double scale = x2 - x1;
+    t            = (t - x1) / scale;
+    double t2    = t * t;
+    double t3    = t2 * t;
+    double h1    = 2 * t3 - 3 * t2 + 1;
+    double h2    = -2 * t3 + 3 * t2;
+    double h3    = t3 - 2 * t2 + t;
+    double h4    = t3 - t2;
+    double left  = y1 * h1 + dy1 * h3 * scale;
+    double right = y2 * h2 + dy2 * h4 * scale;
+    return left + right;
+}
+
+std::size_t CountIrregular(const PairResults & results, std::size_t n)
+{
+    std::size_t count = 0;
+    for(std::size_t k = 0; k < n; ++k) {
+        count += results.irregular[k];
+    }
+    return count;
+}
+} // namespace
+
+void NeighbourBlock::Clear()
+{
+    index.clear();
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    cosPhi.clear();
+    sinPhi.clear();
+    ea.clear();
+    eb.clear();
+    xp.clear();
+}
+
+void NeighbourBlock::Add(std::size_t i, const Point & pos)
+{
+    index.push_back(i);
+    x.push_back(pos._x);
+    y.push_back(pos._y);
+}
+
+void NeighbourBlock::Add(std::size_t i, const Point & v, const JEllipse & ellipse)
+{
+    Add(i, ellipse.GetCenter());
+    vx.push_back(v._x);
+    vy.push_back(v._y);
+    cosPhi.push_back(ellipse.GetCosPhi());
+    sinPhi.push_back(ellipse.GetSinPhi());
+    ea.push_back(ellipse.GetEA());
+    eb.push_back(ellipse.GetEB());
+    xp.push_back(ellipse.GetXp());
+}
+
+void PairResults::Resize(std::size_t n)
+{
+    fx.resize(n);
+    fy.resize(n);
+    spacing.resize(n);
+    irregular.resize(n);
+    tmp.resize(n);
+}
+
+JPS_SIMD_CLONES
+std::size_t VelocityRepulsion(
+    const VelocityAgent & agent,
+    const NeighbourBlock & neighbours,
+    const VelocityPedParameters & parameters,
+    PairResults & results)
+{
+    const std::size_t n = neighbours.Size();
+    results.Resize(n);
+
+    const double * x          = neighbours.x.data();
+    const double * y          = neighbours.y.data();
+    double * fx               = results.fx.data();
+    double * fy               = results.fy.data();
+    double * exponent         = results.tmp.data();
+    unsigned char * irregular = results.irregular.data();
+
+    const double posX   = agent.pos._x;
+    const double posY   = agent.pos._y;
+    const double l      = 2 * agent.bmax;
+    const double D      = parameters.D;
+    const bool periodic = parameters.periodic.enabled;
+    const double xLeft  = parameters.periodic.xLeft;
+    const double xRight = parameters.periodic.xRight;
+    const double cutoff = parameters.periodic.cutoff;
+
+#pragma omp simd
+    for(std::size_t k = 0; k < n; ++k) {
+        double dx       = x[k] - posX;
+        const double dy = y[k] - posY;
+        if(periodic && (xRight - posX) + (x[k] - xLeft) <= cutoff) {
+            dx = dx + xRight - xLeft;
+        }
+        const double distance = std::sqrt(dx * dx + dy * dy);
+        irregular[k]          = distance < J_EPS;
+        // ep12, stored in the result until the strength is known
+        fx[k]       = distance > J_EPS ? dx / distance : 0.;
+        fy[k]       = distance > J_EPS ? dy / distance : 0.;
+        exponent[k] = (l - distance) / D;
+    }
+
+    // there is no vector version of exp without -ffast-math, keep it apart
+    for(std::size_t k = 0; k < n; ++k) {
+        exponent[k] = std::exp(exponent[k]);
+    }
+
+    const double a = parameters.a;
+#pragma omp simd
+    for(std::size_t k = 0; k < n; ++k) {
+        const double R = -a * exponent[k];
+        fx[k]          = fx[k] * R;
+        fy[k]          = fy[k] * R;
+    }
+    return CountIrregular(results, n);
+}
+
+JPS_SIMD_CLONES
+std::size_t VelocitySpacing(
+    const VelocityAgent & agent,
+    const Point & ei,
+    const NeighbourBlock & neighbours,
+    const PeriodicBoundary & periodic,
+    PairResults & results)
+{
+    const std::size_t n = neighbours.Size();
+    results.Resize(n);
+
+    const double * x          = neighbours.x.data();
+    const double * y          = neighbours.y.data();
+    double * spacing          = results.spacing.data();
+    unsigned char * irregular = results.irregular.data();
+
+    const double posX     = agent.pos._x;
+    const double posY     = agent.pos._y;
+    const double l        = 2 * agent.bmax;
+    const Point normal    = ei.Rotate(0, 1); // theta = pi/2
+    const bool isPeriodic = periodic.enabled;
+    const double xLeft    = periodic.xLeft;
+    const double xRight   = periodic.xRight;
+    const double cutoff   = periodic.cutoff;
+
+#pragma omp simd
+    for(std::size_t k = 0; k < n; ++k) {
+        double dx       = x[k] - posX;
+        const double dy = y[k] - posY;
+        if(isPeriodic && (xRight - posX) + (x[k] - xLeft) <= cutoff) {
+            dx = dx + xRight - xLeft;
+        }
+        const double distance = std::sqrt(dx * dx + dy * dy);
+        irregular[k]          = distance < J_EPS;
+        const double epx      = distance > J_EPS ? dx / distance : 0.;
+        const double epy      = distance > J_EPS ? dy / distance : 0.;
+
+        // < e_i , e_ij > should be positive
+        const double condition1 = ei._x * epx + ei._y * epy;
+        // condition2 should be <= than l/Distance
+        double condition2 = normal._x * epx + normal._y * epy;
+        condition2        = (condition2 > 0) ? condition2 : -condition2;
+        spacing[k]        = (condition1 >= 0) && (condition2 <= l / distance) ? distance : FLT_MAX;
+    }
+    return CountIrregular(results, n);
+}
+
+JPS_SIMD_CLONES
+std::size_t GCFMRepulsion(
+    const GCFMAgent & agent,
+    const NeighbourBlock & neighbours,
+    const GCFMPedParameters & parameters,
+    PairResults & results)
+{
+    const std::size_t n = neighbours.Size();
+    results.Resize(n);
+
+    const double * x          = neighbours.x.data();
+    const double * y          = neighbours.y.data();
+    const double * vx         = neighbours.vx.data();
+    const double * vy         = neighbours.vy.data();
+    const double * cosPhi     = neighbours.cosPhi.data();
+    const double * sinPhi     = neighbours.sinPhi.data();
+    const double * ea         = neighbours.ea.data();
+    const double * eb         = neighbours.eb.data();
+    const double * xp         = neighbours.xp.data();
+    double * fx               = results.fx.data();
+    double * fy               = results.fy.data();
+    unsigned char * irregular = results.irregular.data();
+
+    const double c1x   = agent.center._x;
+    const double c1y   = agent.center._y;
+    const double cos1  = agent.cosPhi;
+    const double sin1  = agent.sinPhi;
+    const double a1    = agent.ea;
+    const double b1    = agent.eb;
+    const double v1x   = agent.v._x;
+    const double v1y   = agent.v._y;
+    const double v1Sq  = agent.v.ScalarProduct(agent.v);
+    const bool v1Small = agent.v.Norm() < J_EPS;
+    const double mass  = agent.mass;
+    const double nom0  = parameters.nu * agent.v0Norm; // Nu: 0=CFM, 0.28=modifCFM
+    // action point of the agent
+    const double p1x = agent.xp * cos1 - 0. * sin1 + c1x;
+    const double p1y = agent.xp * sin1 + 0. * cos1 + c1y;
+
+    //          smax    dist_intpol_left      dist_intpol_right       dist_eff_max
+    //       ----|-------------|--------------------------|--------------|----
+    //       5   |     4       |            3             |      2       | 1
+    const double distEffMax = parameters.distEffMax;
+    const double maxF       = parameters.maxF;
+    // it is assumed that the minimal distance is about 50 cm
+    const double mindist         = 0.5;
+    const double distIntpolLeft  = mindist + parameters.intpWidth;
+    const double distIntpolRight = distEffMax - parameters.intpWidth;
+    const double smax            = mindist - parameters.intpWidth;
+
+#pragma omp simd
+    for(std::size_t k = 0; k < n; ++k) {
+        // effective distance of the ellipses, JEllipse::EffectiveDistanceToEllipse()
+        const double c2x  = x[k];
+        const double c2y  = y[k];
+        const double cos2 = cosPhi[k];
+        const double sin2 = sinPhi[k];
+        const double d21x = c2x - c1x;
+        const double d21y = c2y - c1y;
+        const double d12x = c1x - c2x;
+        const double d12y = c1y - c2y;
+        // center of E2 in coordinates of E1 and vice versa
+        const double e2in1x = d21x * cos1 - d21y * -sin1;
+        const double e2in1y = d21x * -sin1 + d21y * cos1;
+        const double e1in2x = d12x * cos2 - d12y * -sin2;
+        const double e1in2y = d12x * -sin2 + d12y * cos2;
+        const double dist   = std::sqrt(d12x * d12x + d12y * d12y);
+        double r1x, r1y, r2x, r2y;
+        PointOnEllipse(e2in1x, e2in1y, c1x, c1y, a1, b1, cos1, sin1, r1x, r1y);
+        PointOnEllipse(e1in2x, e1in2y, c2x, c2y, ea[k], eb[k], cos2, sin2, r2x, r2y);
+        const double r1 = std::sqrt((c1x - r1x) * (c1x - r1x) + (c1y - r1y) * (c1y - r1y));
+        const double r2 = std::sqrt((c2x - r2x) * (c2x - r2x) + (c2y - r2y) * (c2y - r2y));
+
+        const double distEff = dist - r1 - r2;
+
+        // direction between the action points
+        const double p2x    = xp[k] * cos2 - 0. * sin2 + c2x;
+        const double p2y    = xp[k] * sin2 + 0. * cos2 + c2y;
+        const double dpx    = p2x - p1x;
+        const double dpy    = p2y - p1y;
+        const double dpNorm = std::sqrt(dpx * dpx + dpy * dpy);
+        const double epx    = dpNorm > J_EPS ? dpx / dpNorm : 0.;
+        const double epy    = dpNorm > J_EPS ? dpy / dpNorm : 0.;
+
+        const double tmp   = (v1x - vx[k]) * epx + (v1y - vy[k]) * epy; // < v_ij , e_ij >
+        const double vij   = 0.5 * (tmp + std::fabs(tmp));
+        const double tmp2  = v1x * epx + v1y * epy; // < v_i , e_ij >
+        const double bla   = tmp2 + std::fabs(tmp2);
+        double K           = v1Small ? 0. : 0.25 * bla * bla / v1Sq;
+        const bool noForce = !v1Small && K < J_EPS * J_EPS;
+        double nom         = nom0 + vij;
+        nom *= nom;
+        K = std::sqrt(K);
+
+        // region 2 and 4 are interpolated
+        const bool region5 = distEff <= smax;
+        const bool region2 = distEff >= distIntpolRight;
+        const bool region3 = !region2 && distEff >= distIntpolLeft;
+        const double denominator =
+            region2 ? distIntpolRight : (region3 ? std::fabs(distEff) : distIntpolLeft);
+        const double f       = -mass * K * nom / denominator;
+        const double f1      = -f / denominator;
+        const double left    = region2 ? distIntpolRight : smax;
+        const double right   = region2 ? distEffMax : distIntpolLeft;
+        const double fLeft   = region2 ? f : maxF * f;
+        const double fRight  = region2 ? 0. : f;
+        const double dfLeft  = region2 ? f1 : 0.;
+        const double dfRight = region2 ? 0. : f1;
+
+        const double px = HermiteInterp(distEff, left, right, fLeft, fRight, dfLeft, dfRight);
+        const double s  = region3 ? f : px;
+
+        double forceX = region5 ? epx * maxF * f : epx * s;
+        double forceY = region5 ? epy * maxF * f : epy * s;
+
+        const bool outside = distEff >= distEffMax;
+        const bool zero    = outside || dpNorm < J_EPS || noForce;
+        forceX             = zero ? 0. : forceX;
+        forceY             = zero ? 0. : forceY;
+        fx[k]              = forceX;
+        fy[k]              = forceY;
+
+        irregular[k] = !outside && (dpNorm < J_EPS || forceX != forceX || forceY != forceY);
+    }
+    return CountIrregular(results, n);
+}
@@ -0,0 +1,169 @@
+/**
+ * \file        PairwiseForces.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Batched pedestrian-pedestrian interactions of the operational models. The
+ * state of all neighbours of one pedestrian is packed into arrays, the
+ * kernels evaluate all pairs in one vectorized loop.
+ *
+ **/
+#pragma once
+
+#include "geometry/Point.h"
+
+#include <cstddef>
+#include <vector>
+
+class JEllipse;
+
+/*!
+ * \class NeighbourBlock
+ *
+ * \brief Packed state (structure of arrays) of the neighbours of one pedestrian.
+ *
+ * The velocity model only needs the positions, GCFM also the velocity and the
+ * ellipse. The blocks are meant to be reused, Clear() keeps the memory.
+ */
+class NeighbourBlock
+{
+public:
+    void Clear();
+    std::size_t Size() const { return index.size(); }
+
+    /// neighbour of the velocity model, index is the index in the kinematics
+    void Add(std::size_t i, const Point & pos);
+    /// neighbour of GCFM with velocity and ellipse
+    void Add(std::size_t i, const Point & v, const JEllipse & ellipse);
+
+    std::vector<std::size_t> index;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> vx;
+    std::vector<double> vy;
+    std::vector<double> cosPhi;
+    std::vector<double> sinPhi;
+    std::vector<double> ea;
+    std::vector<double> eb;
+    std::vector<double> xp; // action point on the main axis of the ellipse
+};
+
+/*!
+ * \class PairResults
+ *
+ * \brief One result per neighbour of a NeighbourBlock.
+ *
+ * Pairs the kernel cannot handle (e.g. pedestrians at the same position) are
+ * marked as irregular, the caller evaluates them with the scalar code of the
+ * model, which also does the error handling.
+ */
+class PairResults
+{
+public:
+    /// allocate n entries, the content is undefined
+    void Resize(std::size_t n);
+
+    std::vector<double> fx;
+    std::vector<double> fy;
+    std::vector<double> spacing;
+    std::vector<unsigned char> irregular;
+    /// scratch of the kernels
+    std::vector<double> tmp;
+};
+
+/// periodic boundary in x direction of the velocity model
+struct PeriodicBoundary {
+    bool enabled  = false;
+    double xLeft  = 0.;
+    double xRight = 0.;
+    double cutoff = 0.;
+};
+
+/// pedestrian the forces of the velocity model act on
+struct VelocityAgent {
+    Point pos;
+    double bmax; // max. semi-axis in shoulder direction
+};
+
+/// parameters of the pedestrian repulsion of the velocity model
+struct VelocityPedParameters {
+    double a; // strength
+    double D; // range
+    PeriodicBoundary periodic;
+};
+
+/// pedestrian the forces of GCFM act on
+struct GCFMAgent {
+    Point v;
+    double v0Norm;
+    double mass;
+    Point center;
+    double cosPhi;
+    double sinPhi;
+    double ea;
+    double eb;
+    double xp;
+};
+
+/// parameters of the pedestrian repulsion of GCFM
+struct GCFMPedParameters {
+    double nu;
+    double maxF;
+    double intpWidth;
+    double distEffMax;
+};
+
+/**
+ * Repulsion of all neighbours on the agent, same as
+ * VelocityModel::ForceRepPed() for each pair.
+ * Results in fx, fy, pedestrians closer than J_EPS are irregular.
+ * @return number of irregular pairs
+ */
+std::size_t VelocityRepulsion(
+    const VelocityAgent & agent,
+    const NeighbourBlock & neighbours,
+    const VelocityPedParameters & parameters,
+    PairResults & results);
+
+/**
+ * Spacing to all neighbours in walking direction ei, same as the first
+ * element of VelocityModel::GetSpacing() for each pair.
+ * Results in spacing, FLT_MAX for neighbours not in front of the agent,
+ * pedestrians closer than J_EPS are irregular.
+ * @return number of irregular pairs
+ */
+std::size_t VelocitySpacing(
+    const VelocityAgent & agent,
+    const Point & ei,
+    const NeighbourBlock & neighbours,
+    const PeriodicBoundary & periodic,
+    PairResults & results);
+
+/**
+ * Repulsion of all neighbours on the agent, same as GCFMModel::ForceRepPed()
+ * for each pair.
+ * Results in fx, fy, pairs with coinciding action points or a result that is
+ * not a number are irregular.
+ * @return number of irregular pairs
+ */
+std::size_t GCFMRepulsion(
+    const GCFMAgent & agent,
+    const NeighbourBlock & neighbours,
+    const GCFMPedParameters & parameters,
+    PairResults & results);
@@ -0,0 +1,79 @@
+/**
+ * \file        ParallelSchedule.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "ParallelSchedule.h"
+
+#include "general/Format.h"
+#include "general/Logger.h"
+#include "mpi/LCGrid.h"
+
+#include <algorithm>
+#include <numeric>
+
+void ParallelSchedule::SetMode(ScheduleMode mode, int chunkSize)
+{
+    _mode      = mode;
+    _chunkSize = std::max(1, chunkSize);
+}
+
+void ParallelSchedule::Prepare(std::size_t nPeds, int nThreads, const LCGrid * grid)
+{
+    _nPeds    = static_cast<long long>(nPeds);
+    _nThreads = nThreads;
+    if(static_cast<int>(_busyTime.size()) < nThreads) {
+        _busyTime.resize(nThreads, 0.);
+    }
+
+    if(_mode != ScheduleMode::Cells) {
+        return;
+    }
+    _order.clear();
+    if(grid) {
+        for(const auto & entry : grid->GetEntries()) {
+            _order.push_back(entry.index);
+        }
+    }
+    // pedestrians added after the update of the grid are not in it
+    if(_order.size() != nPeds) {
+        _order.resize(nPeds);
+        std::iota(_order.begin(), _order.end(), 0);
+    }
+}
+
+void ParallelSchedule::LogThreadLoad() const
+{
+    if(_busyTime.empty()) {
+        return;
+    }
+    for(std::size_t thread = 0; thread < _busyTime.size(); ++thread) {
+        Logging::Info(fmt::format(
+            check_fmt("Thread {} busy in the operational model: {:.2f}s"),
+            thread,
+            _busyTime[thread]));
+    }
+    const double max  = *std::max_element(_busyTime.begin(), _busyTime.end());
+    const double mean = std::accumulate(_busyTime.begin(), _busyTime.end(), 0.) /
+                        static_cast<double>(_busyTime.size());
+    if(mean > 0) {
+        Logging::Info(fmt::format(
+            check_fmt("Load imbalance (max/mean busy time) {:.2f}"), max / mean));
+    }
+}
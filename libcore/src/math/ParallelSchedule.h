@@ -0,0 +1,125 @@
+/**
+ * \file        ParallelSchedule.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Distribution of the pedestrians to the OpenMP threads in the operational
+ * models, with a record of the time each thread spends on its share.
+ *
+ **/
+#pragma once
+
+#include "general/Macros.h"
+#include "general/OpenMP.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class LCGrid;
+
+/*!
+ * \class ParallelSchedule
+ *
+ * \brief Loop over all pedestrians inside a parallel region.
+ *
+ * - Static: each thread gets one contiguous block of pedestrians
+ * - Dynamic: chunks of pedestrians are handed out to idle threads
+ * - Cells: like Dynamic, but the pedestrians are visited in the order of
+ *   the linked cell grid, so a chunk covers neighbouring pedestrians
+ *
+ * The order in which the pedestrians are visited does not change the
+ * results, as every pedestrian only writes its own state.
+ */
+class ParallelSchedule
+{
+public:
+    void SetMode(ScheduleMode mode, int chunkSize);
+    ScheduleMode GetMode() const { return _mode; }
+    int GetChunkSize() const { return _chunkSize; }
+
+    /**
+      * Prepare the loops of one time step. Must be called outside of the
+      * parallel region.
+      * @param nPeds number of pedestrians
+      * @param nThreads number of threads of the parallel region
+      * @param grid the updated grid, only needed for ScheduleMode::Cells
+      */
+    void Prepare(std::size_t nPeds, int nThreads, const LCGrid * grid);
+
+    /**
+      * Call body(p) for the pedestrians of the calling thread. Must be
+      * called by all threads of the parallel region. There is no barrier at
+      * the end of the loop.
+      */
+    template <typename Body>
+    void ForEach(Body && body);
+
+    /**
+      * Log the busy time of every thread and the load imbalance
+      */
+    void LogThreadLoad() const;
+
+private:
+    ScheduleMode _mode = ScheduleMode::Static;
+    int _chunkSize     = 64;
+    long long _nPeds   = 0;
+    int _nThreads      = 1;
+    /// pedestrians sorted by cell, for ScheduleMode::Cells
+    std::vector<std::size_t> _order;
+    /// seconds spent in ForEach by each thread
+    std::vector<double> _busyTime;
+};
+
+template <typename Body>
+void ParallelSchedule::ForEach(Body && body)
+{
+    const int threadID = omp_get_thread_num();
+    const auto begin   = std::chrono::steady_clock::now();
+
+    switch(_mode) {
+        case ScheduleMode::Static: {
+            const long long partSize = (_nPeds > _nThreads) ? _nPeds / _nThreads : _nPeds;
+            const long long start    = threadID * partSize;
+            const long long end      = (threadID < _nThreads - 1) ? start + partSize : _nPeds;
+            for(long long p = start; p < end; ++p) {
+                body(static_cast<std::size_t>(p));
+            }
+            break;
+        }
+        case ScheduleMode::Dynamic: {
+#pragma omp for schedule(dynamic, _chunkSize) nowait
+            for(long long p = 0; p < _nPeds; ++p) {
+                body(static_cast<std::size_t>(p));
+            }
+            break;
+        }
+        case ScheduleMode::Cells: {
+#pragma omp for schedule(dynamic, _chunkSize) nowait
+            for(long long i = 0; i < _nPeds; ++i) {
+                body(_order[i]);
+            }
+            break;
+        }
+    }
+
+    const std::chrono::duration<double> busy = std::chrono::steady_clock::now() - begin;
+    _busyTime[threadID] += busy.count();
+}
@@ -129,104 +129,104 @@ void VelocityModel::ComputeNextTimeStep(
 {
     // collect all pedestrians in the simulation.
     const std::vector<Pedestrian *> & allPeds = building->GetAllPedestrians();
-    std::vector<Pedestrian *> pedsToRemove;
-    pedsToRemove.reserve(500);
+    const PedestrianKinematics & kinematics   = building->GetKinematics();
     unsigned long nSize;
     nSize = allPeds.size();
 
     int nThreads = omp_get_max_threads();
 
     //nThreads = 1; //debug only
-    int partSize;
-    partSize = ((int) nSize > nThreads) ? (int) (nSize / nThreads) : (int) nSize;
-    if(partSize == (int) nSize)
+    if((int) nSize <= nThreads)
         nThreads = 1; // not worthy to parallelize
 
+    if((int) _scratch.size() < nThreads)
+        _scratch.resize(nThreads);
+    PeriodicBoundary boundary;
+    boundary.enabled = periodic != 0;
+    boundary.xLeft   = xLeft;
+    boundary.xRight  = xRight;
+    boundary.cutoff  = cutoff;
+    const VelocityPedParameters pedParameters{_aPed, _DPed, boundary};
+    _pedSubRooms.resize(nSize);
+    _velocities.resize(nSize);
+    _schedule.Prepare(nSize, nThreads, building->GetGrid());
 
-//TODO richtig parallelisieren!
 #pragma omp parallel default(shared) num_threads(nThreads)
     {
-        std::vector<Point> result_acc = std::vector<Point>();
-        result_acc.reserve(nSize);
-        std::vector<my_pair> spacings = std::vector<my_pair>();
-        spacings.reserve(nSize);             // larger than needed
-        spacings.push_back(my_pair(100, 1)); // in case there are no neighbors
-        const int threadID = omp_get_thread_num();
-
-        int start = threadID * partSize;
-        int end;
-        end = (threadID < nThreads - 1) ? (threadID + 1) * partSize - 1 : (int) (nSize - 1);
-        for(int p = start; p <= end; ++p) {
+        const int threadID      = omp_get_thread_num();
+        ThreadScratch & scratch = _scratch[threadID];
+        scratch.subrooms.resize(2);
+
+        // the subrooms are needed for every pair, look them up once
+        _schedule.ForEach([&](std::size_t p) {
+            _pedSubRooms[p] = building->GetRoom(kinematics.GetRoomID(p))
+                                  ->GetSubRoom(kinematics.GetSubRoomID(p));
+        });
+#pragma omp barrier
+
+        _schedule.ForEach([&](std::size_t p) {
             // printf("\n------------------\nid=%d (%d)\t p=%d\n", threadID, nThreads, p);
-            Pedestrian * ped  = allPeds[p];
-            Room * room       = building->GetRoom(ped->GetRoomID());
-            SubRoom * subroom = room->GetSubRoom(ped->GetSubRoomID());
-            Point repPed      = Point(0, 0);
-            std::vector<Pedestrian *> neighbours;
-            building->GetGrid()->GetNeighbourhood(ped, neighbours);
-
-            int size = (int) neighbours.size();
-            ////                if (ped->GetID() == 71) {
-            ////                     std::cout << "------------------------------------" << std::endl;
-            //                     std::cout << Pedestrian::GetGlobalTime() << ":\t\tVelocity Model debug ped: " << ped->GetID()
-            //                               << "\t" << ped->GetPos().toString() << "\t" << size<< std::endl;
-            ////                }
-
-
-            for(int i = 0; i < size; i++) {
-                Pedestrian * ped1 = neighbours[i];
-                //                     if (ped->GetID() == 71) {
-                //                         std::cout << "Velocity Model debug ped1: " << ped1->GetID() << "\t" <<  ped1->GetPos().toString() <<std::endl;
-                //                     }
-
-                //                     std::cout << "Velocity Model debug ped1: " << ped1 << std::endl;
-                //                     std::cout << ped1->GetID() << std::endl;
-
-                if(ped1 == nullptr) {
-                    std::cout << "Velocity Model debug: " << size << std::endl;
+            Pedestrian * ped                       = allPeds[p];
+            Room * room                            = building->GetRoom(ped->GetRoomID());
+            SubRoom * subroom                      = _pedSubRooms[p];
+            Point repPed                           = Point(0, 0);
+            const LCGrid::Neighbourhood neighbours = building->GetGrid()->GetNeighbours(ped);
+
+            // pack the neighbours, the pairs are evaluated in batches below
+            NeighbourBlock & visibleNeighbours   = scratch.repulsion;
+            NeighbourBlock & connectedNeighbours = scratch.spacing;
+            visibleNeighbours.Clear();
+            connectedNeighbours.Clear();
+            int size = 0;
+            for(const auto & neighbour : neighbours) {
+                ++size;
+                const std::size_t j = neighbour.index;
+                SubRoom * sb2       = _pedSubRooms[j];
+                // only pedestrians in the same subroom or in neighbour subrooms interact
+                if(kinematics.GetUniqueRoomID(p) != kinematics.GetUniqueRoomID(j) &&
+                   !subroom->IsDirectlyConnectedWith(sb2)) {
+                    continue;
                 }
-                //if they are in the same subroom
-                Point p1 = ped->GetPos();
-
-                Point p2 = ped1->GetPos();
+                Point p1 = kinematics.GetPos(p);
+                Point p2 = kinematics.GetPos(j);
+                connectedNeighbours.Add(j, p2);
                 //subrooms to consider when looking for neighbour for the 3d visibility
-                std::vector<SubRoom *> emptyVector;
-                emptyVector.push_back(subroom);
-                emptyVector.push_back(
-                    building->GetRoom(ped1->GetRoomID())->GetSubRoom(ped1->GetSubRoomID()));
-                bool isVisible = building->IsVisible(p1, p2, emptyVector, false);
-                if(!isVisible)
-                    continue;
-                if(ped->GetUniqueRoomID() == ped1->GetUniqueRoomID()) {
-                    repPed += ForceRepPed(ped, ped1, periodic);
-                } else {
-                    // or in neighbour subrooms
-                    SubRoom * sb2 =
-                        building->GetRoom(ped1->GetRoomID())->GetSubRoom(ped1->GetSubRoomID());
-                    if(subroom->IsDirectlyConnectedWith(sb2)) {
-                        repPed += ForceRepPed(ped, ped1, periodic);
-                    }
+                scratch.subrooms[0] = subroom;
+                scratch.subrooms[1] = sb2;
+                if(building->IsVisible(p1, p2, scratch.subrooms, false)) {
+                    visibleNeighbours.Add(j, p2);
                 }
-            } // for i
+            } // for neighbours
+
+            const VelocityAgent agent{kinematics.GetPos(p), kinematics.GetBmax(p)};
+            PairResults & results = scratch.results;
+            VelocityRepulsion(agent, visibleNeighbours, pedParameters, results);
+            for(std::size_t k = 0; k < visibleNeighbours.Size(); ++k) {
+                repPed += results.irregular[k] ?
+                              ForceRepPed(kinematics, p, visibleNeighbours.index[k], periodic) :
+                              Point(results.fx[k], results.fy[k]);
+            }
             //repulsive forces to walls and closed transitions that are not my target
             Point repWall = ForceRepRoom(allPeds[p], subroom);
 
             // calculate new direction ei according to (6)
             Point direction = e0(ped, room) + repPed + repWall;
-            for(int i = 0; i < size; i++) {
-                Pedestrian * ped1 = neighbours[i];
-                // calculate spacing
-                // my_pair spacing_winkel = GetSpacing(ped, ped1);
-                if(ped->GetUniqueRoomID() == ped1->GetUniqueRoomID()) {
-                    spacings.push_back(GetSpacing(ped, ped1, direction, periodic));
-                } else {
-                    // or in neighbour subrooms
-                    SubRoom * sb2 =
-                        building->GetRoom(ped1->GetRoomID())->GetSubRoom(ped1->GetSubRoomID());
-                    if(subroom->IsDirectlyConnectedWith(sb2)) {
-                        spacings.push_back(GetSpacing(ped, ped1, direction, periodic));
-                    }
+            // smallest spacing, with the same order as sort_pred
+            my_pair minSpacing = my_pair(100, 1); // in case there are no neighbors
+            VelocitySpacing(agent, direction, connectedNeighbours, boundary, results);
+            for(std::size_t k = 0; k < connectedNeighbours.Size(); ++k) {
+                const std::size_t j = connectedNeighbours.index[k];
+                if(results.irregular[k]) {
+                    // reports the pedestrians that are too close
+                    GetSpacing(kinematics, p, j, direction, periodic);
                 }
+                // a larger spacing can not be the smallest one
+                if(results.spacing[k] > minSpacing.first) {
+                    continue;
+                }
+                const my_pair spacing(results.spacing[k], kinematics.GetPedestrian(j)->GetID());
+                if(sort_pred()(spacing, minSpacing))
+                    minSpacing = spacing;
             }
             // @todo: get spacing to walls
             // @todo: update direction every DT?
@@ -234,9 +234,7 @@ void VelocityModel::ComputeNextTimeStep(
             // if(ped->GetID()==-10)
             //       std::cout << "time: " << ped->GetGlobalTime() << "  |  updateRate  " <<ped->GetUpdateRate() << "   modulo " <<fmod(ped->GetGlobalTime(), ped->GetUpdateRate())<<std::endl;
 
-            // calculate min spacing
-            std::sort(spacings.begin(), spacings.end(), sort_pred());
-            double spacing = spacings[0].first;
+            double spacing = minSpacing.first;
             //============================================================
             // TODO: Hack for Head on situations: ped1 x ------> | <------- x ped2
             if(0 && direction.NormSquare() < 0.5) {
@@ -256,10 +254,7 @@ void VelocityModel::ComputeNextTimeStep(
             //double winkel = spacings[0].second;
             //Point tmp;
             Point speed = direction.Normalized() * OptimalSpeed(ped, spacing);
-            result_acc.push_back(speed);
-
-
-            spacings.clear(); //clear for ped p
+            _velocities[p] = speed;
 
             // stuck peds get removed. Warning is thrown. low speed due to jam is omitted.
             if(ped->GetTimeInJam() > ped->GetPatienceTime() &&
@@ -278,17 +273,17 @@ void VelocityModel::ComputeNextTimeStep(
                     current);
                 Log->incrementDeletedAgents();
 #pragma omp critical(VelocityModel_ComputeNextTimeStep_pedsToRemove)
-                pedsToRemove.push_back(ped);
+                _pedsToRemove.push_back(ped);
             }
 
-        } // for p
+        }); // for p
 
 #pragma omp barrier
         // update
-        for(int p = start; p <= end; ++p) {
+        _schedule.ForEach([&](std::size_t p) {
             Pedestrian * ped = allPeds[p];
 
-            Point v_neu   = result_acc[p - start];
+            Point v_neu   = _velocities[p];
             Point pos_neu = ped->GetPos() + v_neu * deltaT;
 
             //Jam is based on the current velocity
@@ -309,7 +304,7 @@ void VelocityModel::ComputeNextTimeStep(
                 }
             }
             ped->SetV(v_neu);
-        }
+        });
         // if(threadID == -1 )
         //      std::cout << " result_acc size " << result_acc.size() << "\n";
         //getc(stdin);
@@ -318,10 +313,10 @@ void VelocityModel::ComputeNextTimeStep(
     } //end parallel
 
     // remove the pedestrians that have left the building
-    for(unsigned int p = 0; p < pedsToRemove.size(); p++) {
-        building->DeletePedestrian(pedsToRemove[p]);
+    for(unsigned int p = 0; p < _pedsToRemove.size(); p++) {
+        building->DeletePedestrian(_pedsToRemove[p]);
     }
-    pedsToRemove.clear();
+    _pedsToRemove.clear();
 }
 
 Point VelocityModel::e0(Pedestrian * ped, Room * room) const
@@ -399,20 +394,25 @@ double VelocityModel::OptimalSpeed(Pedestrian * ped, double spacing) const
 }
 
 // return spacing and id of the nearest pedestrian
-my_pair
-VelocityModel::GetSpacing(Pedestrian * ped1, Pedestrian * ped2, Point ei, int periodic) const
+my_pair VelocityModel::GetSpacing(
+    const PedestrianKinematics & kinematics,
+    std::size_t ped1,
+    std::size_t ped2,
+    Point ei,
+    int periodic) const
 {
-    Point distp12 = ped2->GetPos() - ped1->GetPos(); // inversed sign
+    const int ped2ID = kinematics.GetPedestrian(ped2)->GetID();
+    Point distp12    = kinematics.GetPos(ped2) - kinematics.GetPos(ped1); // inversed sign
     if(periodic) {
-        double x   = ped1->GetPos()._x;
-        double x_j = ped2->GetPos()._x;
+        double x   = kinematics.GetPos(ped1)._x;
+        double x_j = kinematics.GetPos(ped2)._x;
 
         if((xRight - x) + (x_j - xLeft) <= cutoff) {
             distp12._x = distp12._x + xRight - xLeft;
         }
     }
     double Distance = distp12.Norm();
-    double l        = 2 * ped1->GetEllipse().GetBmax();
+    double l        = 2 * kinematics.GetBmax(ped1);
     Point ep12;
     if(Distance >= J_EPS) {
         ep12 = distp12.Normalized();
@@ -420,7 +420,7 @@ VelocityModel::GetSpacing(Pedestrian * ped1, Pedestrian * ped2, Point ei, int pe
         //printf("ERROR: \tin VelocityModel::forcePedPed() ep12 can not be calculated!!!\n");
         Log->Write("WARNING: \tin VelocityModel::GetSPacing() ep12 can not be calculated!!!\n");
         Log->Write("\t\t Pedestrians are too near to each other (%f).", Distance);
-        my_pair(FLT_MAX, ped2->GetID());
+        my_pair(FLT_MAX, ped2ID);
         exit(EXIT_FAILURE); //TODO
     }
 
@@ -431,19 +431,25 @@ VelocityModel::GetSpacing(Pedestrian * ped1, Pedestrian * ped2, Point ei, int pe
 
     if((condition1 >= 0) && (condition2 <= l / Distance))
         // return a pair <dist, condition1>. Then take the smallest dist. In case of equality the biggest condition1
-        return my_pair(distp12.Norm(), ped2->GetID());
+        return my_pair(distp12.Norm(), ped2ID);
     else
-        return my_pair(FLT_MAX, ped2->GetID());
+        return my_pair(FLT_MAX, ped2ID);
 }
-Point VelocityModel::ForceRepPed(Pedestrian * ped1, Pedestrian * ped2, int periodic) const
+Point VelocityModel::ForceRepPed(
+    const PedestrianKinematics & kinematics,
+    std::size_t ped1,
+    std::size_t ped2,
+    int periodic) const
 {
     Point F_rep(0.0, 0.0);
     // x- and y-coordinate of the distance between p1 and p2
-    Point distp12 = ped2->GetPos() - ped1->GetPos();
+    const Point pos1 = kinematics.GetPos(ped1);
+    const Point pos2 = kinematics.GetPos(ped2);
+    Point distp12    = pos2 - pos1;
 
     if(periodic) {
-        double x   = ped1->GetPos()._x;
-        double x_j = ped2->GetPos()._x;
+        double x   = pos1._x;
+        double x_j = pos2._x;
         if((xRight - x) + (x_j - xLeft) <= cutoff) {
             distp12._x = distp12._x + xRight - xLeft;
         }
@@ -452,7 +458,7 @@ Point VelocityModel::ForceRepPed(Pedestrian * ped1, Pedestrian * ped2, int perio
     double Distance = distp12.Norm();
     Point ep12; // x- and y-coordinate of the normalized vector between p1 and p2
     double R_ij;
-    double l = 2 * ped1->GetEllipse().GetBmax();
+    double l = 2 * kinematics.GetBmax(ped1);
 
     if(Distance >= J_EPS) {
         ep12 = distp12.Normalized();
@@ -464,19 +470,18 @@ Point VelocityModel::ForceRepPed(Pedestrian * ped1, Pedestrian * ped2, int perio
         Log->Write("\t\t Pedestrians are too near to each other (dist=%f).", Distance);
         Log->Write(
             "\t\t Maybe the value of <a> in force_ped should be increased. Going to exit.\n");
-        printf("ped1 %d  ped2 %d\n", ped1->GetID(), ped2->GetID());
         printf(
-            "ped1 at (%f, %f), ped2 at (%f, %f)\n",
-            ped1->GetPos()._x,
-            ped1->GetPos()._y,
-            ped2->GetPos()._x,
-            ped2->GetPos()._y);
+            "ped1 %d  ped2 %d\n",
+            kinematics.GetPedestrian(ped1)->GetID(),
+            kinematics.GetPedestrian(ped2)->GetID());
+        printf("ped1 at (%f, %f), ped2 at (%f, %f)\n", pos1._x, pos1._y, pos2._x, pos2._y);
         exit(EXIT_FAILURE); //TODO: quick and dirty fix for issue #158
                             // (sometimes sources create peds on the same location)
     }
-    Point ei = ped1->GetV().Normalized();
-    if(ped1->GetV().NormSquare() < 0.01) {
-        ei = ped1->GetV0().Normalized();
+    const Point v1 = kinematics.GetV(ped1);
+    Point ei       = v1.Normalized();
+    if(v1.NormSquare() < 0.01) {
+        ei = kinematics.GetPedestrian(ped1)->GetV0().Normalized();
     }
     double condition1 = ei.ScalarProduct(ep12);            // < e_i , e_ij > should be positive
     condition1        = (condition1 > 0) ? condition1 : 0; // abs
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "OperationalModel.h"
+#include "PairwiseForces.h"
 #include "geometry/Building.h"
 
 #include <vector>
@@ -69,6 +70,20 @@ private:
     double _aWall;
     double _DWall;
 
+    /// per thread buffers of ComputeNextTimeStep, reused in every step
+    struct ThreadScratch {
+        std::vector<SubRoom *> subrooms; // the two subrooms for the visibility check
+        NeighbourBlock repulsion;        // visible neighbours
+        NeighbourBlock spacing;          // neighbours in the same or a connected subroom
+        PairResults results;
+    };
+    std::vector<ThreadScratch> _scratch;
+    /// subroom of each pedestrian (index of the kinematic store), set once per step
+    std::vector<SubRoom *> _pedSubRooms;
+    /// new velocity of each pedestrian
+    std::vector<Point> _velocities;
+    std::vector<Pedestrian *> _pedsToRemove;
+
     /**
       * Optimal velocity function \f$ V(spacing) =\min{v_0, \max{0, (s-l)/T}}  \f$
       *
@@ -89,27 +104,6 @@ private:
       * @return Point
       */
     Point e0(Pedestrian * ped, Room * room) const;
-    /**
-      * Get the spacing between ped1 and ped2
-      *
-      * @param ped1 Pointer to Pedestrian: First pedestrian
-      * @param ped2 Pointer to Pedestrian: Second pedestrian
-      * @param ei the direction of pedestrian.
-      * This direction is: \f$ e_0 + \sum_j{R(spacing_{ij})*e_{ij}}\f$
-      * and should be calculated *before* calling OptimalSpeed
-      * @return Point
-      */
-    my_pair GetSpacing(Pedestrian * ped1, Pedestrian * ped2, Point ei, int periodic) const;
-    /**
-      * Repulsive force between two pedestrians ped1 and ped2 according to
-      * the Velocity model (to be published in TGF15)
-      *
-      * @param ped1 Pointer to Pedestrian: First pedestrian
-      * @param ped2 Pointer to Pedestrian: Second pedestrian
-      *
-      * @return Point
-      */
-    Point ForceRepPed(Pedestrian * ped1, Pedestrian * ped2, int periodic) const;
     /**
       * Repulsive force acting on pedestrian <ped> from the walls in
       * <subroom>. The sum of all repulsive forces of the walls in <subroom> is calculated
@@ -139,6 +133,39 @@ public:
         double Dwall);
     virtual ~VelocityModel(void);
 
+    /**
+      * Get the spacing between ped1 and ped2
+      *
+      * @param kinematics state of all pedestrians
+      * @param ped1 index of the first pedestrian in kinematics
+      * @param ped2 index of the second pedestrian in kinematics
+      * @param ei the direction of pedestrian.
+      * This direction is: \f$ e_0 + \sum_j{R(spacing_{ij})*e_{ij}}\f$
+      * and should be calculated *before* calling OptimalSpeed
+      * @return Point
+      */
+    my_pair GetSpacing(
+        const PedestrianKinematics & kinematics,
+        std::size_t ped1,
+        std::size_t ped2,
+        Point ei,
+        int periodic) const;
+    /**
+      * Repulsive force between two pedestrians ped1 and ped2 according to
+      * the Velocity model (to be published in TGF15)
+      *
+      * @param kinematics state of all pedestrians
+      * @param ped1 index of the first pedestrian in kinematics
+      * @param ped2 index of the second pedestrian in kinematics
+      *
+      * @return Point
+      */
+    Point ForceRepPed(
+        const PedestrianKinematics & kinematics,
+        std::size_t ped1,
+        std::size_t ped2,
+        int periodic) const;
+
     /**
       * @todo What is this parameter doing?
       *
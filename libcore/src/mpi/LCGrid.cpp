@@ -27,22 +27,26 @@
  * at each simulation step. Only pedestrians in the neighbouring cells are involved
  * in the force computations.
  *
- * The class is static as only one instance is needed per simulation round.
- * This solution is fine for parallelisation as well, at least for OpenMP.
+ * The pedestrians are sorted by cell with a counting sort, so the pedestrians
+ * of neighbouring cells are contiguous in memory and can be visited without
+ * building a list. The sort is done in parallel with per thread histograms.
  *
  *
  **/
 #include "LCGrid.h"
 
+#include "general/OpenMP.h"
 #include "pedestrian/Pedestrian.h"
+#include "pedestrian/PedestrianKinematics.h"
 
+#include <algorithm>
 #include <mutex>
 
 
 std::mutex grid_mutex;
 
-//FIXME:
-#define MAX_AGENT_COUNT 10000 // 1000000
+/// below this number of pedestrians per thread the grid is sorted serially
+#define MIN_PEDS_PER_THREAD 1000
 
 LCGrid::LCGrid(double boundaries[4], double cellsize, int nPeds)
 {
@@ -51,115 +55,91 @@ LCGrid::LCGrid(double boundaries[4], double cellsize, int nPeds)
     _gridYmin = boundaries[2];
     _gridYmax = boundaries[3];
     _cellSize = cellsize;
-    _nPeds    = nPeds + MAX_AGENT_COUNT;
 
     // add 1 to ensure that the whole area is covered by cells if not divisible without remainder
     _gridSizeX = (int) ((_gridXmax - _gridXmin) / _cellSize) + 1 + 2; // 1 dummy cell on each side
     _gridSizeY = (int) ((_gridYmax - _gridYmin) / _cellSize) + 1 + 2; // 1 dummy cell on each side
 
-    // allocate memory for cells (2D-array) and initialize
-    _cellHead = new int *[_gridSizeY];
-
-    for(int i = 0; i < _gridSizeY; ++i) {
-        _cellHead[i] = new int[_gridSizeX]; // nx columns
-
-        for(int j = 0; j < _gridSizeX; ++j) {
-            _cellHead[i][j] = LIST_EMPTY;
-        }
-    }
-
-    // creating and resetting the pedestrians list
-    _list = new int[_nPeds];
-    for(int i = 0; i < _nPeds; i++)
-        _list[i] = 0;
-
-    //allocating the place for the peds copy
-    _localPedsCopy = new Pedestrian *[_nPeds];
-    for(int i = 0; i < _nPeds; i++)
-        _localPedsCopy[i] = nullptr;
+    // all cells are empty
+    _cellStart.assign(static_cast<std::size_t>(_gridSizeX) * _gridSizeY + 1, 0);
+    _entries.reserve(nPeds);
+    _pedCell.reserve(nPeds);
 }
 
-LCGrid::~LCGrid()
-{
-    //     for(int i=0; i<_nPeds; i++) {
-    //          if(_localPedsCopy[i]!=nullptr)
-    //               delete _localPedsCopy[i];
-    //     }
-    delete[] _list;
-    delete[] _localPedsCopy;
-    for(int i = 0; i < _gridSizeY; ++i)
-        delete[] _cellHead[i];
-    delete[] _cellHead;
-}
-
-void LCGrid::ShallowCopy(const std::vector<Pedestrian *> & peds)
-{
-    for(unsigned int p = 0; p < peds.size(); p++) {
-        int id             = peds[p]->GetID() - 1;
-        _localPedsCopy[id] = peds[p];
-    }
-}
+LCGrid::~LCGrid() = default;
 
-void LCGrid::Update(const std::vector<Pedestrian *> & peds)
+int LCGrid::CellIndex(const Point & pos) const
 {
-    grid_mutex.lock();
-    ClearGrid();
-
-    for(auto & ped : peds) {
-        //Pedestrian* ped = peds[p];
-        int id = ped->GetID() - 1;
-        // determine the cell coordinates of pedestrian i
-        int ix =
-            (int) ((ped->GetPos()._x - _gridXmin) / _cellSize) + 1; // +1 because of dummy cells
-        int iy = (int) ((ped->GetPos()._y - _gridYmin) / _cellSize) + 1;
-        //printf("[%f, %f]  ",ped->GetPos()._x, ped->GetPos()._y);
-        // create lists
-        //printf("[%d=%d] ",ped->GetPedIndex(),id);
-        _list[id]         = _cellHead[iy][ix];
-        _cellHead[iy][ix] = id;
-
-        _localPedsCopy[id] = ped;
-
-        //          if (ped->GetID() == 71) {
-        //               std::cout << "pos: " << ped->GetPos().toString() << " ix:"  << ix << " iy:" << iy << std::endl;
-        //          }
-    }
-    grid_mutex.unlock();
+    // +1 because of dummy cells
+    int ix = (int) ((pos._x - _gridXmin) / _cellSize) + 1;
+    int iy = (int) ((pos._y - _gridYmin) / _cellSize) + 1;
+    ix     = std::clamp(ix, 1, _gridSizeX - 2);
+    iy     = std::clamp(iy, 1, _gridSizeY - 2);
+    return ix * _gridSizeY + iy;
 }
 
-// I hope you had called Clear() first
-// todo: can be used to solve the issue with MAX_AGENT_COUNT
-void LCGrid::Update(Pedestrian * ped)
+void LCGrid::Update(const PedestrianKinematics & kinematics)
 {
-    grid_mutex.lock();
-
-    int id = ped->GetID() - 1;
-    // determine the cell coordinates of pedestrian i
-    int ix = (int) ((ped->GetPos()._x - _gridXmin) / _cellSize) + 1; // +1 because of dummy cells
-    int iy = (int) ((ped->GetPos()._y - _gridYmin) / _cellSize) + 1;
+    std::lock_guard<std::mutex> lock(grid_mutex);
+
+    const int nPeds  = static_cast<int>(kinematics.Size());
+    const int nCells = _gridSizeX * _gridSizeY;
+    const int nThreads =
+        std::max(1, std::min(omp_get_max_threads(), nPeds / MIN_PEDS_PER_THREAD));
+    const double * x = kinematics.GetX();
+    const double * y = kinematics.GetY();
+
+    _pedCell.resize(nPeds);
+    _entries.resize(nPeds);
+    _threadCount.assign(static_cast<std::size_t>(nThreads) * nCells, 0);
+
+#pragma omp parallel num_threads(nThreads)
+    {
+        // the runtime may start less threads than requested
+        const int nTeam  = omp_get_num_threads();
+        const int thread = omp_get_thread_num();
+        const int begin  = static_cast<int>(static_cast<long long>(nPeds) * thread / nTeam);
+        const int end    = static_cast<int>(static_cast<long long>(nPeds) * (thread + 1) / nTeam);
+        int * count      = &_threadCount[static_cast<std::size_t>(thread) * nCells];
+
+        // histogram of the own pedestrians
+        for(int p = begin; p < end; ++p) {
+            const int cell = CellIndex(Point(x[p], y[p]));
+            _pedCell[p]    = cell;
+            ++count[cell];
+        }
 
-    // update the list previously created
-    _list[id]         = _cellHead[iy][ix];
-    _cellHead[iy][ix] = id;
+#pragma omp barrier
+#pragma omp single
+        {
+            // turn the histograms into write offsets. Within a cell the last
+            // thread writes first, so the cell is in descending pedestrian order
+            // as it was with the former linked list.
+            int offset = 0;
+            for(int cell = 0; cell < nCells; ++cell) {
+                _cellStart[cell] = offset;
+                for(int t = nTeam - 1; t >= 0; --t) {
+                    int & n      = _threadCount[static_cast<std::size_t>(t) * nCells + cell];
+                    const int nt = n;
+                    n            = offset;
+                    offset += nt;
+                }
+            }
+            _cellStart[nCells] = offset;
+        }
 
-    // this is probably a pedestrian coming from the mpi routine, so made a copy
-    _localPedsCopy[id] = ped;
-    grid_mutex.unlock();
+        // scatter the own pedestrians backwards
+        for(int p = end - 1; p >= begin; --p) {
+            _entries[count[_pedCell[p]]++] =
+                Entry{kinematics.GetPedestrian(p), static_cast<std::size_t>(p)};
+        }
+    }
 }
 
 void LCGrid::ClearGrid()
 {
-    // start by resetting the current list
-    for(int i = 0; i < _gridSizeY; ++i) {
-        for(int j = 0; j < _gridSizeX; ++j) {
-            _cellHead[i][j] = LIST_EMPTY;
-        }
-    }
-
-    for(int i = 0; i < _nPeds; i++) {
-        _list[i]          = LIST_EMPTY;
-        _localPedsCopy[i] = nullptr;
-    }
+    std::fill(_cellStart.begin(), _cellStart.end(), 0);
+    _entries.clear();
 }
 
 void LCGrid::HighlightNeighborhood(int pedID, Building * building)
@@ -181,95 +161,59 @@ void LCGrid::HighlightNeighborhood(int pedID, Building * building)
             p->SetSpotlight(true);
     }
 }
-/*
-void LCGrid::HighlightNeighborhood(int pedID, Building* building)
+
+LCGrid::Neighbourhood LCGrid::GetRange(const Point & pos) const
 {
-     // force spotlight activation
-     Pedestrian::SetColorMode(BY_SPOTLIGHT);
-     //darken all
-     //const vector< Pedestrian* >& allPeds = building->GetAllPedestrians();
-     //for(unsigned int p=0;p<allPeds.size();p++){
-     //     allPeds[p]->SetSpotlight(false);
-     //}
-
-     for(auto&& ped: building->GetAllPedestrians())
-     {
-          ped->SetSpotlight(false);
-     }
-
-     Pedestrian* ped=building->GetPedestrian(pedID);
-     //get and highlight the neighborhood
-     if(ped){
-          vector<Pedestrian*> neighbours;
-          GetNeighbourhood(ped,neighbours);
-
-          for(auto&& p: neighbours)
-               p->SetSpotlight(true);
-          //for(unsigned int p=0;p<neighbours.size();p++){
-          //     neighbours[p]->SetSpotlight(true);
-          //}
-     }
+    const int cell = CellIndex(pos);
+    const int l    = cell / _gridSizeY;
+    const int k    = cell % _gridSizeY;
+
+    Neighbourhood range;
+    const Entry * entries = _entries.data();
+    // the cells (i, k-1) ... (i, k+1) of one column are contiguous
+    for(int n = 0; n < 3; ++n) {
+        const int i     = l - 1 + n;
+        range._begin[n] = entries + _cellStart[i * _gridSizeY + k - 1];
+        range._end[n]   = entries + _cellStart[i * _gridSizeY + k + 2];
+    }
+    return range;
 }
-*/
-void LCGrid::GetNeighbourhood(const Pedestrian * ped, std::vector<Pedestrian *> & neighbourhood)
+
+void LCGrid::Neighbourhood::Iterator::SkipInvalid()
 {
-    grid_mutex.lock();
-
-    double xPed = ped->GetPos()._x;
-    double yPed = ped->GetPos()._y;
-
-    int l = (int) ((xPed - _gridXmin) / _cellSize) + 1; // +1 because of dummy cells
-    int k = (int) ((yPed - _gridYmin) / _cellSize) + 1;
-
-    //-1 to get  correct mapping in the array local
-    int myID = ped->GetID() - 1;
-
-    // all neighbor cells
-    for(int i = l - 1; i <= l + 1; ++i) {
-        for(int j = k - 1; j <= k + 1; ++j) {
-            //printf(" i=%d j=%d k=%d l=%d\n",i,j,nx,ny);
-            int p = _cellHead[j][i];
-            // all peds in one cell
-            while(p != LIST_EMPTY) {
-                // double x=pLocalPedsCopy[p]->GetPos()._x;
-                // double y=pLocalPedsCopy[p]->GetPos()._y;
-                // double dist=((x-xPed)*(x-xPed) + (y-yPed)*(y-yPed));
-                if(p != myID) {
-                    // if((dist<pCellSize*pCellSize) && (p!=myID)) {
-                    neighbourhood.push_back(_localPedsCopy[p]);
-                }
-                // next ped
-                p = _list[p];
-            }
+    while(_column < 3) {
+        if(_entry == _range->_end[_column]) {
+            ++_column;
+            _entry = (_column < 3) ? _range->_begin[_column] : nullptr;
+        } else if(_entry->ped == _range->_exclude) {
+            ++_entry;
+        } else {
+            return;
         }
     }
+}
+
+LCGrid::Neighbourhood LCGrid::GetNeighbours(const Pedestrian * ped) const
+{
+    Neighbourhood range = GetRange(ped->GetPos());
+    range._exclude      = ped;
+    return range;
+}
 
-    grid_mutex.unlock();
+void LCGrid::GetNeighbourhood(const Pedestrian * ped, std::vector<Pedestrian *> & neighbourhood)
+{
+    std::lock_guard<std::mutex> lock(grid_mutex);
+    for(const auto & entry : GetNeighbours(ped)) {
+        neighbourhood.push_back(entry.ped);
+    }
 }
 
 void LCGrid::GetNeighbourhood(const Point & pos, std::vector<Pedestrian *> & neighbourhood)
 {
-    grid_mutex.lock();
-
-    double xPed = pos._x;
-    double yPed = pos._y;
-
-    int l = (int) ((xPed - _gridXmin) / _cellSize) + 1; // +1 because of dummy cells
-    int k = (int) ((yPed - _gridYmin) / _cellSize) + 1;
-
-    // all neighbor cells
-    for(int i = l - 1; i <= l + 1; ++i) {
-        for(int j = k - 1; j <= k + 1; ++j) {
-            //printf(" i=%d j=%d k=%d l=%d\n",i,j,nx,ny);
-            int p = _cellHead[j][i];
-            // all peds in one cell
-            while(p != LIST_EMPTY) {
-                neighbourhood.push_back(_localPedsCopy[p]);
-                p = _list[p]; // next ped
-            }
-        }
+    std::lock_guard<std::mutex> lock(grid_mutex);
+    for(const auto & entry : GetRange(pos)) {
+        neighbourhood.push_back(entry.ped);
     }
-    grid_mutex.unlock();
 }
 
 
@@ -283,9 +227,8 @@ void LCGrid::Dump()
 {
     for(int l = 1; l < _gridSizeY - 1; l++) {
         for(int k = 1; k < _gridSizeX - 1; k++) {
-            int ped = _cellHead[l][k];
-
-            if(ped == LIST_EMPTY)
+            const int cell = k * _gridSizeY + l;
+            if(_cellStart[cell] == _cellStart[cell + 1])
                 continue;
 
             printf("Cell[%d][%d] = { ", l, k);
@@ -293,12 +236,9 @@ void LCGrid::Dump()
             for(int i = l - 1; i <= l + 1; ++i) {
                 for(int j = k - 1; j <= k + 1; ++j) {
                     // dummy cells will be empty
-                    int p = _cellHead[i][j];
-                    // all peds in one cell
-                    while(p != LIST_EMPTY) {
-                        printf("%d, ", p + 1);
-                        // next ped
-                        p = _list[p];
+                    const int neighbour = j * _gridSizeY + i;
+                    for(int p = _cellStart[neighbour]; p < _cellStart[neighbour + 1]; ++p) {
+                        printf("%d, ", _entries[p].ped->GetID());
                     }
                 }
             }
@@ -311,21 +251,13 @@ void LCGrid::dumpCellsOnly()
 {
     for(int l = 1; l < _gridSizeY - 1; l++) {
         for(int k = 1; k < _gridSizeX - 1; k++) {
-            int ped = _cellHead[l][k];
-
-            if(ped == LIST_EMPTY)
+            const int cell = k * _gridSizeY + l;
+            if(_cellStart[cell] == _cellStart[cell + 1])
                 continue;
 
             printf("Cell[%d][%d] = { ", l, k);
-
-            // all neighbor cells
-            // dummy cells will be empty
-            int p = _cellHead[l][k];
-            // all peds in one cell
-            while(p != LIST_EMPTY) {
-                printf("%d, ", p + 1);
-                // next ped
-                p = _list[p];
+            for(int p = _cellStart[cell]; p < _cellStart[cell + 1]; ++p) {
+                printf("%d, ", _entries[p].ped->GetID());
             }
             printf("}\n");
         }
@@ -26,8 +26,9 @@
  * A grid is laid on the complete geometry and the pedestrians are assigned the cells
  * at each simulation step. Only pedestrians in the neighbouring cells are involved
  * in the force computations.
- * The class is static as only one instance is needed per simulation round.
- * This solution is fine for parallelisation as well, at least for OpenMP.
+ * The pedestrians are sorted by cell with a counting sort, so the pedestrians
+ * of neighbouring cells are contiguous in memory and can be visited without
+ * building a list. The sort is done in parallel with per thread histograms.
  *
  *
  **/
@@ -35,20 +36,71 @@
 
 #include "geometry/Point.h"
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
 //forwarded classes
 class Pedestrian;
+class PedestrianKinematics;
 class Building;
 
 class LCGrid
 {
+public:
+    /// a pedestrian in the grid and its index in Building::GetAllPedestrians()
+    struct Entry {
+        Pedestrian * ped;
+        std::size_t index;
+    };
+
+    /**
+      * The pedestrians of the 3x3 cells around a position, as three contiguous
+      * ranges (one per column of cells) of the sorted entries. Iterating does
+      * not allocate.
+      */
+    class Neighbourhood
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator(const Neighbourhood * range, int column, const Entry * entry) :
+                _range(range), _column(column), _entry(entry)
+            {
+                SkipInvalid();
+            }
+            const Entry & operator*() const { return *_entry; }
+            const Entry * operator->() const { return _entry; }
+            Iterator & operator++()
+            {
+                ++_entry;
+                SkipInvalid();
+                return *this;
+            }
+            bool operator==(const Iterator & other) const { return _entry == other._entry; }
+            bool operator!=(const Iterator & other) const { return _entry != other._entry; }
+
+        private:
+            void SkipInvalid();
+
+            const Neighbourhood * _range;
+            int _column;
+            const Entry * _entry;
+        };
+
+        Iterator begin() const { return Iterator(this, 0, _begin[0]); }
+        Iterator end() const { return Iterator(this, 3, nullptr); }
+
+    private:
+        friend class LCGrid;
+        const Entry * _begin[3] = {nullptr, nullptr, nullptr};
+        const Entry * _end[3]   = {nullptr, nullptr, nullptr};
+        /// pedestrian to skip, the one asking for its neighbours
+        const Pedestrian * _exclude = nullptr;
+    };
+
 private:
-    /// the 'first' pedestrian in each cell
-    int ** _cellHead;
-    ///  the next pedestrians. more efficient than the double linked- list
-    int * _list;
     /// number of cells in x- and y-direction respectively.
     /// Also to be interpreted as cell coordinates in the grid
     int _gridSizeX, _gridSizeY;
@@ -56,18 +108,26 @@ private:
     double _cellSize;
     /// rectangular area for linked cells which covers the whole geometry
     double _gridXmin, _gridXmax, _gridYmin, _gridYmax;
-    /// for convenience
-    /// will be delete in next versions
-    Pedestrian ** _localPedsCopy;
-    ///total number of pedestrians
-    int _nPeds;
+    /// first entry of each cell in _entries, the cells are ordered column by column
+    std::vector<int> _cellStart;
+    /// all pedestrians sorted by cell
+    std::vector<Entry> _entries;
+    /// cell of each pedestrian, scratch space of Update()
+    std::vector<int> _pedCell;
+    /// per thread histograms / write offsets, scratch space of Update()
+    std::vector<int> _threadCount;
+
+    int CellIndex(const Point & pos) const;
+
+    /// the ranges of the 3x3 cells around pos
+    Neighbourhood GetRange(const Point & pos) const;
 
 public:
     /**
       * Constructor
       * @param boundaries the boundaries of the grid [xmin xmax ymin ymax]
       * @param cellsize the cell size
-      * @param nPeds the number of pedestrians
+      * @param nPeds the expected number of pedestrians (memory is reserved)
       */
     LCGrid(double boundaries[4], double cellsize, int nPeds);
 
@@ -82,19 +142,10 @@ public:
     double GetCellSize();
 
     /**
-      *Update the cells occupation
-      */
-    void Update(const std::vector<Pedestrian *> & peds);
-
-    /**
-      * Update this special pedestrian on the grid
+      *Update the cells occupation. Within a cell the pedestrians are sorted
+      *in descending order of their index.
       */
-    void Update(Pedestrian * ped);
-
-    /**
-      * Make a shallow copy of the initial pedestrians distribution
-      */
-    void ShallowCopy(const std::vector<Pedestrian *> & peds);
+    void Update(const PedestrianKinematics & kinematics);
 
     /**
       * Clear the grid.
@@ -125,6 +176,18 @@ public:
       */
     void GetNeighbourhood(const Pedestrian * ped, std::vector<Pedestrian *> & neighbourhood);
 
+    /**
+      * Allocation free neighbourhood of the pedestrian ped (ped itself is skipped).
+      * Does not lock the grid, so it must not run concurrently with Update().
+      * Meant for the operational models, which run after the update of the grid.
+      */
+    Neighbourhood GetNeighbours(const Pedestrian * ped) const;
+
+    /**
+      * @return all pedestrians sorted by cell (column by column)
+      */
+    const std::vector<Entry> & GetEntries() const { return _entries; }
+
     /**
       * Highlight the neighborhood of the given pedestrian
       * @param pedID
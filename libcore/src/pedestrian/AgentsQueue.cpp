@@ -55,11 +55,13 @@ void AgentsQueueIn::GetandClear(std::vector<Pedestrian *> & peds)
 
 bool AgentsQueueIn::IsEmpty()
 {
+    std::lock_guard<std::mutex> lock(_queueMutex);
     return (_agentsQueue.size() == 0);
 }
 
 int AgentsQueueIn::Size()
 {
+    std::lock_guard<std::mutex> lock(_queueMutex);
     return _agentsQueue.size();
 }
 
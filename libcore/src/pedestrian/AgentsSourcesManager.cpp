@@ -33,65 +33,44 @@
 #include "mpi/LCGrid.h"
 #include "voronoi-boost/VoronoiPositionGenerator.h"
 
-#include <thread>
-
-bool AgentsSourcesManager::_isCompleted = true;
-
 AgentsSourcesManager::AgentsSourcesManager() {}
 
 AgentsSourcesManager::~AgentsSourcesManager() {}
 
-void AgentsSourcesManager::operator()()
-{
-    Run();
-}
-
-void AgentsSourcesManager::Run()
+void AgentsSourcesManager::Start()
 {
-    SetRunning(true);
-    Log->Write("INFO:\tStarting agent manager thread");
-    std::cout << KRED << "\n Starting agent manager thread\n"
-              << ">> time: " << Pedestrian::GetGlobalTime() << RESET << "\n";
+    Log->Write("INFO:\tStarting agent manager");
     //Generate all agents required for the complete simulation
     //It might be more efficient to generate at each frequency step
-    //TODO  this loop is exactly GenerateAgents( --> REFACTOR)
-    for(const auto & src : _sources) {
-        std::cout << "Generate src: " << src->GetId() << "\n";
-        src->GenerateAgentsAndAddToPool(src->GetMaxAgents(), _building);
-    }
+    GenerateAgents();
 
     //first call ignoring the return value
     ProcessAllSources();
 
-    //the loop is updated each x second.
-    //it might be better to use a timer
-    _isCompleted  = false;
-    bool finished = false;
+    _isCompleted    = false;
+    _lastUpdateTime = (int) Pedestrian::GetGlobalTime();
     SetBuildingUpdated(false);
+}
+
+void AgentsSourcesManager::Update(double time)
+{
+    if(_isCompleted) {
+        return;
+    }
+
+    int current_time     = (int) time;
     long updateFrequency = 1; // @todo parse this from inifile
-    /* std::cout << KMAG << "RUN Starting thread manager with _lastUpdateTime " << _lastUpdateTime<< std::endl; */
-    do {
-        int current_time = (int) Pedestrian::GetGlobalTime();
-        // std::cout << KBLU << ">> RUN: current_time " << current_time << " last update  " << _lastUpdateTime << "\n" << RESET;
-
-        if((current_time != _lastUpdateTime) && ((current_time % updateFrequency) == 0)) {
-            /* std::cout << "   ---  Enter IF  --- \n" << KRED << "QUEUE isempty: " << AgentsQueueIn::IsEmpty() << "\n" << RESET; */
-            if(AgentsQueueIn::IsEmpty())
-            //if queue is empty. Otherwise, wait for main thread to empty it and update _building
-            {
-                /* std::cout << "   ---  Enter QUEUE EMPTY --- \n"; */
-                finished        = ProcessAllSources();
-                _lastUpdateTime = current_time;
-                //SetBuildingUpdated(false);
-            }
-        }
-        // wait for main thread to update building
-        if(current_time >= GetMaxSimTime())
-            break; // break if max simulation time is reached.
+    bool finished        = false;
+    // the agents of the last update were already added to the building by the caller
+    if((current_time != _lastUpdateTime) && ((current_time % updateFrequency) == 0)) {
+        finished        = ProcessAllSources();
+        _lastUpdateTime = current_time;
+    }
 
-    } while(!finished);
-    Log->Write("INFO:\tTerminating agent manager thread");
-    _isCompleted = true;
+    if(finished || current_time >= GetMaxSimTime()) {
+        Log->Write("INFO:\tTerminating agent manager");
+        _isCompleted = true;
+    }
 }
 
 bool AgentsSourcesManager::ProcessAllSources() const
@@ -587,6 +566,7 @@ void AgentsSourcesManager::SortPositionByDensity(
 void AgentsSourcesManager::GenerateAgents()
 {
     for(const auto & src : _sources) {
+        Log->Write("INFO:\tGenerate agents of source %d", src->GetId());
         src->GenerateAgentsAndAddToPool(src->GetMaxAgents(), _building);
     }
 }
@@ -612,12 +592,6 @@ bool AgentsSourcesManager::IsCompleted() const
     return _isCompleted;
 }
 
-bool AgentsSourcesManager::IsRunning() const
-{
-    return _isRunning;
-}
-
-
 bool AgentsSourcesManager::IsBuildingUpdated() const
 {
     return _buildingUpdated;
@@ -629,11 +603,6 @@ void AgentsSourcesManager::SetBuildingUpdated(bool update)
 }
 
 
-void AgentsSourcesManager::SetRunning(bool running)
-{
-    _isRunning = running;
-}
-
 Building * AgentsSourcesManager::GetBuilding() const
 {
     return _building;
@@ -28,7 +28,6 @@
  **/
 #pragma once
 
-#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -57,15 +56,19 @@ public:
     virtual ~AgentsSourcesManager();
 
     /**
-      * Make the class "runnable" by overloading the operator
-      * @param value
+      * Generate the agents of all sources and release the ones due at the
+      * start. Has to be called once before the simulation loop.
       */
-    void operator()();
+    void Start();
 
     /**
-      *
+      * Release the agents of all sources due at the given simulation time.
+      * Called by the simulation loop before the incoming agents are added to
+      * the building, the sources are only processed when the time crosses a
+      * full second.
+      * @param time current simulation time
       */
-    void Run();
+    void Update(double time);
 
     /**
       *  Add a new agent source
@@ -81,7 +84,6 @@ public:
       * Set the building object
       */
     void SetBuilding(Building * building);
-    void SetRunning(bool running);
 
     /**
       * @return true if all agents have been generated
@@ -123,7 +125,6 @@ public:
 
     int GetMaxSimTime() const;
     void SetMaxSimTime(int t);
-    bool IsRunning() const;
 
 private:
     /**
@@ -180,9 +181,6 @@ private:
     /// building object
     Building * _building = nullptr;
     /// whether all agents have been dispatched
-    static bool _isCompleted;
-    //std::atomic<bool>_isCompleted=false;
-    //     std::atomic<bool>_buildingUpdated=false;
+    bool _isCompleted = true;
     bool _buildingUpdated;
-    bool _isRunning = false;
 };
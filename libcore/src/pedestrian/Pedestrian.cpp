@@ -28,6 +28,7 @@
 
 #include "JPSfire/generic/FDSMeshStorage.h"
 #include "Knowledge.h"
+#include "PedestrianKinematics.h"
 #include "geometry/Building.h"
 #include "geometry/SubRoom.h"
 #include "geometry/WaitingArea.h"
@@ -213,16 +214,25 @@ void Pedestrian::SetRoomID(int i, std::string roomCaption)
 {
     _roomID      = i;
     _roomCaption = roomCaption;
+    if(_kinematics) {
+        _kinematics->SetLocation(_kinematicsIndex, _roomID, _subRoomID, _subRoomUID);
+    }
 }
 
 void Pedestrian::SetSubRoomID(int i)
 {
     _subRoomID = i;
+    if(_kinematics) {
+        _kinematics->SetLocation(_kinematicsIndex, _roomID, _subRoomID, _subRoomUID);
+    }
 }
 
 void Pedestrian::SetSubRoomUID(int i)
 {
     _subRoomUID = i;
+    if(_kinematics) {
+        _kinematics->SetLocation(_kinematicsIndex, _roomID, _subRoomID, _subRoomUID);
+    }
 }
 
 void Pedestrian::SetMass(double m)
@@ -243,6 +253,9 @@ void Pedestrian::SetT(double T)
 void Pedestrian::SetEllipse(const JEllipse & e)
 {
     _ellipse = e;
+    if(_kinematics) {
+        WriteKinematics();
+    }
 }
 
 void Pedestrian::SetExitIndex(int i)
@@ -266,6 +279,9 @@ void Pedestrian::SetPos(const Point & pos, bool initial)
 {
     if((_globalTime >= _premovement) || (initial == true)) {
         _ellipse.SetCenter(pos);
+        if(_kinematics) {
+            _kinematics->SetPos(_kinematicsIndex, pos);
+        }
         //save the last values for the records
         _lastPositions.push(pos);
         unsigned int max_size = _recordingTime / _deltaT;
@@ -283,6 +299,9 @@ void Pedestrian::SetV(const Point & v)
 {
     if(_globalTime >= _premovement) {
         _ellipse.SetV(v);
+        if(_kinematics) {
+            _kinematics->SetV(_kinematicsIndex, v, _ellipse.GetEA(), _ellipse.GetEB());
+        }
         //save the last values for the records
         _lastVelocites.push(v);
 
@@ -308,6 +327,41 @@ void Pedestrian::SetV0Norm(
     _EscalatorDownStairs       = escalatorDown;
     _V0IdleEscalatorUpStairs   = v0IdleEscalatorUp;
     _V0IdleEscalatorDownStairs = v0IdleEscalatorDown;
+    if(_kinematics) {
+        WriteKinematics();
+    }
+}
+
+void Pedestrian::AttachKinematics(PedestrianKinematics * kinematics, std::size_t index)
+{
+    _kinematics      = kinematics;
+    _kinematicsIndex = index;
+    if(_kinematics) {
+        WriteKinematics();
+    }
+}
+
+void Pedestrian::SetKinematicsIndex(std::size_t index)
+{
+    _kinematicsIndex = index;
+}
+
+std::size_t Pedestrian::GetKinematicsIndex() const
+{
+    return _kinematicsIndex;
+}
+
+void Pedestrian::WriteKinematics() const
+{
+    _kinematics->SetPos(_kinematicsIndex, _ellipse.GetCenter());
+    _kinematics->SetV(_kinematicsIndex, _ellipse.GetV(), _ellipse.GetEA(), _ellipse.GetEB());
+    _kinematics->SetShape(
+        _kinematicsIndex,
+        _ellipse.GetV0(),
+        _ellipse.GetEA(),
+        _ellipse.GetEB(),
+        _ellipse.GetBmax());
+    _kinematics->SetLocation(_kinematicsIndex, _roomID, _subRoomID, _subRoomUID);
 }
 
 
@@ -1229,41 +1283,30 @@ int Pedestrian::GetColor() const
 
 bool Pedestrian::Relocate(std::function<void(const Pedestrian &)> flowupdater)
 {
-    auto allRooms = _building->GetAllRooms();
-    bool status   = false;
-    for(auto & it_room : allRooms) {
-        auto & room                                           = it_room.second;
-        auto subrooms                                         = room->GetAllSubRooms();
-        std::map<int, std::shared_ptr<SubRoom>>::iterator sub = std::find_if(
-            subrooms.begin(),
-            subrooms.end(),
-            [&](std::pair<int, std::shared_ptr<SubRoom>> iterator) {
-                return (
-                    (iterator.second->IsDirectlyConnectedWith(
-                        allRooms[_roomID]->GetSubRoom(_subRoomID))) &&
-                    iterator.second->IsInSubRoom(this));
-            });
-        if(sub != subrooms.end()) {
-            flowupdater(
-                *this); //@todo: ar.graf : this call should move into a critical region? check plz
-            ClearMentalMap(); // reset the destination
-            const int oldRoomID = _roomID;
-            SetRoomID(room->GetID(), room->GetCaption());
-            SetSubRoomID(sub->second->GetSubRoomID());
-            SetSubRoomUID(sub->second->GetUID());
-            _router->FindExit(this);
-            if(oldRoomID != room->GetID()) {
-                //the agent left the old room
-                //actualize the egress time for that room
+    SubRoom * oldSubRoom = _building->GetRoom(_roomID)->GetSubRoom(_subRoomID);
+    SubRoom * sub =
+        _building->FindSubRoom(GetPos(), GetElevation(), [oldSubRoom](SubRoom * candidate) {
+            return candidate->IsDirectlyConnectedWith(oldSubRoom);
+        });
+    if(!sub) {
+        return false;
+    }
+    Room * room = _building->GetRoom(sub->GetRoomID());
+    flowupdater(*this); //@todo: ar.graf : this call should move into a critical region? check plz
+    ClearMentalMap(); // reset the destination
+    const int oldRoomID = _roomID;
+    SetRoomID(room->GetID(), room->GetCaption());
+    SetSubRoomID(sub->GetSubRoomID());
+    SetSubRoomUID(sub->GetUID());
+    _router->FindExit(this);
+    if(oldRoomID != room->GetID()) {
+        //the agent left the old room
+        //actualize the egress time for that room
 #pragma omp critical(SetEgressTime)
-                allRooms.at(oldRoomID)->SetEgressTime(
-                    GetGlobalTime()); //set Egresstime to old room //@todo: ar.graf : GetRoomID() yields NEW room
-            }
-            status = true;
-            break;
-        }
+        _building->GetRoom(oldRoomID)->SetEgressTime(
+            GetGlobalTime()); //set Egresstime to old room //@todo: ar.graf : GetRoomID() yields NEW room
     }
-    return status;
+    return true;
 }
 
 int Pedestrian::GetLastGoalID() const
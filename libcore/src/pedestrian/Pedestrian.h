@@ -45,6 +45,7 @@ class NavLine;
 class Router;
 class Knowledge;
 class WalkingSpeed;
+class PedestrianKinematics;
 class Pedestrian
 {
 private:
@@ -148,6 +149,12 @@ private:
     bool _waiting    = false;
     Point _waitingPos;
 
+    /// contiguous copy of the kinematic state, owned by the building
+    PedestrianKinematics * _kinematics = nullptr;
+    std::size_t _kinematicsIndex       = 0;
+
+    void WriteKinematics() const;
+
 public:
     // public member
     int _ticksInThisRoom;
@@ -197,6 +204,16 @@ public:
         double v0IdleEscalatorUp,
         double v0IdleEscalatorDown);
     void SetSmoothTurning(); // activate the smooth turning with a delay of 2 sec
+
+    /**
+      * Connect the pedestrian to the entry index of the kinematics store and
+      * copy the current state there. All setters of position, velocity,
+      * shape and location write through to the store afterwards.
+      * @param kinematics the store, nullptr detaches the pedestrian
+      */
+    void AttachKinematics(PedestrianKinematics * kinematics, std::size_t index);
+    void SetKinematicsIndex(std::size_t index);
+    std::size_t GetKinematicsIndex() const;
     void SetPhiPed();
     void SetFinalDestination(int UID);
     void SetTrip(const std::vector<int> & trip);
@@ -0,0 +1,82 @@
+/**
+ * \file        PedestrianKinematics.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "PedestrianKinematics.h"
+
+#include "Pedestrian.h"
+
+std::size_t PedestrianKinematics::Add(Pedestrian * ped)
+{
+    const std::size_t index = _peds.size();
+    _peds.push_back(ped);
+    _x.push_back(0.);
+    _y.push_back(0.);
+    _vx.push_back(0.);
+    _vy.push_back(0.);
+    _v0.push_back(0.);
+    _ea.push_back(0.);
+    _eb.push_back(0.);
+    _bmax.push_back(0.);
+    _roomID.push_back(-1);
+    _subRoomID.push_back(-1);
+    _subRoomUID.push_back(-1);
+    ped->AttachKinematics(this, index);
+    return index;
+}
+
+void PedestrianKinematics::Remove(std::size_t index)
+{
+    _peds[index]->AttachKinematics(nullptr, 0);
+    _peds.erase(_peds.begin() + index);
+    _x.erase(_x.begin() + index);
+    _y.erase(_y.begin() + index);
+    _vx.erase(_vx.begin() + index);
+    _vy.erase(_vy.begin() + index);
+    _v0.erase(_v0.begin() + index);
+    _ea.erase(_ea.begin() + index);
+    _eb.erase(_eb.begin() + index);
+    _bmax.erase(_bmax.begin() + index);
+    _roomID.erase(_roomID.begin() + index);
+    _subRoomID.erase(_subRoomID.begin() + index);
+    _subRoomUID.erase(_subRoomUID.begin() + index);
+    for(std::size_t i = index; i < _peds.size(); ++i) {
+        _peds[i]->SetKinematicsIndex(i);
+    }
+}
+
+void PedestrianKinematics::Clear()
+{
+    for(auto * ped : _peds) {
+        ped->AttachKinematics(nullptr, 0);
+    }
+    _peds.clear();
+    _x.clear();
+    _y.clear();
+    _vx.clear();
+    _vy.clear();
+    _v0.clear();
+    _ea.clear();
+    _eb.clear();
+    _bmax.clear();
+    _roomID.clear();
+    _subRoomID.clear();
+    _subRoomUID.clear();
+}
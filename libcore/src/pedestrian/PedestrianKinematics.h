@@ -0,0 +1,129 @@
+/**
+ * \file        PedestrianKinematics.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Structure of arrays with the kinematic state of all pedestrians of a
+ * building. The operational models read the state of neighbours from here
+ * instead of following a Pedestrian pointer for every value.
+ *
+ **/
+#pragma once
+
+#include "geometry/Point.h"
+
+#include <cstddef>
+#include <vector>
+
+class Pedestrian;
+
+/*!
+ * \class PedestrianKinematics
+ *
+ * \brief Contiguous position, velocity, desired speed, ellipse axes and
+ * location of all pedestrians in the simulation.
+ *
+ * The entry of a pedestrian has the same index as the pedestrian in
+ * Building::GetAllPedestrians(). The Pedestrian setters write through to
+ * this store, so models only read it directly.
+ */
+class PedestrianKinematics
+{
+public:
+    /**
+      * Append the pedestrian and copy its current state
+      * @return index of the new entry
+      */
+    std::size_t Add(Pedestrian * ped);
+
+    /**
+      * Remove the entry, the following entries move one index down (same
+      * as the erase in Building::DeletePedestrian)
+      */
+    void Remove(std::size_t index);
+
+    /**
+      * Detach all pedestrians and release the memory
+      */
+    void Clear();
+
+    std::size_t Size() const { return _peds.size(); }
+    Pedestrian * GetPedestrian(std::size_t i) const { return _peds[i]; }
+
+    Point GetPos(std::size_t i) const { return Point(_x[i], _y[i]); }
+    Point GetV(std::size_t i) const { return Point(_vx[i], _vy[i]); }
+    double GetV0(std::size_t i) const { return _v0[i]; }
+    double GetEA(std::size_t i) const { return _ea[i]; }
+    double GetEB(std::size_t i) const { return _eb[i]; }
+    double GetBmax(std::size_t i) const { return _bmax[i]; }
+    int GetRoomID(std::size_t i) const { return _roomID[i]; }
+    int GetSubRoomID(std::size_t i) const { return _subRoomID[i]; }
+    int GetSubRoomUID(std::size_t i) const { return _subRoomUID[i]; }
+    int GetUniqueRoomID(std::size_t i) const { return _roomID[i] * 1000 + _subRoomID[i]; }
+
+    /// raw arrays for vectorized kernels
+    const double * GetX() const { return _x.data(); }
+    const double * GetY() const { return _y.data(); }
+    const double * GetVx() const { return _vx.data(); }
+    const double * GetVy() const { return _vy.data(); }
+
+    void SetPos(std::size_t i, const Point & pos)
+    {
+        _x[i] = pos._x;
+        _y[i] = pos._y;
+    }
+
+    /// velocity and the axes of the ellipse, which depend on it
+    void SetV(std::size_t i, const Point & v, double ea, double eb)
+    {
+        _vx[i] = v._x;
+        _vy[i] = v._y;
+        _ea[i] = ea;
+        _eb[i] = eb;
+    }
+
+    void SetShape(std::size_t i, double v0, double ea, double eb, double bmax)
+    {
+        _v0[i]   = v0;
+        _ea[i]   = ea;
+        _eb[i]   = eb;
+        _bmax[i] = bmax;
+    }
+
+    void SetLocation(std::size_t i, int roomID, int subRoomID, int subRoomUID)
+    {
+        _roomID[i]     = roomID;
+        _subRoomID[i]  = subRoomID;
+        _subRoomUID[i] = subRoomUID;
+    }
+
+private:
+    std::vector<Pedestrian *> _peds;
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<double> _vx;
+    std::vector<double> _vy;
+    std::vector<double> _v0;   // desired speed
+    std::vector<double> _ea;   // semi-axis in walking direction
+    std::vector<double> _eb;   // semi-axis in shoulder direction
+    std::vector<double> _bmax; // max. semi-axis in shoulder direction
+    std::vector<int> _roomID;
+    std::vector<int> _subRoomID;
+    std::vector<int> _subRoomUID;
+};
@@ -0,0 +1,248 @@
+/**
+ * \file        DistanceMatrix.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "DistanceMatrix.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+DistanceMatrix::DistanceMatrix(double unreachable, PathConvention convention) :
+    _unreachable(unreachable), _convention(convention)
+{
+}
+
+void DistanceMatrix::Reset(const std::vector<int> & uids)
+{
+    _uids = uids;
+    const std::size_t n = _uids.size();
+
+    _indexOfUID.clear();
+    _minUID = 0;
+    if(n > 0) {
+        const auto [minIt, maxIt] = std::minmax_element(_uids.begin(), _uids.end());
+        _minUID                   = *minIt;
+        _indexOfUID.assign(static_cast<std::size_t>(*maxIt - *minIt) + 1, -1);
+        for(std::size_t i = 0; i < n; ++i) {
+            _indexOfUID[_uids[i] - _minUID] = static_cast<int>(i);
+        }
+    }
+
+    _edges.assign(n, {});
+    _dist.assign(n * n, _unreachable);
+    _path.resize(n * n);
+    for(std::size_t i = 0; i < n; ++i) {
+        _dist[Offset(i, i)] = 0.;
+        for(std::size_t j = 0; j < n; ++j) {
+            _path[Offset(i, j)] =
+                static_cast<int>((_convention == PathConvention::NextHop) ? j : i);
+        }
+    }
+}
+
+void DistanceMatrix::Reset(std::size_t n)
+{
+    std::vector<int> uids(n);
+    std::iota(uids.begin(), uids.end(), 0);
+    Reset(uids);
+}
+
+void DistanceMatrix::Clear()
+{
+    _uids.clear();
+    _uids.shrink_to_fit();
+    _indexOfUID.clear();
+    _indexOfUID.shrink_to_fit();
+    _dist.clear();
+    _dist.shrink_to_fit();
+    _path.clear();
+    _path.shrink_to_fit();
+    _edges.clear();
+    _edges.shrink_to_fit();
+}
+
+void DistanceMatrix::FloydWarshall()
+{
+    for(std::size_t i = 0; i < Size(); ++i) {
+        _edges[i].clear();
+        for(std::size_t j = 0; j < Size(); ++j) {
+            if(i != j && _dist[Offset(i, j)] < _unreachable) {
+                _edges[i].emplace_back(static_cast<int>(j), _dist[Offset(i, j)]);
+            }
+        }
+    }
+
+    const std::size_t nBlocks = (Size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const long long nb        = static_cast<long long>(nBlocks);
+
+    for(std::size_t kb = 0; kb < nBlocks; ++kb) {
+        // phase 1: the tile on the diagonal only depends on itself
+        RelaxBlock(kb, kb, kb);
+
+        // phase 2: tiles in row kb and column kb depend on themselves and on (kb, kb)
+#pragma omp parallel for schedule(dynamic)
+        for(long long b = 0; b < nb; ++b) {
+            const auto blk = static_cast<std::size_t>(b);
+            if(blk == kb) {
+                continue;
+            }
+            RelaxBlock(kb, blk, kb);
+            RelaxBlock(blk, kb, kb);
+        }
+
+        // phase 3: all other tiles only read the (final) row and column tiles
+#pragma omp parallel for schedule(dynamic)
+        for(long long b = 0; b < nb * nb; ++b) {
+            const auto ib = static_cast<std::size_t>(b / nb);
+            const auto jb = static_cast<std::size_t>(b % nb);
+            if(ib == kb || jb == kb) {
+                continue;
+            }
+            RelaxBlock(ib, jb, kb);
+        }
+    }
+}
+
+void DistanceMatrix::RelaxBlock(std::size_t ib, std::size_t jb, std::size_t kb)
+{
+    const std::size_t n      = Size();
+    const std::size_t iBegin = ib * BLOCK_SIZE;
+    const std::size_t iEnd   = std::min(iBegin + BLOCK_SIZE, n);
+    const std::size_t jBegin = jb * BLOCK_SIZE;
+    const std::size_t jEnd   = std::min(jBegin + BLOCK_SIZE, n);
+    const std::size_t kBegin = kb * BLOCK_SIZE;
+    const std::size_t kEnd   = std::min(kBegin + BLOCK_SIZE, n);
+    const bool nextHop       = _convention == PathConvention::NextHop;
+
+    for(std::size_t k = kBegin; k < kEnd; ++k) {
+        const double * rowK   = &_dist[Offset(k, 0)];
+        const int * pathRowK  = &_path[Offset(k, 0)];
+        for(std::size_t i = iBegin; i < iEnd; ++i) {
+            const double distIK = _dist[Offset(i, k)];
+            if(distIK >= _unreachable) {
+                continue;
+            }
+            const int hopIK  = _path[Offset(i, k)];
+            double * rowI    = &_dist[Offset(i, 0)];
+            int * pathRowI   = &_path[Offset(i, 0)];
+            for(std::size_t j = jBegin; j < jEnd; ++j) {
+                const double candidate = distIK + rowK[j];
+                if(candidate < rowI[j]) {
+                    rowI[j]     = candidate;
+                    pathRowI[j] = nextHop ? hopIK : pathRowK[j];
+                }
+            }
+        }
+    }
+}
+
+std::size_t DistanceMatrix::UpdateEdge(int uidFrom, int uidTo, double distance)
+{
+    const std::size_t from = CheckedIndexOf(uidFrom);
+    const std::size_t to   = CheckedIndexOf(uidTo);
+    if(from == to) {
+        return 0;
+    }
+    distance = std::min(distance, _unreachable);
+
+    auto & outEdges = _edges[from];
+    auto edge       = std::find_if(outEdges.begin(), outEdges.end(), [to](const auto & e) {
+        return e.first == static_cast<int>(to);
+    });
+    const double oldDistance = (edge != outEdges.end()) ? edge->second : _unreachable;
+    if(distance == oldDistance) {
+        return 0;
+    }
+
+    // A longer edge can only change rows whose shortest path tree contains
+    // it, i.e. dist(i, from) + old = dist(i, to). A shorter edge can only
+    // change rows for which it shortens the path to 'to'.
+    std::vector<std::size_t> affected;
+    for(std::size_t i = 0; i < Size(); ++i) {
+        const double distIFrom = _dist[Offset(i, from)];
+        const double distITo   = _dist[Offset(i, to)];
+        if(distIFrom >= _unreachable) {
+            continue;
+        }
+        if(distance > oldDistance) {
+            const double tolerance = 1e-9 * std::max(1., distITo);
+            if(oldDistance < _unreachable && distIFrom + oldDistance <= distITo + tolerance) {
+                affected.push_back(i);
+            }
+        } else if(distIFrom + distance < distITo) {
+            affected.push_back(i);
+        }
+    }
+
+    if(distance >= _unreachable) {
+        if(edge != outEdges.end()) {
+            outEdges.erase(edge);
+        }
+    } else if(edge != outEdges.end()) {
+        edge->second = distance;
+    } else {
+        outEdges.emplace_back(static_cast<int>(to), distance);
+    }
+
+    const long long nAffected = static_cast<long long>(affected.size());
+#pragma omp parallel for schedule(dynamic)
+    for(long long r = 0; r < nAffected; ++r) {
+        ComputeRow(affected[r]);
+    }
+    return affected.size();
+}
+
+void DistanceMatrix::ComputeRow(std::size_t source)
+{
+    const std::size_t n = Size();
+    const bool nextHop  = _convention == PathConvention::NextHop;
+    double * dist       = &_dist[Offset(source, 0)];
+    int * path          = &_path[Offset(source, 0)];
+    for(std::size_t j = 0; j < n; ++j) {
+        dist[j] = _unreachable;
+        path[j] = static_cast<int>(nextHop ? j : source);
+    }
+    dist[source] = 0.;
+
+    using Entry = std::pair<double, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> front;
+    front.emplace(0., static_cast<int>(source));
+    while(!front.empty()) {
+        const auto [distU, u] = front.top();
+        front.pop();
+        if(distU > dist[u]) {
+            continue; // outdated entry
+        }
+        for(const auto & [v, length] : _edges[u]) {
+            const double candidate = distU + length;
+            if(candidate < dist[v]) {
+                dist[v] = candidate;
+                if(nextHop) {
+                    path[v] = (u == static_cast<int>(source)) ? v : path[u];
+                } else {
+                    path[v] = u;
+                }
+                front.emplace(candidate, v);
+            }
+        }
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * \file        DistanceMatrix.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Dense all-pairs distance / path matrix over a set of nodes (doors,
+ * access points) identified by their UID. Used by the FF router and the
+ * global router as storage for the Floyd-Warshall algorithm.
+ *
+ **/
+#pragma once
+
+#include <cfloat>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+ * \class DistanceMatrix
+ *
+ * \brief Row major n x n distance and path matrix with a UID -> index lookup.
+ *
+ * Nodes are addressed by their UID, the mapping to the dense index is a flat
+ * lookup table. Distances >= the unreachable value mark missing edges.
+ *
+ * The path matrix is stored either as next hop (path[i][j] is the first node
+ * after i on the shortest path i -> j) or as predecessor (path[i][j] is the
+ * node before j on that path), depending on what the owning router expects.
+ *
+ *\ingroup Router
+ */
+class DistanceMatrix
+{
+public:
+    enum class PathConvention { NextHop, Predecessor };
+
+    /// edge length of the square tiles used by the blocked Floyd-Warshall
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    explicit DistanceMatrix(
+        double unreachable        = DBL_MAX,
+        PathConvention convention = PathConvention::NextHop);
+
+    /**
+      * Resize the matrix to the given nodes. All distances are set to
+      * unreachable, except the diagonal which is 0.
+      * @param uids of all nodes, duplicates are not allowed
+      */
+    void Reset(const std::vector<int> & uids);
+
+    /**
+      * Resize the matrix to n nodes with UIDs 0...n-1
+      */
+    void Reset(std::size_t n);
+
+    /**
+      * Release all memory
+      */
+    void Clear();
+
+    std::size_t Size() const { return _uids.size(); }
+    const std::vector<int> & GetUIDs() const { return _uids; }
+    double GetUnreachable() const { return _unreachable; }
+
+    /**
+      * @return the dense index of the node or -1 if unknown
+      */
+    int IndexOf(int uid) const
+    {
+        const long long offset = static_cast<long long>(uid) - _minUID;
+        if(offset < 0 || offset >= static_cast<long long>(_indexOfUID.size())) {
+            return -1;
+        }
+        return _indexOfUID[offset];
+    }
+
+    bool Contains(int uid) const { return IndexOf(uid) != -1; }
+
+    /**
+      * @return distance between the nodes with the given UIDs
+      * @throws std::out_of_range if a UID is unknown
+      */
+    double GetDistance(int uidFrom, int uidTo) const
+    {
+        return _dist[Offset(CheckedIndexOf(uidFrom), CheckedIndexOf(uidTo))];
+    }
+
+    /**
+      * Set the distance (edge weight) between the nodes with the given UIDs
+      * @throws std::out_of_range if a UID is unknown
+      */
+    void SetDistance(int uidFrom, int uidTo, double distance)
+    {
+        _dist[Offset(CheckedIndexOf(uidFrom), CheckedIndexOf(uidTo))] = distance;
+    }
+
+    bool IsReachable(int uidFrom, int uidTo) const
+    {
+        return GetDistance(uidFrom, uidTo) < _unreachable;
+    }
+
+    /**
+      * @return UID stored in the path matrix for (uidFrom, uidTo), i.e. the
+      * next hop or the predecessor, depending on the path convention
+      * @throws std::out_of_range if a UID is unknown
+      */
+    int GetPath(int uidFrom, int uidTo) const
+    {
+        return _uids[_path[Offset(CheckedIndexOf(uidFrom), CheckedIndexOf(uidTo))]];
+    }
+
+    /**
+      * Find all shortest paths with a single pass of a cache blocked
+      * Floyd-Warshall algorithm. Tiles of one phase are relaxed in parallel.
+      * The distances set before are remembered as edges of the graph for
+      * later calls of UpdateEdge().
+      */
+    void FloydWarshall();
+
+    /**
+      * Change the length of a single edge after FloydWarshall() and repair
+      * the shortest paths. Only the rows (start nodes) whose shortest paths
+      * can be affected by the change are recomputed, each with Dijkstra.
+      * @param distance new edge length, unreachable removes the edge
+      * @return number of recomputed rows
+      * @throws std::out_of_range if a UID is unknown
+      */
+    std::size_t UpdateEdge(int uidFrom, int uidTo, double distance);
+
+private:
+    std::size_t CheckedIndexOf(int uid) const
+    {
+        const int index = IndexOf(uid);
+        if(index == -1) {
+            throw std::out_of_range("DistanceMatrix: unknown UID " + std::to_string(uid));
+        }
+        return index;
+    }
+
+    std::size_t Offset(std::size_t i, std::size_t j) const { return i * _uids.size() + j; }
+
+    /// relax all (i,j) of tile (ib, jb) over the intermediate nodes of tile kb
+    void RelaxBlock(std::size_t ib, std::size_t jb, std::size_t kb);
+
+    /// recompute the row of source from _edges (single source Dijkstra)
+    void ComputeRow(std::size_t source);
+
+    double _unreachable;
+    PathConvention _convention;
+    std::vector<int> _uids;
+    std::vector<int> _indexOfUID;
+    int _minUID = 0;
+    std::vector<double> _dist;
+    std::vector<int> _path;
+    /// adjacency list (index, length) of the graph the matrix was computed from
+    std::vector<std::vector<std::pair<int, double>>> _edges;
+};
@@ -26,6 +26,8 @@
  **/
 #include "RoutingEngine.h"
 
+#include "general/OpenMP.h"
+#include "geometry/Crossing.h"
 #include "pedestrian/Pedestrian.h"
 
 RoutingEngine::RoutingEngine() {}
@@ -111,6 +113,22 @@ bool RoutingEngine::Init(Building * building)
     return status;
 }
 
+std::future<bool>
+RoutingEngine::InitAsync(Building * building, std::map<int, DoorState> doorStates)
+{
+    return std::async(std::launch::async, [this, building, doorStates = std::move(doorStates)]() {
+        //only this thread sees the assumed door states, the parallel loops of the routers must
+        //not pass their work to other threads
+#ifdef _OPENMP
+        omp_set_num_threads(1);
+#endif
+        Crossing::AssumeDoorStates(&doorStates);
+        const bool initialized = Init(building);
+        Crossing::AssumeDoorStates(nullptr);
+        return initialized;
+    });
+}
+
 bool RoutingEngine::NeedsUpdate() const
 {
     return _needUpdate;
@@ -27,7 +27,10 @@
 #pragma once
 
 #include "Router.h"
+#include "general/Macros.h"
 
+#include <future>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -90,6 +93,16 @@ public:
       */
     bool Init(Building * building);
 
+    /**
+      * Initialize all routers in the background, they see the doors in the
+      * given states instead of the current ones. The building is not changed.
+      * The routers are initialized by a single thread.
+      * @param building
+      * @param doorStates state of the doors by unique ID
+      * @return the status of the initialisation
+      */
+    std::future<bool> InitAsync(Building * building, std::map<int, DoorState> doorStates);
+
     /**
       * Returns if routers need to be updated
       * @return routers need to be updated
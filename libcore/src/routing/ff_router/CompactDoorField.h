@@ -0,0 +1,95 @@
+/**
+ * \file        CompactDoorField.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Compact storage of the floor field to one door of UnivFFviaFM, 8 instead
+ * of 24 bytes per grid point. The fields are calculated in double precision
+ * and stored compactly afterwards.
+ *
+ **/
+#pragma once
+
+#include "geometry/Point.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \class CompactDoorField
+ *
+ * \brief Cost field as float, direction field as two int16 components.
+ *
+ * The directions of the floor fields are unit vectors or zero, their
+ * components are stored in steps of 1/32767, i.e. the angle error is below
+ * 1e-4 rad. The relative error of the costs is below 1e-7, the magic numbers
+ * of the cost fields (walls, unknown cost, target) are exact.
+ */
+class CompactDoorField
+{
+public:
+    /**
+      * @param cost field of nPoints values
+      * @param direction field of nPoints values, nullptr if the directions
+      * are not used
+      */
+    CompactDoorField(const double * cost, const Point * direction, long int nPoints) :
+        _cost(cost, cost + nPoints)
+    {
+        if(direction) {
+            _direction.resize(2 * nPoints);
+            for(long int key = 0; key < nPoints; ++key) {
+                _direction[2 * key]     = Quantize(direction[key]._x);
+                _direction[2 * key + 1] = Quantize(direction[key]._y);
+            }
+        }
+    }
+
+    double GetCost(long int key) const { return _cost[key]; }
+
+    /// zero if the directions are not stored
+    Point GetDirection(long int key) const
+    {
+        if(_direction.empty()) {
+            return Point(0., 0.);
+        }
+        return Point(_direction[2 * key] / SCALE, _direction[2 * key + 1] / SCALE);
+    }
+
+    /// bytes per grid point
+    static std::size_t GetPointBytes(bool directions)
+    {
+        return sizeof(float) + (directions ? 2 * sizeof(std::int16_t) : 0);
+    }
+
+private:
+    static constexpr double SCALE = 32767.;
+
+    static std::int16_t Quantize(double component)
+    {
+        return static_cast<std::int16_t>(std::lround(std::clamp(component, -1., 1.) * SCALE));
+    }
+
+    std::vector<float> _cost;
+    /// x and y of the directions, interleaved
+    std::vector<std::int16_t> _direction;
+};
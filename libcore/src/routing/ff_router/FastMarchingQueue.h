@@ -0,0 +1,150 @@
+/**
+ * \file        FastMarchingQueue.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Queues of the trial points of the fast marching method in UnivFFviaFM. The
+ * cost of a grid point does not change after it was pushed, both queues keep
+ * it next to the key instead of reading the cost array on every comparison.
+ *
+ **/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/*!
+ * \class FMHeapQueue
+ *
+ * \brief Binary min heap of the trial points, the exact solver.
+ *
+ * Uses the same heap algorithm as the former
+ * std::priority_queue<long int, std::vector<long int>, CompareCostTrips>, so
+ * the points are popped in the same order, including ties.
+ */
+class FMHeapQueue
+{
+public:
+    void Reserve(std::size_t n) { _heap.reserve(n); }
+    bool Empty() const { return _heap.empty(); }
+
+    void Push(long int key, double cost)
+    {
+        _heap.push_back({cost, key});
+        std::push_heap(_heap.begin(), _heap.end(), Greater);
+    }
+
+    long int Pop()
+    {
+        std::pop_heap(_heap.begin(), _heap.end(), Greater);
+        const long int key = _heap.back().key;
+        _heap.pop_back();
+        return key;
+    }
+
+private:
+    struct TrialPoint {
+        double cost;
+        long int key;
+    };
+
+    static bool Greater(const TrialPoint & a, const TrialPoint & b) { return a.cost > b.cost; }
+
+    std::vector<TrialPoint> _heap;
+};
+
+/*!
+ * \class FMBucketQueue
+ *
+ * \brief Untidy priority queue of the trial points (Yatziv et al. 2006).
+ *
+ * The costs are sorted into buckets of a fixed width, the points of a bucket
+ * are popped first in first out. Push and pop are O(1), the error of the
+ * resulting field is in the order of the bucket width. The buckets form a
+ * ring, which grows if a point is pushed beyond its end.
+ */
+class FMBucketQueue
+{
+public:
+    /// @param width of the buckets, about the cost of one grid step
+    explicit FMBucketQueue(double width) : _width(width), _buckets(64) {}
+
+    bool Empty() const { return _size == 0; }
+
+    void Push(long int key, double cost)
+    {
+        const double bucket = std::max(0., std::floor(cost / _width));
+        if(_size == 0) {
+            // (re)start the ring at the first point
+            _buckets[_current & (_buckets.size() - 1)].clear();
+            _head    = 0;
+            _current = static_cast<std::size_t>(bucket);
+        }
+        // the front may put a point slightly behind the current bucket
+        std::size_t index = _current;
+        if(bucket > static_cast<double>(_current)) {
+            index = static_cast<std::size_t>(bucket);
+        }
+        if(index - _current >= _buckets.size()) {
+            Grow(index - _current + 1);
+        }
+        _buckets[index & (_buckets.size() - 1)].push_back(key);
+        ++_size;
+    }
+
+    long int Pop()
+    {
+        std::vector<long int> * bucket = &_buckets[_current & (_buckets.size() - 1)];
+        while(_head == bucket->size()) {
+            bucket->clear();
+            _head = 0;
+            ++_current;
+            bucket = &_buckets[_current & (_buckets.size() - 1)];
+        }
+        --_size;
+        return (*bucket)[_head++];
+    }
+
+private:
+    /// resize the ring to hold at least n buckets from the current one on
+    void Grow(std::size_t n)
+    {
+        std::size_t size = _buckets.size();
+        while(size < n) {
+            size *= 2;
+        }
+        std::vector<std::vector<long int>> buckets(size);
+        for(std::size_t i = 0; i < _buckets.size(); ++i) {
+            const std::size_t index = _current + i;
+            buckets[index & (size - 1)].swap(_buckets[index & (_buckets.size() - 1)]);
+        }
+        _buckets.swap(buckets);
+    }
+
+    double _width;
+    /// ring of buckets, the size is a power of two
+    std::vector<std::vector<long int>> _buckets;
+    /// absolute number of the bucket popped from
+    std::size_t _current = 0;
+    /// next point to pop in the current bucket
+    std::size_t _head = 0;
+    std::size_t _size = 0;
+};
@@ -0,0 +1,248 @@
+/**
+ * \file        FloorfieldCache.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "FloorfieldCache.h"
+
+#include "general/Format.h"
+#include "general/Logger.h"
+#include "geometry/Building.h"
+#include "geometry/Crossing.h"
+#include "geometry/Obstacle.h"
+#include "geometry/SubRoom.h"
+#include "geometry/Transition.h"
+#include "geometry/Wall.h"
+#include "routing/ff_router/UnivFFviaFM.h"
+#include "routing/ff_router/mesh/RectGrid.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace
+{
+constexpr char MAGIC[8] = {'J', 'P', 'S', 'F', 'F', 'C', '0', '1'};
+
+/// 64 bit FNV-1a hash
+class Hash
+{
+public:
+    template <typename T>
+    void Add(const T & value)
+    {
+        const auto * bytes = reinterpret_cast<const unsigned char *>(&value);
+        for(std::size_t i = 0; i < sizeof(T); ++i) {
+            _value = (_value ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+
+    void AddLine(const Line & line)
+    {
+        Add(line.GetPoint1()._x);
+        Add(line.GetPoint1()._y);
+        Add(line.GetPoint2()._x);
+        Add(line.GetPoint2()._y);
+    }
+
+    std::uint64_t Get() const { return _value; }
+
+private:
+    std::uint64_t _value = 14695981039346656037ULL;
+};
+
+void Write(std::ostream & out, std::int64_t value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+std::int64_t Read(std::istream & in)
+{
+    std::int64_t value = -1;
+    in.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return in ? value : -1;
+}
+
+/// door UIDs with a cost field in ascending order, the file does not depend on
+/// the order the fields were calculated in
+std::vector<int> CachedDoors(UnivFFviaFM & floorfield)
+{
+    std::vector<int> uids = floorfield.getKnownDoorUIDs();
+    std::sort(uids.begin(), uids.end());
+    uids.erase(std::unique(uids.begin(), uids.end()), uids.end());
+    uids.erase(
+        std::remove_if(
+            uids.begin(), uids.end(), [&](int uid) { return !floorfield.getCostField(uid); }),
+        uids.end());
+    return uids;
+}
+} // namespace
+
+FloorfieldCache::FloorfieldCache(
+    const fs::path & directory,
+    const Building & building,
+    const std::vector<double> & parameters)
+{
+    // everything UnivFFviaFM reads from the geometry
+    Hash hash;
+    for(double parameter : parameters) {
+        hash.Add(parameter);
+    }
+    for(const auto & [roomID, room] : building.GetAllRooms()) {
+        hash.Add(roomID);
+        for(const auto & [subroomID, subroom] : room->GetAllSubRooms()) {
+            hash.Add(subroom->GetUID());
+            hash.Add(subroom->GetAllWalls().size());
+            for(const auto & wall : subroom->GetAllWalls()) {
+                hash.AddLine(wall);
+            }
+            hash.Add(subroom->GetAllObstacles().size());
+            for(const Obstacle * obstacle : subroom->GetAllObstacles()) {
+                hash.Add(obstacle->GetAllWalls().size());
+                for(const auto & wall : obstacle->GetAllWalls()) {
+                    hash.AddLine(wall);
+                }
+            }
+            hash.Add(subroom->GetAllCrossings().size());
+            for(const Crossing * crossing : subroom->GetAllCrossings()) {
+                hash.Add(crossing->GetUniqueID());
+                hash.Add(crossing->IsClose());
+                hash.AddLine(*crossing);
+            }
+            hash.Add(subroom->GetAllTransitions().size());
+            for(const Transition * transition : subroom->GetAllTransitions()) {
+                hash.Add(transition->GetUniqueID());
+                hash.Add(transition->IsClose());
+                hash.AddLine(*transition);
+            }
+        }
+    }
+    _key  = hash.Get();
+    _file = directory / fmt::format(check_fmt("ffrouter_{:016x}.bin"), _key);
+}
+
+bool FloorfieldCache::Load(const std::map<int, UnivFFviaFM *> & floorfields) const
+{
+    std::ifstream in(_file, std::ios::binary);
+    if(!in) {
+        return false;
+    }
+    auto corrupt = [this]() {
+        Logging::Warning(fmt::format(
+            check_fmt("Ignoring the floor field cache <{}>, it does not match the geometry"),
+            _file.string()));
+        return false;
+    };
+
+    char magic[sizeof(MAGIC)];
+    in.read(magic, sizeof(magic));
+    if(!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+       static_cast<std::uint64_t>(Read(in)) != _key ||
+       Read(in) != static_cast<std::int64_t>(floorfields.size())) {
+        return corrupt();
+    }
+
+    // check the layout of the whole file before the first field is set, a broken
+    // file leaves the floor fields untouched
+    struct Field {
+        UnivFFviaFM * floorfield;
+        int uid;
+        std::streampos position;
+    };
+    std::vector<Field> fields;
+    for(std::size_t room = 0; room < floorfields.size(); ++room) {
+        const auto floorfield = floorfields.find(static_cast<int>(Read(in)));
+        if(floorfield == floorfields.end()) {
+            return corrupt();
+        }
+        const std::int64_t nPoints = Read(in);
+        const std::int64_t nFields = Read(in);
+        if(nPoints != floorfield->second->getGrid()->GetnPoints() || nFields < 0) {
+            return corrupt();
+        }
+        for(std::int64_t i = 0; i < nFields; ++i) {
+            const int uid = static_cast<int>(Read(in));
+            if(!in || !floorfield->second->acceptsCostField(uid)) {
+                return corrupt();
+            }
+            fields.push_back({floorfield->second, uid, in.tellg()});
+            in.seekg(nPoints * sizeof(double), std::ios::cur);
+        }
+    }
+    std::error_code error;
+    const auto fileSize = fs::file_size(_file, error);
+    if(!in || error || in.tellg() != static_cast<std::streamoff>(fileSize)) {
+        return corrupt();
+    }
+
+    // the fields are read straight into the floor fields
+    for(const Field & field : fields) {
+        const long int nPoints = field.floorfield->getGrid()->GetnPoints();
+        double * cost          = field.floorfield->allocateCostField(field.uid);
+        in.seekg(field.position);
+        in.read(reinterpret_cast<char *>(cost), nPoints * sizeof(double));
+        if(!in) {
+            return corrupt();
+        }
+    }
+    return true;
+}
+
+bool FloorfieldCache::Store(const std::map<int, UnivFFviaFM *> & floorfields) const
+{
+    std::error_code error;
+    fs::create_directories(_file.parent_path(), error);
+
+    // concurrent runs write their own file, the last rename wins
+    fs::path tmpFile = _file;
+    tmpFile += fmt::format(check_fmt(".{:08x}.tmp"), std::random_device{}());
+    {
+        std::ofstream out(tmpFile, std::ios::binary);
+        out.write(MAGIC, sizeof(MAGIC));
+        Write(out, static_cast<std::int64_t>(_key));
+        Write(out, static_cast<std::int64_t>(floorfields.size()));
+        for(const auto & [roomID, floorfield] : floorfields) {
+            const std::vector<int> uids = CachedDoors(*floorfield);
+            const std::int64_t nPoints  = floorfield->getGrid()->GetnPoints();
+            Write(out, roomID);
+            Write(out, nPoints);
+            Write(out, static_cast<std::int64_t>(uids.size()));
+            for(int uid : uids) {
+                Write(out, uid);
+                out.write(
+                    reinterpret_cast<const char *>(floorfield->getCostField(uid)),
+                    nPoints * sizeof(double));
+            }
+        }
+        out.close();
+        if(!out) {
+            fs::remove(tmpFile, error);
+            return false;
+        }
+    }
+    fs::rename(tmpFile, _file, error);
+    if(error) {
+        fs::remove(tmpFile, error);
+        return false;
+    }
+    return true;
+}
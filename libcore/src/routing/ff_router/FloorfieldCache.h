@@ -0,0 +1,90 @@
+/**
+ * \file        FloorfieldCache.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * File cache of the door floor fields the ff router calculates in every room.
+ * Runs on the same geometry with the same floor field parameters, e.g. the
+ * seeds of a Monte Carlo study, read them instead of recalculating them.
+ *
+ **/
+#pragma once
+
+#include "general/Filesystem.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class Building;
+class UnivFFviaFM;
+
+/*!
+ * \class FloorfieldCache
+ *
+ * \brief Stores and loads the cost fields to the doors of UnivFFviaFM objects.
+ *
+ * The file name is a hash of the geometry the floor fields see (walls,
+ * obstacles, doors and their state) and of the floor field parameters, a
+ * changed geometry or parameter uses a different file. The file holds the
+ * raw cost arrays, 8 byte aligned:
+ *
+ *     "JPSFFC01" key #rooms
+ *     per room:  id #points #fields
+ *     per field: door UID, #points doubles
+ *
+ * Only fields with DISTANCE_MEASUREMENTS_ONLY can be cached, directions are
+ * not stored.
+ */
+class FloorfieldCache
+{
+public:
+    /**
+      * @param directory of the cache files
+      * @param building the floor fields are calculated in
+      * @param parameters of the floor fields that change the result, e.g. the
+      * grid spacing and the speed mode
+      */
+    FloorfieldCache(
+        const fs::path & directory,
+        const Building & building,
+        const std::vector<double> & parameters);
+
+    std::uint64_t GetKey() const { return _key; }
+    const fs::path & GetFile() const { return _file; }
+
+    /**
+      * Sets the cost fields of the given floor fields (room id -> field) from
+      * the cache file. The floor fields are not changed if the file is missing
+      * or does not match them.
+      * @return true if all cost fields were read
+      */
+    bool Load(const std::map<int, UnivFFviaFM *> & floorfields) const;
+
+    /**
+      * Writes the cost fields of the given floor fields to the cache file,
+      * replaces an existing file atomically.
+      * @return true on success
+      */
+    bool Store(const std::map<int, UnivFFviaFM *> & floorfields) const;
+
+private:
+    std::uint64_t _key;
+    fs::path _file;
+};
@@ -0,0 +1,89 @@
+/**
+ * \file        FloorfieldStore.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "FloorfieldStore.h"
+
+#include "geometry/Crossing.h"
+#include "geometry/Room.h"
+#include "geometry/SubRoom.h"
+#include "geometry/Transition.h"
+
+#include <algorithm>
+
+std::shared_ptr<UnivFFviaFM> FloorfieldStore::Find(const Room & room) const
+{
+    const Key key = GetKey(room);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found    = _floorfields.find(key);
+    if(found == _floorfields.end()) {
+        return nullptr;
+    }
+    return found->second.lock();
+}
+
+void FloorfieldStore::Insert(const Room & room, const std::shared_ptr<UnivFFviaFM> & floorfield)
+{
+    const Key key = GetKey(room);
+    std::lock_guard<std::mutex> lock(_mutex);
+    //forget the floor fields no router uses any more
+    for(auto it = _floorfields.begin(); it != _floorfields.end();) {
+        it = it->second.expired() ? _floorfields.erase(it) : std::next(it);
+    }
+    _floorfields[key] = floorfield;
+}
+
+void FloorfieldStore::Remove(const UnivFFviaFM * floorfield)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(auto it = _floorfields.begin(); it != _floorfields.end();) {
+        auto shared = it->second.lock();
+        it = (!shared || shared.get() == floorfield) ? _floorfields.erase(it) : std::next(it);
+    }
+}
+
+std::size_t FloorfieldStore::GetnFloorfields() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::count_if(_floorfields.begin(), _floorfields.end(), [](const auto & entry) {
+        return !entry.second.expired();
+    });
+}
+
+FloorfieldStore::Key FloorfieldStore::GetKey(const Room & room)
+{
+    //the floor field of a room sees the doors of all its subrooms, see UnivFFviaFM
+    Key key{room.GetID(), {}};
+    for(const auto & [id, subroom] : room.GetAllSubRooms()) {
+        for(const Crossing * crossing : subroom->GetAllCrossings()) {
+            if(crossing->IsClose()) {
+                key.second.push_back(crossing->GetUniqueID());
+            }
+        }
+        for(const Transition * transition : subroom->GetAllTransitions()) {
+            if(transition->IsClose()) {
+                key.second.push_back(transition->GetUniqueID());
+            }
+        }
+    }
+    std::sort(key.second.begin(), key.second.end());
+    key.second.erase(std::unique(key.second.begin(), key.second.end()), key.second.end());
+    return key;
+}
@@ -0,0 +1,77 @@
+/**
+ * \file        FloorfieldStore.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Room floor fields shared by the ff routers of the routing engines the event
+ * manager creates for different door states. Most door states differ in a few
+ * doors, the rooms without a changed door use the same floor field.
+ *
+ **/
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class Room;
+class UnivFFviaFM;
+
+/*!
+ * \class FloorfieldStore
+ *
+ * \brief Floor fields of rooms by room and closed doors, reference counted.
+ *
+ * The floor field of a room depends on its geometry and on which of its doors
+ * are closed (closed doors are walls). The store only holds weak references,
+ * a floor field is freed with the last router that uses it. Routers that
+ * change their floor fields (e.g. the speeds in quickest mode) must Remove()
+ * them first. Routers initialized in other threads may use the store at the
+ * same time.
+ */
+class FloorfieldStore
+{
+public:
+    /**
+      * @return floor field of room with its current door states, nullptr if
+      * no router holds one
+      */
+    std::shared_ptr<UnivFFviaFM> Find(const Room & room) const;
+
+    /// shares floorfield of room with its current door states
+    void Insert(const Room & room, const std::shared_ptr<UnivFFviaFM> & floorfield);
+
+    /// stops sharing floorfield
+    void Remove(const UnivFFviaFM * floorfield);
+
+    /// number of floor fields in use
+    std::size_t GetnFloorfields() const;
+
+private:
+    /// room ID and UIDs of its closed doors
+    using Key = std::pair<int, std::vector<int>>;
+
+    static Key GetKey(const Room & room);
+
+    mutable std::mutex _mutex;
+    std::map<Key, std::weak_ptr<UnivFFviaFM>> _floorfields;
+};
@@ -0,0 +1,161 @@
+/**
+ * \file        MultiLevelDoorField.cpp
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "MultiLevelDoorField.h"
+
+#include "general/Macros.h"
+#include "routing/ff_router/mesh/RectGrid.h"
+
+#include <utility>
+
+FloorfieldLevels::FloorfieldLevels(
+    const RectGrid & grid,
+    const int * gridCode,
+    SubRoom * const * subrooms,
+    const double * speed,
+    int blockSize) :
+    _iMax(grid.GetiMax()),
+    _jMax(grid.GetjMax()),
+    _hx(grid.Gethx()),
+    _hy(grid.Gethy()),
+    _blockSize(blockSize)
+{
+    //blocks at the upper and right border may be cut off, they are never open
+    _iBlocks = (_iMax - 1) / _blockSize;
+    _jBlocks = (_jMax - 1) / _blockSize;
+    _state.assign(_iBlocks * _jBlocks, REFINED);
+    _speed.assign(_iBlocks * _jBlocks, 0.);
+    for(long int jBlock = 0; jBlock < _jBlocks; ++jBlock) {
+        for(long int iBlock = 0; iBlock < _iBlocks; ++iBlock) {
+            const long int first = (jBlock * _iMax + iBlock) * _blockSize;
+            bool open            = true;
+            bool outside         = true;
+            for(long int j = 0; j <= _blockSize; ++j) {
+                for(long int i = 0; i <= _blockSize; ++i) {
+                    const long int key = first + j * _iMax + i;
+                    open = open && (gridCode[key] == INSIDE) &&
+                           (subrooms[key] == subrooms[first]) && (speed[key] == speed[first]);
+                    outside = outside && (gridCode[key] == OUTSIDE);
+                }
+            }
+            const long int block = jBlock * _iBlocks + iBlock;
+            _state[block]        = open ? OPEN : (outside ? OUTSIDE_ONLY : REFINED);
+            _speed[block]        = open ? speed[first] : 0.;
+        }
+    }
+
+    //grid points of refined blocks and on the border of open blocks are nodes
+    _node.assign(_iMax * _jMax, EMPTY);
+    for(long int j = 0; j < _jMax; ++j) {
+        for(long int i = 0; i < _iMax; ++i) {
+            const bool iBorder = (i % _blockSize == 0);
+            const bool jBorder = (j % _blockSize == 0);
+            bool refined       = false;
+            bool open          = false;
+            for(long int jBlock = j / _blockSize - (jBorder ? 1 : 0); jBlock <= j / _blockSize;
+                ++jBlock) {
+                for(long int iBlock = i / _blockSize - (iBorder ? 1 : 0);
+                    iBlock <= i / _blockSize;
+                    ++iBlock) {
+                    const BlockState state = GetState(iBlock, jBlock);
+                    refined                = refined || (state == REFINED);
+                    open                   = open || (state == OPEN);
+                }
+            }
+            const long int key = j * _iMax + i;
+            if(refined || (open && (iBorder || jBorder))) {
+                _node[key] = static_cast<std::int32_t>(_nNodes++);
+            } else if(open) {
+                _node[key] = INSIDE_BLOCK;
+            }
+        }
+    }
+}
+
+Point FloorfieldLevels::GetVector(long int from, long int to) const
+{
+    return Point((to % _iMax - from % _iMax) * _hx, (to / _iMax - from / _iMax) * _hy);
+}
+
+double FloorfieldLevels::GetTime(long int iBlock, long int jBlock, long int key1, long int key2)
+    const
+{
+    return GetVector(key1, key2).Norm() / _speed[jBlock * _iBlocks + iBlock];
+}
+
+MultiLevelDoorField::MultiLevelDoorField(
+    std::shared_ptr<const FloorfieldLevels> levels,
+    const double * cost,
+    const Point * direction) :
+    _levels(std::move(levels))
+{
+    _cost.resize(_levels->GetnNodes());
+    if(direction) {
+        _direction.resize(_levels->GetnNodes());
+    }
+    const long int nPoints = _levels->GetnPoints();
+    for(long int key = 0; key < nPoints; ++key) {
+        const long int node = _levels->GetNode(key);
+        if(node < 0) {
+            continue;
+        }
+        _cost[node] = cost[key];
+        if(direction) {
+            _direction[node] = direction[key];
+        }
+    }
+}
+
+double MultiLevelDoorField::GetCost(long int key) const
+{
+    const long int node = _levels->GetNode(key);
+    if(node >= 0) {
+        return _cost[node];
+    }
+    long int borderKey = -1;
+    if(node == FloorfieldLevels::INSIDE_BLOCK) {
+        const double cost = _levels->GetInsideCost(
+            key, [this](long int border) { return _cost[_levels->GetNode(border)]; }, borderKey);
+        if(borderKey >= 0) {
+            return cost;
+        }
+    }
+    return magicnum(UNKNOWN_COST);
+}
+
+Point MultiLevelDoorField::GetDirection(long int key) const
+{
+    const long int node = _levels->GetNode(key);
+    if(node >= 0) {
+        return _direction.empty() ? Point(0., 0.) : _direction[node];
+    }
+    if(node != FloorfieldLevels::INSIDE_BLOCK || _direction.empty()) {
+        return Point(0., 0.);
+    }
+    //the neighbours of a grid point inside of an open block are inside or on its border
+    const long int iMax = _levels->GetiMax();
+    const double dx     = (GetCost(key + 1) - GetCost(key - 1)) / (2. * _levels->Gethx());
+    const double dy     = (GetCost(key + iMax) - GetCost(key - iMax)) / (2. * _levels->Gethy());
+    if(GetCost(key) < 0.) {
+        return Point(0., 0.);
+    }
+    return Point(-dx, -dy).Normalized();
+}
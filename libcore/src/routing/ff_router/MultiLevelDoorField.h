@@ -0,0 +1,204 @@
+/**
+ * \file        MultiLevelDoorField.h
+ * \copyright   <2009-2022> Forschungszentrum Jülich GmbH. All rights reserved.
+ *
+ * \section License
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section Description
+ * Two grid levels of the door fields of UnivFFviaFM for large rooms: the grid
+ * is divided into square blocks, blocks in open space keep the grid points on
+ * their border only, blocks near walls, doors and subroom borders keep every
+ * grid point.
+ *
+ **/
+#pragma once
+
+#include "geometry/Point.h"
+
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class RectGrid;
+class SubRoom;
+
+/*!
+ * \class FloorfieldLevels
+ *
+ * \brief Nodes of the two grid levels of one room.
+ *
+ * A block of blockSize x blockSize cells is open if all its grid points,
+ * including its border, are INSIDE the same subroom and have the same speed,
+ * and empty if they are all OUTSIDE. The nodes are the grid points of the
+ * other blocks (fine level) and the border of the open blocks (coarse level).
+ * Nothing blocks the way across an open block, the cost of a grid point inside
+ * is the minimum of cost + distance / speed over the border of its block.
+ */
+class FloorfieldLevels
+{
+public:
+    /**
+      * @param grid of the floor field
+      * @param gridCode of the grid points, see GridCode
+      * @param subrooms of the grid points
+      * @param speed of the grid points used by the fast marching
+      * @param blockSize grid cells per block side, at least 2
+      */
+    FloorfieldLevels(
+        const RectGrid & grid,
+        const int * gridCode,
+        SubRoom * const * subrooms,
+        const double * speed,
+        int blockSize);
+
+    static constexpr long int INSIDE_BLOCK = -1;
+    static constexpr long int EMPTY        = -2;
+
+    int GetBlockSize() const { return _blockSize; }
+    long int GetiMax() const { return _iMax; }
+    double Gethx() const { return _hx; }
+    double Gethy() const { return _hy; }
+    long int GetnNodes() const { return _nNodes; }
+    long int GetnPoints() const { return _iMax * _jMax; }
+
+    /// index of grid point key in the door fields, INSIDE_BLOCK or EMPTY if it has none
+    long int GetNode(long int key) const { return _node[key]; }
+
+    /// false for blocks outside of the grid
+    bool IsOpen(long int iBlock, long int jBlock) const
+    {
+        return GetState(iBlock, jBlock) == OPEN;
+    }
+
+    /// vector from grid point from to grid point to
+    Point GetVector(long int from, long int to) const;
+
+    /// time to walk straight from grid point key1 to key2 in open block (iBlock, jBlock)
+    double GetTime(long int iBlock, long int jBlock, long int key1, long int key2) const;
+
+    /**
+      * calls visit(key) for the grid points on the border of open block
+      * (iBlock, jBlock), counter clockwise from the lower left corner
+      */
+    template <typename Visit>
+    void VisitBorder(long int iBlock, long int jBlock, Visit visit) const
+    {
+        const long int first = (jBlock * _iMax + iBlock) * _blockSize;
+        const long int up    = _blockSize * _iMax;
+        for(long int m = 0; m < _blockSize; ++m) {
+            visit(first + m);
+            visit(first + _blockSize + m * _iMax);
+            visit(first + up + _blockSize - m);
+            visit(first + up - m * _iMax);
+        }
+    }
+
+    /**
+      * cost of a grid point inside of an open block
+      * @param key of the grid point, GetNode(key) == INSIDE_BLOCK
+      * @param costOf(borderKey) cost of a grid point on the border of the block
+      * @param borderKey grid point on the border the cost comes from, -1 if
+      * no grid point on the border has a cost
+      * @return minimum of cost + time over the border of the block
+      */
+    template <typename CostOf>
+    double GetInsideCost(long int key, CostOf costOf, long int & borderKey) const
+    {
+        const long int iBlock = (key % _iMax) / _blockSize;
+        const long int jBlock = (key / _iMax) / _blockSize;
+        double result         = DBL_MAX;
+        borderKey             = -1;
+        VisitBorder(iBlock, jBlock, [&](long int border) {
+            const double borderCost = costOf(border);
+            if(borderCost < 0.) {
+                return;
+            }
+            const double candidate = borderCost + GetTime(iBlock, jBlock, border, key);
+            if(candidate < result) {
+                result    = candidate;
+                borderKey = border;
+            }
+        });
+        return result;
+    }
+
+private:
+    enum BlockState : char { REFINED, OPEN, OUTSIDE_ONLY };
+
+    /// blocks at the upper and right border which are cut off are refined
+    BlockState GetState(long int iBlock, long int jBlock) const
+    {
+        if(iBlock < 0 || jBlock < 0 || iBlock >= _iBlocks || jBlock >= _jBlocks) {
+            return REFINED;
+        }
+        return _state[jBlock * _iBlocks + iBlock];
+    }
+
+    long int _iMax;
+    long int _jMax;
+    double _hx;
+    double _hy;
+    int _blockSize;
+    long int _iBlocks;
+    long int _jBlocks;
+    std::vector<BlockState> _state;
+    /// speed in the open blocks
+    std::vector<double> _speed;
+    std::vector<std::int32_t> _node;
+    long int _nNodes = 0;
+};
+
+/*!
+ * \class MultiLevelDoorField
+ *
+ * \brief Cost and direction field to one door at the nodes of FloorfieldLevels.
+ *
+ * Inside of an open block the direction is the negative gradient of the cost,
+ * by central differences of the neighbouring grid points.
+ */
+class MultiLevelDoorField
+{
+public:
+    /**
+      * @param levels of the room, shared with the other door fields
+      * @param cost field of all grid points, only the nodes are read
+      * @param direction field of all grid points, nullptr if the directions
+      * are not used
+      */
+    MultiLevelDoorField(
+        std::shared_ptr<const FloorfieldLevels> levels,
+        const double * cost,
+        const Point * direction);
+
+    double GetCost(long int key) const;
+
+    /// zero if the directions are not stored
+    Point GetDirection(long int key) const;
+
+    /// bytes per node
+    static std::size_t GetNodeBytes(bool directions)
+    {
+        return sizeof(double) + (directions ? sizeof(Point) : 0);
+    }
+
+private:
+    std::shared_ptr<const FloorfieldLevels> _levels;
+    std::vector<double> _cost;
+    std::vector<Point> _direction;
+};
@@ -11,8 +11,11 @@
 #include "geometry/SubRoom.h"
 #include "geometry/Wall.h"
 #include "pedestrian/Pedestrian.h"
+#include "routing/ff_router/FastMarchingQueue.h"
 #include "routing/ff_router/mesh/RectGrid.h"
 
+#include <algorithm>
+#include <cmath>
 #include <unordered_set>
 
 UnivFFviaFM::~UnivFFviaFM()
@@ -88,6 +91,11 @@ UnivFFviaFM::UnivFFviaFM(
     _configuration = confArg;
     _scope         = FF_ROOM_SCALE;
     _room          = roomArg->GetID();
+    if(confArg) {
+        _fmQueue = confArg->get_fm_queue();
+        _storage   = confArg->get_ff_storage();
+        _blockSize = confArg->get_ff_block_size();
+    }
     std::vector<Line> lines;
     std::map<int, Line> tmpDoors;
     Line anyDoor = Line{};
@@ -191,6 +199,11 @@ UnivFFviaFM::UnivFFviaFM(
     _configuration = confArg;
     _scope         = FF_SUBROOM_SCALE;
     _room          = subRoomArg->GetRoomID();
+    if(confArg) {
+        _fmQueue = confArg->get_fm_queue();
+        _storage   = confArg->get_ff_storage();
+        _blockSize = confArg->get_ff_block_size();
+    }
     std::vector<Line> lines;
     std::map<int, Line> tmpDoors;
 
@@ -506,8 +519,21 @@ void UnivFFviaFM::createReduWallSpeed(double * reduWallSpeed)
 
 void UnivFFviaFM::recreateAllForQuickest()
 {
-    //allocate if neccessary (should not be!)
+    if(_lazy) {
+        //the fields are recalculated with the new speed on their next use
+        clearLazyFields();
+        _levels.reset();
+        return;
+    }
+    //allocate if neccessary (should not be!), compact and multilevel fields are calculated into
+    //temporary arrays, the levels are rebuilt with the new speed
+    _levels.reset();
     for(int doorUID : _uids) {
+        if(_storage != FF_STORAGE_DOUBLE) {
+            _costFieldWithKey[doorUID]      = nullptr;
+            _directionFieldWithKey[doorUID] = nullptr;
+            continue;
+        }
         if(!_costFieldWithKey[doorUID]) {
             _costFieldWithKey[doorUID] = new double[_nPoints];
         }
@@ -1043,87 +1069,62 @@ void UnivFFviaFM::drawLinesOnWall(Line & line, T * const target, const T value)
     }
 } //drawLinesOnWall
 
-void UnivFFviaFM::calcFF(double * costOutput, Point * directionOutput, const double * const speed)
+template <typename Update>
+void UnivFFviaFM::marchFront(double * costOutput, const double * const speed, Update update)
 {
-    //CompareCostTrips comp = CompareCostTrips(costOutput);
-    std::priority_queue<long int, std::vector<long int>, CompareCostTrips> trialfield(
-        costOutput); //pass the argument for the constr of CompareCostTrips
-    //std::priority_queue<long int, std::vector<long int>, CompareCostTrips> trialfield2(comp);      //pass the CompareCostTrips object directly
-
-    directNeighbor local_neighbor = _grid->getNeighbors(0);
-    long int aux                  = 0;
-    //init trial field
-    for(long int i = 0; i < _nPoints; ++i) {
-        if(costOutput[i] == 0.0) {
-            //check for negative neighbours, calc that ones and add to queue trialfield
-            local_neighbor = _grid->getNeighbors(i);
-
-            //check for valid neigh
-            aux = local_neighbor.key[0];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[1];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[2];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
+    if(_fmQueue == FM_QUEUE_BUCKET) {
+        //bucket width: smallest cost increase of a two sided update
+        double maxSpeed = 0.;
+        for(long int i = 0; i < _nPoints; ++i) {
+            if((_gridCode[i] != WALL) && (_gridCode[i] != OUTSIDE)) {
+                maxSpeed = std::max(maxSpeed, speed[i]);
             }
-            aux = local_neighbor.key[3];
+        }
+        double width = std::min(_grid->Gethx(), _grid->Gethy()) / (std::sqrt(2.) * maxSpeed);
+        if(!std::isfinite(width) || width <= 0.) {
+            width = _grid->Gethx();
+        }
+        FMBucketQueue trialfield(width);
+        marchFront(trialfield, costOutput, update);
+    } else {
+        FMHeapQueue trialfield;
+        trialfield.Reserve(static_cast<std::size_t>(_nPoints));
+        marchFront(trialfield, costOutput, update);
+    }
+}
+
+template <typename Queue, typename Update>
+void UnivFFviaFM::marchFront(Queue & trialfield, double * costOutput, Update update)
+{
+    //calc the unknown neighbours of key and add them to the queue trialfield
+    auto expand = [&](long int key) {
+        const directNeighbor local_neighbor = _grid->getNeighbors(key);
+        for(long int aux : local_neighbor.key) {
             if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
                (costOutput[aux] < 0.0)) {
-                calcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
+                update(aux);
+                trialfield.Push(aux, costOutput[aux]);
             }
         }
-    }
-
-    while(!trialfield.empty()) {
-        local_neighbor = _grid->getNeighbors(trialfield.top());
-        trialfield.pop();
+    };
 
-        //check for valid neigh
-        aux = local_neighbor.key[0];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[1];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[2];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[3];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
+    //init trial field
+    for(long int i = 0; i < _nPoints; ++i) {
+        if(costOutput[i] == 0.0) {
+            expand(i);
         }
     }
+
+    while(!trialfield.Empty()) {
+        expand(trialfield.Pop());
+    }
+}
+
+void UnivFFviaFM::calcFF(double * costOutput, Point * directionOutput, const double * const speed)
+{
+    marchFront(costOutput, speed, [&](long int key) {
+        calcCost(key, costOutput, directionOutput, speed);
+    });
 }
 
 void UnivFFviaFM::calcCost(
@@ -1251,89 +1252,201 @@ void UnivFFviaFM::calcCost(
     dir[key] = dir[key].Normalized();
 }
 
-void UnivFFviaFM::calcDF(double * costOutput, Point * directionOutput, const double * const speed)
+//fast marching on the nodes of levels: neighbours are one grid cell apart, except across an open
+//block, where a grid point on its border is reached straight from every other grid point on the
+//border. Other than calcFF, trial points are updated again if another neighbour becomes known.
+void UnivFFviaFM::calcFFMultiLevel(
+    const FloorfieldLevels & levels,
+    double * cost,
+    Point * dir,
+    const double * const speed)
 {
-    //CompareCostTrips comp = CompareCostTrips(costOutput);
-    std::priority_queue<long int, std::vector<long int>, CompareCostTrips> trialfield(
-        costOutput); //pass the argument for the constr of CompareCostTrips
-    //std::priority_queue<long int, std::vector<long int>, CompareCostTrips> trialfield2(comp);      //pass the CompareCostTrips object directly
+    const long int iMax = _grid->GetiMax();
+    const long int jMax = _grid->GetjMax();
+    const long int k    = levels.GetBlockSize();
+    std::vector<char> known(_nPoints, 0);
+    FMHeapQueue trialfield;
+
+    auto forOpenBlocks = [&](long int key, auto visit) {
+        const long int i = key % iMax;
+        const long int j = key / iMax;
+        for(long int jBlock = j / k - ((j % k == 0) ? 1 : 0); jBlock <= j / k; ++jBlock) {
+            for(long int iBlock = i / k - ((i % k == 0) ? 1 : 0); iBlock <= i / k; ++iBlock) {
+                if(levels.IsOpen(iBlock, jBlock)) {
+                    visit(iBlock, jBlock);
+                }
+            }
+        }
+    };
 
-    directNeighbor local_neighbor = _grid->getNeighbors(0);
-    long int aux                  = 0;
-    //init trial field
-    for(long int i = 0; i < _nPoints; ++i) {
-        if(costOutput[i] == 0.0) {
-            //check for negative neighbours, calc that ones and add to queue trialfield
-            local_neighbor = _grid->getNeighbors(i);
+    auto improve = [&](long int key, double value) {
+        if(cost[key] >= 0. && cost[key] <= value) {
+            return false;
+        }
+        cost[key] = value;
+        trialfield.Push(key, value);
+        return true;
+    };
 
-            //check for valid neigh
-            aux = local_neighbor.key[0];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[1];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[2];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[3];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                calcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                //trialfield2.emplace(aux);
+    //known neighbour on one axis, side is +1 or -1 if it is right or above, 0 if there is none
+    struct Upwind {
+        double cost = DBL_MAX;
+        int side    = 0;
+    };
+    auto offer = [&](Upwind & axis, long int neighbour, int side) {
+        if(known[neighbour] && levels.GetNode(neighbour) >= 0 && cost[neighbour] < axis.cost) {
+            axis = {cost[neighbour], side};
+        }
+    };
+
+    auto update = [&](long int key) {
+        const long int i = key % iMax;
+        const long int j = key / iMax;
+        const double hx  = _grid->Gethx();
+        const double hy  = _grid->Gethy();
+        Upwind row;
+        Upwind col;
+        if(i + 1 < iMax) {
+            offer(row, key + 1, 1);
+        }
+        if(i > 0) {
+            offer(row, key - 1, -1);
+        }
+        if(j + 1 < jMax) {
+            offer(col, key + iMax, 1);
+        }
+        if(j > 0) {
+            offer(col, key - iMax, -1);
+        }
+        if(row.side == 0 && col.side == 0) {
+            return;
+        }
+        double result = DBL_MAX;
+        if(row.side != 0 && col.side != 0) {
+            result = twosidedCalc(row.cost, col.cost, hx / speed[key]);
+        }
+        const bool twoSided = (result >= std::max(row.cost, col.cost)) && (result != DBL_MAX);
+        if(!twoSided) {
+            const double rowCost =
+                (row.side != 0) ? onesidedCalc(row.cost, hx / speed[key]) : DBL_MAX;
+            const double colCost =
+                (col.side != 0) ? onesidedCalc(col.cost, hy / speed[key]) : DBL_MAX;
+            if(rowCost <= colCost) {
+                col    = Upwind();
+                result = rowCost;
+            } else {
+                row    = Upwind();
+                result = colCost;
             }
         }
-    }
+        if(improve(key, result) && dir) {
+            const double dx = (row.side != 0) ? row.side * (row.cost - result) / hx : 0.;
+            const double dy = (col.side != 0) ? col.side * (col.cost - result) / hy : 0.;
+            dir[key]        = Point(-dx, -dy).Normalized();
+        }
+    };
 
-    while(!trialfield.empty()) {
-        local_neighbor = _grid->getNeighbors(trialfield.top());
-        trialfield.pop();
+    auto relax = [&](long int key) {
+        if(!known[key] && levels.GetNode(key) >= 0 && _gridCode[key] != WALL &&
+           _gridCode[key] != OUTSIDE) {
+            update(key);
+        }
+    };
+    auto expand = [&](long int key) {
+        const long int i = key % iMax;
+        const long int j = key / iMax;
+        if(i + 1 < iMax) {
+            relax(key + 1);
+        }
+        if(i > 0) {
+            relax(key - 1);
+        }
+        if(j + 1 < jMax) {
+            relax(key + iMax);
+        }
+        if(j > 0) {
+            relax(key - iMax);
+        }
+        //straight across the open blocks with key on their border
+        forOpenBlocks(key, [&](long int iBlock, long int jBlock) {
+            levels.VisitBorder(iBlock, jBlock, [&](long int other) {
+                if(!known[other]) {
+                    improve(other, cost[key] + levels.GetTime(iBlock, jBlock, key, other));
+                }
+            });
+        });
+    };
 
-        //check for valid neigh
-        aux = local_neighbor.key[0];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
+    for(long int key = 0; key < _nPoints; ++key) {
+        if(cost[key] == magicnum(TARGET_REGION) && levels.GetNode(key) >= 0) {
+            known[key] = 1;
+        }
+    }
+    for(long int key = 0; key < _nPoints; ++key) {
+        if(known[key]) {
+            expand(key);
+        }
+    }
+    while(!trialfield.Empty()) {
+        const long int key = trialfield.Pop();
+        if(known[key]) {
+            continue;
+        }
+        known[key] = 1;
+        expand(key);
+    }
+
+    //costs inside of the open blocks, as MultiLevelDoorField::GetCost
+    for(long int key = 0; key < _nPoints; ++key) {
+        if(levels.GetNode(key) == FloorfieldLevels::INSIDE_BLOCK) {
+            long int borderKey = -1;
+            const double inside = levels.GetInsideCost(
+                key, [cost](long int border) { return cost[border]; }, borderKey);
+            cost[key] = (borderKey >= 0) ? inside : magicnum(UNKNOWN_COST);
+        }
+    }
+    if(!dir) {
+        return;
+    }
+    //the directions on the borders of the open blocks follow the gradient of the cost, not the
+    //straight line to the grid point the cost came from
+    auto slope = [&](long int key, long int step, double h, bool lowerExists, bool upperExists) {
+        const bool lower = lowerExists && cost[key - step] >= 0.;
+        const bool upper = upperExists && cost[key + step] >= 0.;
+        if(lower && upper) {
+            return (cost[key + step] - cost[key - step]) / (2. * h);
+        }
+        if(upper) {
+            return (cost[key + step] - cost[key]) / h;
         }
-        aux = local_neighbor.key[1];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
+        if(lower) {
+            return (cost[key] - cost[key - step]) / h;
         }
-        aux = local_neighbor.key[2];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
+        return 0.;
+    };
+    for(long int key = 0; key < _nPoints; ++key) {
+        if(levels.GetNode(key) < 0 || cost[key] <= 0.) {
+            continue;
         }
-        aux = local_neighbor.key[3];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            calcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            //trialfield2.emplace(aux);
+        bool onOpenBorder = false;
+        forOpenBlocks(key, [&](long int, long int) { onOpenBorder = true; });
+        if(onOpenBorder) {
+            const long int i = key % iMax;
+            const long int j = key / iMax;
+            const double dx  = slope(key, 1, _grid->Gethx(), i > 0, i + 1 < iMax);
+            const double dy  = slope(key, iMax, _grid->Gethy(), j > 0, j + 1 < jMax);
+            dir[key]         = Point(-dx, -dy).Normalized();
         }
     }
 }
 
+void UnivFFviaFM::calcDF(double * costOutput, Point * directionOutput, const double * const speed)
+{
+    marchFront(costOutput, speed, [&](long int key) {
+        calcDist(key, costOutput, directionOutput, speed);
+    });
+}
+
 void UnivFFviaFM::calcDist(
     const long int key,
     double * cost,
@@ -1484,7 +1597,34 @@ void UnivFFviaFM::addTarget(const int uid, double * costarrayDBL, Point * gradar
         Log->Write("ERROR: \tCould not find door with uid %d in Room %d", uid, _room);
         return;
     }
-    Line tempTargetLine   = Line(_doors[uid]);
+    //this allocation must be on shared heap! to be accessible by any thread later (should be shared in openmp)
+    double * newArrayDBL = (costarrayDBL) ? costarrayDBL : new double[_nPoints];
+    Point * newArrayPt   = nullptr;
+    if(_user == DISTANCE_AND_DIRECTIONS_USED) {
+        newArrayPt = (gradarrayPt) ? gradarrayPt : new Point[_nPoints];
+    }
+
+    if((_costFieldWithKey[uid]) && (_costFieldWithKey[uid] != costarrayDBL))
+        delete[] _costFieldWithKey[uid];
+    _costFieldWithKey[uid] = newArrayDBL;
+
+    if((_directionFieldWithKey[uid]) && (_directionFieldWithKey[uid] != gradarrayPt))
+        delete[] _directionFieldWithKey[uid];
+    if(newArrayPt)
+        _directionFieldWithKey[uid] = newArrayPt;
+
+    calcTarget(uid, newArrayDBL, newArrayPt);
+    if(_storage != FF_STORAGE_DOUBLE) {
+        storeDoorField(uid, newArrayDBL, newArrayPt);
+    }
+#pragma omp critical(_uids)
+    _uids.emplace_back(uid);
+}
+
+//calculates the fields to door uid into the given arrays, does not touch the maps of the fields
+void UnivFFviaFM::calcTarget(const int uid, double * newArrayDBL, Point * newArrayPt)
+{
+    Line tempTargetLine   = Line(_doors.at(uid));
     Point tempCenterPoint = Point(tempTargetLine.GetCentre());
     if(_mode == LINESEGMENT) {
         if(tempTargetLine.GetLength() >
@@ -1503,17 +1643,6 @@ void UnivFFviaFM::addTarget(const int uid, double * costarrayDBL, Point * gradar
         }
     }
 
-    //this allocation must be on shared heap! to be accessible by any thread later (should be shared in openmp)
-    double * newArrayDBL = (costarrayDBL) ? costarrayDBL : new double[_nPoints];
-    Point * newArrayPt   = nullptr;
-    if(_user == DISTANCE_AND_DIRECTIONS_USED) {
-        newArrayPt = (gradarrayPt) ? gradarrayPt : new Point[_nPoints];
-    }
-
-    if((_costFieldWithKey[uid]) && (_costFieldWithKey[uid] != costarrayDBL))
-        delete[] _costFieldWithKey[uid];
-    _costFieldWithKey[uid] = newArrayDBL;
-
     //init costarray
     for(int i = 0; i < _nPoints; ++i) {
         if(_gridCode[i] == WALL) {
@@ -1523,11 +1652,6 @@ void UnivFFviaFM::addTarget(const int uid, double * costarrayDBL, Point * gradar
         }
     }
 
-    if((_directionFieldWithKey[uid]) && (_directionFieldWithKey[uid] != gradarrayPt))
-        delete[] _directionFieldWithKey[uid];
-    if(newArrayPt)
-        _directionFieldWithKey[uid] = newArrayPt;
-
     //initialize start area
     if(_mode == LINESEGMENT) {
         drawLinesOnGrid(tempTargetLine, newArrayDBL, magicnum(TARGET_REGION));
@@ -1536,12 +1660,11 @@ void UnivFFviaFM::addTarget(const int uid, double * costarrayDBL, Point * gradar
         newArrayDBL[_grid->getKeyAtPoint(tempCenterPoint)] = magicnum(TARGET_REGION);
     }
 
-    if(_speedmode == FF_WALL_AVOID) {
-        calcFF(newArrayDBL, newArrayPt, _speedFieldSelector[REDU_WALL_SPEED]);
-    } else if(_speedmode == FF_HOMO_SPEED) {
-        calcFF(newArrayDBL, newArrayPt, _speedFieldSelector[INITIAL_SPEED]);
-    } else if(_speedmode == FF_PED_SPEED) {
-        calcFF(newArrayDBL, newArrayPt, _speedFieldSelector[PED_SPEED]);
+    const double * speed = getSpeedField();
+    if(speed && _storage == FF_STORAGE_MULTILEVEL) {
+        calcFFMultiLevel(*getLevels(), newArrayDBL, newArrayPt, speed);
+    } else if(speed) {
+        calcFF(newArrayDBL, newArrayPt, speed);
     }
 
     //the rest of the door must be initialized if centerpoint was used. else ff_router will have probs getting localDist
@@ -1555,12 +1678,12 @@ void UnivFFviaFM::addTarget(const int uid, double * costarrayDBL, Point * gradar
         Point trial      = tempTargetLine.GetCentre() - passvector * 0.25;
         Point trial2     = tempTargetLine.GetCentre() + passvector * 0.25;
         if((_grid->includesPoint(trial)) && (_gridCode[_grid->getKeyAtPoint(trial)] == INSIDE)) {
-            finalizeTargetLine(uid, _doors[uid], newArrayPt, passvector);
+            finalizeTargetLine(uid, _doors.at(uid), newArrayPt, passvector);
             finalizeTargetLine(uid, tempTargetLine, newArrayPt, passvector);
         } else if(
             (_grid->includesPoint(trial2)) && (_gridCode[_grid->getKeyAtPoint(trial2)] == INSIDE)) {
             passvector = passvector * -1.0;
-            finalizeTargetLine(uid, _doors[uid], newArrayPt, passvector);
+            finalizeTargetLine(uid, _doors.at(uid), newArrayPt, passvector);
             finalizeTargetLine(uid, tempTargetLine, newArrayPt, passvector);
 
         } else {
@@ -1572,8 +1695,6 @@ void UnivFFviaFM::addTarget(const int uid, double * costarrayDBL, Point * gradar
         //             }
         //         }
     }
-#pragma omp critical(_uids)
-    _uids.emplace_back(uid);
 }
 
 void UnivFFviaFM::addTarget(const int uid, Line * door, double * costarray, Point * gradarray)
@@ -1592,6 +1713,49 @@ void UnivFFviaFM::addAllTargets()
 }
 
 void UnivFFviaFM::addAllTargetsParallel()
+{
+    prepareAllTargets();
+
+    //parallel region
+#pragma omp parallel
+    {
+#pragma omp for
+        for(size_t i = 0; i < _doors.size(); ++i) {
+            auto doorPair = _doors.begin();
+            std::advance(doorPair, i);
+            addTarget(
+                doorPair->first,
+                _costFieldWithKey[doorPair->first],
+                _directionFieldWithKey[doorPair->first]);
+        }
+    };
+}
+
+void UnivFFviaFM::addAllTargetsParallel(const std::map<int, UnivFFviaFM *> & floorfields)
+{
+    //one task per door of every floor field, the largest grids first, so many small rooms do not
+    //leave the threads idle and a large room does not start last
+    std::vector<std::pair<UnivFFviaFM *, int>> targets;
+    for(const auto & floorfield : floorfields) {
+        floorfield.second->prepareAllTargets();
+        for(const auto & door : floorfield.second->_doors) {
+            targets.emplace_back(floorfield.second, door.first);
+        }
+    }
+    std::stable_sort(targets.begin(), targets.end(), [](const auto & a, const auto & b) {
+        return a.first->_nPoints > b.first->_nPoints;
+    });
+
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < targets.size(); ++i) {
+        UnivFFviaFM * floorfield = targets[i].first;
+        const int uid            = targets[i].second;
+        floorfield->addTarget(
+            uid, floorfield->_costFieldWithKey[uid], floorfield->_directionFieldWithKey[uid]);
+    }
+}
+
+void UnivFFviaFM::prepareAllTargets()
 {
     //Reason: freeing and reallocating takes time. We do not use already allocated memory, because we do not know if it
     //        is shared memory. Maybe this is not neccessary - maybe reconsider. This way, it is safe. If this function
@@ -1609,8 +1773,13 @@ void UnivFFviaFM::addAllTargetsParallel()
         if(memoryPt.second)
             delete[](memoryPt.second);
     }
-    //allocate new memory
+    //allocate new memory, compact and multilevel fields are calculated into temporary arrays by addTarget
     for(auto uidmap : _doors) {
+        if(_storage != FF_STORAGE_DOUBLE) {
+            _costFieldWithKey[uidmap.first]      = nullptr;
+            _directionFieldWithKey[uidmap.first] = nullptr;
+            continue;
+        }
         _costFieldWithKey[uidmap.first] = new double[_nPoints];
         if(_user == DISTANCE_MEASUREMENTS_ONLY) {
             _directionFieldWithKey[uidmap.first] = nullptr;
@@ -1619,20 +1788,6 @@ void UnivFFviaFM::addAllTargetsParallel()
             _directionFieldWithKey[uidmap.first] = new Point[_nPoints];
         }
     }
-
-    //parallel region
-#pragma omp parallel
-    {
-#pragma omp for
-        for(size_t i = 0; i < _doors.size(); ++i) {
-            auto doorPair = _doors.begin();
-            std::advance(doorPair, i);
-            addTarget(
-                doorPair->first,
-                _costFieldWithKey[doorPair->first],
-                _directionFieldWithKey[doorPair->first]);
-        }
-    };
 }
 
 void UnivFFviaFM::addTargetsParallel(std::vector<int> wantedDoors)
@@ -1647,8 +1802,13 @@ void UnivFFviaFM::addTargetsParallel(std::vector<int> wantedDoors)
             delete[] _directionFieldWithKey[targetUID];
         }
     }
-    //allocate new memory
+    //allocate new memory, compact and multilevel fields are calculated into temporary arrays by addTarget
     for(int targetUID : wantedDoors) {
+        if(_storage != FF_STORAGE_DOUBLE) {
+            _costFieldWithKey[targetUID]      = nullptr;
+            _directionFieldWithKey[targetUID] = nullptr;
+            continue;
+        }
         _costFieldWithKey[targetUID] = new double[_nPoints];
         if(_user == DISTANCE_MEASUREMENTS_ONLY) {
             _directionFieldWithKey[targetUID] = nullptr;
@@ -1688,9 +1848,44 @@ SubRoom * UnivFFviaFM::getSubRoom(const Point & pos)
 
 std::vector<int> UnivFFviaFM::getKnownDoorUIDs()
 {
+    if(_lazy) {
+        //every door has a field, it is calculated when it is used
+        std::vector<int> uids;
+        for(const auto & door : _doors) {
+            uids.emplace_back(door.first);
+        }
+        return uids;
+    }
     return _uids;
 }
 
+const double * UnivFFviaFM::getCostField(const int uid) const
+{
+    auto field = _costFieldWithKey.find(uid);
+    return (field != _costFieldWithKey.end()) ? field->second : nullptr;
+}
+
+bool UnivFFviaFM::acceptsCostField(const int uid) const
+{
+    return (_doors.count(uid) != 0) && (_user == DISTANCE_MEASUREMENTS_ONLY) && !_lazy &&
+           (_storage == FF_STORAGE_DOUBLE);
+}
+
+double * UnivFFviaFM::allocateCostField(const int uid)
+{
+    if(!acceptsCostField(uid)) {
+        return nullptr;
+    }
+    double * newArrayDBL = _costFieldWithKey[uid];
+    if(!newArrayDBL) {
+        newArrayDBL            = new double[_nPoints];
+        _costFieldWithKey[uid] = newArrayDBL;
+        _uids.emplace_back(uid);
+    }
+    _directionFieldWithKey.emplace(uid, nullptr);
+    return newArrayDBL;
+}
+
 void UnivFFviaFM::setUser(int userArg)
 {
     _user = userArg;
@@ -1701,9 +1896,275 @@ void UnivFFviaFM::setMode(int modeArg)
     _mode = modeArg;
 }
 
+void UnivFFviaFM::setBuilding(const Building * building)
+{
+    _building = building;
+}
+
+void UnivFFviaFM::setFastMarchingQueue(int fmQueueArg)
+{
+    _fmQueue = fmQueueArg;
+}
+
+void UnivFFviaFM::setStorage(int storageArg)
+{
+    _storage = storageArg;
+}
+
+void UnivFFviaFM::setBlockSize(int blockSizeArg)
+{
+    _blockSize = blockSizeArg;
+    _levels.reset();
+}
+
+void UnivFFviaFM::setLazy(std::size_t memoryBudget)
+{
+    _lazy         = true;
+    _memoryBudget = memoryBudget;
+}
+
+void UnivFFviaFM::setLazy(
+    const std::map<int, UnivFFviaFM *> & floorfields,
+    std::size_t memoryBudget)
+{
+    //a room with a share below one field still keeps the field in use
+    double allFields = 0.;
+    for(const auto & floorfield : floorfields) {
+        allFields += floorfield.second->getDoorFieldBytes();
+    }
+    if(memoryBudget > 0 && memoryBudget < allFields) {
+        Logging::Warning(fmt::format(
+            check_fmt("The floor field memory budget of {:.1f} MB is below one door field per room "
+                      "({:.1f} MB)"),
+            memoryBudget / 1048576.,
+            allFields / 1048576.));
+    }
+    for(const auto & floorfield : floorfields) {
+        std::size_t share = 0;
+        if(memoryBudget > 0) {
+            share = static_cast<std::size_t>(
+                memoryBudget * (floorfield.second->getDoorFieldBytes() / allFields));
+            share = std::max<std::size_t>(share, 1);
+        }
+        floorfield.second->setLazy(share);
+    }
+}
+
+std::size_t UnivFFviaFM::getDoorFieldBytes()
+{
+    if(_storage == FF_STORAGE_COMPACT) {
+        return _nPoints * CompactDoorField::GetPointBytes(_user == DISTANCE_AND_DIRECTIONS_USED);
+    }
+    if(_storage == FF_STORAGE_MULTILEVEL) {
+        return getLevels()->GetnNodes() *
+               MultiLevelDoorField::GetNodeBytes(_user == DISTANCE_AND_DIRECTIONS_USED);
+    }
+    std::size_t bytes = _nPoints * sizeof(double);
+    if(_user == DISTANCE_AND_DIRECTIONS_USED) {
+        bytes += _nPoints * sizeof(Point);
+    }
+    return bytes;
+}
+
+//calls read() while no other thread can free the fields to door uid, read uses getDoorCost() and
+//getDoorDirection(). The fields are calculated on first use. Reads of calculated fields only share
+//the lock and mark the door as used in the current tick of the use clock, so the least recently
+//used door is only known up to one tick. Concurrent calls for the same door wait for the thread that
+//calculates it, calls for other doors are not blocked by the calculation. If the calculation
+//throws, the exception is passed on and the next call for the door calculates it again.
+template <typename Read>
+bool UnivFFviaFM::readLazyField(const int uid, Read read)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(_lazyMutex);
+        auto lastUse = _lastUse.find(uid);
+        if(lastUse != _lastUse.end()) {
+            const std::uint64_t now = _useClock.load(std::memory_order_relaxed);
+            if(lastUse->second.load(std::memory_order_relaxed) != now) {
+                lastUse->second.store(now, std::memory_order_relaxed);
+            }
+            read();
+            return true;
+        }
+    }
+    if(_doors.count(uid) == 0) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(_lazyMutex);
+    _lazyCalculated.wait(lock, [&]() { return _calculating.count(uid) == 0; });
+    auto lastUse = _lastUse.find(uid);
+    if(lastUse != _lastUse.end()) {
+        lastUse->second.store(_useClock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        read();
+        return true;
+    }
+
+    _calculating.insert(uid);
+    if(_evictedDoors.count(uid) && ++_recalculations == 100) {
+        Logging::Warning(fmt::format(
+            check_fmt("Door fields in room {} are recalculated repeatedly, the floor field memory "
+                      "budget is too small for the doors in use"),
+            _room));
+    }
+    lock.unlock();
+    double * cost    = nullptr;
+    Point * gradient = nullptr;
+    try {
+        cost = new double[_nPoints];
+        if(_user == DISTANCE_AND_DIRECTIONS_USED) {
+            gradient = new Point[_nPoints];
+        }
+        calcTarget(uid, cost, gradient);
+    } catch(...) {
+        //the waiting readers calculate the field themselves instead of waiting forever
+        delete[] cost;
+        delete[] gradient;
+        lock.lock();
+        _calculating.erase(uid);
+        _lazyCalculated.notify_all();
+        throw;
+    }
+    lock.lock();
+    _calculating.erase(uid);
+    _costFieldWithKey[uid]      = cost;
+    _directionFieldWithKey[uid] = gradient;
+    if(_storage != FF_STORAGE_DOUBLE) {
+        storeDoorField(uid, cost, gradient);
+    }
+    _lastUse.try_emplace(uid, ++_useClock);
+    _memoryUsed += getDoorFieldBytes();
+
+    //free the least recently used fields, the new one is kept even if it exceeds the budget
+    while(_memoryBudget > 0 && _memoryUsed > _memoryBudget && _lastUse.size() > 1) {
+        auto coldest = _lastUse.end();
+        for(auto door = _lastUse.begin(); door != _lastUse.end(); ++door) {
+            if(door->first != uid &&
+               (coldest == _lastUse.end() || door->second.load(std::memory_order_relaxed) <
+                                                 coldest->second.load(std::memory_order_relaxed))) {
+                coldest = door;
+            }
+        }
+        const int coldUID = coldest->first;
+        freeDoorField(coldUID);
+        _lastUse.erase(coldest);
+        _evictedDoors.insert(coldUID);
+        _memoryUsed -= getDoorFieldBytes();
+    }
+    read();
+    _lazyCalculated.notify_all();
+    return true;
+}
+
+//speed field of the fast marching in the current speed mode, nullptr if there is none
+const double * UnivFFviaFM::getSpeedField() const
+{
+    if(_speedmode == FF_WALL_AVOID) {
+        return _speedFieldSelector[REDU_WALL_SPEED];
+    }
+    if(_speedmode == FF_HOMO_SPEED) {
+        return _speedFieldSelector[INITIAL_SPEED];
+    }
+    if(_speedmode == FF_PED_SPEED) {
+        return _speedFieldSelector[PED_SPEED];
+    }
+    return nullptr;
+}
+
+//the levels depend on the speed field, they are built for the first door field that needs them
+std::shared_ptr<const FloorfieldLevels> UnivFFviaFM::getLevels()
+{
+    std::shared_ptr<const FloorfieldLevels> levels;
+#pragma omp critical(UnivFFviaFM_levels)
+    {
+        if(!_levels) {
+            _levels = std::make_shared<const FloorfieldLevels>(
+                *_grid, _gridCode, _subrooms, getSpeedField(), _blockSize);
+        }
+        levels = _levels;
+    }
+    return levels;
+}
+
+//replaces the double arrays of door uid with a CompactDoorField or MultiLevelDoorField and frees them
+void UnivFFviaFM::storeDoorField(const int uid, double * costarray, Point * gradarray)
+{
+    if(_storage == FF_STORAGE_MULTILEVEL) {
+        MultiLevelDoorField multiLevel(getLevels(), costarray, gradarray);
+#pragma omp critical(_multiLevelFieldWithKey)
+        _multiLevelFieldWithKey.insert_or_assign(uid, std::move(multiLevel));
+    } else {
+        CompactDoorField compact(costarray, gradarray, _nPoints);
+#pragma omp critical(_compactFieldWithKey)
+        _compactFieldWithKey.insert_or_assign(uid, std::move(compact));
+    }
+    _costFieldWithKey[uid]      = nullptr;
+    _directionFieldWithKey[uid] = nullptr;
+    delete[] costarray;
+    delete[] gradarray;
+}
+
+//door uid is stored as CompactDoorField or MultiLevelDoorField instead of double arrays
+bool UnivFFviaFM::hasStoredField(const int uid) const
+{
+    return _compactFieldWithKey.count(uid) != 0 || _multiLevelFieldWithKey.count(uid) != 0;
+}
+
+double UnivFFviaFM::getDoorCost(const int uid, const long int key) const
+{
+    auto compact = _compactFieldWithKey.find(uid);
+    if(compact != _compactFieldWithKey.end()) {
+        return compact->second.GetCost(key);
+    }
+    auto multiLevel = _multiLevelFieldWithKey.find(uid);
+    if(multiLevel != _multiLevelFieldWithKey.end()) {
+        return multiLevel->second.GetCost(key);
+    }
+    return _costFieldWithKey.at(uid)[key];
+}
+
+Point UnivFFviaFM::getDoorDirection(const int uid, const long int key) const
+{
+    auto compact = _compactFieldWithKey.find(uid);
+    if(compact != _compactFieldWithKey.end()) {
+        return compact->second.GetDirection(key);
+    }
+    auto multiLevel = _multiLevelFieldWithKey.find(uid);
+    if(multiLevel != _multiLevelFieldWithKey.end()) {
+        return multiLevel->second.GetDirection(key);
+    }
+    const Point * gradarray = _directionFieldWithKey.at(uid);
+    return gradarray ? gradarray[key] : Point(0., 0.);
+}
+
+void UnivFFviaFM::freeDoorField(const int uid)
+{
+    if(_costFieldWithKey.count(uid) != 0) {
+        delete[] _costFieldWithKey.at(uid);
+        _costFieldWithKey.erase(uid);
+    }
+    if(_directionFieldWithKey.count(uid) != 0) {
+        delete[] _directionFieldWithKey.at(uid);
+        _directionFieldWithKey.erase(uid);
+    }
+    _compactFieldWithKey.erase(uid);
+    _multiLevelFieldWithKey.erase(uid);
+}
+
+void UnivFFviaFM::clearLazyFields()
+{
+    std::lock_guard<std::shared_mutex> lock(_lazyMutex);
+    for(const auto & door : _lastUse) {
+        freeDoorField(door.first);
+    }
+    _lastUse.clear();
+    _memoryUsed = 0;
+}
+
 void UnivFFviaFM::setSpeedMode(int speedModeArg)
 {
     _speedmode = speedModeArg;
+    _levels.reset();
     if(_speedmode == FF_PED_SPEED && !_speedFieldSelector[PED_SPEED]) {
         _speedFieldSelector[PED_SPEED] = new double[_nPoints];
     }
@@ -1769,38 +2230,38 @@ void UnivFFviaFM::writeFF(const fs::path & filename, std::vector<int> targetID)
 
     if(!targetID.empty()) {
         for(unsigned int iTarget = 0; iTarget < targetID.size(); ++iTarget) {
-            if(_costFieldWithKey.count(targetID[iTarget]) == 0) {
+            const int uid      = targetID[iTarget];
+            const bool compact = hasStoredField(uid);
+            if(_costFieldWithKey.count(uid) == 0 && !compact) {
                 continue;
             }
-            double * costarray = _costFieldWithKey[targetID[iTarget]];
 
-            std::string name = _building->GetTransOrCrossByUID(targetID[iTarget])->GetCaption() +
-                               "-" + std::to_string(targetID[iTarget]);
+            std::string name = _building->GetTransOrCrossByUID(uid)->GetCaption() + "-" +
+                               std::to_string(uid);
             std::replace(name.begin(), name.end(), ' ', '_');
 
-            if(!costarray) {
+            if(!compact && !_costFieldWithKey[uid]) {
                 continue;
             }
 
             file << "SCALARS CostTarget" << name << " float 1" << std::endl;
             file << "LOOKUP_TABLE default" << std::endl;
             for(long int i = 0; i < _grid->GetnPoints(); ++i) {
-                file << costarray[i] << std::endl;
+                file << getDoorCost(uid, i) << std::endl;
             }
 
-            if(_directionFieldWithKey.count(targetID[iTarget]) == 0) {
-                continue;
-            }
-
-            Point * gradarray = _directionFieldWithKey[targetID[iTarget]];
-            if(gradarray == nullptr) {
+            const bool directions =
+                compact ? (_user == DISTANCE_AND_DIRECTIONS_USED) :
+                          (_directionFieldWithKey.count(uid) != 0 && _directionFieldWithKey[uid]);
+            if(!directions) {
                 continue;
             }
 
 
             file << "VECTORS GradientTarget" << name << " float" << std::endl;
             for(int i = 0; i < _grid->GetnPoints(); ++i) {
-                file << gradarray[i]._x << " " << gradarray[i]._y << " 0.0" << std::endl;
+                const Point direction = getDoorDirection(uid, i);
+                file << direction._x << " " << direction._y << " 0.0" << std::endl;
             }
         }
     }
@@ -1834,6 +2295,14 @@ double UnivFFviaFM::getCostToDestination(const int destID, const Point & positio
             // Log->Write("ERROR:\t In getCostToDestination(3 args)");
         }
     }
+    if(_lazy) {
+        double cost = DBL_MAX;
+        readLazyField(destID, [&]() { cost = getDoorCost(destID, key); });
+        return cost;
+    }
+    if(hasStoredField(destID)) {
+        return getDoorCost(destID, key);
+    }
     if(_costFieldWithKey.count(destID) == 1 && _costFieldWithKey[destID]) {
         return _costFieldWithKey[destID][key];
     } else if(_directCalculation && _doors.count(destID) > 0) {
@@ -1880,6 +2349,14 @@ double UnivFFviaFM::getCostToDestination(const int destID, const Point & positio
             // Log->Write("ERROR:\t In getCostToDestination(2 args)");
         }
     }
+    if(_lazy) {
+        double cost = DBL_MAX;
+        readLazyField(destID, [&]() { cost = getDoorCost(destID, key); });
+        return cost;
+    }
+    if(hasStoredField(destID)) {
+        return getDoorCost(destID, key);
+    }
     if(_costFieldWithKey.count(destID) == 1 && _costFieldWithKey[destID]) {
         return _costFieldWithKey[destID][key];
     } else if(_directCalculation && _doors.count(destID) > 0) {
@@ -1905,20 +2382,17 @@ double UnivFFviaFM::getDistanceBetweenDoors(const int door1_ID, const int door2_
     assert(_doors.count(door1_ID) != 0);
     assert(_doors.count(door2_ID) != 0);
 
+    if(_lazy) {
+        const long int key = getDoorKey(door2_ID);
+        double cost        = DBL_MAX;
+        readLazyField(door1_ID, [&]() { cost = getDoorCost(door1_ID, key); });
+        return cost;
+    }
+    if(hasStoredField(door1_ID)) {
+        return getDoorCost(door1_ID, getDoorKey(door2_ID));
+    }
     if(_costFieldWithKey.count(door1_ID) == 1 && _costFieldWithKey[door1_ID]) {
-        long int key = _grid->getKeyAtPoint(_doors.at(door2_ID).GetCentre());
-        if(_gridCode[key] != door2_ID) {
-            //bresenham line (treppenstruktur) getKeyAtPoint yields gridpoint next to edge, although position is on edge
-            //find a key that belongs to door (must be one left or right and second one below or above)
-            if(_gridCode[key + 1] == door2_ID) {
-                key = key + 1;
-            } else if(_gridCode[key - 1] == door2_ID) {
-                key = key - 1;
-            } else {
-                Log->Write("ERROR:\t In DistanceBetweenDoors");
-            }
-        }
-        return _costFieldWithKey[door1_ID][key];
+        return _costFieldWithKey[door1_ID][getDoorKey(door2_ID)];
     } else if(_directCalculation && _doors.count(door1_ID) > 0) {
         _costFieldWithKey[door1_ID] = new double[_nPoints];
         if(_user == DISTANCE_AND_DIRECTIONS_USED) {
@@ -1937,6 +2411,23 @@ double UnivFFviaFM::getDistanceBetweenDoors(const int door1_ID, const int door2_
     return DBL_MAX;
 }
 
+long int UnivFFviaFM::getDoorKey(const int doorUID)
+{
+    long int key = _grid->getKeyAtPoint(_doors.at(doorUID).GetCentre());
+    if(_gridCode[key] != doorUID) {
+        //bresenham line (treppenstruktur) getKeyAtPoint yields gridpoint next to edge, although position is on edge
+        //find a key that belongs to door (must be one left or right and second one below or above)
+        if(_gridCode[key + 1] == doorUID) {
+            key = key + 1;
+        } else if(_gridCode[key - 1] == doorUID) {
+            key = key - 1;
+        } else {
+            Log->Write("ERROR:\t In DistanceBetweenDoors");
+        }
+    }
+    return key;
+}
+
 RectGrid * UnivFFviaFM::getGrid()
 {
     return _grid;
@@ -1967,7 +2458,17 @@ void UnivFFviaFM::getDirectionToUID(int destID, long int key, Point & direction,
             Log->Write("ERROR:\t In getDirectionToUID (4 args)");
         }
     }
-    if(_directionFieldWithKey.count(destID) == 1 && _directionFieldWithKey[destID]) {
+    if(_lazy) {
+        readLazyField(destID, [&]() {
+            if(_user == DISTANCE_AND_DIRECTIONS_USED) {
+                direction = getDoorDirection(destID, key);
+            }
+        });
+        return;
+    }
+    if(hasStoredField(destID) && _user == DISTANCE_AND_DIRECTIONS_USED) {
+        direction = getDoorDirection(destID, key);
+    } else if(_directionFieldWithKey.count(destID) == 1 && _directionFieldWithKey[destID]) {
         direction = _directionFieldWithKey[destID][key];
     } else if(_directCalculation && _doors.count(destID) > 0) {
         //free memory if needed
@@ -2025,7 +2526,17 @@ void UnivFFviaFM::getDirectionToUID(int destID, long int key, Point & direction)
             // Log->Write("ERROR:\t In getDirectionToUID (3 args)");
         }
     }
-    if(_directionFieldWithKey.count(destID) == 1 && _directionFieldWithKey[destID]) {
+    if(_lazy) {
+        readLazyField(destID, [&]() {
+            if(_user == DISTANCE_AND_DIRECTIONS_USED) {
+                direction = getDoorDirection(destID, key);
+            }
+        });
+        return;
+    }
+    if(hasStoredField(destID) && _user == DISTANCE_AND_DIRECTIONS_USED) {
+        direction = getDoorDirection(destID, key);
+    } else if(_directionFieldWithKey.count(destID) == 1 && _directionFieldWithKey[destID]) {
         direction = _directionFieldWithKey[destID][key];
     } else if(_directCalculation && _doors.count(destID) > 0) {
         //free memory if needed
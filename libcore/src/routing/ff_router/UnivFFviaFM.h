@@ -37,9 +37,18 @@
 
 #include "general/Filesystem.h"
 #include "general/Macros.h"
+#include "routing/ff_router/CompactDoorField.h"
+#include "routing/ff_router/MultiLevelDoorField.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <float.h>
 #include <map>
+#include <memory>
+#include <set>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
@@ -68,16 +77,6 @@ class Line;
 //     DISTANCE_AND_DIRECTIONS_USED
 //};
 
-class CompareCostTrips
-{ //this class is used in std::priority_queue in UnivFFviaFM::calcFF
-public:
-    CompareCostTrips(double * costarray) : _costarray(costarray) {}
-    bool operator()(const int a, const int b) const { return _costarray[a] > _costarray[b]; }
-
-private:
-    double * _costarray = nullptr;
-};
-
 class UnivFFviaFM
 {
 public:
@@ -130,11 +129,36 @@ public:
     void addTarget(const int uid, double * costarray = nullptr, Point * gradarray = nullptr);
     void addAllTargets();
     void addAllTargetsParallel();
+    //calculates the door fields of all floor fields in one parallel loop over their doors
+    static void addAllTargetsParallel(const std::map<int, UnivFFviaFM *> & floorfields);
     void addTargetsParallel(std::vector<int> wantedDoors);
     std::vector<int> getKnownDoorUIDs();
+    //cost field to door uid, nullptr if it was not calculated
+    const double * getCostField(const int uid) const;
+    //a precalculated cost field to door uid (e.g. from FloorfieldCache) can replace addTarget,
+    //no directions are restored: only for DISTANCE_MEASUREMENTS_ONLY
+    bool acceptsCostField(const int uid) const;
+    //cost field to door uid for the caller to fill with a precalculated field, nullptr if not accepted
+    double * allocateCostField(const int uid);
     void setUser(int userArg);
     void setMode(int modeArg);
     void setSpeedMode(int speedModeArg);
+    //building whose doors name the door fields in writeFF(), set by the Building constructors
+    void setBuilding(const Building * building);
+    void setFastMarchingQueue(int fmQueueArg);
+    //FF_STORAGE_COMPACT and FF_STORAGE_MULTILEVEL keep the door fields as CompactDoorField or
+    //MultiLevelDoorField only, set before they are calculated
+    void setStorage(int storageArg);
+    //grid cells per side of the coarse blocks of FF_STORAGE_MULTILEVEL
+    void setBlockSize(int blockSizeArg);
+    //lazy mode: the door fields are calculated on first use instead of by addAllTargets*, the least
+    //recently used ones are freed if they need more than memoryBudget bytes (0: no limit). Must be set
+    //before any door field is calculated. The getters are thread safe, every field is calculated once.
+    void setLazy(std::size_t memoryBudget);
+    //sets all floor fields lazy and shares memoryBudget in proportion to the size of their door fields
+    static void setLazy(const std::map<int, UnivFFviaFM *> & floorfields, std::size_t memoryBudget);
+    //bytes of the fields to one door
+    std::size_t getDoorFieldBytes();
     SubRoom ** getSubRoomFF();
     SubRoom * getSubRoom(const Point & pos);
 
@@ -173,7 +197,17 @@ public:
     template <typename T>
     void drawLinesOnWall(Line & line, T * const target, const T value);
 
+    template <typename Update>
+    void marchFront(double * costOutput, const double * const speed, Update update);
+    template <typename Queue, typename Update>
+    void marchFront(Queue & trialfield, double * costOutput, Update update);
+    virtual void calcTarget(const int uid, double * costarray, Point * gradarray);
     void calcFF(double *, Point *, const double * const);
+    void calcFFMultiLevel(
+        const FloorfieldLevels & levels,
+        double * cost,
+        Point * dir,
+        const double * const speed);
     void calcCost(const long int key, double * cost, Point * dir, const double * const speed);
     void calcDF(double *, Point *, const double * const);
     void calcDist(const long int key, double * cost, Point * dir, const double * const speed);
@@ -181,12 +215,29 @@ public:
     inline double twosidedCalc(double x, double y, double hDivF);
 
 private:
-    Building * _building           = nullptr;
+    long int getDoorKey(const int doorUID);
+    //frees the door fields and allocates the arrays addAllTargetsParallel calculates into
+    void prepareAllTargets();
+    const double * getSpeedField() const;
+    std::shared_ptr<const FloorfieldLevels> getLevels();
+    void storeDoorField(const int uid, double * costarray, Point * gradarray);
+    bool hasStoredField(const int uid) const;
+    double getDoorCost(const int uid, const long int key) const;
+    Point getDoorDirection(const int uid, const long int key) const;
+    void freeDoorField(const int uid);
+    template <typename Read>
+    bool readLazyField(const int uid, Read read);
+    void clearLazyFields();
+
+    const Building * _building     = nullptr;
     Configuration * _configuration = nullptr;
     int _room                      = -1;                           //not set
     int _mode                      = LINESEGMENT;                  //default
     int _user                      = DISTANCE_AND_DIRECTIONS_USED; //default
     int _speedmode                 = FF_HOMO_SPEED;                //default
+    int _fmQueue                   = FM_QUEUE_HEAP;                //default
+    int _storage                   = FF_STORAGE_DOUBLE;            //default
+    int _blockSize                 = 8;                            //default
     int _scope                     = 0;                            //not set / unknown
     bool _directCalculation        = true;
     RectGrid * _grid               = nullptr;
@@ -203,6 +254,11 @@ private:
     //the following maps are responsible for dealloc the arrays
     std::map<int, double *> _costFieldWithKey;
     std::map<int, Point *> _directionFieldWithKey;
+    //door fields with FF_STORAGE_COMPACT, the arrays above are freed after they are calculated
+    std::map<int, CompactDoorField> _compactFieldWithKey;
+    //door fields with FF_STORAGE_MULTILEVEL and the levels of the room, built by the first of them
+    std::map<int, MultiLevelDoorField> _multiLevelFieldWithKey;
+    std::shared_ptr<const FloorfieldLevels> _levels;
 
     std::vector<int> _uids;
     std::map<int, Line> _doors;
@@ -211,4 +267,18 @@ private:
     std::map<int, Point> _subroomUIDtoInsidePoint;
     std::map<int, SubRoom *> _subroomUIDtoSubRoomPtr;
     std::map<SubRoom *, Point> _subRoomPtrTOinsidePoint;
+
+    //lazy mode, the door fields in the maps above are guarded by _lazyMutex: reads of calculated
+    //fields share it, calculating and freeing fields hold it exclusively
+    bool _lazy                = false;
+    std::size_t _memoryBudget = 0;
+    std::size_t _memoryUsed   = 0;
+    //calculated doors and the time of their last use, the clock ticks with every calculation
+    std::map<int, std::atomic<std::uint64_t>> _lastUse;
+    std::atomic<std::uint64_t> _useClock{0};
+    std::set<int> _calculating;
+    std::set<int> _evictedDoors;
+    int _recalculations = 0;
+    std::shared_mutex _lazyMutex;
+    std::condition_variable_any _lazyCalculated;
 };
@@ -46,12 +46,25 @@
  **/
 #include "ffRouter.h"
 
+#include "FloorfieldCache.h"
 #include "direction/walking/DirectionStrategy.h"
 #include "geometry/GoalManager.h"
 #include "geometry/WaitingArea.h"
 
+#include "general/Format.h"
+#include "general/Logger.h"
+
 #include <algorithm>
 #include <cfloat>
+#include <memory>
+
+namespace
+{
+/// grid spacing of the floor fields of the rooms [m]
+constexpr double ROOM_FF_SPACING = 0.125;
+/// wall avoid distance of the floor fields of the rooms [m]
+constexpr double ROOM_FF_WALL_AVOID = 0.0;
+} // namespace
 
 int FFRouter::_cnt = 0;
 
@@ -86,11 +99,7 @@ FFRouter::~FFRouter()
     if(_globalFF) {
         delete _globalFF;
     }
-    //delete localffs
-    std::map<int, UnivFFviaFM *>::reverse_iterator delIter;
-    for(delIter = _locffviafm.rbegin(); delIter != _locffviafm.rend(); ++delIter) {
-        delete(*delIter).second;
-    }
+    //the localffs are freed with _roomFloorfields, unless another router still uses them
 }
 
 bool FFRouter::Init(Building * building)
@@ -154,48 +163,108 @@ bool FFRouter::Init(Building * building)
     std::sort(_allDoorUIDs.begin(), _allDoorUIDs.end());
     _allDoorUIDs.erase(std::unique(_allDoorUIDs.begin(), _allDoorUIDs.end()), _allDoorUIDs.end());
 
-    //cleanse maps
-    _distMatrix.clear();
-    _pathsMatrix.clear();
-
-    //init, yet no distances, only create map entries
-    for(auto & id1 : _allDoorUIDs) {
-        for(auto & id2 : _allDoorUIDs) {
-            std::pair<int, int> key = std::make_pair(id1, id2);
-            double value            = (id1 == id2) ? 0.0 : DBL_MAX;
-            //distMatrix[i][j] = 0,   if i==j
-            //distMatrix[i][j] = max, else
-            _distMatrix.insert(std::make_pair(key, value));
-            //pathsMatrix[i][j] = i or j ? (follow wiki:path_reconstruction, it should be j)
-            _pathsMatrix.insert(std::make_pair(key, id2));
-            //_subroomMatrix.insert(std::make_pair(key, nullptr));
-        }
-    }
+    //init, yet no distances
+    //distMatrix[i][j] = 0,   if i==j
+    //distMatrix[i][j] = max, else
+    //pathsMatrix[i][j] = j (follow wiki:path_reconstruction)
+    //closed doors are isolated nodes, so they can be reconnected by RepairDistances()
+    _distMatrix.Reset(GetMatrixDoorUIDs());
+    _doorDistances.clear();
 
     //prepare all room-floor-fields-objects (one room = one instance)
+    //the former fields are kept until the end of Init(), the store may return them again
     _locffviafm.clear();
+    auto formerFloorfields = std::move(_roomFloorfields);
+    _roomFloorfields.clear();
     //type of allRooms: const std::map<int, std::unique_ptr<Room> >&
     const std::map<int, std::shared_ptr<Room>> & allRooms = _building->GetAllRooms();
 
-
-    for(unsigned int i = 0; i < allRooms.size(); ++i) {
+    //rooms in the same state as in another router share its floor field, the others are
+    //independent, their grids and wall distances are built in parallel
+    std::vector<std::pair<int, Room *>> rooms;
+    for(const auto & pairRoom : allRooms) {
+        auto shared = _floorfieldStore ? _floorfieldStore->Find(*pairRoom.second) : nullptr;
+        if(shared) {
+            _roomFloorfields[pairRoom.first] = shared;
+        } else {
+            rooms.emplace_back(pairRoom.first, pairRoom.second.get());
+        }
+    }
+    std::vector<UnivFFviaFM *> floorfields(rooms.size(), nullptr);
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < rooms.size(); ++i) {
 #ifdef DEBUG
-        std::cerr << "Creating Floorfield for Room: " << pair.first << std::endl;
+        std::cerr << "Creating Floorfield for Room: " << rooms[i].first << std::endl;
 #endif
+        floorfields[i] = CreateRoomFloorfield(rooms[i].second);
+    }
+    //the fields without door fields yet
+    std::map<int, UnivFFviaFM *> newFloorfields;
+    for(size_t i = 0; i < rooms.size(); ++i) {
+        _roomFloorfields[rooms[i].first] = std::shared_ptr<UnivFFviaFM>(floorfields[i]);
+        newFloorfields.insert(std::make_pair(rooms[i].first, floorfields[i]));
+        if(_floorfieldStore) {
+            _floorfieldStore->Insert(*rooms[i].second, _roomFloorfields[rooms[i].first]);
+        }
+    }
+    for(auto & [roomID, floorfield] : _roomFloorfields) {
+        _locffviafm.insert(std::make_pair(roomID, floorfield.get()));
+    }
+    if(newFloorfields.size() < _locffviafm.size()) {
+        Logging::Info(fmt::format(
+            check_fmt("Floor fields of {} of {} rooms shared with other routers"),
+            _locffviafm.size() - newFloorfields.size(),
+            _locffviafm.size()));
+    }
 
-        auto pairRoomIt = allRooms.begin();
-        std::advance(pairRoomIt, i);
-        UnivFFviaFM * locffptr = nullptr;
-        locffptr = new UnivFFviaFM(pairRoomIt->second.get(), building, 0.125, 0.0, false);
+    //the door fields only depend on the geometry and the parameters above, reuse them from
+    //former runs if they are cached. Only used if no field is shared, the file holds all rooms.
+    std::unique_ptr<FloorfieldCache> cache;
+    bool cacheLoaded = false;
+    if(_config->get_ff_lazy()) {
+        //the door fields are calculated when the distances between the doors are needed
+        UnivFFviaFM::setLazy(_locffviafm, _config->get_ff_memory_budget());
+    }
+    const bool cacheable =
+        !_config->get_ff_lazy() && _config->get_ff_storage() == FF_STORAGE_DOUBLE;
+    if(!_config->get_ff_cache_dir().empty() && !cacheable) {
+        Logging::Warning("The floor field cache is not used with lazy or compact floor fields");
+    } else if(!_config->get_ff_cache_dir().empty() && newFloorfields.size() == _locffviafm.size()) {
+        cache = std::make_unique<FloorfieldCache>(
+            _config->get_ff_cache_dir(),
+            *building,
+            std::vector<double>{
+                ROOM_FF_SPACING,
+                ROOM_FF_WALL_AVOID,
+                CENTERPOINT,
+                FF_HOMO_SPEED,
+                static_cast<double>(_config->get_fm_queue())});
+        if(!_config->get_ff_cache_rebuild()) {
+            cacheLoaded = cache->Load(newFloorfields);
+        }
+        if(cacheLoaded) {
+            Logging::Info(fmt::format(
+                check_fmt("Floor fields read from <{}>"), cache->GetFile().string()));
+        }
+    }
 
-        locffptr->setUser(DISTANCE_MEASUREMENTS_ONLY);
-        locffptr->setMode(CENTERPOINT);
-        locffptr->setSpeedMode(FF_HOMO_SPEED);
-        locffptr->addAllTargetsParallel();
+    if(!cacheLoaded && !_config->get_ff_lazy()) {
+        UnivFFviaFM::addAllTargetsParallel(newFloorfields);
+    }
+    for(auto & [roomID, locffptr] : _locffviafm) {
         //locffptr->writeFF("UnivFF"+std::to_string(pairRoomIt->first)+".vtk", locffptr->getKnownDoorUIDs());
-        Log->Write("INFO: \tAdding distances in Room %d to matrix", (*pairRoomIt).first);
-        //#pragma omp critical(_locffviafm)
-        _locffviafm.insert(std::make_pair((*pairRoomIt).first, locffptr));
+        Log->Write("INFO: \tAdding distances in Room %d to matrix", roomID);
+    }
+
+    if(cache && !cacheLoaded) {
+        if(cache->Store(newFloorfields)) {
+            Logging::Info(fmt::format(
+                check_fmt("Floor fields written to <{}>"), cache->GetFile().string()));
+        } else {
+            Logging::Warning(fmt::format(
+                check_fmt("Could not write the floor field cache <{}>"),
+                cache->GetFile().string()));
+        }
     }
 
 
@@ -205,17 +274,16 @@ bool FFRouter::Init(Building * building)
     //                 we do only want doors of same subroom anyway. BUT the router would have to switch from room-scope
     //                 to subroom-scope. Nevertheless, we could omit the room info (used to acces correct field), if we
     //                 do it like in "ReInit()".
-    for(unsigned int i = 0; i < roomAndCroTrVector.size(); ++i) {
-        auto rctIt = roomAndCroTrVector.begin();
-        std::advance(rctIt, i);
-
+    //pairs of doors with a room and a subroom in common
+    std::vector<std::pair<std::pair<int, int>, int>> doorPairs;
+    for(const auto & [roomID, doorUID] : roomAndCroTrVector) {
         ////loop over upper triangular matrice (i,j) and write to (j,i) as well
         for(auto otherDoor : roomAndCroTrVector) {
-            if(otherDoor.first != rctIt->first)
+            if(otherDoor.first != roomID)
                 continue; // we only want doors with one room in common
-            if(otherDoor.second <= rctIt->second)
+            if(otherDoor.second <= doorUID)
                 continue; // calculate every path only once
-            // if we exclude otherDoor.second == rctIt->second, the program loops forever
+            // if we exclude otherDoor.second == doorUID, the program loops forever
 
             //if the door is closed, then don't calc distances
             //if (!_CroTrByUID.at(*otherDoor)->IsOpen()) {
@@ -224,11 +292,11 @@ bool FFRouter::Init(Building * building)
 
             // if the two doors are not within the same subroom, do not consider (ar.graf)
             // should fix problems of oscillation caused by doorgaps in the distancegraph
-            int thisUID1 = (_CroTrByUID.at(rctIt->second)->GetSubRoom1()) ?
-                               _CroTrByUID.at(rctIt->second)->GetSubRoom1()->GetUID() :
+            int thisUID1 = (_CroTrByUID.at(doorUID)->GetSubRoom1()) ?
+                               _CroTrByUID.at(doorUID)->GetSubRoom1()->GetUID() :
                                -10;
-            int thisUID2 = (_CroTrByUID.at(rctIt->second)->GetSubRoom2()) ?
-                               _CroTrByUID.at(rctIt->second)->GetSubRoom2()->GetUID() :
+            int thisUID2 = (_CroTrByUID.at(doorUID)->GetSubRoom2()) ?
+                               _CroTrByUID.at(doorUID)->GetSubRoom2()->GetUID() :
                                -20;
             int otherUID1 = (_CroTrByUID.at(otherDoor.second)->GetSubRoom1()) ?
                                 _CroTrByUID.at(otherDoor.second)->GetSubRoom1()->GetUID() :
@@ -241,35 +309,40 @@ bool FFRouter::Init(Building * building)
                (thisUID2 != otherUID2)) {
                 continue;
             }
-
-            UnivFFviaFM * locffptr = _locffviafm[rctIt->first];
-            double tempDistance =
-                locffptr->getDistanceBetweenDoors(rctIt->second, otherDoor.second);
-
-            if(tempDistance < locffptr->getGrid()->Gethx()) {
-                Log->Write(
-                    "WARNING:\tIgnoring distance of doors %d and %d because it is too small: %f",
-                    rctIt->second,
-                    otherDoor.second,
-                    tempDistance);
-                //Log->Write("^^^^^^^^\tIf there are scattered subrooms, which are not connected, this is ok.");
-                continue;
-            }
-            //
-            std::pair<int, int> key_ij = std::make_pair(otherDoor.second, rctIt->second);
-            std::pair<int, int> key_ji = std::make_pair(rctIt->second, otherDoor.second);
-
-
-#pragma omp critical(_distMatrix)
-            if(_distMatrix.at(key_ij) > tempDistance) {
-                _distMatrix.erase(key_ij);
-                _distMatrix.erase(key_ji);
-                _distMatrix.insert(std::make_pair(key_ij, tempDistance));
-                _distMatrix.insert(std::make_pair(key_ji, tempDistance));
-            }
+            doorPairs.emplace_back(std::make_pair(doorUID, otherDoor.second), roomID);
         } // otherDoor
     }     // roomAndCroTrVector
 
+    //the distances are read (or, with lazy floor fields, calculated) in parallel, each into its
+    //own slot, and entered into the matrix in the order of the pairs afterwards
+    std::vector<double> distances(doorPairs.size(), DBL_MAX);
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < doorPairs.size(); ++i) {
+        const auto & [doors, roomID] = doorPairs[i];
+        distances[i] = _locffviafm.at(roomID)->getDistanceBetweenDoors(doors.first, doors.second);
+    }
+
+    for(size_t i = 0; i < doorPairs.size(); ++i) {
+        const auto & [doors, roomID] = doorPairs[i];
+        const auto & [door1, door2]  = doors;
+        const double tempDistance    = distances[i];
+        if(tempDistance < _locffviafm.at(roomID)->getGrid()->Gethx()) {
+            Log->Write(
+                "WARNING:\tIgnoring distance of doors %d and %d because it is too small: %f",
+                door1,
+                door2,
+                tempDistance);
+            //Log->Write("^^^^^^^^\tIf there are scattered subrooms, which are not connected, this is ok.");
+            continue;
+        }
+        if(_distMatrix.GetDistance(door2, door1) > tempDistance) {
+            _distMatrix.SetDistance(door2, door1, tempDistance);
+            _distMatrix.SetDistance(door1, door2, tempDistance);
+            _doorDistances[door2][door1] = tempDistance;
+            _doorDistances[door1][door2] = tempDistance;
+        }
+    }
+
     if(_config->get_has_directional_escalators()) {
         _directionalEscalatorsUID.clear();
         _penaltyList.clear();
@@ -300,12 +373,14 @@ bool FFRouter::Init(Building * building)
             }
         }
         for(auto key : _penaltyList) {
-            _distMatrix.erase(key);
-            _distMatrix.insert(std::make_pair(key, DBL_MAX));
+            if(_distMatrix.Contains(key.first) && _distMatrix.Contains(key.second)) {
+                _distMatrix.SetDistance(key.first, key.second, DBL_MAX);
+            }
         }
     }
 
     FloydWarshall();
+    BuildExitCache();
 
     //debug output in file
     //     _locffviafm[4]->writeFF("ffTreppe.vtk", _allDoorUIDs);
@@ -341,10 +416,6 @@ bool FFRouter::Init(Building * building)
 
 bool FFRouter::ReInit()
 {
-    //cleanse maps
-    _distMatrix.clear();
-    _pathsMatrix.clear();
-
     // Geometry may change due to trains or whatever happens in the future
     //get all door UIDs
     _allDoorUIDs.clear();
@@ -389,19 +460,33 @@ bool FFRouter::ReInit()
     _allDoorUIDs.erase(std::unique(_allDoorUIDs.begin(), _allDoorUIDs.end()), _allDoorUIDs.end());
 
     // alldoorUIDs reinit
-    //init, yet no distances, only create map entries
-    for(auto & id1 : _allDoorUIDs) {
-        for(auto & id2 : _allDoorUIDs) {
-            std::pair<int, int> key = std::make_pair(id1, id2);
-            double value            = (id1 == id2) ? 0.0 : DBL_MAX;
-            //distMatrix[i][j] = 0,   if i==j
-            //distMatrix[i][j] = max, else
-            _distMatrix.insert(std::make_pair(key, value));
-            //pathsMatrix[i][j] = i or j ? (follow wiki:path_reconstruction, it should be j)
-            _pathsMatrix.insert(std::make_pair(key, id2));
+    //init, yet no distances
+    _distMatrix.Reset(GetMatrixDoorUIDs());
+
+    //the speeds of the floor fields change, other routers must not use them any more. A door that
+    //was closed when the field of its room was calculated is a wall in it, these rooms get a new
+    //field as well. The replacements have no door fields yet.
+    std::set<int> replacedRooms;
+    for(auto & [roomID, floorfield] : _roomFloorfields) {
+        if(_floorfieldStore) {
+            _floorfieldStore->Remove(floorfield.get());
+        }
+        const std::vector<int> knownDoors = floorfield->getKnownDoorUIDs();
+        const bool doorOpened             = std::any_of(
+            roomAndCroTrVector.begin(), roomAndCroTrVector.end(), [&](const auto & roomAndDoor) {
+                return roomAndDoor.first == roomID &&
+                       std::find(knownDoors.begin(), knownDoors.end(), roomAndDoor.second) ==
+                           knownDoors.end();
+            });
+        if(floorfield.use_count() > 1 || doorOpened) {
+            floorfield.reset(CreateRoomFloorfield(_building->GetAllRooms().at(roomID).get()));
+            _locffviafm[roomID] = floorfield.get();
+            replacedRooms.insert(roomID);
         }
     }
-
+    if(!replacedRooms.empty() && _config->get_ff_lazy()) {
+        UnivFFviaFM::setLazy(_locffviafm, _config->get_ff_memory_budget());
+    }
     for(auto floorfield : _locffviafm) {
         floorfield.second->setSpeedMode(FF_PED_SPEED);
         //@todo: ar.graf: create a list of local ped-ptr instead of giving all peds-ptr
@@ -410,7 +495,11 @@ bool FFRouter::ReInit()
             _building->GetAllPedestrians().size(),
             _mode,
             1.);
-        floorfield.second->recreateAllForQuickest();
+        if(replacedRooms.count(floorfield.first) != 0 && !_config->get_ff_lazy()) {
+            floorfield.second->addAllTargetsParallel();
+        } else {
+            floorfield.second->recreateAllForQuickest();
+        }
         std::vector<int> allDoors(floorfield.second->getKnownDoorUIDs());
         for(auto firstDoor : allDoors) {
             for(auto secondDoor : allDoors) {
@@ -449,13 +538,11 @@ bool FFRouter::ReInit()
                     //Log->Write("^^^^^^^^\tIf there are scattered subrooms, which are not connected, this is ok.");
                     continue;
                 }
-                std::pair<int, int> key_ij = std::make_pair(secondDoor, firstDoor);
-                std::pair<int, int> key_ji = std::make_pair(firstDoor, secondDoor);
-                if(_distMatrix.at(key_ij) > tempDistance) {
-                    _distMatrix.erase(key_ij);
-                    _distMatrix.erase(key_ji);
-                    _distMatrix.insert(std::make_pair(key_ij, tempDistance));
-                    _distMatrix.insert(std::make_pair(key_ji, tempDistance));
+                if(_distMatrix.GetDistance(secondDoor, firstDoor) > tempDistance) {
+                    _distMatrix.SetDistance(secondDoor, firstDoor, tempDistance);
+                    _distMatrix.SetDistance(firstDoor, secondDoor, tempDistance);
+                    _doorDistances[secondDoor][firstDoor] = tempDistance;
+                    _doorDistances[firstDoor][secondDoor] = tempDistance;
                 }
             } //secondDoor(s)
         }     //firstDoor(s)
@@ -491,12 +578,14 @@ bool FFRouter::ReInit()
             }
         }
         for(auto key : _penaltyList) {
-            _distMatrix.erase(key);
-            _distMatrix.insert(std::make_pair(key, DBL_MAX));
+            if(_distMatrix.Contains(key.first) && _distMatrix.Contains(key.second)) {
+                _distMatrix.SetDistance(key.first, key.second, DBL_MAX);
+            }
         }
     }
 
     FloydWarshall();
+    BuildExitCache();
     _plzReInit = false;
     return true;
 }
@@ -533,146 +622,101 @@ int FFRouter::FindExit(Pedestrian * p)
             _plzReInit = true;
         }
     }
-    double minDist = DBL_MAX;
-    int bestDoor   = -1;
 
     int goalID = p->GetFinalDestination();
 
     if(WaitingArea * wa = dynamic_cast<WaitingArea *>(_building->GetFinalGoal(goalID))) {
-        bestDoor = wa->GetCentreCrossing()->GetUniqueID();
+        int bestDoor = wa->GetCentreCrossing()->GetUniqueID();
         p->SetExitIndex(bestDoor);
         p->SetExitLine(_CroTrByUID.at(bestDoor));
         return bestDoor;
     }
 
-    std::vector<int> validFinalDoor; //UIDs of doors
-    validFinalDoor.clear();
-    if(goalID == -1) {
-        for(auto & pairDoor : _ExitsByUID) {
-            //we add the all exits,
-            validFinalDoor.emplace_back(pairDoor.first); //UID
-        }
-    } else { //only one specific goal, goalToLineUIDmap gets
-        //populated in Init()
-        if((_goalToLineUIDmap.count(goalID) == 0) || (_goalToLineUIDmap[goalID] == -1)) {
+    //slot 0 are all exits, specific goals get populated in BuildExitCache()
+    std::size_t goalSlot = 0;
+    bool knownGoal       = true;
+    if(goalID != -1) {
+        auto slotIt = _exitGoalSlots.find(goalID);
+        if(slotIt == _exitGoalSlots.end()) {
             Log->Write(
                 "ERROR: \t ffRouter: unknown/unreachable goalID: %d in FindExit(Ped)", goalID);
+            knownGoal = false;
         } else {
-            validFinalDoor.emplace_back(_goalToLineUIDmap.at(goalID));
+            goalSlot = slotIt->second;
         }
     }
 
-    std::vector<int> DoorUIDsOfRoom;
-    DoorUIDsOfRoom.clear();
     if(_building->GetRoom(p->GetRoomID())
            ->GetSubRoom(p->GetSubRoomID())
            ->IsInSubRoom(p->GetPos())) {
         //ped is in the subroom, according to its member attribs
     } else {
-        bool located         = false;
         SubRoom * oldSubRoom = _building->GetRoom(p->GetRoomID())->GetSubRoom(p->GetSubRoomID());
-        for(auto & room : _building->GetAllRooms()) {
-            if(located) {
-                break;
-            }
-            for(auto & subroom : room.second->GetAllSubRooms()) {
-                if(subroom.second->IsInSubRoom(p->GetPos()) &&
-                   subroom.second->IsDirectlyConnectedWith(oldSubRoom)) {
-                    //maybe room on wrong floor
-                    p->SetRoomID(room.second->GetID(), room.second->GetCaption());
-                    p->SetSubRoomID(subroom.second->GetSubRoomID());
-                    p->SetSubRoomUID(subroom.second->GetUID());
-                    located = true;
-                    break;
-                }
-            }
-        }
-        if(!located) { //ped is outside
+        SubRoom * subroom    = _building->FindSubRoom(
+            p->GetPos(), p->GetElevation(), [oldSubRoom](SubRoom * candidate) {
+                return candidate->IsDirectlyConnectedWith(oldSubRoom);
+            });
+        if(!subroom) { //ped is outside
             return -1;
         }
+        //maybe room on wrong floor
+        Room * room = _building->GetRoom(subroom->GetRoomID());
+        p->SetRoomID(room->GetID(), room->GetCaption());
+        p->SetSubRoomID(subroom->GetSubRoomID());
+        p->SetSubRoomUID(subroom->GetUID());
     }
-    DoorUIDsOfRoom.clear();
-    if(!_targetWithinSubroom) {
-        //candidates of current room (ID) (provided by Room)
-        for(auto transUID : _building->GetRoom(p->GetRoomID())->GetAllTransitionsIDs()) {
-            // TODO if ((_CroTrByUID.count(transUID) != 0) && (_CroTrByUID[transUID]->IsOpen())) {
-            if((_CroTrByUID.count(transUID) != 0) && (!_CroTrByUID[transUID]->IsClose())) {
-                DoorUIDsOfRoom.emplace_back(transUID);
-            }
-        }
-        for(auto & subIPair : _building->GetRoom(p->GetRoomID())->GetAllSubRooms()) {
-            for(auto & crossI : subIPair.second->GetAllCrossings()) {
-                // TODO if (crossI->IsOpen()) {
-                if(!crossI->IsClose()) {
-                    DoorUIDsOfRoom.emplace_back(crossI->GetUniqueID());
-                }
-            }
+    if(!knownGoal) {
+        return -1;
+    }
+
+    //candidates of current room or subroom, depending on _targetWithinSubroom
+    const int subroomUID =
+        _building->GetRoom(p->GetRoomID())->GetSubRoom(p->GetSubRoomID())->GetUID();
+    if(subroomUID < 0 || subroomUID >= static_cast<int>(_exitCandidates.size())) {
+        return -1;
+    }
+    const std::size_t offset = goalSlot * _distMatrix.Size();
+    double minDist           = DBL_MAX;
+    int bestIndex            = -1;
+    int bestDoor             = -1;
+    int bestFinalDoor        = -1; // to silence the compiler
+    for(const ExitCandidate & candidate : _exitCandidates[subroomUID]) {
+        // TODO if (candidate.door->IsOpen()) {
+        const double remainingDist = _exitDistance[offset + candidate.index];
+        if(candidate.door->IsClose() || remainingDist == DBL_MAX) {
+            continue;
         }
-    } else {
-        //candidates of current subroom only
-        for(auto & crossI :
-            _building->GetRoom(p->GetRoomID())->GetSubRoom(p->GetSubRoomID())->GetAllCrossings()) {
-            //TODO if (crossI->IsOpen()) {
-            if(!crossI->IsClose()) {
-                DoorUIDsOfRoom.emplace_back(crossI->GetUniqueID());
-            }
+        const int doorUID = candidate.door->GetUniqueID();
+        double locDistToDoor =
+            _config->GetDirectionManager()->GetDirectionStrategy()->GetDistance2Target(
+                p, doorUID);
+        if(locDistToDoor <
+           -J_EPS) { //for old ff: //this can happen, if the point is not reachable and therefore has init val -7
+            continue;
         }
-
-        for(auto & transI : _building->GetRoom(p->GetRoomID())
-                                ->GetSubRoom(p->GetSubRoomID())
-                                ->GetAllTransitions()) {
-            //TODO if (transI->IsClose()) {
-            if(!transI->IsClose()) {
-                DoorUIDsOfRoom.emplace_back(transI->GetUniqueID());
-            }
+        // on equal distances the final door with the lower UID wins
+        const int finalDoor = _exitFinalDoor[offset + candidate.index];
+        if((remainingDist + locDistToDoor) < minDist ||
+           ((remainingDist + locDistToDoor) == minDist && finalDoor < bestFinalDoor)) {
+            minDist       = remainingDist + locDistToDoor;
+            bestIndex     = candidate.index;
+            bestDoor      = doorUID;
+            bestFinalDoor = finalDoor;
         }
     }
-
-    int bestFinalDoor = -1; // to silence the compiler
-    for(int finalDoor : validFinalDoor) {
-        //with UIDs, we can ask for shortest path
-        for(int doorUID : DoorUIDsOfRoom) {
-            //double locDistToDoor = _locffviafm[p->GetRoomID()]->getCostToDestination(doorUID, p->GetPos(), _mode);
-            double locDistToDoor =
-                _config->GetDirectionManager()->GetDirectionStrategy()->GetDistance2Target(
-                    p, doorUID);
-
-            if(locDistToDoor <
-               -J_EPS) { //for old ff: //this can happen, if the point is not reachable and therefore has init val -7
-                continue;
-            }
-            std::pair<int, int> key = std::make_pair(doorUID, finalDoor);
-            //auto subroomDoors = _building->GetSubRoomByUID(p->GetSubRoomUID())->GetAllGoalIDs();
-            //only consider, if paths exists
-            if(_pathsMatrix.count(key) == 0) {
-                Log->Write("no key for %d %d", key.first, key.second);
-                continue;
-            }
-
-            if((_distMatrix.count(key) != 0) && (_distMatrix.at(key) != DBL_MAX)) {
-                if((_distMatrix.at(key) + locDistToDoor) < minDist) {
-                    minDist  = _distMatrix.at(key) + locDistToDoor;
-                    bestDoor = key.first; //doorUID
-                    //if (locDistToDoor == 0.) {
-                    if(true) {
-                        auto subroomDoors =
-                            _building->GetSubRoomByUID(p->GetSubRoomUID())->GetAllGoalIDs();
-                        if(std::find(subroomDoors.begin(), subroomDoors.end(), _pathsMatrix[key]) !=
-                           subroomDoors.end()) {
-                            bestDoor = _pathsMatrix[key]; //@todo: @ar.graf: check this hack
-                        }
-                    }
-                    bestFinalDoor = key.second;
-                }
-            }
+    if(bestIndex != -1) {
+        const std::vector<int> & subroomDoors =
+            _building->GetSubRoomByUID(p->GetSubRoomUID())->GetAllGoalIDs();
+        int nextDoor = _exitNextDoor[offset + bestIndex];
+        if(std::find(subroomDoors.begin(), subroomDoors.end(), nextDoor) != subroomDoors.end()) {
+            bestDoor = nextDoor; //@todo: @ar.graf: check this hack
         }
     }
 
     //at this point, bestDoor is either a crossing or a transition
     if((!_targetWithinSubroom) && (_CroTrByUID.count(bestDoor) != 0)) {
         while(!_CroTrByUID[bestDoor]->IsTransition()) {
-            std::pair<int, int> key = std::make_pair(bestDoor, bestFinalDoor);
-            bestDoor                = _pathsMatrix[key];
+            bestDoor = _distMatrix.GetPath(bestDoor, bestFinalDoor);
         }
     }
 
@@ -688,31 +732,8 @@ int FFRouter::FindExit(Pedestrian * p)
 
 void FFRouter::FloydWarshall()
 {
-    bool change  = false;
-    int totalnum = _allDoorUIDs.size();
-    for(int k = 0; k < totalnum; ++k) {
-        for(int i = 0; i < totalnum; ++i) {
-            for(int j = 0; j < totalnum; ++j) {
-                std::pair<int, int> key_ij = std::make_pair(_allDoorUIDs[i], _allDoorUIDs[j]);
-                std::pair<int, int> key_ik = std::make_pair(_allDoorUIDs[i], _allDoorUIDs[k]);
-                std::pair<int, int> key_kj = std::make_pair(_allDoorUIDs[k], _allDoorUIDs[j]);
-                if((_distMatrix[key_ik] < DBL_MAX) && (_distMatrix[key_kj] < DBL_MAX) &&
-                   (_distMatrix[key_ik] + _distMatrix[key_kj] < _distMatrix[key_ij])) {
-                    _distMatrix.erase(key_ij);
-                    _distMatrix.insert(
-                        std::make_pair(key_ij, _distMatrix[key_ik] + _distMatrix[key_kj]));
-                    _pathsMatrix.erase(key_ij);
-                    _pathsMatrix.insert(std::make_pair(key_ij, _pathsMatrix[key_ik]));
-                    change = true;
-                }
-            }
-        }
-    }
-    if(change) {
-        FloydWarshall();
-    } else {
-        Log->Write("INFO:\t FloydWarshall done!");
-    }
+    _distMatrix.FloydWarshall();
+    Log->Write("INFO:\t FloydWarshall done!");
 }
 
 void FFRouter::SetMode(std::string s)
@@ -743,5 +764,217 @@ void FFRouter::SetRecalc(double t)
 
 void FFRouter::Update()
 {
+    if(_config->get_incremental_update() && _mode != quickest && RepairDistances()) {
+        return;
+    }
     this->ReInit();
 }
+
+void FFRouter::SetFloorfieldStore(std::shared_ptr<FloorfieldStore> store)
+{
+    _floorfieldStore = std::move(store);
+    if(!_floorfieldStore || !_building) {
+        return;
+    }
+    for(auto & [roomID, floorfield] : _roomFloorfields) {
+        _floorfieldStore->Insert(*_building->GetAllRooms().at(roomID), floorfield);
+    }
+}
+
+UnivFFviaFM * FFRouter::CreateRoomFloorfield(Room * room) const
+{
+    auto * floorfield =
+        new UnivFFviaFM(room, _config, ROOM_FF_SPACING, ROOM_FF_WALL_AVOID, false);
+    floorfield->setUser(DISTANCE_MEASUREMENTS_ONLY);
+    floorfield->setMode(CENTERPOINT);
+    floorfield->setSpeedMode(FF_HOMO_SPEED);
+    floorfield->setBuilding(_building);
+    return floorfield;
+}
+
+std::vector<int> FFRouter::GetMatrixDoorUIDs()
+{
+    _closedDoorUIDs.clear();
+    std::vector<int> doorUIDs;
+    for(auto & pair : _building->GetAllTransitions()) {
+        doorUIDs.emplace_back(pair.second->GetUniqueID());
+        if(pair.second->IsClose()) {
+            _closedDoorUIDs.insert(pair.second->GetUniqueID());
+        }
+    }
+    for(auto & pair : _building->GetAllCrossings()) {
+        doorUIDs.emplace_back(pair.second->GetUniqueID());
+        if(pair.second->IsClose()) {
+            _closedDoorUIDs.insert(pair.second->GetUniqueID());
+        }
+    }
+    std::sort(doorUIDs.begin(), doorUIDs.end());
+    doorUIDs.erase(std::unique(doorUIDs.begin(), doorUIDs.end()), doorUIDs.end());
+    return doorUIDs;
+}
+
+bool FFRouter::RepairDistances()
+{
+    // collect the doors which were opened or closed since the last (re)init
+    std::vector<Crossing *> changedDoors;
+    std::size_t nDoors = 0;
+    auto checkDoor     = [&](Crossing * door) {
+        const int uid = door->GetUniqueID();
+        if(!_distMatrix.Contains(uid)) {
+            return false;
+        }
+        if(door->IsClose() != (_closedDoorUIDs.count(uid) > 0)) {
+            changedDoors.emplace_back(door);
+        }
+        ++nDoors;
+        return true;
+    };
+    for(auto & pair : _building->GetAllTransitions()) {
+        if(!checkDoor(pair.second)) {
+            return false; // geometry changed, e.g. by trains
+        }
+    }
+    for(auto & pair : _building->GetAllCrossings()) {
+        if(!checkDoor(pair.second)) {
+            return false;
+        }
+    }
+    if(nDoors != _distMatrix.Size()) {
+        return false;
+    }
+    // a door closed when the floor fields were calculated is a wall in them, its distances are
+    // unknown
+    for(Crossing * door : changedDoors) {
+        const auto known = _doorDistances.find(door->GetUniqueID());
+        if(!door->IsClose() && (known == _doorDistances.end() || known->second.empty())) {
+            return false;
+        }
+    }
+
+    for(Crossing * door : changedDoors) {
+        const int uid = door->GetUniqueID();
+        if(door->IsClose()) {
+            _closedDoorUIDs.insert(uid);
+            _CroTrByUID.erase(uid);
+            _ExitsByUID.erase(uid);
+            _allDoorUIDs.erase(
+                std::remove(_allDoorUIDs.begin(), _allDoorUIDs.end(), uid), _allDoorUIDs.end());
+        } else {
+            _closedDoorUIDs.erase(uid);
+            _CroTrByUID.insert(std::make_pair(uid, door));
+            if(door->IsTransition() && static_cast<Transition *>(door)->IsExit()) {
+                _ExitsByUID.insert(std::make_pair(uid, static_cast<Transition *>(door)));
+            }
+            _allDoorUIDs.insert(
+                std::lower_bound(_allDoorUIDs.begin(), _allDoorUIDs.end(), uid), uid);
+        }
+    }
+
+    // edge length of the door graph with the current door states
+    auto edgeLength = [this](int from, int to, double distance) {
+        if(_closedDoorUIDs.count(from) || _closedDoorUIDs.count(to) ||
+           std::find(_penaltyList.begin(), _penaltyList.end(), std::make_pair(from, to)) !=
+               _penaltyList.end()) {
+            return DBL_MAX;
+        }
+        return distance;
+    };
+
+    std::size_t nRows = 0;
+    for(Crossing * door : changedDoors) {
+        const int uid = door->GetUniqueID();
+        for(auto [otherUID, distance] : _doorDistances[uid]) {
+            if(!_distMatrix.Contains(otherUID)) {
+                continue;
+            }
+            nRows += _distMatrix.UpdateEdge(uid, otherUID, edgeLength(uid, otherUID, distance));
+            nRows += _distMatrix.UpdateEdge(otherUID, uid, edgeLength(otherUID, uid, distance));
+        }
+    }
+    Log->Write(
+        "INFO: 	FF Router repaired paths of %d changed doors (%d rows recomputed)",
+        static_cast<int>(changedDoors.size()),
+        static_cast<int>(nRows));
+    BuildExitCache();
+    return true;
+}
+
+void FFRouter::BuildExitCache()
+{
+    //final doors of every goal, slot 0 are all exits (ordered by UID)
+    std::vector<std::vector<int>> finalDoorsOfSlot(1);
+    for(auto & pairDoor : _ExitsByUID) {
+        finalDoorsOfSlot[0].emplace_back(pairDoor.first);
+    }
+    _exitGoalSlots.clear();
+    for(auto & [goalID, lineUID] : _goalToLineUIDmap) {
+        if(lineUID == -1) {
+            continue; // unreachable goal
+        }
+        _exitGoalSlots[goalID] = finalDoorsOfSlot.size();
+        finalDoorsOfSlot.push_back({lineUID});
+    }
+
+    //min remaining distance of every door to the final doors of each slot
+    const std::vector<int> & doorUIDs = _distMatrix.GetUIDs();
+    const std::size_t nDoors          = doorUIDs.size();
+    _exitDistance.assign(finalDoorsOfSlot.size() * nDoors, DBL_MAX);
+    _exitFinalDoor.assign(finalDoorsOfSlot.size() * nDoors, -1);
+    _exitNextDoor.assign(finalDoorsOfSlot.size() * nDoors, -1);
+    for(std::size_t slot = 0; slot < finalDoorsOfSlot.size(); ++slot) {
+        for(int finalDoor : finalDoorsOfSlot[slot]) {
+            if(!_distMatrix.Contains(finalDoor)) {
+                Log->Write("no key for final door %d", finalDoor);
+                continue;
+            }
+            for(std::size_t i = 0; i < nDoors; ++i) {
+                const double distance = _distMatrix.GetDistance(doorUIDs[i], finalDoor);
+                if(distance < _exitDistance[slot * nDoors + i]) {
+                    _exitDistance[slot * nDoors + i]  = distance;
+                    _exitFinalDoor[slot * nDoors + i] = finalDoor;
+                    _exitNextDoor[slot * nDoors + i]  = _distMatrix.GetPath(doorUIDs[i], finalDoor);
+                }
+            }
+        }
+    }
+
+    //candidate doors of every subroom, open or closed
+    auto addCandidate = [this](std::vector<ExitCandidate> & candidates, Crossing * door) {
+        const int index = _distMatrix.IndexOf(door->GetUniqueID());
+        if(index != -1) {
+            candidates.push_back({door, index});
+        }
+    };
+    _exitCandidates.clear();
+    for(auto & room : _building->GetAllRooms()) {
+        for(auto & subroom : room.second->GetAllSubRooms()) {
+            const int subroomUID = subroom.second->GetUID();
+            if(subroomUID >= static_cast<int>(_exitCandidates.size())) {
+                _exitCandidates.resize(subroomUID + 1);
+            }
+            std::vector<ExitCandidate> & candidates = _exitCandidates[subroomUID];
+            if(!_targetWithinSubroom) {
+                //candidates of current room (ID) (provided by Room)
+                for(auto transUID : room.second->GetAllTransitionsIDs()) {
+                    auto transIt = _CroTrByUID.find(transUID);
+                    if(transIt != _CroTrByUID.end()) {
+                        addCandidate(candidates, transIt->second);
+                    }
+                }
+                for(auto & subIPair : room.second->GetAllSubRooms()) {
+                    for(auto & crossI : subIPair.second->GetAllCrossings()) {
+                        addCandidate(candidates, crossI);
+                    }
+                }
+            } else {
+                //candidates of current subroom only
+                for(auto & crossI : subroom.second->GetAllCrossings()) {
+                    addCandidate(candidates, crossI);
+                }
+                for(auto & transI : subroom.second->GetAllTransitions()) {
+                    addCandidate(candidates, transI);
+                }
+            }
+        }
+    }
+}
@@ -57,12 +57,17 @@
  **/
 #pragma once
 
+#include "FloorfieldStore.h"
 #include "FloorfieldViaFM.h"
 #include "UnivFFviaFM.h"
 #include "general/Macros.h"
 #include "geometry/Building.h"
+#include "routing/DistanceMatrix.h"
 #include "routing/Router.h"
 
+#include <memory>
+#include <set>
+
 class Building;
 class Pedestrian;
 class OutputHandler;
@@ -181,13 +186,65 @@ public:
     bool MustReInit();
     void SetRecalc(double t);
 
+    /*!
+      * \brief Update the router after doors were opened or closed
+      *
+      * With the router parameter incremental_update only the shortest paths
+      * affected by the changed doors are repaired (see RepairDistances()),
+      * otherwise (and always in quickest mode) ReInit() is called. The
+      * repaired paths keep the distances of Init() without pedestrians, while
+      * ReInit() measures them with the current pedestrian speeds.
+      */
     virtual void Update();
 
+    /*!
+      * \brief Share the floor fields of the rooms with the other routers of store
+      *
+      * Init() takes the floor fields of rooms whose doors are in the same
+      * state from the store instead of calculating them. Called after Init(),
+      * the floor fields of this router are added to the store.
+      */
+    void SetFloorfieldStore(std::shared_ptr<FloorfieldStore> store);
+
 private:
+    /// floor field of a room without its door fields
+    UnivFFviaFM * CreateRoomFloorfield(Room * room) const;
+
+    /*!
+      * \brief UIDs of all doors (open and closed), the nodes of _distMatrix
+      *
+      * Also remembers the currently closed doors in _closedDoorUIDs.
+      */
+    std::vector<int> GetMatrixDoorUIDs();
+
+    /*!
+      * \brief Repair the shortest paths after doors were opened or closed
+      *
+      * The edges of the changed doors are set to their recorded lengths (open)
+      * or removed (closed), only the affected rows of _distMatrix are
+      * recomputed. The floor fields are not touched.
+      *
+      * \return false if the doors of the building changed or a door was opened
+      *         that was closed in the floor fields, ReInit() is needed then
+      */
+    bool RepairDistances();
+
+    /*!
+      * \brief Precompute the exit potentials used by FindExit()
+      *
+      * For every door and every final goal (all exits or one specific goal)
+      * the remaining distance to the goal, the final door and the next hop
+      * are stored in flat arrays, as well as the candidate doors of every
+      * subroom. Must be called whenever _distMatrix or _CroTrByUID changed.
+      */
+    void BuildExitCache();
+
 protected:
     Configuration * _config;
-    std::map<std::pair<int, int>, double> _distMatrix;
-    std::map<std::pair<int, int>, int> _pathsMatrix;
+    DistanceMatrix _distMatrix; // distances and next hop between all door UIDs
+    std::map<int, std::map<int, double>>
+        _doorDistances;            // door to door distances measured in the floor fields
+    std::set<int> _closedDoorUIDs; // doors closed when _distMatrix was last updated
     //std::map< std::pair<int, int> , SubRoom* > _subroomMatrix;
     std::vector<int> _allDoorUIDs;
     std::vector<int> _localShortestSafedPeds;
@@ -195,11 +252,25 @@ protected:
     std::vector<std::pair<int, int>> _penaltyList;
     const Building * _building;
     std::map<int, UnivFFviaFM *> _locffviafm; // the actual type might be CentrePointLocalFFViaFM
+    std::map<int, std::shared_ptr<UnivFFviaFM>> _roomFloorfields; // owns the fields of _locffviafm
+    std::shared_ptr<FloorfieldStore> _floorfieldStore; // floor fields shared with other routers
     FloorfieldViaFM * _globalFF;
     std::map<int, Transition *> _TransByUID;
     std::map<int, Transition *> _ExitsByUID;
     std::map<int, Crossing *> _CroTrByUID;
 
+    // exit potentials of FindExit(), see BuildExitCache()
+    struct ExitCandidate {
+        Crossing * door;
+        int index; // index of the door in _distMatrix
+    };
+    std::vector<std::vector<ExitCandidate>> _exitCandidates; // by subroom UID
+    std::map<int, std::size_t> _exitGoalSlots; // goal ID -> slot, slot 0 are all exits
+    // per slot and door index (slot * doors + index):
+    std::vector<double> _exitDistance; // remaining distance to the goal
+    std::vector<int> _exitFinalDoor;   // final door of that distance
+    std::vector<int> _exitNextDoor;    // next hop towards the final door
+
     std::map<int, int>
         _goalToLineUIDmap; //key is the goalID and value is the UID of closest transition -> it maps goal to LineUID
     std::map<int, int> _goalToLineUIDmap2;
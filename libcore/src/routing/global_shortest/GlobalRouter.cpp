@@ -38,8 +38,6 @@ GlobalRouter::GlobalRouter() : Router()
     _accessPoints    = std::map<int, AccessPoint *>();
     _map_id_to_index = std::map<int, int>();
     _map_index_to_id = std::map<int, int>();
-    _distMatrix      = nullptr;
-    _pathsMatrix     = nullptr;
     _building        = nullptr;
     _edgeCost        = 100;
     _exitsCnt        = -1;
@@ -53,8 +51,6 @@ GlobalRouter::GlobalRouter(int id, RoutingStrategy s) : Router(id, s)
     _accessPoints    = std::map<int, AccessPoint *>();
     _map_id_to_index = std::map<int, int>();
     _map_index_to_id = std::map<int, int>();
-    _distMatrix      = nullptr;
-    _pathsMatrix     = nullptr;
     _building        = nullptr;
     _edgeCost        = 100;
     _exitsCnt        = -1;
@@ -64,16 +60,6 @@ GlobalRouter::GlobalRouter(int id, RoutingStrategy s) : Router(id, s)
 
 GlobalRouter::~GlobalRouter()
 {
-    if(_distMatrix && _pathsMatrix) {
-        for(int p = 0; p < _exitsCnt; ++p) {
-            delete[] _distMatrix[p];
-            delete[] _pathsMatrix[p];
-        }
-
-        delete[] _distMatrix;
-        delete[] _pathsMatrix;
-    }
-
     std::map<int, AccessPoint *>::const_iterator itr;
     for(itr = _accessPoints.begin(); itr != _accessPoints.end(); ++itr) {
         delete itr->second;
@@ -102,22 +88,9 @@ bool GlobalRouter::Init(Building * building)
     // initialize the distances matrix for the floydwahrshall
     _exitsCnt = _building->GetNumberOfGoals() + _building->GetAllGoals().size();
 
-    _distMatrix  = new double *[_exitsCnt];
-    _pathsMatrix = new int *[_exitsCnt];
-
-    for(int i = 0; i < _exitsCnt; ++i) {
-        _distMatrix[i]  = new double[_exitsCnt];
-        _pathsMatrix[i] = new int[_exitsCnt];
-    }
-
     // Initializing the values
     // all nodes are disconnected
-    for(int p = 0; p < _exitsCnt; ++p) {
-        for(int r = 0; r < _exitsCnt; ++r) {
-            _distMatrix[p][r]  = (r == p) ? 0.0 : FLT_MAX; /*0.0*/
-            _pathsMatrix[p][r] = p;                        /*0.0*/
-        }
-    }
+    _distMatrix.Reset(_exitsCnt);
 
     // init the access points
     int index = 0;
@@ -321,8 +294,10 @@ bool GlobalRouter::Init(Building * building)
                            _subroomsAtElevation[elevation],
                            true)) {
                         int to_door = _map_id_to_index[nav2->GetUniqueID()];
-                        _distMatrix[from_door][to_door] =
-                            penalty * (nav1->GetCentre() - nav2->GetCentre()).Norm();
+                        _distMatrix.SetDistance(
+                            from_door,
+                            to_door,
+                            penalty * (nav1->GetCentre() - nav2->GetCentre()).Norm());
                         from_AP->AddConnectingAP(_accessPoints[nav2->GetUniqueID()]);
                     }
                 }
@@ -369,12 +344,12 @@ bool GlobalRouter::Init(Building * building)
             int to_door   = _map_id_to_index[to_AP->GetID()];
             // I assume a direct line connection between every exit connected to the outside and
             // any final goal also located outside
-            _distMatrix[from_door][to_door] =
-                _edgeCost * from_AP->GetNavLine()->DistTo(goal->GetCentroid());
+            double dist = _edgeCost * from_AP->GetNavLine()->DistTo(goal->GetCentroid());
 
             // add a penalty for goals outside due to the direct line assumption while computing the distances
-            if(_distMatrix[from_door][to_door] > 10.0)
-                _distMatrix[from_door][to_door] *= 100;
+            if(dist > 10.0)
+                dist *= 100;
+            _distMatrix.SetDistance(from_door, to_door, dist);
         }
     }
 
@@ -412,7 +387,7 @@ bool GlobalRouter::Init(Building * building)
                     continue;
 
                 //cout <<" checking final destination: "<< pAccessPoints[j]->GetID()<<endl;
-                double dist = _distMatrix[from_door][to_door];
+                double dist = _distMatrix.GetDistance(from_door, to_door);
                 if(dist < tmpMinDist) {
                     tmpFinalGlobalNearestID = to_door;
                     tmpMinDist              = dist;
@@ -482,7 +457,8 @@ bool GlobalRouter::Init(Building * building)
             int from_door_matrix_index = _map_id_to_index[itr.first];
 
             //comment this if you want infinite as distance to unreachable destinations
-            double dist = _distMatrix[from_door_matrix_index][to_door_matrix_index];
+            double dist =
+                _distMatrix.GetDistance(from_door_matrix_index, to_door_matrix_index);
             from_AP->AddFinalDestination(_finalDestinations[p], dist);
 
             // set the intermediate path
@@ -522,15 +498,7 @@ bool GlobalRouter::Init(Building * building)
 
 void GlobalRouter::Reset()
 { //clean all allocated spaces
-    if(_distMatrix && _pathsMatrix) {
-        for(int p = 0; p < _exitsCnt; ++p) {
-            delete[] _distMatrix[p];
-            delete[] _pathsMatrix[p];
-        }
-
-        delete[] _distMatrix;
-        delete[] _pathsMatrix;
-    }
+    _distMatrix.Clear();
 
     for(auto itr = _accessPoints.begin(); itr != _accessPoints.end(); ++itr) {
         delete itr->second;
@@ -556,10 +524,10 @@ double GlobalRouter::GetEdgeCost() const
 
 void GlobalRouter::GetPath(int i, int j)
 {
-    if(_distMatrix[i][j] == FLT_MAX)
+    if(_distMatrix.GetDistance(i, j) == FLT_MAX)
         return;
     if(i != j)
-        GetPath(i, _pathsMatrix[i][j]);
+        GetPath(i, _distMatrix.GetPath(i, j));
     _tmpPedPath.push_back(j);
 }
 
@@ -685,17 +653,7 @@ bool GlobalRouter::GetPath(Pedestrian * ped, int goalID, std::vector<SubRoom *>
  */
 void GlobalRouter::FloydWarshall()
 {
-    const int n = _building->GetNumberOfGoals() + _building->GetAllGoals().size();
-    for(int k = 0; k < n; k++) {
-        for(int i = 0; i < n; i++) {
-            for(int j = 0; j < n; j++) {
-                if(_distMatrix[i][k] + _distMatrix[k][j] < _distMatrix[i][j]) {
-                    _distMatrix[i][j]  = _distMatrix[i][k] + _distMatrix[k][j];
-                    _pathsMatrix[i][j] = _pathsMatrix[k][j];
-                }
-            }
-        }
-    }
+    _distMatrix.FloydWarshall();
 }
 
 //void GlobalRouter::DumpAccessPoints(int p)
@@ -29,6 +29,7 @@
 
 #include "general/Filesystem.h"
 #include "geometry/Building.h"
+#include "routing/DistanceMatrix.h"
 #include "routing/Router.h"
 
 #include <cfloat>
@@ -212,8 +213,8 @@ private:
     double MinAngle(const Point & p1, const Point & p2, const Point & p3);
 
 private:
-    int ** _pathsMatrix;
-    double ** _distMatrix;
+    /// distances and predecessors between all access points (by matrix index)
+    DistanceMatrix _distMatrix{FLT_MAX, DistanceMatrix::PathConvention::Predecessor};
     double _edgeCost;
     int _exitsCnt;
     //if false, the router will only return the exits and not the navigations line created through the mesh or inserted
@@ -0,0 +1,153 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "IO/AsyncTrajectories.h"
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::string Describe(const TrajectoryFrame & frame)
+{
+    std::string event = "frame " + std::to_string(frame.frameNr);
+    for(const auto & agent : frame.agents) {
+        event += " " + std::to_string(agent.id);
+    }
+    return event;
+}
+
+/// records the calls, the events are only read after a flush
+class RecordingTrajectories : public Trajectories
+{
+public:
+    std::vector<std::string> events;
+    int failingFrame = -1;
+
+    void WriteHeader(long, double, Building *, int, int count) override
+    {
+        events.push_back("header " + std::to_string(count));
+    }
+    void WriteGeometry(Building *) override { events.emplace_back("geometry"); }
+    void WriteFooter() override { events.emplace_back("footer"); }
+    void WriteSources(const std::vector<std::shared_ptr<AgentsSource>> &) override {}
+
+    using Trajectories::WriteFrame;
+    void WriteFrame(const TrajectoryFrame & frame) override
+    {
+        if(frame.frameNr == failingFrame) {
+            throw std::runtime_error("disk full");
+        }
+        events.push_back(Describe(frame));
+    }
+};
+
+TrajectoryFrame MakeFrame(int frameNr, int nAgents)
+{
+    TrajectoryFrame frame;
+    frame.frameNr = frameNr;
+    for(int id = 1; id <= nAgents; ++id) {
+        AgentFrameData agent{};
+        agent.id = id;
+        frame.agents.push_back(agent);
+    }
+    return frame;
+}
+} // namespace
+
+TEST_CASE("IO/AsyncTrajectories", "[IO][AsyncTrajectories]")
+{
+    constexpr std::size_t depth = 2;
+    auto writer                 = std::make_unique<RecordingTrajectories>();
+    auto & recorder             = *writer;
+    AsyncTrajectories async(std::move(writer), depth);
+
+    SECTION("output keeps the order of the calls")
+    {
+        async.WriteHeader(0, 8, nullptr, 0, 0);
+        async.WriteGeometry(nullptr);
+        std::vector<std::string> expected{"header 0", "geometry"};
+        for(int frameNr = 0; frameNr < 50; ++frameNr) {
+            const TrajectoryFrame frame = MakeFrame(frameNr, frameNr % 3);
+            async.WriteFrame(frame);
+            expected.push_back(Describe(frame));
+            if(frameNr % 10 == 9) {
+                // like the rotation of the output file
+                async.Post([frameNr](Trajectories & trajectories) {
+                    trajectories.WriteHeader(0, 8, nullptr, 0, frameNr);
+                });
+                expected.push_back("header " + std::to_string(frameNr));
+            }
+        }
+        async.WriteFooter();
+        expected.emplace_back("footer");
+        REQUIRE(recorder.events == expected);
+    }
+
+    SECTION("frames are copied before WriteFrame returns")
+    {
+        TrajectoryFrame frame = MakeFrame(1, 1);
+        async.WriteFrame(frame);
+        frame.frameNr = 2;
+        async.WriteFrame(frame);
+        frame.agents.clear();
+        async.Flush();
+        REQUIRE(recorder.events == std::vector<std::string>{"frame 1 1", "frame 2 1"});
+    }
+
+    SECTION("WriteFrame blocks if all buffers are queued")
+    {
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        async.Post([released](Trajectories &) { released.wait(); });
+        for(std::size_t i = 0; i < depth; ++i) {
+            async.WriteFrame(MakeFrame(static_cast<int>(i), 1));
+        }
+
+        auto blocked = std::async(std::launch::async, [&async]() {
+            async.WriteFrame(MakeFrame(static_cast<int>(depth), 1));
+        });
+        REQUIRE(
+            blocked.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+
+        release.set_value();
+        blocked.get();
+        async.Flush();
+        REQUIRE(recorder.events.size() == depth + 1);
+    }
+
+    SECTION("errors of the writer thread are reported")
+    {
+        recorder.failingFrame = 1;
+        async.WriteFrame(MakeFrame(0, 1));
+        async.WriteFrame(MakeFrame(1, 1));
+        REQUIRE_THROWS_AS(async.Flush(), std::runtime_error);
+
+        // the error is reported once, the output continues afterwards
+        async.WriteFrame(MakeFrame(2, 1));
+        async.Flush();
+        REQUIRE(recorder.events.front() == "frame 0 1");
+        REQUIRE(recorder.events.back() == "frame 2 1");
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "IO/Trajectories.h"
+
+#include "IO/OutputHandler.h"
+#include "general/Configuration.h"
+#include "general/Filesystem.h"
+#include "geometry/Building.h"
+
+// reader of jpsreport
+#include "TrajectoriesBinaryReader.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("IO/TrajectoriesBinary", "[IO][TrajectoriesBinary]")
+{
+    const fs::path directory =
+        fs::temp_directory_path() / ("jps_trajectories_" + std::to_string(std::random_device{}()));
+    fs::create_directories(directory);
+    const fs::path file = directory / "trajectories.bin";
+    Configuration config;
+    config.SetProjectRootDir(directory);
+    config.SetGeometryFile("geometry.xml");
+    Building building;
+    building.SetConfig(&config);
+
+    //frame i has i agents, the first frame is empty
+    std::vector<TrajectoryFrame> frames(4);
+    for(int i = 0; i < static_cast<int>(frames.size()); ++i) {
+        frames[i].frameNr = 10 + i;
+        for(int k = 0; k < i; ++k) {
+            AgentFrameData agent{};
+            agent.id    = 3 * k + 1;
+            agent.x     = 1.25 * k + 0.5 * i;
+            agent.y     = k - 2.5;
+            agent.z     = 0.75 * i;
+            agent.angle = 30. * k;
+            frames[i].agents.push_back(agent);
+        }
+    }
+    {
+        TrajectoriesBinary trajectories;
+        trajectories.SetOutputHandler(std::make_shared<FileHandler>(file, true));
+        trajectories.WriteHeader(0, 8., &building, 42, 2);
+        for(const auto & frame : frames) {
+            trajectories.WriteFrame(frame);
+        }
+        trajectories.WriteFooter();
+    }
+    std::string bytes;
+    {
+        std::ifstream in(file, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    fs::remove_all(directory);
+
+    SECTION("read by jpsreport")
+    {
+        std::istringstream in(bytes);
+        BinaryTrajectories read;
+        REQUIRE(ReadBinaryTrajectories(in, read).empty());
+        REQUIRE(read.count == 2);
+        REQUIRE(read.seed == 42);
+        REQUIRE(read.fps == 8.);
+        REQUIRE(read.geometry == (directory / "geometry.xml").string());
+        REQUIRE(read.truncatedFrame == -1);
+        REQUIRE(read.frames == std::vector<int>{10, 11, 12, 13});
+        REQUIRE(read.frameStart.size() == frames.size() + 1);
+        for(std::size_t i = 0; i < frames.size(); ++i) {
+            REQUIRE(read.frameStart[i + 1] - read.frameStart[i] == frames[i].agents.size());
+            for(std::size_t k = 0; k < frames[i].agents.size(); ++k) {
+                const AgentFrameData & agent = frames[i].agents[k];
+                const std::size_t index      = read.frameStart[i] + k;
+                REQUIRE(read.ids[index] == agent.id);
+                REQUIRE(read.xs[index] == static_cast<float>(agent.x));
+                REQUIRE(read.ys[index] == static_cast<float>(agent.y));
+                REQUIRE(read.zs[index] == static_cast<float>(agent.z));
+            }
+        }
+    }
+
+    SECTION("the incomplete last frame is dropped")
+    {
+        std::istringstream in(bytes.substr(0, bytes.size() - 1));
+        BinaryTrajectories read;
+        REQUIRE(ReadBinaryTrajectories(in, read).empty());
+        REQUIRE(read.truncatedFrame == 13);
+        REQUIRE(read.frames == std::vector<int>{10, 11, 12});
+        REQUIRE(read.ids.size() == read.frameStart.back());
+    }
+
+    SECTION("files of the other byte order are rejected")
+    {
+        //the byte order mark follows the magic
+        std::reverse(bytes.begin() + 4, bytes.begin() + 8);
+        std::istringstream in(bytes);
+        BinaryTrajectories read;
+        REQUIRE(ReadBinaryTrajectories(in, read).find("byte order") != std::string::npos);
+    }
+}
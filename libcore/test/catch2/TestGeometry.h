@@ -0,0 +1,83 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#pragma once
+
+#include "geometry/Building.h"
+#include "geometry/Room.h"
+#include "geometry/SubRoom.h"
+#include "geometry/Transition.h"
+#include "geometry/Wall.h"
+
+#include <catch2/catch.hpp>
+#include <vector>
+
+/**
+ * Rooms of 4 m x 2 m in a row along the x axis, each with one subroom. Door i
+ * of 1 m width is at x = 4 i, doors 0 and nRooms are exits, door i connects the
+ * rooms i - 1 and i otherwise.
+ */
+inline void CreateRowOfRooms(Building & building, int nRooms)
+{
+    std::vector<Room *> rooms;
+    std::vector<SubRoom *> subrooms;
+    for(int id = 0; id < nRooms; ++id) {
+        const double x0 = 4. * id;
+        auto * room     = new Room();
+        room->SetID(id);
+        auto * sub = new NormalSubRoom();
+        sub->SetSubRoomID(0);
+        sub->SetRoomID(id);
+        sub->SetPlanEquation(0., 0., 0.);
+        sub->AddWall(Wall(Point(x0, 0), Point(x0 + 4, 0)));
+        sub->AddWall(Wall(Point(x0 + 4, 0), Point(x0 + 4, 0.5)));
+        sub->AddWall(Wall(Point(x0 + 4, 1.5), Point(x0 + 4, 2)));
+        sub->AddWall(Wall(Point(x0 + 4, 2), Point(x0, 2)));
+        sub->AddWall(Wall(Point(x0, 2), Point(x0, 1.5)));
+        sub->AddWall(Wall(Point(x0, 0.5), Point(x0, 0)));
+        room->AddSubRoom(sub);
+        building.AddRoom(room);
+        rooms.push_back(room);
+        subrooms.push_back(sub);
+    }
+
+    for(int id = 0; id <= nRooms; ++id) {
+        auto * door = new Transition();
+        door->SetID(id);
+        door->SetPoint1(Point(4. * id, 0.5));
+        door->SetPoint2(Point(4. * id, 1.5));
+        const int first = (id < nRooms) ? id : id - 1;
+        door->SetRoom1(rooms[first]);
+        door->SetSubRoom1(subrooms[first]);
+        subrooms[first]->AddTransition(door);
+        rooms[first]->AddTransitionID(door->GetUniqueID());
+        if(id > 0 && id < nRooms) {
+            door->SetRoom2(rooms[id - 1]);
+            door->SetSubRoom2(subrooms[id - 1]);
+            subrooms[id - 1]->AddTransition(door);
+            rooms[id - 1]->AddTransitionID(door->GetUniqueID());
+        }
+        building.AddTransition(door);
+    }
+    REQUIRE(building.InitGeometry());
+}
+
+/// corridor of 4 m x 2 m with an exit at both ends
+inline void CreateCorridor(Building & building)
+{
+    CreateRowOfRooms(building, 1);
+}
@@ -0,0 +1,142 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "events/EventManager.h"
+
+#include "TestGeometry.h"
+#include "general/Configuration.h"
+#include "general/OpenMP.h"
+#include "geometry/Building.h"
+#include "mpi/LCGrid.h"
+#include "pedestrian/Knowledge.h"
+#include "pedestrian/Pedestrian.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+/// gives the tests access to the dissemination of the knowledge
+class TestEventManager : public EventManager
+{
+public:
+    using EventManager::DisseminateKnowledge;
+    using EventManager::EventManager;
+
+    /// the dissemination as a serial loop over the pedestrians and their neighbourhood
+    void DisseminateKnowledgeSerially(Building * building)
+    {
+        for(auto && ped : building->GetAllPedestrians()) {
+            for(auto && info : ped->GetKnownledge()) {
+                info.second.DecreaseLatency(_updateFrequency);
+            }
+        }
+        for(auto && ped1 : building->GetAllPedestrians()) {
+            std::vector<Pedestrian *> neighbourhood;
+            building->GetGrid()->GetNeighbourhood(ped1, neighbourhood);
+            for(auto && ped2 : neighbourhood) {
+                if((ped1->GetPos() - ped2->GetPos()).Norm() < _updateRadius) {
+                    std::vector<SubRoom *> empty;
+                    if(building->IsVisible(ped1->GetPos(), ped2->GetPos(), empty)) {
+                        MergeKnowledge(ped1, ped2);
+                    }
+                }
+            }
+        }
+    }
+};
+
+/// knowledge of every pedestrian after some passes of the dissemination, without the door
+/// uids which differ from building to building
+std::vector<std::string> Disseminate(int nThreads, bool serially)
+{
+    Configuration config;
+    Building building;
+    CreateRowOfRooms(building, 3);
+    building.SetConfig(&config);
+    Transition * door = building.GetTransition(2);
+    door->Close();
+
+    //ten pedestrians per room, the ones close to the closed door know it
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> x(0.3, 3.7);
+    std::uniform_real_distribution<double> y(0.3, 1.7);
+    std::uniform_real_distribution<double> riskTolerance(0., 1.);
+    for(int roomID = 0; roomID < 3; ++roomID) {
+        SubRoom * subroom = building.GetRoom(roomID)->GetSubRoom(0);
+        for(int k = 0; k < 10; ++k) {
+            auto * ped = new Pedestrian();
+            ped->SetBuilding(&building);
+            ped->SetRoomID(roomID, "");
+            ped->SetSubRoomID(0);
+            ped->SetSubRoomUID(subroom->GetUID());
+            ped->SetPos(Point(4. * roomID + x(gen), y(gen)), true);
+            ped->SetRiskTolerance(riskTolerance(gen));
+            if(door->DistTo(ped->GetPos()) < 1.5) {
+                ped->AddKnownClosedDoor(door->GetUniqueID(), 0., true, 1.0, 1.0);
+            }
+            building.AddPedestrian(ped);
+        }
+    }
+    building.InitGrid();
+    building.UpdateGrid();
+
+    TestEventManager events(&config, &building, 7);
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(nThreads);
+#endif
+    for(int pass = 0; pass < 5; ++pass) {
+        if(serially) {
+            events.DisseminateKnowledgeSerially(&building);
+        } else {
+            events.DisseminateKnowledge(&building);
+        }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+
+    const std::string name = "door [" + std::to_string(door->GetUniqueID()) + "]";
+    std::vector<std::string> knowledge;
+    for(auto && ped : building.GetAllPedestrians()) {
+        std::string dump;
+        for(auto && info : ped->GetKnownledge()) {
+            REQUIRE(info.first == door->GetUniqueID());
+            dump += info.second.Dump().substr(name.size()) + "\n";
+        }
+        knowledge.push_back(dump);
+    }
+    return knowledge;
+}
+} // namespace
+
+TEST_CASE("events/EventManager knowledge dissemination", "[events][EventManager]")
+{
+    const std::vector<std::string> expected = Disseminate(1, true);
+    //the information passed through the crowd, and was refused by some
+    REQUIRE(std::count(expected.begin(), expected.end(), "") < 10);
+    REQUIRE(std::count_if(expected.begin(), expected.end(), [](const std::string & dump) {
+                return dump.find("Refused= 1") != std::string::npos;
+            }) > 0);
+
+    REQUIRE(Disseminate(1, false) == expected);
+    REQUIRE(Disseminate(4, false) == expected);
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "geometry/Crossing.h"
+
+#include <catch2/catch.hpp>
+#include <future>
+#include <map>
+
+TEST_CASE("geometry/Crossing/AssumeDoorStates", "[geometry][Crossing]")
+{
+    Crossing door;
+    Crossing other;
+    door.Close();
+
+    const std::map<int, DoorState> assumed{{door.GetUniqueID(), DoorState::TEMP_CLOSE}};
+
+    SECTION("calling thread")
+    {
+        Crossing::AssumeDoorStates(&assumed);
+        REQUIRE(door.IsTempClose());
+        REQUIRE_FALSE(door.IsClose());
+        REQUIRE(door.GetState() == DoorState::TEMP_CLOSE);
+        // doors without an assumed state keep their state
+        REQUIRE(other.IsOpen());
+
+        Crossing::AssumeDoorStates(nullptr);
+        REQUIRE(door.IsClose());
+    }
+
+    SECTION("other threads")
+    {
+        auto stateInThread = std::async(std::launch::async, [&]() {
+            Crossing::AssumeDoorStates(&assumed);
+            const DoorState state = door.GetState();
+            Crossing::AssumeDoorStates(nullptr);
+            return state;
+        });
+        REQUIRE(stateInThread.get() == DoorState::TEMP_CLOSE);
+        REQUIRE(door.IsClose());
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "geometry/SubRoomIndex.h"
+
+#include "geometry/Point.h"
+#include "geometry/SubRoom.h"
+#include "geometry/Wall.h"
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::unique_ptr<NormalSubRoom>
+Rectangle(int id, const Point & lowerLeft, const Point & upperRight, double elevation = 0.)
+{
+    auto sub = std::make_unique<NormalSubRoom>();
+    sub->SetSubRoomID(id);
+    sub->SetRoomID(0);
+    const Point lowerRight(upperRight._x, lowerLeft._y);
+    const Point upperLeft(lowerLeft._x, upperRight._y);
+    sub->AddWall(Wall(lowerLeft, lowerRight));
+    sub->AddWall(Wall(lowerRight, upperRight));
+    sub->AddWall(Wall(upperRight, upperLeft));
+    sub->AddWall(Wall(upperLeft, lowerLeft));
+    sub->ConvertLineToPoly({});
+    sub->CreateBoostPoly();
+    sub->SetPlanEquation(0., 0., elevation);
+    return sub;
+}
+
+SubRoom * BruteForceFind(const std::vector<SubRoom *> & subrooms, const Point & pos, int skip)
+{
+    for(SubRoom * sub : subrooms) {
+        if(sub->GetSubRoomID() % skip != 0 && sub->IsInSubRoom(pos)) {
+            return sub;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+TEST_CASE("geometry/SubRoomIndex", "[geometry][SubRoomIndex]")
+{
+    SECTION("empty index")
+    {
+        SubRoomIndex index;
+        REQUIRE(index.IsEmpty());
+        REQUIRE(index.Find(Point(0, 0), 0., [](SubRoom *) { return true; }) == nullptr);
+        REQUIRE(index.CountCandidates(Point(0, 0)) == 0);
+
+        index.Build({});
+        REQUIRE(index.IsEmpty());
+    }
+
+    SECTION("same result as testing all subrooms")
+    {
+        // 8 x 8 subrooms of 3 m x 3 m sharing their walls
+        std::vector<std::unique_ptr<NormalSubRoom>> storage;
+        std::vector<SubRoom *> subrooms;
+        for(int i = 0; i < 8; ++i) {
+            for(int j = 0; j < 8; ++j) {
+                storage.push_back(Rectangle(
+                    static_cast<int>(storage.size()),
+                    Point(3. * i, 3. * j),
+                    Point(3. * (i + 1), 3. * (j + 1))));
+                subrooms.push_back(storage.back().get());
+            }
+        }
+
+        SubRoomIndex index;
+        index.Build(subrooms);
+        REQUIRE(index.GetNumberOfSubRooms() == subrooms.size());
+
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> pos(-2., 26.);
+        for(int i = 0; i < 5000; ++i) {
+            const Point p(pos(gen), pos(gen));
+            const int skip = 1 + i % 3;
+            auto accept    = [skip](SubRoom * sub) { return sub->GetSubRoomID() % skip != 0; };
+            SubRoom * found = index.Find(p, 0., accept);
+            REQUIRE(found == BruteForceFind(subrooms, p, skip));
+            // the cells are as large as the subrooms, rounding at the borders
+            // adds at most the neighbours
+            REQUIRE(index.CountCandidates(p) <= 9);
+        }
+
+        // points on a shared wall are in no subroom
+        REQUIRE(index.Find(Point(3, 1), 0., [](SubRoom *) { return true; }) == nullptr);
+    }
+
+    SECTION("stacked floors")
+    {
+        auto ground  = Rectangle(1, Point(0, 0), Point(10, 10), 0.);
+        auto stairs  = Rectangle(2, Point(4, 4), Point(6, 12), 1.5);
+        auto upstair = Rectangle(3, Point(0, 0), Point(10, 10), 3.);
+        SubRoomIndex index;
+        index.Build({ground.get(), stairs.get(), upstair.get()});
+        auto all = [](SubRoom *) { return true; };
+
+        REQUIRE(index.Find(Point(1, 1), 0.2, all) == ground.get());
+        REQUIRE(index.Find(Point(1, 1), 2.9, all) == upstair.get());
+        REQUIRE(index.Find(Point(5, 5), 1.6, all) == stairs.get());
+        REQUIRE(index.Find(Point(5, 11), 0., all) == stairs.get());
+        REQUIRE(
+            index.Find(Point(1, 1), 2.9, [&](SubRoom * sub) { return sub != upstair.get(); }) ==
+            ground.get());
+        // equal distance to both floors, the first one wins
+        REQUIRE(index.Find(Point(1, 1), 1.5, all) == ground.get());
+    }
+}
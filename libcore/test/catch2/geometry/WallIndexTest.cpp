@@ -0,0 +1,162 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "geometry/WallIndex.h"
+
+#include "geometry/Line.h"
+#include "geometry/Point.h"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+bool BruteForceIntersectsAny(const std::vector<Line> & lines, const Point & p1, const Point & p2)
+{
+    for(const auto & line : lines) {
+        if(line.IntersectionWith(p1, p2)) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+TEST_CASE("geometry/WallIndex", "[geometry][WallIndex]")
+{
+    SECTION("empty index")
+    {
+        WallIndex index;
+        REQUIRE(index.IsEmpty());
+        REQUIRE_FALSE(index.IntersectsAny(Point(0, 0), Point(1, 1)));
+        REQUIRE(index.CountCandidates(Point(0, 0), Point(1, 1)) == 0);
+
+        index.Build({});
+        REQUIRE(index.IsEmpty());
+    }
+
+    SECTION("same result as testing all segments")
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> pos(0., 50.);
+        std::uniform_real_distribution<double> offset(-2., 2.);
+
+        // short walls spread over the area, like the walls of a large subroom
+        std::vector<Line> lines;
+        for(int i = 0; i < 500; ++i) {
+            const Point start(pos(gen), pos(gen));
+            lines.emplace_back(start, start + Point(offset(gen), offset(gen)));
+        }
+        // walls along the boundary crossing many cells
+        lines.emplace_back(Point(0, 0), Point(50, 0));
+        lines.emplace_back(Point(50, 0), Point(50, 50));
+
+        WallIndex index;
+        index.Build(lines);
+        REQUIRE(index.GetNumberOfLines() == lines.size());
+
+        for(int i = 0; i < 5000; ++i) {
+            const Point p1(pos(gen), pos(gen));
+            // mostly neighbours within the linked cell range, some far away
+            const Point p2 = (i % 10 == 0) ? Point(pos(gen), pos(gen)) :
+                                             p1 + Point(offset(gen), offset(gen));
+            REQUIRE(index.IntersectsAny(p1, p2) == BruteForceIntersectsAny(lines, p1, p2));
+            REQUIRE(index.CountCandidates(p1, p2) <= lines.size());
+        }
+    }
+
+    SECTION("intersections slightly behind the first point")
+    {
+        std::vector<Line> lines;
+        for(int i = 0; i < 20; ++i) {
+            lines.emplace_back(Point(i, 10), Point(i + 0.5, 10));
+        }
+        // Line::IntersectionWith() accepts up to 5% of the segment behind p1
+        lines.emplace_back(Point(24.9, 0), Point(24.9, 1));
+
+        WallIndex index;
+        index.Build(lines);
+        const Point p1(25, 0.5);
+        const Point p2(29, 0.5);
+        REQUIRE(BruteForceIntersectsAny(lines, p1, p2));
+        REQUIRE(index.IntersectsAny(p1, p2));
+    }
+
+    SECTION("collinear segments")
+    {
+        std::vector<Line> lines;
+        for(int i = 0; i < 20; ++i) {
+            lines.emplace_back(Point(2. * i, 0), Point(2. * i + 1, 0));
+        }
+
+        WallIndex index;
+        index.Build(lines);
+        // sharing an end point counts as intersection
+        REQUIRE(index.IntersectsAny(Point(4.5, 0), Point(5, 0)));
+        for(const auto & [p1, p2] : std::vector<std::pair<Point, Point>>{
+                {Point(4.5, 0), Point(5.5, 0)},
+                {Point(5.2, 0), Point(5.8, 0)},
+                {Point(3, 0), Point(7, 0)},
+                {Point(4.5, 1), Point(5.5, 1)}}) {
+            REQUIRE(index.IntersectsAny(p1, p2) == BruteForceIntersectsAny(lines, p1, p2));
+        }
+    }
+
+    SECTION("segments of other owners are ignored")
+    {
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> pos(0., 20.);
+        std::uniform_real_distribution<double> offset(-2., 2.);
+
+        std::vector<Line> lines;
+        std::vector<int> owners;
+        std::vector<Line> evenLines;
+        for(int i = 0; i < 200; ++i) {
+            const Point start(pos(gen), pos(gen));
+            lines.emplace_back(start, start + Point(offset(gen), offset(gen)));
+            owners.push_back(i % 4);
+            if(i % 2 == 0) {
+                evenLines.push_back(lines.back());
+            }
+        }
+
+        WallIndex index;
+        index.Build(lines, owners);
+        const auto isEven = [](int owner) { return owner % 2 == 0; };
+        for(int i = 0; i < 2000; ++i) {
+            const Point p1(pos(gen), pos(gen));
+            const Point p2 = (i % 10 == 0) ? Point(pos(gen), pos(gen)) :
+                                             p1 + Point(offset(gen), offset(gen));
+            REQUIRE(
+                index.IntersectsAny(p1, p2, isEven) == BruteForceIntersectsAny(evenLines, p1, p2));
+        }
+        REQUIRE_FALSE(index.IntersectsAny(Point(0, 0), Point(20, 20), [](int) { return false; }));
+    }
+
+    SECTION("clear")
+    {
+        WallIndex index;
+        index.Build({Line(Point(0, 0), Point(1, 0))});
+        REQUIRE_FALSE(index.IsEmpty());
+        index.Clear();
+        REQUIRE(index.IsEmpty());
+        REQUIRE_FALSE(index.IntersectsAny(Point(0.5, -1), Point(0.5, 1)));
+    }
+}
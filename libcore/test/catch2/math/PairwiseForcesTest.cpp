@@ -0,0 +1,221 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "TestGeometry.h"
+#include "general/Macros.h"
+#include "geometry/Building.h"
+#include "math/GCFMModel.h"
+#include "math/PairwiseForces.h"
+#include "math/VelocityModel.h"
+#include "pedestrian/Ellipse.h"
+#include "pedestrian/Pedestrian.h"
+#include "pedestrian/PedestrianKinematics.h"
+
+#include <catch2/catch.hpp>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr double TOLERANCE = 1e-12;
+
+JEllipse RandomEllipse(const Point & center, std::mt19937 & gen)
+{
+    std::uniform_real_distribution<double> speed(-1.2, 1.2);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    JEllipse E;
+    E.SetV0(1.34);
+    E.SetV(Point(speed(gen), speed(gen)));
+    E.SetCenter(center);
+    const double phi = angle(gen);
+    E.SetCosPhi(cos(phi));
+    E.SetSinPhi(sin(phi));
+    E.SetXp(0);
+    return E;
+}
+
+void RequireClose(double actual, double expected)
+{
+    REQUIRE(actual == Approx(expected).epsilon(TOLERANCE).margin(TOLERANCE));
+}
+} // namespace
+
+TEST_CASE("math/PairwiseForces", "[math][PairwiseForces]")
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> pos(-2.5, 2.5);
+    constexpr int nNeighbours = 301; // not a multiple of the vector width
+
+    SECTION("velocity model repulsion and spacing")
+    {
+        // reference is the pairwise code of the model
+        VelocityModel model(nullptr, 5., 0.1, 5., 0.02);
+        const VelocityPedParameters parameters{5., 0.1, PeriodicBoundary{}};
+        const Point ei(0.8, 0.6);
+
+        std::vector<std::unique_ptr<Pedestrian>> peds;
+        PedestrianKinematics kinematics;
+        for(int k = 0; k <= nNeighbours; ++k) {
+            peds.emplace_back(std::make_unique<Pedestrian>());
+            peds.back()->SetID(k + 1);
+            peds.back()->SetPos(k == 0 ? Point(0.3, -0.2) : Point(pos(gen), pos(gen)), true);
+            kinematics.Add(peds.back().get());
+        }
+        const VelocityAgent agent{kinematics.GetPos(0), kinematics.GetBmax(0)};
+
+        NeighbourBlock block;
+        for(std::size_t k = 1; k < kinematics.Size(); ++k) {
+            block.Add(k, kinematics.GetPos(k));
+        }
+        PairResults results;
+        REQUIRE(VelocityRepulsion(agent, block, parameters, results) == 0);
+        for(std::size_t k = 0; k < block.Size(); ++k) {
+            const Point expected = model.ForceRepPed(kinematics, 0, block.index[k], 0);
+            RequireClose(results.fx[k], expected._x);
+            RequireClose(results.fy[k], expected._y);
+        }
+
+        REQUIRE(VelocitySpacing(agent, ei, block, parameters.periodic, results) == 0);
+        std::size_t inFront = 0;
+        for(std::size_t k = 0; k < block.Size(); ++k) {
+            const double expected = model.GetSpacing(kinematics, 0, block.index[k], ei, 0).first;
+            RequireClose(results.spacing[k], expected);
+            inFront += expected < FLT_MAX;
+        }
+        REQUIRE(inFront > 0);
+        REQUIRE(inFront < block.Size());
+    }
+
+    SECTION("velocity model reports pedestrians at the same position")
+    {
+        const VelocityAgent agent{Point(1, 1), 0.25};
+        NeighbourBlock block;
+        block.Add(0, Point(2, 1));
+        block.Add(1, Point(1, 1));
+        block.Add(2, Point(1, 2));
+        PairResults results;
+        REQUIRE(VelocityRepulsion(agent, block, {5., 0.1, PeriodicBoundary{}}, results) == 1);
+        REQUIRE(results.irregular == std::vector<unsigned char>{0, 1, 0});
+        REQUIRE(VelocitySpacing(agent, Point(1, 0), block, PeriodicBoundary{}, results) == 1);
+        REQUIRE(results.irregular[1]);
+    }
+
+    SECTION("velocity model with periodic boundary")
+    {
+        // periodic boundary the velocity model uses
+        VelocityModel model(nullptr, 5., 0.1, 5., 0.02);
+        PeriodicBoundary periodic;
+        periodic.enabled = true;
+        periodic.xLeft   = 0.;
+        periodic.xRight  = 26.;
+        periodic.cutoff  = 2.;
+
+        std::vector<std::unique_ptr<Pedestrian>> peds;
+        PedestrianKinematics kinematics;
+        for(const Point & position : {Point(25.5, 1), Point(0.5, 1), Point(24.5, 1)}) {
+            peds.emplace_back(std::make_unique<Pedestrian>());
+            peds.back()->SetPos(position, true);
+            kinematics.Add(peds.back().get());
+        }
+        const VelocityAgent agent{kinematics.GetPos(0), kinematics.GetBmax(0)};
+        NeighbourBlock block;
+        block.Add(1, kinematics.GetPos(1)); // 1 m ahead behind the boundary
+        block.Add(2, kinematics.GetPos(2));
+        PairResults results;
+        VelocitySpacing(agent, Point(1, 0), block, periodic, results);
+        RequireClose(results.spacing[0], 1.);
+        REQUIRE(results.spacing[1] == FLT_MAX);
+        for(std::size_t k = 0; k < block.Size(); ++k) {
+            RequireClose(
+                results.spacing[k],
+                model.GetSpacing(kinematics, 0, block.index[k], Point(1, 0), 1).first);
+        }
+    }
+
+    SECTION("GCFM repulsion")
+    {
+        GCFMModel model(nullptr, 0.6, 0.2, 2., 2., 0.1, 0.1, 3., 3.);
+        const GCFMPedParameters parameters{0.6, 3., 0.1, 2.};
+        // the desired speed of a pedestrian depends on the elevation of its subroom
+        Building building;
+        CreateCorridor(building);
+        auto createPedestrian = [&](const Point & center) {
+            auto ped = std::make_unique<Pedestrian>();
+            ped->SetBuilding(&building);
+            ped->SetRoomID(0, "");
+            ped->SetSubRoomID(0);
+            ped->SetEllipse(RandomEllipse(center, gen));
+            return ped;
+        };
+
+        for(int agentNr = 0; agentNr < 10; ++agentNr) {
+            auto ped                 = createPedestrian(Point(0, 0));
+            const JEllipse & ellipse = ped->GetEllipse();
+            const GCFMAgent agent{
+                ped->GetV(),
+                ped->GetV0Norm(),
+                ped->GetMass(),
+                ellipse.GetCenter(),
+                ellipse.GetCosPhi(),
+                ellipse.GetSinPhi(),
+                ellipse.GetEA(),
+                ellipse.GetEB(),
+                ellipse.GetXp()};
+
+            NeighbourBlock block;
+            std::vector<std::unique_ptr<Pedestrian>> neighbours;
+            for(int k = 0; k < nNeighbours; ++k) {
+                neighbours.emplace_back(createPedestrian(Point(pos(gen), pos(gen))));
+                block.Add(
+                    static_cast<std::size_t>(k),
+                    neighbours.back()->GetV(),
+                    neighbours.back()->GetEllipse());
+            }
+            PairResults results;
+            REQUIRE(GCFMRepulsion(agent, block, parameters, results) == 0);
+
+            std::size_t nonZero = 0;
+            for(std::size_t k = 0; k < block.Size(); ++k) {
+                const Point expected = model.ForceRepPed(ped.get(), neighbours[k].get());
+                RequireClose(results.fx[k], expected._x);
+                RequireClose(results.fy[k], expected._y);
+                nonZero += expected._x != 0 || expected._y != 0;
+            }
+            REQUIRE(nonZero > 0);
+        }
+    }
+
+    SECTION("GCFM reports coinciding action points")
+    {
+        const GCFMPedParameters parameters{0.6, 3., 0.1, 2.};
+        JEllipse E1;
+        E1.SetV0(1.34);
+        E1.SetV(Point(1, 0));
+        E1.SetCenter(Point(1, 1));
+        const GCFMAgent agent{
+            E1.GetV(), 1.34, 1., E1.GetCenter(), 1., 0., E1.GetEA(), E1.GetEB(), 0.};
+        NeighbourBlock block;
+        block.Add(0, Point(0, 0), E1);
+        PairResults results;
+        REQUIRE(GCFMRepulsion(agent, block, parameters, results) == 1);
+        REQUIRE(results.fx[0] == 0.);
+        REQUIRE(results.fy[0] == 0.);
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "math/ParallelSchedule.h"
+
+#include "mpi/LCGrid.h"
+#include "pedestrian/Pedestrian.h"
+#include "pedestrian/PedestrianKinematics.h"
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <vector>
+
+namespace
+{
+/// number of visits of every pedestrian in one parallel loop
+std::vector<int> CountVisits(ParallelSchedule & schedule, std::size_t nPeds, const LCGrid * grid)
+{
+    const int nThreads = omp_get_max_threads();
+    schedule.Prepare(nPeds, nThreads, grid);
+    std::vector<int> visits(nPeds, 0);
+#pragma omp parallel num_threads(nThreads)
+    {
+        schedule.ForEach([&](std::size_t p) {
+#pragma omp atomic
+            ++visits[p];
+        });
+    }
+    return visits;
+}
+} // namespace
+
+TEST_CASE("math/ParallelSchedule", "[math][ParallelSchedule]")
+{
+    const std::size_t nPeds = 1000;
+    std::vector<std::unique_ptr<Pedestrian>> peds;
+    PedestrianKinematics kinematics;
+    for(std::size_t i = 0; i < nPeds; ++i) {
+        peds.emplace_back(std::make_unique<Pedestrian>());
+        kinematics.Add(peds.back().get());
+        peds.back()->SetPos(Point((i * 7) % 20 + 0.5, (i * 13) % 20 + 0.5), true);
+    }
+    double boundaries[4] = {0., 20., 0., 20.};
+    LCGrid grid(boundaries, 2., nPeds);
+    grid.Update(kinematics);
+
+    ParallelSchedule schedule;
+    const auto mode = GENERATE(ScheduleMode::Static, ScheduleMode::Dynamic, ScheduleMode::Cells);
+    schedule.SetMode(mode, 16);
+
+    SECTION("Every pedestrian is visited once")
+    {
+        const std::vector<int> visits = CountVisits(schedule, nPeds, &grid);
+        REQUIRE(visits == std::vector<int>(nPeds, 1));
+    }
+
+    SECTION("Without grid every pedestrian is visited once")
+    {
+        const std::vector<int> visits = CountVisits(schedule, nPeds, nullptr);
+        REQUIRE(visits == std::vector<int>(nPeds, 1));
+    }
+
+    SECTION("Chunk size is at least one")
+    {
+        schedule.SetMode(ScheduleMode::Dynamic, 0);
+        REQUIRE(schedule.GetChunkSize() == 1);
+    }
+}
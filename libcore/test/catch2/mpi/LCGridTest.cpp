@@ -0,0 +1,142 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "mpi/LCGrid.h"
+
+#include "pedestrian/Pedestrian.h"
+#include "pedestrian/PedestrianKinematics.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+/// neighbourhood of pos by checking all pedestrians (cells of 1 m starting at 0)
+std::vector<Pedestrian *> BruteForceNeighbours(
+    const std::vector<std::unique_ptr<Pedestrian>> & peds,
+    const Point & pos,
+    const Pedestrian * exclude)
+{
+    std::vector<Pedestrian *> result;
+    for(const auto & ped : peds) {
+        if(ped.get() == exclude) {
+            continue;
+        }
+        const Point & other = ped->GetPos();
+        if(std::abs(std::floor(other._x) - std::floor(pos._x)) <= 1 &&
+           std::abs(std::floor(other._y) - std::floor(pos._y)) <= 1) {
+            result.push_back(ped.get());
+        }
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE("mpi/LCGrid", "[mpi][LCGrid]")
+{
+    // many pedestrians, so the parallel sort is used if several threads are available
+    const int nPeds = 5000;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dis(0.05, 19.95);
+
+    std::vector<std::unique_ptr<Pedestrian>> peds;
+    PedestrianKinematics kinematics;
+    for(int i = 0; i < nPeds; ++i) {
+        peds.emplace_back(std::make_unique<Pedestrian>());
+        kinematics.Add(peds.back().get());
+        peds.back()->SetPos(Point(dis(gen), dis(gen)), true);
+    }
+
+    double boundaries[4] = {0., 20., 0., 20.};
+    LCGrid grid(boundaries, 1., nPeds);
+    grid.Update(kinematics);
+
+    SECTION("Neighbourhood matches brute force search")
+    {
+        for(int i = 0; i < nPeds; i += 97) {
+            const Pedestrian * ped = peds[i].get();
+            std::vector<Pedestrian *> expected = BruteForceNeighbours(peds, ped->GetPos(), ped);
+
+            std::vector<Pedestrian *> actual;
+            for(const auto & entry : grid.GetNeighbours(ped)) {
+                REQUIRE(entry.ped != ped);
+                REQUIRE(kinematics.GetPedestrian(entry.index) == entry.ped);
+                actual.push_back(entry.ped);
+            }
+
+            std::vector<Pedestrian *> locked;
+            grid.GetNeighbourhood(ped, locked);
+            REQUIRE(locked == actual);
+
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("Neighbourhood of a position contains all pedestrians")
+    {
+        const Point pos(10.5, 3.5);
+        std::vector<Pedestrian *> expected = BruteForceNeighbours(peds, pos, nullptr);
+        std::vector<Pedestrian *> actual;
+        grid.GetNeighbourhood(pos, actual);
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        REQUIRE(actual == expected);
+    }
+
+    SECTION("Pedestrians of a cell are in descending order")
+    {
+        // a single cell covering everything: the whole population in one range
+        double bigBoundaries[4] = {0., 20., 0., 20.};
+        LCGrid single(bigBoundaries, 40., nPeds);
+        single.Update(kinematics);
+
+        std::vector<Pedestrian *> neighbours;
+        single.GetNeighbourhood(Point(10., 10.), neighbours);
+        std::vector<std::size_t> indices;
+        for(const auto * ped : neighbours) {
+            indices.push_back(ped->GetKinematicsIndex());
+        }
+        REQUIRE(indices.size() == static_cast<std::size_t>(nPeds));
+        REQUIRE(std::is_sorted(indices.rbegin(), indices.rend()));
+    }
+
+    SECTION("Positions outside of the grid are clamped to the border cells")
+    {
+        peds[0]->SetPos(Point(-5., -5.), true);
+        grid.Update(kinematics);
+
+        std::vector<Pedestrian *> neighbours;
+        grid.GetNeighbourhood(Point(0.5, 0.5), neighbours);
+        REQUIRE(std::find(neighbours.begin(), neighbours.end(), peds[0].get()) != neighbours.end());
+    }
+
+    SECTION("Cleared grid is empty")
+    {
+        grid.ClearGrid();
+        std::vector<Pedestrian *> neighbours;
+        grid.GetNeighbourhood(Point(10., 10.), neighbours);
+        REQUIRE(neighbours.empty());
+    }
+}
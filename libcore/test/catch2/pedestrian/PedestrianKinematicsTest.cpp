@@ -0,0 +1,83 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "pedestrian/PedestrianKinematics.h"
+
+#include "pedestrian/Pedestrian.h"
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <vector>
+
+TEST_CASE("pedestrian/PedestrianKinematics", "[pedestrian][PedestrianKinematics]")
+{
+    std::vector<std::unique_ptr<Pedestrian>> peds;
+    for(int i = 0; i < 4; ++i) {
+        peds.emplace_back(std::make_unique<Pedestrian>());
+        peds.back()->SetPos(Point(i, 2. * i), true);
+    }
+
+    PedestrianKinematics kinematics;
+    for(auto & ped : peds) {
+        kinematics.Add(ped.get());
+    }
+
+    SECTION("Add copies the current state")
+    {
+        REQUIRE(kinematics.Size() == 4);
+        for(std::size_t i = 0; i < peds.size(); ++i) {
+            REQUIRE(peds[i]->GetKinematicsIndex() == i);
+            REQUIRE(kinematics.GetPedestrian(i) == peds[i].get());
+            REQUIRE(kinematics.GetPos(i)._x == Approx(peds[i]->GetPos()._x));
+            REQUIRE(kinematics.GetPos(i)._y == Approx(peds[i]->GetPos()._y));
+            REQUIRE(kinematics.GetBmax(i) == Approx(peds[i]->GetEllipse().GetBmax()));
+        }
+    }
+
+    SECTION("Setters of the pedestrian write through")
+    {
+        Pedestrian & ped = *peds[2];
+        ped.SetPos(Point(5., 6.));
+        ped.SetV(Point(0.5, 0.));
+        ped.SetRoomID(3, "");
+        ped.SetSubRoomID(4);
+        ped.SetSubRoomUID(17);
+
+        REQUIRE(kinematics.GetPos(2)._x == Approx(5.));
+        REQUIRE(kinematics.GetPos(2)._y == Approx(6.));
+        REQUIRE(kinematics.GetV(2)._x == Approx(0.5));
+        REQUIRE(kinematics.GetEA(2) == Approx(ped.GetLargerAxis()));
+        REQUIRE(kinematics.GetEB(2) == Approx(ped.GetSmallerAxis()));
+        REQUIRE(kinematics.GetUniqueRoomID(2) == ped.GetUniqueRoomID());
+        REQUIRE(kinematics.GetSubRoomUID(2) == 17);
+    }
+
+    SECTION("Remove keeps the order and updates the indices")
+    {
+        kinematics.Remove(1);
+        REQUIRE(kinematics.Size() == 3);
+        REQUIRE(kinematics.GetPedestrian(1) == peds[2].get());
+        REQUIRE(peds[2]->GetKinematicsIndex() == 1);
+        REQUIRE(peds[3]->GetKinematicsIndex() == 2);
+        REQUIRE(kinematics.GetPos(2)._x == Approx(3.));
+
+        // a detached pedestrian does not write to the store anymore
+        peds[1]->SetPos(Point(-1., -1.));
+        REQUIRE(kinematics.GetPos(1)._x == Approx(2.));
+    }
+}
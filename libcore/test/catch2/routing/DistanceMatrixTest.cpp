@@ -0,0 +1,227 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "routing/DistanceMatrix.h"
+
+#include <catch2/catch.hpp>
+#include <cfloat>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+/// sparse random graph with non consecutive UIDs, symmetric edge weights
+std::vector<int> FillRandomGraph(DistanceMatrix & matrix, int n, unsigned int seed)
+{
+    std::vector<int> uids;
+    for(int i = 0; i < n; ++i) {
+        uids.push_back(1000 + 3 * i);
+    }
+    matrix.Reset(uids);
+
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0.5, 10.);
+    for(int e = 0; e < 3 * n; ++e) {
+        const int a = uids[node(gen)];
+        const int b = uids[node(gen)];
+        if(a == b) {
+            continue;
+        }
+        const double w = weight(gen);
+        matrix.SetDistance(a, b, w);
+        matrix.SetDistance(b, a, w);
+    }
+    return uids;
+}
+
+/// textbook Floyd-Warshall on a copy of the edge weights
+std::vector<double> ReferenceDistances(const DistanceMatrix & matrix)
+{
+    const auto & uids = matrix.GetUIDs();
+    const int n       = static_cast<int>(uids.size());
+    std::vector<double> dist(n * n);
+    for(int i = 0; i < n; ++i) {
+        for(int j = 0; j < n; ++j) {
+            dist[i * n + j] = matrix.GetDistance(uids[i], uids[j]);
+        }
+    }
+    for(int k = 0; k < n; ++k) {
+        for(int i = 0; i < n; ++i) {
+            for(int j = 0; j < n; ++j) {
+                if(dist[i * n + k] < DBL_MAX && dist[k * n + j] < DBL_MAX &&
+                   dist[i * n + k] + dist[k * n + j] < dist[i * n + j]) {
+                    dist[i * n + j] = dist[i * n + k] + dist[k * n + j];
+                }
+            }
+        }
+    }
+    return dist;
+}
+} // namespace
+
+TEST_CASE("routing/DistanceMatrix", "[routing][DistanceMatrix]")
+{
+    SECTION("UID lookup")
+    {
+        DistanceMatrix matrix;
+        matrix.Reset(std::vector<int>{7, 3, 12});
+        REQUIRE(matrix.Size() == 3);
+        REQUIRE(matrix.IndexOf(7) == 0);
+        REQUIRE(matrix.IndexOf(3) == 1);
+        REQUIRE(matrix.IndexOf(12) == 2);
+        REQUIRE(matrix.IndexOf(4) == -1);
+        REQUIRE(matrix.IndexOf(-1) == -1);
+        REQUIRE(matrix.IndexOf(13) == -1);
+        REQUIRE(matrix.GetDistance(7, 7) == 0.);
+        REQUIRE_FALSE(matrix.IsReachable(7, 3));
+        REQUIRE(matrix.GetPath(7, 12) == 12);
+        REQUIRE_THROWS_AS(matrix.GetDistance(7, 4), std::out_of_range);
+        REQUIRE_THROWS_AS(matrix.SetDistance(13, 7, 1.), std::out_of_range);
+        REQUIRE_THROWS_AS(matrix.GetPath(-1, 3), std::out_of_range);
+        REQUIRE_THROWS_AS(matrix.UpdateEdge(3, 4, 1.), std::out_of_range);
+    }
+
+    SECTION("Blocked Floyd-Warshall matches reference")
+    {
+        // more than two tiles, last tile only partially filled
+        const int n = 2 * static_cast<int>(DistanceMatrix::BLOCK_SIZE) + 17;
+        DistanceMatrix matrix;
+        const auto uids      = FillRandomGraph(matrix, n, 42);
+        const auto reference = ReferenceDistances(matrix);
+
+        matrix.FloydWarshall();
+
+        for(int i = 0; i < n; ++i) {
+            for(int j = 0; j < n; ++j) {
+                REQUIRE(matrix.GetDistance(uids[i], uids[j]) == Approx(reference[i * n + j]));
+            }
+        }
+    }
+
+    SECTION("Next hops reconstruct the shortest path")
+    {
+        const int n = static_cast<int>(DistanceMatrix::BLOCK_SIZE) + 5;
+        DistanceMatrix matrix;
+        const auto uids = FillRandomGraph(matrix, n, 7);
+        const DistanceMatrix edges = matrix;
+        matrix.FloydWarshall();
+
+        for(int from : uids) {
+            for(int to : uids) {
+                if(!matrix.IsReachable(from, to)) {
+                    continue;
+                }
+                double length = 0.;
+                int current   = from;
+                while(current != to) {
+                    const int next = matrix.GetPath(current, to);
+                    length += edges.GetDistance(current, next);
+                    current = next;
+                }
+                REQUIRE(length == Approx(matrix.GetDistance(from, to)));
+            }
+        }
+    }
+
+    SECTION("Incremental edge updates match full recompute")
+    {
+        const int n = static_cast<int>(DistanceMatrix::BLOCK_SIZE) + 11;
+        DistanceMatrix matrix;
+        const auto uids      = FillRandomGraph(matrix, n, 3);
+        DistanceMatrix edges = matrix;
+        matrix.FloydWarshall();
+
+        auto update = [&](int from, int to, double distance) {
+            matrix.UpdateEdge(from, to, distance);
+            edges.SetDistance(from, to, distance);
+        };
+
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<int> node(0, n - 1);
+        std::uniform_real_distribution<double> weight(0.5, 10.);
+        for(int step = 0; step < 20; ++step) {
+            // close a door: remove all its edges, reopen it again later
+            const int closed = uids[node(gen)];
+            std::vector<std::pair<int, double>> removed;
+            for(int other : uids) {
+                if(other != closed && edges.IsReachable(closed, other)) {
+                    removed.emplace_back(other, edges.GetDistance(closed, other));
+                    update(closed, other, DBL_MAX);
+                    update(other, closed, DBL_MAX);
+                }
+            }
+            // change some other edges, longer, shorter or new
+            for(int e = 0; e < 3; ++e) {
+                const int a = uids[node(gen)];
+                const int b = uids[node(gen)];
+                if(a != b && a != closed && b != closed) {
+                    update(a, b, weight(gen));
+                }
+            }
+
+            DistanceMatrix reference = edges;
+            reference.FloydWarshall();
+            for(int from : uids) {
+                for(int to : uids) {
+                    REQUIRE(matrix.IsReachable(from, to) == reference.IsReachable(from, to));
+                    if(!matrix.IsReachable(from, to)) {
+                        continue;
+                    }
+                    REQUIRE(matrix.GetDistance(from, to) ==
+                            Approx(reference.GetDistance(from, to)));
+                    double length = 0.;
+                    int current   = from;
+                    while(current != to) {
+                        const int next = matrix.GetPath(current, to);
+                        length += edges.GetDistance(current, next);
+                        current = next;
+                    }
+                    REQUIRE(length == Approx(matrix.GetDistance(from, to)));
+                }
+            }
+
+            if(step % 2 == 1) {
+                for(auto [other, distance] : removed) {
+                    update(closed, other, distance);
+                    update(other, closed, distance);
+                }
+            }
+        }
+    }
+
+    SECTION("Predecessors reconstruct the shortest path")
+    {
+        DistanceMatrix matrix(FLT_MAX, DistanceMatrix::PathConvention::Predecessor);
+        matrix.Reset(5);
+        // chain 0 - 1 - 2 - 3 - 4 with a long shortcut 0 - 4
+        for(int i = 0; i < 4; ++i) {
+            matrix.SetDistance(i, i + 1, 1.);
+            matrix.SetDistance(i + 1, i, 1.);
+        }
+        matrix.SetDistance(0, 4, 10.);
+        matrix.FloydWarshall();
+
+        REQUIRE(matrix.GetDistance(0, 4) == Approx(4.));
+        REQUIRE(matrix.GetPath(0, 4) == 3);
+        REQUIRE(matrix.GetPath(0, 3) == 2);
+        REQUIRE(matrix.GetPath(0, 1) == 0);
+        REQUIRE(matrix.GetDistance(4, 0) == Approx(4.));
+    }
+}
@@ -0,0 +1,331 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "routing/ff_router/ffRouter.h"
+
+#include "TestGeometry.h"
+#include "direction/DirectionManager.h"
+#include "direction/walking/DirectionStrategy.h"
+#include "general/Configuration.h"
+#include "general/Filesystem.h"
+#include "general/Macros.h"
+#include "geometry/Building.h"
+#include "geometry/Goal.h"
+#include "pedestrian/Pedestrian.h"
+#include "routing/DistanceMatrix.h"
+#include "routing/RoutingEngine.h"
+#include "routing/ff_router/FloorfieldStore.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cfloat>
+#include <future>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+/// gives the tests access to the distances between the doors
+class TestFFRouter : public FFRouter
+{
+public:
+    TestFFRouter(Configuration & config, RoutingStrategy strategy) :
+        FFRouter(1, strategy, false, &config)
+    {
+    }
+    const DistanceMatrix & GetDistances() const { return _distMatrix; }
+    std::vector<int> GetFloorfieldDoors(int roomID) const
+    {
+        std::vector<int> doors = _locffviafm.at(roomID)->getKnownDoorUIDs();
+        std::sort(doors.begin(), doors.end());
+        doors.erase(std::unique(doors.begin(), doors.end()), doors.end());
+        return doors;
+    }
+    /// stands in for the goal lines of the global floor field of specific goals
+    void SetGoalLine(int goalID, int lineUID) { _goalToLineUIDmap[goalID] = lineUID; }
+
+    /// exit choice of FindExit() without the cache: all open doors of the room to all final doors
+    int FindExitByFullScan(Pedestrian * p) const
+    {
+        std::vector<int> finalDoors;
+        const int goalID = p->GetFinalDestination();
+        if(goalID == -1) {
+            for(auto & pairDoor : _ExitsByUID) {
+                finalDoors.push_back(pairDoor.first);
+            }
+        } else if(_goalToLineUIDmap.count(goalID) != 0) {
+            finalDoors.push_back(_goalToLineUIDmap.at(goalID));
+        }
+
+        std::vector<int> doors;
+        const Room * room = _building->GetRoom(p->GetRoomID());
+        for(int transUID : room->GetAllTransitionsIDs()) {
+            if(_CroTrByUID.count(transUID) != 0 && !_CroTrByUID.at(transUID)->IsClose()) {
+                doors.push_back(transUID);
+            }
+        }
+        for(auto & subroom : room->GetAllSubRooms()) {
+            for(Crossing * crossing : subroom.second->GetAllCrossings()) {
+                if(!crossing->IsClose()) {
+                    doors.push_back(crossing->GetUniqueID());
+                }
+            }
+        }
+
+        const auto & direction = _config->GetDirectionManager()->GetDirectionStrategy();
+        const std::vector<int> & subroomDoors =
+            _building->GetSubRoomByUID(p->GetSubRoomUID())->GetAllGoalIDs();
+        double minDist    = DBL_MAX;
+        int bestDoor      = -1;
+        int bestFinalDoor = -1;
+        for(int finalDoor : finalDoors) {
+            for(int door : doors) {
+                const double locDistToDoor = direction->GetDistance2Target(p, door);
+                if(locDistToDoor < -J_EPS || !_distMatrix.Contains(door) ||
+                   !_distMatrix.Contains(finalDoor) || !_distMatrix.IsReachable(door, finalDoor)) {
+                    continue;
+                }
+                const double distance = _distMatrix.GetDistance(door, finalDoor) + locDistToDoor;
+                if(distance < minDist) {
+                    minDist       = distance;
+                    bestDoor      = door;
+                    bestFinalDoor = finalDoor;
+                    const int nextDoor = _distMatrix.GetPath(door, finalDoor);
+                    if(std::find(subroomDoors.begin(), subroomDoors.end(), nextDoor) !=
+                       subroomDoors.end()) {
+                        bestDoor = nextDoor;
+                    }
+                }
+            }
+        }
+        while(bestDoor != -1 && !_CroTrByUID.at(bestDoor)->IsTransition()) {
+            bestDoor = _distMatrix.GetPath(bestDoor, bestFinalDoor);
+        }
+        return bestDoor;
+    }
+};
+
+/// local distance to a door as the crow flies, the rooms of the tests have nothing in the way
+class EuclideanDirection : public DirectionStrategy
+{
+public:
+    explicit EuclideanDirection(const Building & building) : _building(building) {}
+    Point GetTarget(Room *, Pedestrian *) const override { return Point(); }
+    double GetDistance2Target(Pedestrian * ped, int doorUID) const override
+    {
+        return (_building.GetTransOrCrossByUID(doorUID)->GetCentre() - ped->GetPos()).Norm();
+    }
+
+private:
+    const Building & _building;
+};
+
+int DoorUID(Building & building, int id)
+{
+    return building.GetTransition(id)->GetUniqueID();
+}
+} // namespace
+
+TEST_CASE("routing/FFRouter shared floor fields", "[routing][FFRouter]")
+{
+    Configuration config;
+    Building building;
+    CreateRowOfRooms(building, 3);
+    const int entrance = DoorUID(building, 0);
+    const int exit     = DoorUID(building, 3);
+
+    auto store = std::make_shared<FloorfieldStore>();
+    TestFFRouter first(config, ROUTING_FF_QUICKEST);
+    first.SetFloorfieldStore(store);
+    REQUIRE(first.Init(&building));
+    TestFFRouter second(config, ROUTING_FF_QUICKEST);
+    second.SetFloorfieldStore(store);
+    REQUIRE(second.Init(&building));
+    REQUIRE(store->GetnFloorfields() == 3);
+    const double distance = second.GetDistances().GetDistance(entrance, exit);
+    REQUIRE(distance == Approx(12.).epsilon(0.05));
+
+    SECTION("ReInit replaces the shared fields by complete ones")
+    {
+        REQUIRE(first.ReInit());
+        REQUIRE(first.GetDistances().IsReachable(entrance, exit));
+        //without pedestrians the speed field is the free speed everywhere
+        REQUIRE(first.GetDistances().GetDistance(entrance, exit) == Approx(distance));
+        REQUIRE(second.GetDistances().GetDistance(entrance, exit) == distance);
+    }
+}
+
+TEST_CASE("routing/FFRouter VTK output", "[routing][FFRouter]")
+{
+    const fs::path directory =
+        fs::temp_directory_path() / ("jps_ff_router_" + std::to_string(std::random_device{}()));
+    fs::create_directories(directory);
+    Configuration config;
+    config.SetProjectRootDir(directory);
+    config.set_write_VTK_files(true);
+    Building building;
+    CreateCorridor(building);
+
+    //the door fields are named after the doors of the building
+    TestFFRouter router(config, ROUTING_FF_GLOBAL_SHORTEST);
+    REQUIRE(router.Init(&building));
+    REQUIRE(fs::exists(directory / "ff_vtk_files" / "ffrouterRoom_0_t_0.000000.vtk"));
+
+    fs::remove_all(directory);
+}
+
+TEST_CASE("routing/FFRouter incremental update", "[routing][FFRouter]")
+{
+    Configuration config;
+    config.set_incremental_update(true);
+    Building building;
+    CreateRowOfRooms(building, 2);
+    const int entrance  = DoorUID(building, 0);
+    const int exit      = DoorUID(building, 2);
+    Transition * middle = building.GetTransition(1);
+
+    SECTION("a door closed and opened again gets its former distances")
+    {
+        TestFFRouter router(config, ROUTING_FF_GLOBAL_SHORTEST);
+        REQUIRE(router.Init(&building));
+        const double distance = router.GetDistances().GetDistance(entrance, exit);
+        REQUIRE(distance == Approx(8.).epsilon(0.05));
+
+        middle->Close();
+        router.Update();
+        REQUIRE_FALSE(router.GetDistances().IsReachable(entrance, exit));
+        middle->Open();
+        router.Update();
+        REQUIRE(router.GetDistances().GetDistance(entrance, exit) == distance);
+    }
+
+    SECTION("a door closed in the floor fields is measured when it opens")
+    {
+        middle->Close();
+        TestFFRouter router(config, ROUTING_FF_GLOBAL_SHORTEST);
+        REQUIRE(router.Init(&building));
+        REQUIRE_FALSE(router.GetDistances().IsReachable(entrance, exit));
+
+        middle->Open();
+        router.Update();
+        REQUIRE(router.GetDistances().GetDistance(entrance, exit) == Approx(8.).epsilon(0.05));
+    }
+}
+
+TEST_CASE("routing/FFRouter initialized in the background", "[routing][FFRouter]")
+{
+    Configuration config;
+    Building building;
+    CreateRowOfRooms(building, 3);
+    Transition * door = building.GetTransition(2);
+    const std::map<int, DoorState> doorStates{{door->GetUniqueID(), DoorState::CLOSE}};
+
+    //like the engines of the events, the field of room 0 is shared with the current engine
+    auto store     = std::make_shared<FloorfieldStore>();
+    auto * current = new TestFFRouter(config, ROUTING_FF_GLOBAL_SHORTEST);
+    current->SetFloorfieldStore(store);
+    RoutingEngine currentEngine;
+    currentEngine.AddRouter(current);
+    REQUIRE(currentEngine.Init(&building));
+
+    auto * precomputed = new TestFFRouter(config, ROUTING_FF_GLOBAL_SHORTEST);
+    precomputed->SetFloorfieldStore(store);
+    RoutingEngine precomputedEngine;
+    precomputedEngine.AddRouter(precomputed);
+    std::future<bool> initialized = precomputedEngine.InitAsync(&building, doorStates);
+    REQUIRE(initialized.get());
+    REQUIRE_FALSE(door->IsClose());
+
+    door->Close();
+    auto * synchronous = new TestFFRouter(config, ROUTING_FF_GLOBAL_SHORTEST);
+    RoutingEngine synchronousEngine;
+    synchronousEngine.AddRouter(synchronous);
+    REQUIRE(synchronousEngine.Init(&building));
+
+    //the doors of the floor fields as well, they are built by several threads
+    for(int roomID = 0; roomID < 3; ++roomID) {
+        REQUIRE(precomputed->GetFloorfieldDoors(roomID) == synchronous->GetFloorfieldDoors(roomID));
+    }
+    const DistanceMatrix & expected  = synchronous->GetDistances();
+    const DistanceMatrix & distances = precomputed->GetDistances();
+    REQUIRE(distances.GetUIDs() == expected.GetUIDs());
+    for(int from : expected.GetUIDs()) {
+        for(int to : expected.GetUIDs()) {
+            REQUIRE(distances.GetDistance(from, to) == expected.GetDistance(from, to));
+            REQUIRE(distances.GetPath(from, to) == expected.GetPath(from, to));
+        }
+    }
+    REQUIRE_FALSE(distances.IsReachable(DoorUID(building, 0), DoorUID(building, 2)));
+}
+
+TEST_CASE("routing/FFRouter cached exit lookup", "[routing][FFRouter]")
+{
+    Configuration config;
+    config.set_incremental_update(true);
+    Building building;
+    CreateRowOfRooms(building, 3);
+    auto directionManager = std::make_shared<DirectionManager>();
+    directionManager->SetDirectionStrategy(std::make_shared<EuclideanDirection>(building));
+    config.SetDirectionManager(directionManager);
+    //goals outside of the building, one behind each exit
+    for(int goalID : {1, 2}) {
+        auto * goal = new Goal();
+        goal->SetId(goalID);
+        REQUIRE(building.AddGoal(goal));
+    }
+
+    TestFFRouter router(config, ROUTING_FF_GLOBAL_SHORTEST);
+    router.SetGoalLine(1, DoorUID(building, 0));
+    router.SetGoalLine(2, DoorUID(building, 3));
+    REQUIRE(router.Init(&building));
+
+    //pedestrians every meter along the rooms, heading to any exit and to each goal
+    auto compareWithFullScan = [&]() {
+        std::vector<int> exits;
+        for(int goalID : {-1, 1, 2}) {
+            for(double x = 0.5; x < 12.; x += 1.) {
+                const int roomID = static_cast<int>(x / 4.);
+                Pedestrian ped;
+                ped.SetBuilding(&building);
+                ped.SetRoomID(roomID, "");
+                ped.SetSubRoomID(0);
+                ped.SetSubRoomUID(building.GetRoom(roomID)->GetSubRoom(0)->GetUID());
+                ped.SetPos(Point(x, 1.), true);
+                ped.SetFinalDestination(goalID);
+                const int expected = router.FindExitByFullScan(&ped);
+                REQUIRE(router.FindExit(&ped) == expected);
+                exits.push_back(expected);
+            }
+        }
+        return exits;
+    };
+    const std::vector<int> exits = compareWithFullScan();
+    REQUIRE(std::count(exits.begin(), exits.end(), -1) == 0);
+
+    SECTION("the cache is rebuilt after the distances were repaired")
+    {
+        building.GetTransition(1)->Close();
+        router.Update();
+        const std::vector<int> exitsWithClosedDoor = compareWithFullScan();
+        REQUIRE(exitsWithClosedDoor != exits);
+        //the goal behind the closed door cannot be reached anymore, 4 + 8 pedestrians
+        REQUIRE(std::count(exitsWithClosedDoor.begin(), exitsWithClosedDoor.end(), -1) == 12);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "routing/ff_router/FloorfieldCache.h"
+
+#include "FloorfieldTestUtils.h"
+#include "TestGeometry.h"
+#include "general/Configuration.h"
+#include "general/Filesystem.h"
+#include "geometry/Building.h"
+#include "routing/ff_router/UnivFFviaFM.h"
+#include "routing/ff_router/mesh/RectGrid.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+/// the floor fields of the ff router without their door fields
+std::map<int, UnivFFviaFM *> CreateFloorFields(
+    Building & building,
+    Configuration & config,
+    std::vector<std::unique_ptr<UnivFFviaFM>> & storage)
+{
+    std::map<int, UnivFFviaFM *> floorfields;
+    for(const auto & [id, room] : building.GetAllRooms()) {
+        storage.push_back(CreateFloorField(room.get(), config));
+        floorfields[id] = storage.back().get();
+    }
+    return floorfields;
+}
+
+std::vector<int> SortedDoors(UnivFFviaFM & floorfield)
+{
+    std::vector<int> uids = floorfield.getKnownDoorUIDs();
+    std::sort(uids.begin(), uids.end());
+    return uids;
+}
+} // namespace
+
+TEST_CASE("routing/FloorfieldCache", "[routing][FloorfieldCache]")
+{
+    const fs::path directory = fs::temp_directory_path() /
+                               ("jps_ff_cache_" + std::to_string(std::random_device{}()));
+    Configuration config;
+    Building building;
+    CreateCorridor(building);
+    const std::vector<double> parameters{0.125, 0.0};
+
+    std::vector<std::unique_ptr<UnivFFviaFM>> storage;
+    auto calculated = CreateFloorFields(building, config, storage);
+    for(auto & [id, floorfield] : calculated) {
+        floorfield->addAllTargetsParallel();
+    }
+    FloorfieldCache cache(directory, building, parameters);
+
+    SECTION("missing file")
+    {
+        auto floorfields = CreateFloorFields(building, config, storage);
+        REQUIRE_FALSE(cache.Load(floorfields));
+        REQUIRE(floorfields.at(0)->getKnownDoorUIDs().empty());
+    }
+
+    SECTION("store and load")
+    {
+        REQUIRE(cache.Store(calculated));
+        REQUIRE(fs::exists(cache.GetFile()));
+
+        auto floorfields = CreateFloorFields(building, config, storage);
+        REQUIRE(cache.Load(floorfields));
+
+        UnivFFviaFM * expected = calculated.at(0);
+        UnivFFviaFM * loaded   = floorfields.at(0);
+        const auto doors       = SortedDoors(*expected);
+        REQUIRE(doors.size() == 2);
+        REQUIRE(SortedDoors(*loaded) == doors);
+        const long int nPoints = expected->getGrid()->GetnPoints();
+        for(int uid : doors) {
+            REQUIRE(std::equal(
+                expected->getCostField(uid),
+                expected->getCostField(uid) + nPoints,
+                loaded->getCostField(uid)));
+        }
+        REQUIRE(
+            loaded->getDistanceBetweenDoors(doors[0], doors[1]) ==
+            expected->getDistanceBetweenDoors(doors[0], doors[1]));
+    }
+
+    SECTION("broken file is ignored")
+    {
+        REQUIRE(cache.Store(calculated));
+        fs::resize_file(cache.GetFile(), fs::file_size(cache.GetFile()) - 8);
+
+        auto floorfields = CreateFloorFields(building, config, storage);
+        REQUIRE_FALSE(cache.Load(floorfields));
+        REQUIRE(floorfields.at(0)->getKnownDoorUIDs().empty());
+    }
+
+    SECTION("floor fields that calculate their door fields themselves are untouched")
+    {
+        REQUIRE(cache.Store(calculated));
+
+        auto floorfields = CreateFloorFields(building, config, storage);
+        floorfields.at(0)->setLazy(0);
+        REQUIRE_FALSE(cache.Load(floorfields));
+        for(int uid : SortedDoors(*calculated.at(0))) {
+            REQUIRE(floorfields.at(0)->getCostField(uid) == nullptr);
+        }
+    }
+
+    SECTION("the key depends on parameters and geometry")
+    {
+        REQUIRE(FloorfieldCache(directory, building, parameters).GetKey() == cache.GetKey());
+        REQUIRE(FloorfieldCache(directory, building, {0.25, 0.0}).GetKey() != cache.GetKey());
+
+        building.GetAllTransitions().begin()->second->Close();
+        REQUIRE(FloorfieldCache(directory, building, parameters).GetKey() != cache.GetKey());
+    }
+
+    fs::remove_all(directory);
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "routing/ff_router/FloorfieldStore.h"
+
+#include "FloorfieldTestUtils.h"
+#include "TestGeometry.h"
+#include "general/Configuration.h"
+#include "geometry/Building.h"
+#include "routing/ff_router/UnivFFviaFM.h"
+
+#include <catch2/catch.hpp>
+#include <memory>
+
+TEST_CASE("routing/FloorfieldStore", "[routing][FloorfieldStore]")
+{
+    Configuration config;
+    Building building;
+    CreateRowOfRooms(building, 2);
+    Room & room0 = *building.GetRoom(0);
+    Room & room1 = *building.GetRoom(1);
+
+    FloorfieldStore store;
+    REQUIRE(store.Find(room0) == nullptr);
+    std::shared_ptr<UnivFFviaFM> floorfield0 = CreateFloorField(&room0, config);
+    std::shared_ptr<UnivFFviaFM> floorfield1 = CreateFloorField(&room1, config);
+    store.Insert(room0, floorfield0);
+    store.Insert(room1, floorfield1);
+    REQUIRE(store.GetnFloorfields() == 2);
+    REQUIRE(store.Find(room0) == floorfield0);
+    REQUIRE(store.Find(room1) == floorfield1);
+
+    SECTION("door states")
+    {
+        //the exit of room 1 is a wall in its floor field now, room 0 is not affected
+        building.GetTransition(2)->Close();
+        REQUIRE(store.Find(room0) == floorfield0);
+        REQUIRE(store.Find(room1) == nullptr);
+
+        std::shared_ptr<UnivFFviaFM> closed = CreateFloorField(&room1, config);
+        store.Insert(room1, closed);
+        REQUIRE(store.Find(room1) == closed);
+        REQUIRE(store.GetnFloorfields() == 3);
+
+        building.GetTransition(2)->Open();
+        REQUIRE(store.Find(room1) == floorfield1);
+
+        //the door between the rooms changes both
+        building.GetTransition(1)->Close();
+        REQUIRE(store.Find(room0) == nullptr);
+        REQUIRE(store.Find(room1) == nullptr);
+    }
+
+    SECTION("reference counting")
+    {
+        floorfield1.reset();
+        REQUIRE(store.Find(room1) == nullptr);
+        REQUIRE(store.GetnFloorfields() == 1);
+    }
+
+    SECTION("remove")
+    {
+        store.Remove(floorfield0.get());
+        REQUIRE(store.Find(room0) == nullptr);
+        REQUIRE(store.Find(room1) == floorfield1);
+    }
+}
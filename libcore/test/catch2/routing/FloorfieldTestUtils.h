@@ -0,0 +1,41 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#pragma once
+
+#include "general/Configuration.h"
+#include "general/Macros.h"
+#include "geometry/Room.h"
+#include "routing/ff_router/UnivFFviaFM.h"
+
+#include <memory>
+
+/**
+ * Floor field of a room without door fields, by default as used by the ff router
+ */
+inline std::unique_ptr<UnivFFviaFM> CreateFloorField(
+    Room * room,
+    Configuration & config,
+    int user = DISTANCE_MEASUREMENTS_ONLY,
+    int mode = CENTERPOINT)
+{
+    auto floorfield = std::make_unique<UnivFFviaFM>(room, &config, 0.125, 0.0, false);
+    floorfield->setUser(user);
+    floorfield->setMode(mode);
+    floorfield->setSpeedMode(FF_HOMO_SPEED);
+    return floorfield;
+}
@@ -0,0 +1,433 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+#include "routing/ff_router/UnivFFviaFM.h"
+
+#include "FloorfieldTestUtils.h"
+#include "TestGeometry.h"
+#include "general/Configuration.h"
+#include "general/Macros.h"
+#include "geometry/Building.h"
+#include "geometry/Room.h"
+#include "geometry/SubRoom.h"
+#include "geometry/Transition.h"
+#include "geometry/Wall.h"
+#include "routing/ff_router/mesh/RectGrid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <map>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// L shaped hall of 20 m x 6 m and 6 m x 10 m, exits at the end of both arms
+void CreateHall(Building & building)
+{
+    auto * room = new Room();
+    room->SetID(0);
+    auto * sub = new NormalSubRoom();
+    sub->SetSubRoomID(0);
+    sub->SetRoomID(0);
+    sub->SetPlanEquation(0., 0., 0.);
+    sub->AddWall(Wall(Point(0, 0), Point(20, 0)));
+    sub->AddWall(Wall(Point(20, 0), Point(20, 16)));
+    sub->AddWall(Wall(Point(20, 16), Point(17.5, 16)));
+    sub->AddWall(Wall(Point(16.5, 16), Point(14, 16)));
+    sub->AddWall(Wall(Point(14, 16), Point(14, 6)));
+    sub->AddWall(Wall(Point(14, 6), Point(0, 6)));
+    sub->AddWall(Wall(Point(0, 6), Point(0, 3.5)));
+    sub->AddWall(Wall(Point(0, 2.5), Point(0, 0)));
+    room->AddSubRoom(sub);
+    building.AddRoom(room);
+
+    int id = 0;
+    for(const auto & [p1, p2] : {std::make_pair(Point(0, 2.5), Point(0, 3.5)),
+                                 std::make_pair(Point(16.5, 16), Point(17.5, 16))}) {
+        auto * door = new Transition();
+        door->SetID(id++);
+        door->SetPoint1(p1);
+        door->SetPoint2(p2);
+        door->SetRoom1(room);
+        door->SetSubRoom1(sub);
+        sub->AddTransition(door);
+        room->AddTransitionID(door->GetUniqueID());
+        building.AddTransition(door);
+    }
+    REQUIRE(building.InitGeometry());
+}
+
+/// floor field of the room as used by DirectionLocalFloorfield
+std::unique_ptr<UnivFFviaFM> CreateLocalFloorField(Building & building, Configuration & config)
+{
+    return CreateFloorField(
+        building.GetAllRooms().at(0).get(), config, DISTANCE_AND_DIRECTIONS_USED, LINESEGMENT);
+}
+
+/// floor field that runs out of memory in the first calculation of a door field
+class ThrowingFloorField : public UnivFFviaFM
+{
+public:
+    using UnivFFviaFM::UnivFFviaFM;
+    void calcTarget(const int uid, double * costarray, Point * gradarray) override
+    {
+        if(_throws.exchange(false)) {
+            //give a concurrent reader of the door time to wait for this calculation
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            throw std::bad_alloc();
+        }
+        UnivFFviaFM::calcTarget(uid, costarray, gradarray);
+    }
+
+private:
+    std::atomic<bool> _throws{true};
+};
+
+/// path of an agent following the direction field to door uid in steps of 2 cm
+std::vector<Point> FollowDirections(UnivFFviaFM & floorfield, int uid, Point pos)
+{
+    std::vector<Point> path{pos};
+    for(int step = 0; step < 2000 && floorfield.getCostToDestination(uid, pos) > 0.05; ++step) {
+        Point direction;
+        floorfield.getDirectionToUID(uid, pos, direction);
+        pos = pos + direction * 0.02;
+        path.push_back(pos);
+    }
+    return path;
+}
+} // namespace
+
+TEST_CASE("routing/UnivFFviaFM lazy door fields", "[routing][UnivFFviaFM]")
+{
+    Configuration config;
+    Building building;
+    CreateCorridor(building);
+
+    auto eager = CreateLocalFloorField(building, config);
+    eager->addAllTargetsParallel();
+    auto lazy = CreateLocalFloorField(building, config);
+
+    const std::vector<int> doors = eager->getKnownDoorUIDs();
+    REQUIRE(doors.size() == 2);
+    const long int nPoints       = eager->getGrid()->GetnPoints();
+    const std::size_t fieldBytes = nPoints * (sizeof(double) + sizeof(Point));
+
+    std::vector<Point> positions;
+    for(double x = 0.1; x < 4.; x += 0.3) {
+        for(double y = 0.1; y < 2.; y += 0.3) {
+            positions.emplace_back(x, y);
+        }
+    }
+
+    SECTION("fields are calculated on first use")
+    {
+        lazy->setLazy(0);
+        REQUIRE(lazy->getKnownDoorUIDs().size() == doors.size());
+        REQUIRE(lazy->getCostField(doors[0]) == nullptr);
+        for(const Point & pos : positions) {
+            for(int uid : doors) {
+                REQUIRE(
+                    lazy->getCostToDestination(uid, pos) == eager->getCostToDestination(uid, pos));
+                Point expected;
+                Point direction;
+                eager->getDirectionToUID(uid, pos, expected);
+                lazy->getDirectionToUID(uid, pos, direction);
+                REQUIRE(direction == expected);
+            }
+        }
+        REQUIRE(
+            lazy->getDistanceBetweenDoors(doors[0], doors[1]) ==
+            eager->getDistanceBetweenDoors(doors[0], doors[1]));
+    }
+
+    SECTION("the least recently used field is freed")
+    {
+        lazy->setLazy(fieldBytes);
+        const Point pos(2., 1.);
+        lazy->getCostToDestination(doors[0], pos);
+        REQUIRE(lazy->getCostField(doors[0]) != nullptr);
+
+        lazy->getCostToDestination(doors[1], pos);
+        REQUIRE(lazy->getCostField(doors[0]) == nullptr);
+        REQUIRE(lazy->getCostField(doors[1]) != nullptr);
+
+        // recalculated after it was freed
+        REQUIRE(
+            lazy->getCostToDestination(doors[0], pos) ==
+            eager->getCostToDestination(doors[0], pos));
+        REQUIRE(lazy->getCostField(doors[1]) == nullptr);
+    }
+
+    SECTION("concurrent first use")
+    {
+        lazy->setLazy(fieldBytes);
+        const long int nQueries = static_cast<long int>(positions.size() * doors.size()) * 8;
+        std::vector<double> costs(nQueries);
+#pragma omp parallel for
+        for(long int i = 0; i < nQueries; ++i) {
+            const int uid = doors[(i / 7) % doors.size()];
+            costs[i]      = lazy->getCostToDestination(uid, positions[i % positions.size()]);
+        }
+        for(long int i = 0; i < nQueries; ++i) {
+            const int uid = doors[(i / 7) % doors.size()];
+            REQUIRE(costs[i] == eager->getCostToDestination(uid, positions[i % positions.size()]));
+        }
+    }
+
+    SECTION("a failed calculation is passed on")
+    {
+        ThrowingFloorField throwing(
+            building.GetAllRooms().at(0).get(), &config, 0.125, 0.0, false);
+        throwing.setUser(DISTANCE_AND_DIRECTIONS_USED);
+        throwing.setMode(LINESEGMENT);
+        throwing.setSpeedMode(FF_HOMO_SPEED);
+        throwing.setLazy(0);
+        const Point pos(2., 1.);
+        const double expected = eager->getCostToDestination(doors[0], pos);
+
+        //one of two concurrent readers gets the error, the other one calculates the field
+        auto read = [&]() {
+            try {
+                return throwing.getCostToDestination(doors[0], pos);
+            } catch(const std::bad_alloc &) {
+                return -1.;
+            }
+        };
+        std::future<double> other = std::async(std::launch::async, read);
+        std::vector<double> costs{read(), other.get()};
+        std::sort(costs.begin(), costs.end());
+        REQUIRE(costs == std::vector<double>{-1., expected});
+        REQUIRE(throwing.getCostToDestination(doors[0], pos) == expected);
+    }
+}
+
+TEST_CASE("routing/UnivFFviaFM compact storage", "[routing][UnivFFviaFM]")
+{
+    Configuration config;
+    Building building;
+    CreateCorridor(building);
+
+    auto exact = CreateLocalFloorField(building, config);
+    exact->addAllTargetsParallel();
+    auto compact = CreateLocalFloorField(building, config);
+    compact->setStorage(FF_STORAGE_COMPACT);
+    compact->addAllTargetsParallel();
+
+    //the threads add the doors in any order, the paths below start far from the first door
+    std::vector<int> doors = exact->getKnownDoorUIDs();
+    std::sort(doors.begin(), doors.end());
+    REQUIRE(doors.size() == 2);
+    // the double arrays are freed
+    REQUIRE(compact->getCostField(doors[0]) == nullptr);
+
+    SECTION("cost and direction error")
+    {
+        RectGrid * grid     = exact->getGrid();
+        SubRoom ** subrooms = exact->getSubRoomFF();
+        double maxCostError = 0.;
+        double maxDirError  = 0.;
+        for(int uid : doors) {
+            for(long int key = 1; key < grid->GetnPoints(); ++key) {
+                if(!subrooms[key]) {
+                    continue;
+                }
+                const Point pos   = grid->getPointFromKey(key);
+                const double cost = exact->getCostToDestination(uid, pos);
+                maxCostError      = std::max(
+                    maxCostError,
+                    std::fabs(compact->getCostToDestination(uid, pos) - cost) /
+                        std::max(1., std::fabs(cost)));
+                Point expected;
+                Point direction;
+                exact->getDirectionToUID(uid, key, expected);
+                compact->getDirectionToUID(uid, key, direction);
+                maxDirError = std::max(maxDirError, (direction - expected).Norm());
+            }
+        }
+        INFO("max relative cost error " << maxCostError << ", direction error " << maxDirError);
+        REQUIRE(maxCostError < 1e-6);
+        REQUIRE(maxDirError < 1e-4);
+    }
+
+    SECTION("trajectory deviation")
+    {
+        double maxDeviation = 0.;
+        for(const Point & start : {Point(3.8, 0.2), Point(2., 1.8), Point(3.5, 1.)}) {
+            const std::vector<Point> expected = FollowDirections(*exact, doors[0], start);
+            const std::vector<Point> path     = FollowDirections(*compact, doors[0], start);
+            REQUIRE(expected.size() > 100);
+            const std::size_t n = std::min(expected.size(), path.size());
+            for(std::size_t i = 0; i < n; ++i) {
+                maxDeviation = std::max(maxDeviation, (path[i] - expected[i]).Norm());
+            }
+            REQUIRE((expected.back() - path.back()).Norm() < 0.05);
+        }
+        INFO("max deviation of the paths " << maxDeviation << " m");
+        REQUIRE(maxDeviation < 0.01);
+    }
+
+    SECTION("lazy compact fields")
+    {
+        auto lazy = CreateLocalFloorField(building, config);
+        lazy->setStorage(FF_STORAGE_COMPACT);
+        lazy->setLazy(0);
+        for(double x = 0.1; x < 4.; x += 0.3) {
+            const Point pos(x, 1.);
+            for(int uid : doors) {
+                REQUIRE(
+                    lazy->getCostToDestination(uid, pos) ==
+                    compact->getCostToDestination(uid, pos));
+                Point expected;
+                Point direction;
+                compact->getDirectionToUID(uid, pos, expected);
+                lazy->getDirectionToUID(uid, pos, direction);
+                REQUIRE(direction == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("routing/UnivFFviaFM multilevel fields", "[routing][UnivFFviaFM]")
+{
+    Configuration config;
+    Building building;
+    CreateHall(building);
+
+    auto exact = CreateLocalFloorField(building, config);
+    exact->addAllTargetsParallel();
+    auto multiLevel = CreateLocalFloorField(building, config);
+    multiLevel->setStorage(FF_STORAGE_MULTILEVEL);
+    multiLevel->setBlockSize(8);
+    multiLevel->addAllTargetsParallel();
+
+    //the threads add the doors in any order, the paths below start far from the first door
+    std::vector<int> doors = exact->getKnownDoorUIDs();
+    std::sort(doors.begin(), doors.end());
+    REQUIRE(doors.size() == 2);
+    REQUIRE(multiLevel->getCostField(doors[0]) == nullptr);
+    INFO(
+        "bytes per door field " << multiLevel->getDoorFieldBytes() << " instead of "
+                                << exact->getDoorFieldBytes());
+    REQUIRE(multiLevel->getDoorFieldBytes() < exact->getDoorFieldBytes() / 2);
+
+    SECTION("costs and directions")
+    {
+        RectGrid * grid     = exact->getGrid();
+        SubRoom ** subrooms = exact->getSubRoomFF();
+        double maxCostError = 0.;
+        double maxDirError  = 0.;
+        for(int uid : doors) {
+            for(long int key = 1; key < grid->GetnPoints(); ++key) {
+                if(!subrooms[key]) {
+                    continue;
+                }
+                const Point pos   = grid->getPointFromKey(key);
+                const double cost = exact->getCostToDestination(uid, pos);
+                maxCostError      = std::max(
+                    maxCostError,
+                    std::fabs(multiLevel->getCostToDestination(uid, pos) - cost) /
+                        std::max(1., cost));
+                Point expected;
+                Point direction;
+                exact->getDirectionToUID(uid, key, expected);
+                multiLevel->getDirectionToUID(uid, key, direction);
+                if(cost > 1.) {
+                    maxDirError = std::max(maxDirError, (direction - expected).Norm());
+                }
+            }
+        }
+        INFO("max relative cost error " << maxCostError << ", direction error " << maxDirError);
+        REQUIRE(maxCostError < 0.03);
+        REQUIRE(maxDirError < 0.2);
+        REQUIRE(
+            multiLevel->getDistanceBetweenDoors(doors[0], doors[1]) ==
+            Approx(exact->getDistanceBetweenDoors(doors[0], doors[1])).epsilon(0.02));
+    }
+
+    SECTION("trajectory deviation")
+    {
+        double maxDeviation = 0.;
+        for(const Point & start : {Point(19., 1.), Point(15., 5.), Point(10., 3.)}) {
+            const std::vector<Point> expected = FollowDirections(*exact, doors[0], start);
+            const std::vector<Point> path     = FollowDirections(*multiLevel, doors[0], start);
+            REQUIRE(exact->getCostToDestination(doors[0], expected.back()) <= 0.05);
+            REQUIRE(multiLevel->getCostToDestination(doors[0], path.back()) <= 0.05);
+            REQUIRE((expected.back() - path.back()).Norm() < 0.5);
+            const std::size_t n = std::min(expected.size(), path.size());
+            for(std::size_t i = 0; i < n; ++i) {
+                maxDeviation = std::max(maxDeviation, (path[i] - expected[i]).Norm());
+            }
+        }
+        INFO("max deviation of the paths " << maxDeviation << " m");
+        REQUIRE(maxDeviation < 0.5);
+    }
+
+    SECTION("lazy multilevel fields")
+    {
+        auto lazy = CreateLocalFloorField(building, config);
+        lazy->setStorage(FF_STORAGE_MULTILEVEL);
+        lazy->setBlockSize(8);
+        lazy->setLazy(0);
+        for(double x = 0.5; x < 20.; x += 0.7) {
+            const Point pos(x, 3.2);
+            for(int uid : doors) {
+                REQUIRE(
+                    lazy->getCostToDestination(uid, pos) ==
+                    multiLevel->getCostToDestination(uid, pos));
+            }
+        }
+    }
+}
+
+TEST_CASE("routing/UnivFFviaFM door fields of several rooms", "[routing][UnivFFviaFM]")
+{
+    Configuration config;
+    Building corridor;
+    CreateCorridor(corridor);
+    Building hall;
+    CreateHall(hall);
+
+    std::vector<std::unique_ptr<UnivFFviaFM>> expected;
+    expected.emplace_back(CreateLocalFloorField(corridor, config));
+    expected.emplace_back(CreateLocalFloorField(hall, config));
+    std::vector<std::unique_ptr<UnivFFviaFM>> joint;
+    joint.emplace_back(CreateLocalFloorField(corridor, config));
+    joint.emplace_back(CreateLocalFloorField(hall, config));
+
+    std::map<int, UnivFFviaFM *> floorfields;
+    for(std::size_t i = 0; i < joint.size(); ++i) {
+        expected[i]->addAllTargetsParallel();
+        floorfields[static_cast<int>(i)] = joint[i].get();
+    }
+    UnivFFviaFM::addAllTargetsParallel(floorfields);
+
+    for(std::size_t i = 0; i < joint.size(); ++i) {
+        const long int nPoints = joint[i]->getGrid()->GetnPoints();
+        for(int uid : expected[i]->getKnownDoorUIDs()) {
+            const double * cost = joint[i]->getCostField(uid);
+            REQUIRE(cost != nullptr);
+            REQUIRE(std::equal(cost, cost + nPoints, expected[i]->getCostField(uid)));
+        }
+    }
+}